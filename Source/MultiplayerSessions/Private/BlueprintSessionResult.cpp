@@ -3,3 +3,15 @@
 
 #include "BlueprintSessionResult.h"
 
+void FBPSessionResult::SetFromOnlineResult(const FOnlineSessionSearchResult& OnlineResult)
+{
+	SearchResult = OnlineResult;
+	Id = OnlineResult.GetSessionIdStr();
+	OwningUserName = OnlineResult.Session.OwningUserName;
+	SessionSettings.Reset();
+	for (const auto& Setting : OnlineResult.Session.SessionSettings.Settings)
+	{
+		// Typed attributes are advertised with their native type, ToString covers every type
+		SessionSettings.Add(Setting.Key, Setting.Value.Data.ToString());
+	}
+}
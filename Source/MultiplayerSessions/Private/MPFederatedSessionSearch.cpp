@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPFederatedSessionSearch.h"
+
+#include "MPSessionSchema.h"
+#include "OnlineSubsystem.h"
+#include "Interfaces/OnlineIdentityInterface.h"
+
+DEFINE_LOG_CATEGORY(LogMPFederatedSearch);
+
+FMPFederatedSessionSearch::FMPFederatedSessionSearch(FMPOnFederatedSearchResults&& InOnResults, FMPOnFederatedSearchComplete&& InOnComplete, const float TimeoutSeconds)
+	: OnResults(MoveTemp(InOnResults))
+	, OnComplete(MoveTemp(InOnComplete))
+	, StartTime(FPlatformTime::Seconds())
+{
+	TimeoutHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateLambda([this](float)
+		{
+			TimeoutHandle.Reset();
+			OnTimeout();
+			return false;
+		}),
+		FMath::Max(TimeoutSeconds, 1.f)
+	);
+}
+
+FMPFederatedSessionSearch::~FMPFederatedSessionSearch()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TimeoutHandle);
+}
+
+bool FMPFederatedSessionSearch::IssueSearch(const FName OnlineSubsystemName, const TSharedRef<FOnlineSessionSearch>& Search, const int32 SearchingPlayerNum)
+{
+	IOnlineSubsystem* OnlineSubsystem = IOnlineSubsystem::Get(OnlineSubsystemName);
+	const IOnlineSessionPtr Sessions = OnlineSubsystem ? OnlineSubsystem->GetSessionInterface() : nullptr;
+	if (!Sessions.IsValid())
+	{
+		UE_LOG(LogMPFederatedSearch, Warning, TEXT("Online subsystem '%s' isn't available, it isn't searched"), *OnlineSubsystemName.ToString());
+		return false;
+	}
+
+	AddPendingBackend(OnlineSubsystemName);
+	FRemoteSearch& RemoteSearch = RemoteSearches.AddDefaulted_GetRef();
+	RemoteSearch.OnlineSubsystemName = OnlineSubsystemName;
+	RemoteSearch.Search = Search;
+	RemoteSearch.CompleteBinding = FMPScopedDelegateBinding::ForInterface(
+		Sessions,
+		Sessions->AddOnFindSessionsCompleteDelegate_Handle(FOnFindSessionsCompleteDelegate::CreateRaw(this, &FMPFederatedSessionSearch::OnRemoteSearchComplete, OnlineSubsystemName)),
+		&IOnlineSession::ClearOnFindSessionsCompleteDelegate_Handle
+	);
+
+	const IOnlineIdentityPtr Identity = OnlineSubsystem->GetIdentityInterface();
+	const FUniqueNetIdPtr SearchingPlayerId = Identity.IsValid() ? Identity->GetUniquePlayerId(SearchingPlayerNum) : nullptr;
+	const bool bHasIssuedSearch = SearchingPlayerId.IsValid()
+		? Sessions->FindSessions(*SearchingPlayerId, Search)
+		: Sessions->FindSessions(SearchingPlayerNum, Search);
+	if (!bHasIssuedSearch)
+	{
+		UE_LOG(LogMPFederatedSearch, Warning, TEXT("Online subsystem '%s' refused the search"), *OnlineSubsystemName.ToString());
+		// It may have answered synchronously before refusing, then it is no longer pending
+		if (const int32 Index = RemoteSearches.IndexOfByPredicate([OnlineSubsystemName](const FRemoteSearch& Other) { return Other.OnlineSubsystemName == OnlineSubsystemName; }); Index != INDEX_NONE)
+		{
+			RemoteSearches.RemoveAt(Index);
+			PendingBackendNames.Remove(OnlineSubsystemName);
+			--NumPendingBackends;
+			--NumBackends;
+		}
+		return false;
+	}
+	UE_LOG(LogMPFederatedSearch, Log, TEXT("Searching sessions on '%s'"), *OnlineSubsystemName.ToString());
+	return true;
+}
+
+void FMPFederatedSessionSearch::AddPendingBackend(const FName OnlineSubsystemName)
+{
+	PendingBackendNames.Add(OnlineSubsystemName);
+	++NumPendingBackends;
+	++NumBackends;
+}
+
+void FMPFederatedSessionSearch::OnRemoteSearchComplete(bool bWasSuccessful, FName OnlineSubsystemName)
+{
+	const int32 Index = RemoteSearches.IndexOfByPredicate([OnlineSubsystemName](const FRemoteSearch& RemoteSearch) { return RemoteSearch.OnlineSubsystemName == OnlineSubsystemName; });
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+	const TSharedPtr<FOnlineSessionSearch> Search = RemoteSearches[Index].Search;
+	// Removing the entry also removes the binding, the backend may reuse its delegates for a later search
+	RemoteSearches.RemoveAt(Index);
+	OnBackendSearchComplete(OnlineSubsystemName, Search->SearchResults, bWasSuccessful);
+}
+
+void FMPFederatedSessionSearch::OnBackendSearchComplete(const FName OnlineSubsystemName, const TArray<FOnlineSessionSearchResult>& BackendResults, const bool bWasSuccessful)
+{
+	if (PendingBackendNames.Remove(OnlineSubsystemName) == 0)
+	{
+		UE_LOG(LogMPFederatedSearch, Log, TEXT("'%s' answered after the deadline, its results are dropped"), *OnlineSubsystemName.ToString());
+		return;
+	}
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+	if (Seconds >= SlowestBackendSeconds)
+	{
+		SlowestBackend = OnlineSubsystemName;
+		SlowestBackendSeconds = Seconds;
+	}
+
+	TArray<FMPFederatedSearchResult> NewResults;
+	if (bWasSuccessful)
+	{
+		bHasAnySucceeded = true;
+		for (const FOnlineSessionSearchResult& BackendResult : BackendResults)
+		{
+			FString SessionKey = GetSessionKey(OnlineSubsystemName, BackendResult);
+			if (ResultIndices.Contains(SessionKey))
+			{
+				UE_LOG(LogMPFederatedSearch, Verbose, TEXT("Session '%s' found again on '%s'"), *SessionKey, *OnlineSubsystemName.ToString());
+				continue;
+			}
+			ResultIndices.Add(SessionKey, Results.Num());
+			Results.Add({ OnlineSubsystemName, BackendResult, MoveTemp(SessionKey) });
+			NewResults.Add(Results.Last());
+		}
+	}
+	UE_LOG(LogMPFederatedSearch, Log, TEXT("'%s' answered in %.3f s (%s), %d of its %d sessions are new"),
+		*OnlineSubsystemName.ToString(), Seconds, bWasSuccessful ? TEXT("success") : TEXT("failure"), NewResults.Num(), BackendResults.Num());
+
+	if (NewResults.Num() > 0)
+	{
+		OnResults.ExecuteIfBound(OnlineSubsystemName, NewResults);
+	}
+	if (--NumPendingBackends == 0)
+	{
+		Complete();
+	}
+}
+
+void FMPFederatedSessionSearch::FinishIssuing()
+{
+	if (--NumPendingBackends == 0)
+	{
+		Complete();
+	}
+}
+
+void FMPFederatedSessionSearch::OnTimeout()
+{
+	if (PendingBackendNames.Num() == 0)
+	{
+		return;
+	}
+	UE_LOG(LogMPFederatedSearch, Warning, TEXT("%d backends didn't answer in time, they are completed as failed"), PendingBackendNames.Num());
+	for (const FName& OnlineSubsystemName : PendingBackendNames.Array())
+	{
+		// Unbinds it, a late answer no longer reaches the search
+		RemoteSearches.RemoveAll([OnlineSubsystemName](const FRemoteSearch& RemoteSearch) { return RemoteSearch.OnlineSubsystemName == OnlineSubsystemName; });
+		OnBackendSearchComplete(OnlineSubsystemName, TArray<FOnlineSessionSearchResult>(), false);
+	}
+}
+
+void FMPFederatedSessionSearch::Complete()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TimeoutHandle);
+	TimeoutHandle.Reset();
+	UE_LOG(LogMPFederatedSearch, Log, TEXT("Found %d sessions on %d backends in %.3f s, the slowest being '%s'"),
+		Results.Num(), NumBackends, FPlatformTime::Seconds() - StartTime, *SlowestBackend.ToString());
+	OnComplete.ExecuteIfBound(bHasAnySucceeded);
+}
+
+const FMPFederatedSearchResult* FMPFederatedSessionSearch::FindResult(const FString& SessionKey) const
+{
+	const int32* Index = ResultIndices.Find(SessionKey);
+	return Index ? &Results[*Index] : nullptr;
+}
+
+FString FMPFederatedSessionSearch::GetSessionKey(const FName OnlineSubsystemName, const FOnlineSessionSearchResult& SearchResult)
+{
+	if (FString SessionKey; FMPSessionSchema::Get<FMPSessionKeyKey>(SearchResult.Session.SessionSettings, SessionKey) && !SessionKey.IsEmpty())
+	{
+		return SessionKey;
+	}
+	// Hosts that don't advertise a key can't be matched across backends
+	return FString::Printf(TEXT("%s:%s"), *OnlineSubsystemName.ToString(), *SearchResult.GetSessionIdStr());
+}
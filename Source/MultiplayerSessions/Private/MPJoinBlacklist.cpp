@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPJoinBlacklist.h"
+
+#include "Hash/CityHash.h"
+
+DEFINE_LOG_CATEGORY(LogMPJoinBlacklist);
+
+FMPJoinBlacklist::FMPJoinBlacklist(const int32 InMaxEntries):
+	MaxEntries(FMath::Max(InMaxEntries, 1))
+{
+}
+
+bool FMPJoinBlacklist::Add(const FString& SessionId, const EOnJoinSessionCompleteResult::Type Reason, const float TtlSeconds)
+{
+	if (SessionId.IsEmpty() || !IsBlacklistedReason(Reason) || TtlSeconds <= 0.f)
+	{
+		return false;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const uint64 Hash = HashSessionId(SessionId);
+	if (!Entries.Contains(Hash) && Entries.Num() >= MaxEntries)
+	{
+		RemoveExpired(Now);
+	}
+	if (!Entries.Contains(Hash) && Entries.Num() >= MaxEntries)
+	{
+		uint64 SoonestHash = 0;
+		double SoonestExpireTime = TNumericLimits<double>::Max();
+		for (const TPair<uint64, FEntry>& Entry : Entries)
+		{
+			if (Entry.Value.ExpireTime < SoonestExpireTime)
+			{
+				SoonestHash = Entry.Key;
+				SoonestExpireTime = Entry.Value.ExpireTime;
+			}
+		}
+		Entries.Remove(SoonestHash);
+	}
+
+	Entries.Add(Hash, { Now + TtlSeconds, Reason });
+	UE_LOG(LogMPJoinBlacklist, Log, TEXT("Session %s blacklisted for %.0f s (%s)"), *SessionId, TtlSeconds, LexToString(Reason));
+	return true;
+}
+
+void FMPJoinBlacklist::Remove(const FString& SessionId)
+{
+	Entries.Remove(HashSessionId(SessionId));
+}
+
+bool FMPJoinBlacklist::Contains(const FString& SessionId, EOnJoinSessionCompleteResult::Type* OutReason) const
+{
+	const FEntry* Entry = Entries.Find(HashSessionId(SessionId));
+	if (Entry == nullptr || Entry->ExpireTime <= FPlatformTime::Seconds())
+	{
+		return false;
+	}
+	if (OutReason)
+	{
+		*OutReason = Entry->Reason;
+	}
+	return true;
+}
+
+int32 FMPJoinBlacklist::Filter(TArray<FOnlineSessionSearchResult>& SearchResults)
+{
+	if (Entries.Num() == 0)
+	{
+		return 0;
+	}
+	RemoveExpired(FPlatformTime::Seconds());
+	const int32 NumRemoved = SearchResults.RemoveAll([this](const FOnlineSessionSearchResult& SearchResult)
+	{
+		return Entries.Contains(HashSessionId(SearchResult.GetSessionIdStr()));
+	});
+	if (NumRemoved > 0)
+	{
+		UE_LOG(LogMPJoinBlacklist, Verbose, TEXT("%d blacklisted sessions left out of the search results"), NumRemoved);
+	}
+	return NumRemoved;
+}
+
+void FMPJoinBlacklist::Reset()
+{
+	Entries.Empty();
+}
+
+bool FMPJoinBlacklist::IsBlacklistedReason(const EOnJoinSessionCompleteResult::Type Reason)
+{
+	return Reason == EOnJoinSessionCompleteResult::SessionIsFull
+		|| Reason == EOnJoinSessionCompleteResult::SessionDoesNotExist
+		|| Reason == EOnJoinSessionCompleteResult::CouldNotRetrieveAddress;
+}
+
+uint64 FMPJoinBlacklist::HashSessionId(const FString& SessionId)
+{
+	return CityHash64(reinterpret_cast<const char*>(*SessionId), SessionId.Len() * sizeof(TCHAR));
+}
+
+void FMPJoinBlacklist::RemoveExpired(const double Now)
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (It->Value.ExpireTime <= Now)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
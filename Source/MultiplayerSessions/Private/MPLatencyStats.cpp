@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPLatencyStats.h"
+
+void FMPLatencyStats::Add(const double Seconds)
+{
+	bIsSorted = bIsSorted && (Samples.Num() == 0 || Samples.Last() <= Seconds);
+	Samples.Add(Seconds);
+	Sum += Seconds;
+}
+
+void FMPLatencyStats::Reset()
+{
+	Samples.Reset();
+	bIsSorted = true;
+	Sum = 0.0;
+}
+
+double FMPLatencyStats::GetMean() const
+{
+	return Samples.Num() > 0 ? Sum / Samples.Num() : 0.0;
+}
+
+double FMPLatencyStats::GetMax() const
+{
+	return GetPercentile(100.0);
+}
+
+double FMPLatencyStats::GetPercentile(const double Percentile) const
+{
+	if (Samples.Num() == 0)
+	{
+		return 0.0;
+	}
+	if (!bIsSorted)
+	{
+		Samples.Sort();
+		bIsSorted = true;
+	}
+	const int32 Rank = FMath::CeilToInt32(FMath::Clamp(Percentile, 0.0, 100.0) / 100.0 * Samples.Num());
+	return Samples[FMath::Clamp(Rank - 1, 0, Samples.Num() - 1)];
+}
+
+FString FMPLatencyStats::ToString() const
+{
+	return FString::Printf(TEXT("n=%d mean=%.1fms p50=%.1fms p95=%.1fms p99=%.1fms max=%.1fms"),
+		Num(), GetMean() * 1000.0, GetPercentile(50.0) * 1000.0, GetPercentile(95.0) * 1000.0, GetPercentile(99.0) * 1000.0, GetMax() * 1000.0);
+}
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPListenerProfiler.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+DEFINE_LOG_CATEGORY(LogMPListenerProfiler);
+
+#if MP_WITH_LISTENER_PROFILER
+static TAutoConsoleVariable<int32> CVarMPSessionsProfileListeners(
+	TEXT("MPSessions.ProfileListeners"),
+	0,
+	TEXT("Times each listener of the multiplayer sessions events on its own (0: off, broadcasts as usual)")
+);
+
+static TAutoConsoleVariable<float> CVarMPSessionsListenerBudgetMs(
+	TEXT("MPSessions.ListenerBudgetMs"),
+	1.f,
+	TEXT("Time a single multiplayer sessions listener call may take before it is logged as slow, in milliseconds")
+);
+
+static FAutoConsoleCommand CVarMPSessionsListenerStats(
+	TEXT("MPSessions.ListenerStats"),
+	TEXT("Logs the time spent in each listener of the multiplayer sessions events, slowest first"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FMPListenerProfiler::Get().DumpListenerStats();
+	})
+);
+
+static FAutoConsoleCommand CVarMPSessionsResetListenerStats(
+	TEXT("MPSessions.ResetListenerStats"),
+	TEXT("Clears the listener totals of MPSessions.ListenerStats"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FMPListenerProfiler::Get().ResetListenerStats();
+	})
+);
+#endif
+
+FString FMPListenerProfiler::FListenerStats::GetListenerName() const
+{
+	FString ListenerName;
+	if (const UClass* Class = ListenerClass.Get())
+	{
+		ListenerName = Class->GetName();
+	}
+	else
+	{
+		ListenerName = ListenerClass.IsExplicitlyNull() ? TEXT("<not a UObject>") : TEXT("<unloaded class>");
+	}
+	if (!FunctionName.IsNone())
+	{
+		ListenerName += TEXT("::") + FunctionName.ToString();
+	}
+	return ListenerName;
+}
+
+FMPListenerProfiler::FScope::FScope(const TCHAR* InEventName, const UObject* InListener, const FName InFunctionName):
+	EventName(InEventName),
+	Listener(InListener),
+	FunctionName(InFunctionName)
+{
+	if (IsEnabled())
+	{
+		StartTime = FPlatformTime::Seconds();
+	}
+}
+
+FMPListenerProfiler::FScope::~FScope()
+{
+	if (StartTime > 0.0)
+	{
+		Get().RecordListenerCall(EventName, Listener.Get(), FunctionName, FPlatformTime::Seconds() - StartTime);
+	}
+}
+
+FMPListenerProfiler& FMPListenerProfiler::Get()
+{
+	static FMPListenerProfiler Profiler;
+	return Profiler;
+}
+
+#if MP_WITH_LISTENER_PROFILER
+bool FMPListenerProfiler::IsEnabled()
+{
+	return CVarMPSessionsProfileListeners.GetValueOnAnyThread() != 0;
+}
+#endif
+
+float FMPListenerProfiler::GetBudgetMs()
+{
+#if MP_WITH_LISTENER_PROFILER
+	return CVarMPSessionsListenerBudgetMs.GetValueOnAnyThread();
+#else
+	return 0.f;
+#endif
+}
+
+void FMPListenerProfiler::RecordListenerCall(const TCHAR* EventName, const UObject* Listener, const FName FunctionName, const double Seconds)
+{
+	const FListenerKey Key { EventName, Listener ? Listener->GetClass() : nullptr, FunctionName };
+
+	const float BudgetMs = GetBudgetMs();
+	const bool bIsOverBudget = BudgetMs > 0.f && Seconds * 1000.0 > BudgetMs;
+	if (bIsOverBudget)
+	{
+		UE_LOG(LogMPListenerProfiler, Warning, TEXT("Slow listener of %s: %s (%s) took %.2f ms, budget %.2f ms"),
+			EventName,
+			Listener ? *Listener->GetPathName() : TEXT("<not a UObject>"),
+			*FunctionName.ToString(),
+			Seconds * 1000.0,
+			BudgetMs);
+	}
+
+	FScopeLock Lock(&StatsCriticalSection);
+	FListenerStats& ListenerStats = Stats.FindOrAdd(Key);
+	if (ListenerStats.NumCalls == 0)
+	{
+		ListenerStats.EventName = Key.EventName;
+		ListenerStats.ListenerClass = Key.ListenerClass;
+		ListenerStats.FunctionName = Key.FunctionName;
+	}
+	++ListenerStats.NumCalls;
+	ListenerStats.NumOverBudget += bIsOverBudget ? 1 : 0;
+	ListenerStats.TotalSeconds += Seconds;
+	ListenerStats.MaxSeconds = FMath::Max(ListenerStats.MaxSeconds, Seconds);
+}
+
+TArray<FMPListenerProfiler::FListenerStats> FMPListenerProfiler::GetListenerStats() const
+{
+	TArray<FListenerStats> ListenerStats;
+	{
+		FScopeLock Lock(&StatsCriticalSection);
+		Stats.GenerateValueArray(ListenerStats);
+	}
+	ListenerStats.Sort([](const FListenerStats& A, const FListenerStats& B)
+	{
+		return A.TotalSeconds > B.TotalSeconds;
+	});
+	return ListenerStats;
+}
+
+void FMPListenerProfiler::DumpListenerStats() const
+{
+	const TArray<FListenerStats> ListenerStats = GetListenerStats();
+	UE_LOG(LogMPListenerProfiler, Display, TEXT("%d listeners, budget %.2f ms%s"),
+		ListenerStats.Num(),
+		GetBudgetMs(),
+		IsEnabled() ? TEXT("") : TEXT(" (profiling off)"));
+	for (const FListenerStats& Listener : ListenerStats)
+	{
+		UE_LOG(LogMPListenerProfiler, Display, TEXT("  %-36s %-56s calls %6d  total %9.2f ms  mean %7.3f ms  max %7.2f ms  over budget %d"),
+			Listener.EventName,
+			*Listener.GetListenerName(),
+			Listener.NumCalls,
+			Listener.TotalSeconds * 1000.0,
+			Listener.TotalSeconds * 1000.0 / Listener.NumCalls,
+			Listener.MaxSeconds * 1000.0,
+			Listener.NumOverBudget);
+	}
+}
+
+void FMPListenerProfiler::ResetListenerStats()
+{
+	FScopeLock Lock(&StatsCriticalSection);
+	Stats.Reset();
+}
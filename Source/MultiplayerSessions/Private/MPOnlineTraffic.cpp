@@ -0,0 +1,385 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPOnlineTraffic.h"
+
+#include "MPStandInSessionInfo.h"
+#include "Algo/StableSort.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Serialization/NameAsStringProxyArchive.h"
+
+DEFINE_LOG_CATEGORY(LogMPOnlineTraffic);
+
+namespace
+{
+	constexpr uint32 OnlineTrafficMagic { 0x544F504D }; // "MPOT"
+	constexpr uint32 OnlineTrafficVersion { 1 };
+	const FName ReplayedNetIdType(TEXT("MPReplayed"));
+
+	template <typename ValueType>
+	void SerializeVariantValue(FArchive& Ar, FVariantData& Data)
+	{
+		ValueType Value {};
+		if (Ar.IsSaving())
+		{
+			Data.GetValue(Value);
+		}
+		Ar << Value;
+		if (Ar.IsLoading())
+		{
+			Data.SetValue(Value);
+		}
+	}
+
+	void SerializeVariant(FArchive& Ar, FVariantData& Data)
+	{
+		uint8 Type = static_cast<uint8>(Data.GetType());
+		Ar << Type;
+		switch (static_cast<EOnlineKeyValuePairDataType::Type>(Type))
+		{
+		case EOnlineKeyValuePairDataType::Int32: SerializeVariantValue<int32>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::UInt32: SerializeVariantValue<uint32>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::Int64: SerializeVariantValue<int64>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::UInt64: SerializeVariantValue<uint64>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::Double: SerializeVariantValue<double>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::Float: SerializeVariantValue<float>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::String: SerializeVariantValue<FString>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::Bool: SerializeVariantValue<bool>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::Blob: SerializeVariantValue<TArray<uint8>>(Ar, Data); break;
+		case EOnlineKeyValuePairDataType::Json:
+			{
+				FString Json = Ar.IsSaving() ? Data.ToString() : FString();
+				Ar << Json;
+				if (Ar.IsLoading())
+				{
+					Data.SetJsonValueFromString(Json);
+				}
+				break;
+			}
+		default:
+			if (Ar.IsLoading())
+			{
+				Data.Empty();
+			}
+			break;
+		}
+	}
+
+	void SerializeSessionSettings(FArchive& Ar, FOnlineSessionSettings& Settings)
+	{
+		Ar << Settings.NumPublicConnections;
+		Ar << Settings.NumPrivateConnections;
+		Ar << Settings.bShouldAdvertise;
+		Ar << Settings.bAllowJoinInProgress;
+		Ar << Settings.bIsLANMatch;
+		Ar << Settings.bIsDedicated;
+		Ar << Settings.bUsesStats;
+		Ar << Settings.bAllowInvites;
+		Ar << Settings.bUsesPresence;
+		Ar << Settings.bAllowJoinViaPresence;
+		Ar << Settings.bAllowJoinViaPresenceFriendsOnly;
+		Ar << Settings.bAntiCheatProtected;
+		Ar << Settings.bUseLobbiesIfAvailable;
+		Ar << Settings.bUseLobbiesVoiceChatIfAvailable;
+		Ar << Settings.BuildUniqueId;
+
+		int32 NumSettings = Settings.Settings.Num();
+		Ar << NumSettings;
+		if (Ar.IsLoading())
+		{
+			Settings.Settings.Reset();
+			for (int32 Index = 0; Index < NumSettings && !Ar.IsError(); ++Index)
+			{
+				FName Key;
+				Ar << Key;
+				FOnlineSessionSetting& Setting = Settings.Settings.Add(Key);
+				SerializeVariant(Ar, Setting.Data);
+				uint8 AdvertisementType = 0;
+				Ar << AdvertisementType;
+				Setting.AdvertisementType = static_cast<EOnlineDataAdvertisementType::Type>(AdvertisementType);
+				Ar << Setting.ID;
+			}
+			return;
+		}
+		for (TPair<FName, FOnlineSessionSetting>& Setting : Settings.Settings)
+		{
+			Ar << Setting.Key;
+			SerializeVariant(Ar, Setting.Value.Data);
+			uint8 AdvertisementType = static_cast<uint8>(Setting.Value.AdvertisementType);
+			Ar << AdvertisementType;
+			Ar << Setting.Value.ID;
+		}
+	}
+
+	void SerializeSearchResult(FArchive& Ar, FOnlineSessionSearchResult& SearchResult)
+	{
+		FOnlineSession& Session = SearchResult.Session;
+		Ar << SearchResult.PingInMs;
+		Ar << Session.OwningUserName;
+		Ar << Session.NumOpenPublicConnections;
+		Ar << Session.NumOpenPrivateConnections;
+
+		FString OwningUserId = Ar.IsSaving() && Session.OwningUserId.IsValid() ? Session.OwningUserId->ToString() : FString();
+		FString SessionId = Ar.IsSaving() && Session.SessionInfo.IsValid() ? SearchResult.GetSessionIdStr() : FString();
+		Ar << OwningUserId;
+		Ar << SessionId;
+		if (Ar.IsLoading() && !OwningUserId.IsEmpty())
+		{
+			Session.OwningUserId = FUniqueNetIdString::Create(OwningUserId, ReplayedNetIdType);
+		}
+		if (Ar.IsLoading() && !SessionId.IsEmpty())
+		{
+			Session.SessionInfo = MakeShared<FMPStandInSessionInfo>(SessionId, ReplayedNetIdType);
+		}
+		SerializeSessionSettings(Ar, Session.SessionSettings);
+	}
+}
+
+const TCHAR* FMPOnlineTrafficEvent::LexToString(const EMPOnlineTrafficEvent InKind)
+{
+	switch (InKind)
+	{
+	case EMPOnlineTrafficEvent::LoginCall: return TEXT("LoginCall");
+	case EMPOnlineTrafficEvent::CreateSessionCall: return TEXT("CreateSessionCall");
+	case EMPOnlineTrafficEvent::UpdateSessionCall: return TEXT("UpdateSessionCall");
+	case EMPOnlineTrafficEvent::StartSessionCall: return TEXT("StartSessionCall");
+	case EMPOnlineTrafficEvent::DestroySessionCall: return TEXT("DestroySessionCall");
+	case EMPOnlineTrafficEvent::FindSessionsCall: return TEXT("FindSessionsCall");
+	case EMPOnlineTrafficEvent::FindSessionByIdCall: return TEXT("FindSessionByIdCall");
+	case EMPOnlineTrafficEvent::JoinSessionCall: return TEXT("JoinSessionCall");
+	case EMPOnlineTrafficEvent::LoginComplete: return TEXT("LoginComplete");
+	case EMPOnlineTrafficEvent::CreateSessionComplete: return TEXT("CreateSessionComplete");
+	case EMPOnlineTrafficEvent::UpdateSessionComplete: return TEXT("UpdateSessionComplete");
+	case EMPOnlineTrafficEvent::StartSessionComplete: return TEXT("StartSessionComplete");
+	case EMPOnlineTrafficEvent::DestroySessionComplete: return TEXT("DestroySessionComplete");
+	case EMPOnlineTrafficEvent::FindSessionsComplete: return TEXT("FindSessionsComplete");
+	case EMPOnlineTrafficEvent::FindSessionByIdComplete: return TEXT("FindSessionByIdComplete");
+	case EMPOnlineTrafficEvent::JoinSessionComplete: return TEXT("JoinSessionComplete");
+	default: return TEXT("Unknown");
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FMPOnlineTrafficEvent& Event)
+{
+	uint8 Kind = static_cast<uint8>(Event.Kind);
+	Ar << Kind;
+	if (Kind >= static_cast<uint8>(EMPOnlineTrafficEvent::Num))
+	{
+		Ar.SetError();
+		return Ar;
+	}
+	Event.Kind = static_cast<EMPOnlineTrafficEvent>(Kind);
+	Ar << Event.Time;
+	Ar << Event.SessionName;
+	Ar << Event.bWasSuccessful;
+	Ar << Event.Value;
+	Ar << Event.Id;
+	Ar << Event.Error;
+	Ar << Event.bHasNamedSession;
+	Ar << Event.NamedSessionState;
+	if (Event.Kind == EMPOnlineTrafficEvent::CreateSessionCall || Event.Kind == EMPOnlineTrafficEvent::UpdateSessionCall)
+	{
+		SerializeSessionSettings(Ar, Event.SessionSettings);
+	}
+
+	int32 NumSearchResults = Event.SearchResults.Num();
+	Ar << NumSearchResults;
+	if (Ar.IsLoading())
+	{
+		if (NumSearchResults < 0)
+		{
+			Ar.SetError();
+			return Ar;
+		}
+		Event.SearchResults.SetNum(NumSearchResults);
+	}
+	for (FOnlineSessionSearchResult& SearchResult : Event.SearchResults)
+	{
+		SerializeSearchResult(Ar, SearchResult);
+	}
+	return Ar;
+}
+
+FMPOnlineTrafficRecorder::FMPOnlineTrafficRecorder(const FString& InPath):
+	Path(InPath)
+{
+	FileWriter.Reset(IFileManager::Get().CreateFileWriter(*Path));
+	if (!FileWriter)
+	{
+		UE_LOG(LogMPOnlineTraffic, Error, TEXT("Could not open %s, online traffic is not recorded"), *Path);
+		return;
+	}
+	Writer = MakeUnique<FNameAsStringProxyArchive>(*FileWriter);
+	uint32 Magic = OnlineTrafficMagic;
+	uint32 Version = OnlineTrafficVersion;
+	*Writer << Magic;
+	*Writer << Version;
+	StartTime = FPlatformTime::Seconds();
+	UE_LOG(LogMPOnlineTraffic, Log, TEXT("Recording online traffic to %s"), *Path);
+}
+
+FMPOnlineTrafficRecorder::~FMPOnlineTrafficRecorder()
+{
+	if (FileWriter)
+	{
+		Writer.Reset();
+		FileWriter->Close();
+		UE_LOG(LogMPOnlineTraffic, Log, TEXT("Recorded %d online traffic events to %s"), NumEvents, *Path);
+	}
+}
+
+double FMPOnlineTrafficRecorder::GetTime() const
+{
+	return FPlatformTime::Seconds() - StartTime;
+}
+
+void FMPOnlineTrafficRecorder::Record(FMPOnlineTrafficEvent& Event)
+{
+	if (!Writer)
+	{
+		return;
+	}
+	*Writer << Event;
+	++NumEvents;
+}
+
+FMPOnlineTrafficReplay::FMPOnlineTrafficReplay(const FString& Path, const bool bInAsFastAsPossible):
+	bAsFastAsPossible(bInAsFastAsPossible)
+{
+	bIsLoaded = Load(Path);
+	if (bIsLoaded)
+	{
+		TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMPOnlineTrafficReplay::Tick));
+	}
+}
+
+FMPOnlineTrafficReplay::~FMPOnlineTrafficReplay()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	if (PendingCallbacks.Num() > 0)
+	{
+		UE_LOG(LogMPOnlineTraffic, Verbose, TEXT("Dropping %d pending replayed callbacks"), PendingCallbacks.Num());
+	}
+}
+
+bool FMPOnlineTrafficReplay::Load(const FString& Path)
+{
+	const TUniquePtr<FArchive> FileReader(IFileManager::Get().CreateFileReader(*Path));
+	if (!FileReader)
+	{
+		UE_LOG(LogMPOnlineTraffic, Error, TEXT("Could not open online traffic log %s"), *Path);
+		return false;
+	}
+	FNameAsStringProxyArchive Reader(*FileReader);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	Reader << Magic;
+	Reader << Version;
+	if (Magic != OnlineTrafficMagic || Version != OnlineTrafficVersion)
+	{
+		UE_LOG(LogMPOnlineTraffic, Error, TEXT("%s is not an online traffic log of version %u"), *Path, OnlineTrafficVersion);
+		return false;
+	}
+
+	TArray<FMPOnlineTrafficEvent> Events;
+	while (!Reader.AtEnd())
+	{
+		FMPOnlineTrafficEvent Event;
+		Reader << Event;
+		if (Reader.IsError() || FileReader->IsError())
+		{
+			// e.g. the recording process did not exit cleanly
+			UE_LOG(LogMPOnlineTraffic, Warning, TEXT("%s is truncated after %d events"), *Path, Events.Num());
+			break;
+		}
+		Events.Add(MoveTemp(Event));
+	}
+	// A callback completing synchronously is written before its call, which is stamped before being issued
+	Algo::StableSort(Events, [](const FMPOnlineTrafficEvent& A, const FMPOnlineTrafficEvent& B)
+	{
+		return A.Time < B.Time;
+	});
+
+	// Calls of a kind are answered in order, a callback answers the oldest issued call of its kind not answered yet
+	int32 NextUnansweredCalls[MPNumOnlineTrafficCalls] {};
+	TArray<double> CallTimes[MPNumOnlineTrafficCalls];
+	for (FMPOnlineTrafficEvent& Event : Events)
+	{
+		// Only the game session is replayed, the traffic of other sessions (e.g. pooled ones) would answer its calls
+		if (!Event.SessionName.IsNone() && Event.SessionName != NAME_GameSession)
+		{
+			continue;
+		}
+		if (Event.IsCall())
+		{
+			const int32 CallKind = static_cast<int32>(Event.Kind);
+			FRecordedCall& Call = Calls[CallKind].AddDefaulted_GetRef();
+			Call.bWasIssued = Event.bWasSuccessful;
+			CallTimes[CallKind].Add(Event.Time);
+			continue;
+		}
+		const int32 CallKind = static_cast<int32>(Event.Kind) - MPNumOnlineTrafficCalls;
+		TArray<FRecordedCall>& KindCalls = Calls[CallKind];
+		int32& NextUnansweredCall = NextUnansweredCalls[CallKind];
+		while (KindCalls.IsValidIndex(NextUnansweredCall) && !KindCalls[NextUnansweredCall].bWasIssued)
+		{
+			++NextUnansweredCall;
+		}
+		if (!KindCalls.IsValidIndex(NextUnansweredCall))
+		{
+			UE_LOG(LogMPOnlineTraffic, Verbose, TEXT("%s at %.3fs answers no call, skipped"), FMPOnlineTrafficEvent::LexToString(Event.Kind), Event.Time);
+			continue;
+		}
+		FRecordedCall& Call = KindCalls[NextUnansweredCall];
+		Call.RoundTripSeconds = FMath::Max(Event.Time - CallTimes[CallKind][NextUnansweredCall], 0.0);
+		Call.CallbackIndex = Callbacks.Add(MoveTemp(Event));
+		++NextUnansweredCall;
+	}
+	UE_LOG(LogMPOnlineTraffic, Log, TEXT("Replaying %d online traffic events from %s %s"),
+		Events.Num(), *Path, bAsFastAsPossible ? TEXT("as fast as possible") : TEXT("in real time"));
+	return true;
+}
+
+bool FMPOnlineTrafficReplay::Issue(const EMPOnlineTrafficEvent CallKind, FDeliverCallback&& Deliver)
+{
+	const int32 Kind = static_cast<int32>(CallKind);
+	if (!ensure(Kind < MPNumOnlineTrafficCalls))
+	{
+		return false;
+	}
+	if (!Calls[Kind].IsValidIndex(NextCalls[Kind]))
+	{
+		UE_LOG(LogMPOnlineTraffic, Warning, TEXT("The log has no %s left, the replay diverged from the recording"), FMPOnlineTrafficEvent::LexToString(CallKind));
+		return false;
+	}
+	const FRecordedCall& Call = Calls[Kind][NextCalls[Kind]++];
+	if (Call.CallbackIndex != INDEX_NONE && Deliver)
+	{
+		FPendingCallback PendingCallback;
+		PendingCallback.DueTime = bAsFastAsPossible ? 0.0 : FPlatformTime::Seconds() + Call.RoundTripSeconds;
+		PendingCallback.Sequence = NextSequence++;
+		PendingCallback.CallbackIndex = Call.CallbackIndex;
+		PendingCallback.Deliver = MoveTemp(Deliver);
+		PendingCallbacks.HeapPush(MoveTemp(PendingCallback), &FMPOnlineTrafficReplay::IsDueFirst);
+	}
+	return Call.bWasIssued;
+}
+
+bool FMPOnlineTrafficReplay::Tick(float DeltaTime)
+{
+	// Delivered callbacks may issue calls, the ones due right away are delivered in the same loop
+	const double Now = FPlatformTime::Seconds();
+	while (PendingCallbacks.Num() > 0 && PendingCallbacks.HeapTop().DueTime <= Now)
+	{
+		FPendingCallback PendingCallback;
+		PendingCallbacks.HeapPop(PendingCallback, &FMPOnlineTrafficReplay::IsDueFirst);
+		PendingCallback.Deliver(Callbacks[PendingCallback.CallbackIndex]);
+	}
+	return true;
+}
+
+bool FMPOnlineTrafficReplay::IsDueFirst(const FPendingCallback& A, const FPendingCallback& B)
+{
+	return A.DueTime < B.DueTime || (A.DueTime == B.DueTime && A.Sequence < B.Sequence);
+}
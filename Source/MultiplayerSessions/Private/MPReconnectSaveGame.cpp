@@ -0,0 +1,6 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPReconnectSaveGame.h"
+
+const FString UMPReconnectSaveGame::SlotName(TEXT("MPReconnect"));
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPScopedDelegateBinding.h"
+
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY(LogMPScopedDelegateBinding);
+
+std::atomic<int32> FMPScopedDelegateBinding::NumLiveBindings { 0 };
+
+static FAutoConsoleCommand CVarMPSessionsLiveBindings(
+	TEXT("MPSessions.LiveBindings"),
+	TEXT("Logs the number of delegate bindings held by the multiplayer sessions subsystem and its listeners"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		UE_LOG(LogMPScopedDelegateBinding, Display, TEXT("%d live delegate bindings"), FMPScopedDelegateBinding::GetNumLiveBindings());
+	})
+);
+
+FMPScopedDelegateBinding::FMPScopedDelegateBinding(TUniqueFunction<void()>&& InUnbind):
+	Unbind(MoveTemp(InUnbind)),
+	bIsBound(true)
+{
+	++NumLiveBindings;
+}
+
+FMPScopedDelegateBinding::~FMPScopedDelegateBinding()
+{
+	Reset();
+}
+
+FMPScopedDelegateBinding::FMPScopedDelegateBinding(FMPScopedDelegateBinding&& Other):
+	Unbind(MoveTemp(Other.Unbind)),
+	bIsBound(Other.bIsBound)
+{
+	Other.bIsBound = false;
+}
+
+FMPScopedDelegateBinding& FMPScopedDelegateBinding::operator=(FMPScopedDelegateBinding&& Other)
+{
+	if (this != &Other)
+	{
+		// The binding held so far is removed, not overwritten
+		Reset();
+		Unbind = MoveTemp(Other.Unbind);
+		bIsBound = Other.bIsBound;
+		Other.bIsBound = false;
+	}
+	return *this;
+}
+
+void FMPScopedDelegateBinding::Reset()
+{
+	if (!bIsBound)
+	{
+		return;
+	}
+	bIsBound = false;
+	--NumLiveBindings;
+	// Moved out first, a Reset from inside the unbind finds nothing left to run
+	TUniqueFunction<void()> UnbindFunction = MoveTemp(Unbind);
+	UnbindFunction();
+}
+
+int32 FMPScopedDelegateBinding::GetNumLiveBindings()
+{
+	return NumLiveBindings.load();
+}
@@ -0,0 +1,627 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionBenchmarkCommandlet.h"
+
+#include "JsonObjectConverter.h"
+#include "MPScopedDelegateBinding.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/Ticker.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+DEFINE_LOG_CATEGORY(LogMPSessionBenchmark);
+
+namespace
+{
+	const TCHAR* StepOperationNames[] = { TEXT("Login"), TEXT("Create"), TEXT("Find"), TEXT("Join"), TEXT("Start"), TEXT("Destroy"), TEXT("Wait"),
+		TEXT("StartPool"), TEXT("ClaimPooled"), TEXT("ReleasePooled"), TEXT("StopPool") };
+	const TCHAR* MetricNames[] = { TEXT("Mean"), TEXT("P50"), TEXT("P95"), TEXT("P99"), TEXT("Max") };
+}
+
+UMPSessionBenchmarkCommandlet::UMPSessionBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UMPSessionBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString ScenarioPath;
+	if (!FParse::Value(*Params, TEXT("Scenario="), ScenarioPath))
+	{
+		UE_LOG(LogMPSessionBenchmark, Error, TEXT("Missing -Scenario=<File>"));
+		return 1;
+	}
+	int32 NumIterations = 20;
+	int32 NumWarmupIterations = 1;
+	FString BaselinePath;
+	FString Metric = TEXT("P50");
+	float Threshold = 0.2f;
+	float MinRegressionMs = 2.f;
+	float StepTimeoutSeconds = 30.f;
+	FParse::Value(*Params, TEXT("Iterations="), NumIterations);
+	FParse::Value(*Params, TEXT("Warmup="), NumWarmupIterations);
+	FParse::Value(*Params, TEXT("Baseline="), BaselinePath);
+	FParse::Value(*Params, TEXT("Metric="), Metric);
+	FParse::Value(*Params, TEXT("Threshold="), Threshold);
+	FParse::Value(*Params, TEXT("MinRegressionMs="), MinRegressionMs);
+	FParse::Value(*Params, TEXT("StepTimeout="), StepTimeoutSeconds);
+	const bool bUpdateBaseline = FParse::Param(*Params, TEXT("UpdateBaseline"));
+
+	if (double MetricMs; !GetMetricMs(FMPLatencyStats(), Metric, MetricMs))
+	{
+		UE_LOG(LogMPSessionBenchmark, Error, TEXT("Unknown metric %s, expected Mean, P50, P95, P99 or Max"), *Metric);
+		return 1;
+	}
+	if (FPaths::IsRelative(ScenarioPath))
+	{
+		ScenarioPath = FPaths::Combine(FPaths::ProjectDir(), ScenarioPath);
+	}
+	if (!LoadScenario(ScenarioPath, StepTimeoutSeconds))
+	{
+		return 1;
+	}
+	if (BaselinePath.IsEmpty())
+	{
+		BaselinePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MPSessionBenchmark"), ScenarioName + TEXT(".json"));
+	}
+
+	// The subsystem only exists within a game instance, a standalone one has a world but no local player
+	GameInstance = NewObject<UGameInstance>(GEngine);
+	GameInstance->InitializeStandalone();
+	Subsystem = GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>();
+	if (Subsystem != nullptr)
+	{
+		UE_LOG(LogMPSessionBenchmark, Display, TEXT("Scenario %s: %d steps, %d iterations after %d warmup"),
+			*ScenarioName, Steps.Num(), NumIterations, NumWarmupIterations);
+		for (int32 Iteration = 0; Iteration < NumWarmupIterations; ++Iteration)
+		{
+			RunIteration(false);
+		}
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			if (!RunIteration(true))
+			{
+				++NumFailedIterations;
+			}
+		}
+	}
+	else
+	{
+		UE_LOG(LogMPSessionBenchmark, Error, TEXT("MultiplayerSessionsSubsystem is not available"));
+	}
+
+	UWorld* World = GameInstance->GetWorld();
+	GameInstance->Shutdown();
+	if (World != nullptr)
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+	if (Subsystem == nullptr)
+	{
+		return 1;
+	}
+	Subsystem = nullptr;
+	GameInstance = nullptr;
+
+	Report();
+	if (NumFailedIterations > 0)
+	{
+		UE_LOG(LogMPSessionBenchmark, Error, TEXT("%d of %d iterations failed, not comparing with the baseline"), NumFailedIterations, NumIterations);
+		return 1;
+	}
+	if (bUpdateBaseline || !FPaths::FileExists(BaselinePath))
+	{
+		return SaveBaseline(BaselinePath) ? 0 : 1;
+	}
+	const int32 NumRegressions = CompareWithBaseline(BaselinePath, Metric, Threshold, MinRegressionMs);
+	if (NumRegressions == INDEX_NONE)
+	{
+		return 1;
+	}
+	if (NumRegressions > 0)
+	{
+		UE_LOG(LogMPSessionBenchmark, Error, TEXT("%d steps regressed against %s"), NumRegressions, *BaselinePath);
+		return 2;
+	}
+	return 0;
+}
+
+bool UMPSessionBenchmarkCommandlet::LoadScenario(const FString& ScenarioPath, const float DefaultTimeoutSeconds)
+{
+	FString ScenarioText;
+	if (!FFileHelper::LoadFileToString(ScenarioText, *ScenarioPath))
+	{
+		UE_LOG(LogMPSessionBenchmark, Error, TEXT("Could not read scenario %s"), *ScenarioPath);
+		return false;
+	}
+	TSharedPtr<FJsonObject> ScenarioObject;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(ScenarioText), ScenarioObject) || !ScenarioObject.IsValid())
+	{
+		UE_LOG(LogMPSessionBenchmark, Error, TEXT("Scenario %s is not valid JSON"), *ScenarioPath);
+		return false;
+	}
+	if (!ScenarioObject->TryGetStringField(TEXT("Name"), ScenarioName))
+	{
+		ScenarioName = FPaths::GetBaseFilename(ScenarioPath);
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* StepValues;
+	if (!ScenarioObject->TryGetArrayField(TEXT("Steps"), StepValues) || StepValues->Num() == 0)
+	{
+		UE_LOG(LogMPSessionBenchmark, Error, TEXT("Scenario %s has no steps"), *ScenarioPath);
+		return false;
+	}
+	TSet<FString> StepNames;
+	for (int32 StepIndex = 0; StepIndex < StepValues->Num(); ++StepIndex)
+	{
+		const TSharedPtr<FJsonObject>* StepObject;
+		if (!(*StepValues)[StepIndex]->TryGetObject(StepObject))
+		{
+			UE_LOG(LogMPSessionBenchmark, Error, TEXT("Step %d of %s is not an object"), StepIndex, *ScenarioPath);
+			return false;
+		}
+		FStep& Step = Steps.AddDefaulted_GetRef();
+		Step.TimeoutSeconds = DefaultTimeoutSeconds;
+		if (!ParseStep(**StepObject, StepIndex, Step))
+		{
+			return false;
+		}
+		// Steps are matched with the baseline by name
+		if (StepNames.Contains(Step.Name))
+		{
+			UE_LOG(LogMPSessionBenchmark, Error, TEXT("Step name %s is used twice in %s"), *Step.Name, *ScenarioPath);
+			return false;
+		}
+		StepNames.Add(Step.Name);
+	}
+	return true;
+}
+
+bool UMPSessionBenchmarkCommandlet::ParseStep(const FJsonObject& StepObject, const int32 StepIndex, FStep& OutStep) const
+{
+	FString OperationName;
+	StepObject.TryGetStringField(TEXT("Op"), OperationName);
+	int32 Operation = 0;
+	while (Operation < static_cast<int32>(EStepOperation::Num) && !OperationName.Equals(StepOperationNames[Operation], ESearchCase::IgnoreCase))
+	{
+		++Operation;
+	}
+	if (Operation == static_cast<int32>(EStepOperation::Num))
+	{
+		UE_LOG(LogMPSessionBenchmark, Error, TEXT("Step %d: unknown operation '%s'"), StepIndex, *OperationName);
+		return false;
+	}
+	OutStep.Operation = static_cast<EStepOperation>(Operation);
+	if (!StepObject.TryGetStringField(TEXT("Name"), OutStep.Name))
+	{
+		OutStep.Name = FString::Printf(TEXT("%d.%s"), StepIndex, StepOperationNames[Operation]);
+	}
+	if (double TimeoutSeconds; StepObject.TryGetNumberField(TEXT("Timeout"), TimeoutSeconds))
+	{
+		OutStep.TimeoutSeconds = static_cast<float>(TimeoutSeconds);
+	}
+
+	switch (OutStep.Operation)
+	{
+	case EStepOperation::Create:
+	case EStepOperation::StartPool:
+	case EStepOperation::ClaimPooled:
+		{
+			StepObject.TryGetNumberField(TEXT("PublicConnections"), OutStep.NumPublicConnections);
+			StepObject.TryGetNumberField(TEXT("PoolSize"), OutStep.PoolSize);
+			const TSharedPtr<FJsonObject>* SettingsObject;
+			if (StepObject.TryGetObjectField(TEXT("Settings"), SettingsObject)
+				&& !FJsonObjectConverter::JsonObjectToUStruct(SettingsObject->ToSharedRef(), &OutStep.SessionSettings))
+			{
+				UE_LOG(LogMPSessionBenchmark, Error, TEXT("Step %s: Settings don't match FMPSessionSettings"), *OutStep.Name);
+				return false;
+			}
+			const TSharedPtr<FJsonObject>* ExtrasObject;
+			if (StepObject.TryGetObjectField(TEXT("Extras"), ExtrasObject))
+			{
+				for (const TPair<FString, TSharedPtr<FJsonValue>>& Extra : (*ExtrasObject)->Values)
+				{
+					OutStep.ExtraSessionSettings.Add(FName(*Extra.Key), Extra.Value->AsString());
+				}
+			}
+			break;
+		}
+	case EStepOperation::Find:
+		{
+			StepObject.TryGetNumberField(TEXT("MaxSearchResults"), OutStep.MaxSearchResults);
+			StepObject.TryGetNumberField(TEXT("MinResults"), OutStep.MinResults);
+			// Extras are advertised as strings (see ToSessionAttributes), filters compare them as such
+			const TSharedPtr<FJsonObject>* FiltersObject;
+			if (StepObject.TryGetObjectField(TEXT("Filters"), FiltersObject))
+			{
+				for (const TPair<FString, TSharedPtr<FJsonValue>>& Filter : (*FiltersObject)->Values)
+				{
+					OutStep.QuerySettings.Set(FName(*Filter.Key), Filter.Value->AsString(), EOnlineComparisonOp::Equals);
+				}
+			}
+			break;
+		}
+	case EStepOperation::Join:
+		StepObject.TryGetNumberField(TEXT("Result"), OutStep.ResultIndex);
+		break;
+	case EStepOperation::Wait:
+		if (double WaitSeconds; StepObject.TryGetNumberField(TEXT("Seconds"), WaitSeconds))
+		{
+			OutStep.WaitSeconds = static_cast<float>(WaitSeconds);
+		}
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+bool UMPSessionBenchmarkCommandlet::RunIteration(const bool bIsTimed)
+{
+	LastSearchResults.Reset();
+	LastClaimedSessionName = NAME_None;
+	for (FStep& Step : Steps)
+	{
+		double Seconds = 0.0;
+		const EStepResult Result = RunStep(Step, Seconds);
+		if (Result == EStepResult::Failed)
+		{
+			if (bIsTimed)
+			{
+				++Step.NumFailed;
+			}
+			UE_LOG(LogMPSessionBenchmark, Warning, TEXT("Step %s failed, skipping the rest of the iteration"), *Step.Name);
+			DestroyLeftoverSession();
+			return false;
+		}
+		if (bIsTimed && Result == EStepResult::Succeeded)
+		{
+			Step.Latency.Add(Seconds);
+		}
+	}
+	return true;
+}
+
+UMPSessionBenchmarkCommandlet::EStepResult UMPSessionBenchmarkCommandlet::RunStep(const FStep& Step, double& OutSeconds)
+{
+	bool bIsComplete = false;
+	bool bWasSuccessful = false;
+	double CompleteTime = 0.0;
+	// Stamped from the subsystem's broadcast, not from the tick loop that noticed it
+	auto Complete = [&bIsComplete, &bWasSuccessful, &CompleteTime](const bool bInWasSuccessful)
+	{
+		CompleteTime = FPlatformTime::Seconds();
+		bWasSuccessful = bInWasSuccessful;
+		bIsComplete = true;
+	};
+	FMPScopedDelegateBinding CompleteBinding;
+	// Set by the steps without a completion event, polled after every tick
+	TFunction<bool()> HasReachedState;
+	double StartTime = FPlatformTime::Seconds();
+
+	switch (Step.Operation)
+	{
+	case EStepOperation::Login:
+		if (Subsystem->IsUserLoggedIn())
+		{
+			return EStepResult::SucceededUntimed;
+		}
+		CompleteBinding = FMPScopedDelegateBinding::ForMulticast(Subsystem, Subsystem->MultiplayerOnLoginComplete,
+			Subsystem->MultiplayerOnLoginComplete.AddLambda([&Complete](int LocalUserNum, bool bInWasSuccessful, const FUniqueNetId& UserId, const FString& Error)
+			{
+				Complete(bInWasSuccessful);
+			}));
+		StartTime = FPlatformTime::Seconds();
+		if (!Subsystem->TryAsyncLogin(FPendingLoginAction()))
+		{
+			return Subsystem->IsUserLoggedIn() ? EStepResult::SucceededUntimed : EStepResult::Failed;
+		}
+		break;
+	case EStepOperation::Create:
+		CompleteBinding = FMPScopedDelegateBinding::ForMulticast(Subsystem, Subsystem->MultiplayerOnCreateSessionComplete,
+			Subsystem->MultiplayerOnCreateSessionComplete.AddLambda([&Complete](FName SessionName, FString SessionId, bool bInWasSuccessful)
+			{
+				Complete(bInWasSuccessful);
+			}));
+		StartTime = FPlatformTime::Seconds();
+		Subsystem->CreateSession(Step.NumPublicConnections, Step.SessionSettings, Step.ExtraSessionSettings);
+		break;
+	case EStepOperation::Find:
+		CompleteBinding = FMPScopedDelegateBinding::ForMulticast(Subsystem, Subsystem->MultiplayerOnFindSessionsComplete,
+			Subsystem->MultiplayerOnFindSessionsComplete.AddLambda([this, &Complete, MinResults = Step.MinResults](const TArray<FOnlineSessionSearchResult>& SearchResults, bool bInWasSuccessful)
+			{
+				LastSearchResults = SearchResults;
+				Complete(bInWasSuccessful && SearchResults.Num() >= MinResults);
+			}));
+		StartTime = FPlatformTime::Seconds();
+		Subsystem->FindSessions(Step.MaxSearchResults, Step.QuerySettings);
+		break;
+	case EStepOperation::Join:
+		if (!LastSearchResults.IsValidIndex(Step.ResultIndex))
+		{
+			UE_LOG(LogMPSessionBenchmark, Warning, TEXT("Step %s: the last search has no result %d"), *Step.Name, Step.ResultIndex);
+			return EStepResult::Failed;
+		}
+		CompleteBinding = FMPScopedDelegateBinding::ForMulticast(Subsystem, Subsystem->MultiplayerOnJoinSessionComplete,
+			Subsystem->MultiplayerOnJoinSessionComplete.AddLambda([&Complete](const FName& SessionName, EOnJoinSessionCompleteResult::Type Result)
+			{
+				Complete(Result == EOnJoinSessionCompleteResult::Success);
+			}));
+		StartTime = FPlatformTime::Seconds();
+		Subsystem->JoinSession(LastSearchResults[Step.ResultIndex]);
+		break;
+	case EStepOperation::Start:
+		CompleteBinding = FMPScopedDelegateBinding::ForMulticast(Subsystem, Subsystem->MultiplayerOnStartSessionComplete,
+			Subsystem->MultiplayerOnStartSessionComplete.AddLambda([&Complete](bool bInWasSuccessful)
+			{
+				Complete(bInWasSuccessful);
+			}));
+		StartTime = FPlatformTime::Seconds();
+		if (!Subsystem->StartSession())
+		{
+			return EStepResult::Failed;
+		}
+		break;
+	case EStepOperation::Destroy:
+		CompleteBinding = FMPScopedDelegateBinding::ForMulticast(Subsystem, Subsystem->MultiplayerOnDestroySessionComplete,
+			Subsystem->MultiplayerOnDestroySessionComplete.AddLambda([&Complete](bool bInWasSuccessful)
+			{
+				Complete(bInWasSuccessful);
+			}));
+		StartTime = FPlatformTime::Seconds();
+		Subsystem->DestroySession();
+		break;
+	case EStepOperation::StartPool:
+		HasReachedState = [this, PoolSize = Step.PoolSize]()
+		{
+			return !Subsystem->IsSessionPoolStopping() && Subsystem->GetNumReadyPooledSessions() >= PoolSize;
+		};
+		StartTime = FPlatformTime::Seconds();
+		Subsystem->StartSessionPool(Step.PoolSize, Step.SessionSettings);
+		break;
+	case EStepOperation::ClaimPooled:
+		CompleteBinding = FMPScopedDelegateBinding::ForMulticast(Subsystem, Subsystem->MultiplayerOnPooledSessionClaimed,
+			Subsystem->MultiplayerOnPooledSessionClaimed.AddLambda([this, &Complete](FName SessionName, FString SessionId, bool bInWasSuccessful)
+			{
+				Complete(bInWasSuccessful && SessionName == LastClaimedSessionName);
+			}));
+		StartTime = FPlatformTime::Seconds();
+		LastClaimedSessionName = Subsystem->ClaimPooledSession(Step.ExtraSessionSettings);
+		if (LastClaimedSessionName.IsNone())
+		{
+			return EStepResult::Failed;
+		}
+		break;
+	case EStepOperation::ReleasePooled:
+		{
+			const int32 NumReadyBeforeRelease = Subsystem->GetNumReadyPooledSessions();
+			HasReachedState = [this, NumReadyBeforeRelease]()
+			{
+				return Subsystem->GetNumReadyPooledSessions() > NumReadyBeforeRelease;
+			};
+			StartTime = FPlatformTime::Seconds();
+			if (!Subsystem->ReleasePooledSession(LastClaimedSessionName))
+			{
+				return EStepResult::Failed;
+			}
+			LastClaimedSessionName = NAME_None;
+			break;
+		}
+	case EStepOperation::StopPool:
+		HasReachedState = [this]()
+		{
+			return !Subsystem->IsSessionPoolStopping();
+		};
+		StartTime = FPlatformTime::Seconds();
+		Subsystem->StopSessionPool();
+		break;
+	case EStepOperation::Wait:
+	default:
+		// Keeps ticking, e.g. so a LAN host answers searches
+		TickUntil([]() { return false; }, Step.WaitSeconds);
+		return EStepResult::SucceededUntimed;
+	}
+
+	const auto IsComplete = [&bIsComplete, &HasReachedState, &Complete]()
+	{
+		if (!bIsComplete && HasReachedState && HasReachedState())
+		{
+			Complete(true);
+		}
+		return bIsComplete;
+	};
+	if (!TickUntil(IsComplete, Step.TimeoutSeconds))
+	{
+		UE_LOG(LogMPSessionBenchmark, Warning, TEXT("Step %s timed out after %.1fs"), *Step.Name, Step.TimeoutSeconds);
+		return EStepResult::Failed;
+	}
+	OutSeconds = CompleteTime - StartTime;
+	return bWasSuccessful ? EStepResult::Succeeded : EStepResult::Failed;
+}
+
+bool UMPSessionBenchmarkCommandlet::TickUntil(TFunctionRef<bool()> IsComplete, const float TimeoutSeconds) const
+{
+	const double StartTime = FPlatformTime::Seconds();
+	double LastTickTime = StartTime;
+	while (!IsComplete())
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (Now - StartTime >= TimeoutSeconds)
+		{
+			return false;
+		}
+		// Online subsystems complete from game thread tasks and the core ticker, which also runs the operation scheduler
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		FTSTicker::GetCoreTicker().Tick(static_cast<float>(Now - LastTickTime));
+		LastTickTime = Now;
+		FPlatformProcess::Sleep(0.f);
+	}
+	return true;
+}
+
+void UMPSessionBenchmarkCommandlet::DestroyLeftoverSession()
+{
+	bool bIsComplete = false;
+	FMPScopedDelegateBinding DestroyBinding = FMPScopedDelegateBinding::ForMulticast(Subsystem, Subsystem->MultiplayerOnDestroySessionComplete,
+		Subsystem->MultiplayerOnDestroySessionComplete.AddLambda([&bIsComplete](bool bWasSuccessful)
+		{
+			bIsComplete = true;
+		}));
+	// Without a session the destroy is rejected right away
+	Subsystem->DestroySession();
+	TickUntil([&bIsComplete]() { return bIsComplete; }, 30.f);
+
+	Subsystem->StopSessionPool();
+	TickUntil([this]() { return !Subsystem->IsSessionPoolStopping(); }, 30.f);
+}
+
+void UMPSessionBenchmarkCommandlet::Report() const
+{
+	UE_LOG(LogMPSessionBenchmark, Display, TEXT("Scenario %s, %d failed iterations"), *ScenarioName, NumFailedIterations);
+	for (const FStep& Step : Steps)
+	{
+		if (Step.Operation != EStepOperation::Wait)
+		{
+			UE_LOG(LogMPSessionBenchmark, Display, TEXT("  %-20s %s failed=%d"), *Step.Name, *Step.Latency.ToString(), Step.NumFailed);
+		}
+	}
+}
+
+bool UMPSessionBenchmarkCommandlet::SaveBaseline(const FString& BaselinePath) const
+{
+	const TSharedRef<FJsonObject> BaselineObject = MakeShared<FJsonObject>();
+	BaselineObject->SetStringField(TEXT("Scenario"), ScenarioName);
+	TArray<TSharedPtr<FJsonValue>> StepValues;
+	for (const FStep& Step : Steps)
+	{
+		if (Step.Latency.Num() == 0)
+		{
+			continue;
+		}
+		const TSharedRef<FJsonObject> StepObject = MakeShared<FJsonObject>();
+		StepObject->SetStringField(TEXT("Name"), Step.Name);
+		StepObject->SetNumberField(TEXT("Num"), Step.Latency.Num());
+		for (const TCHAR* MetricName : MetricNames)
+		{
+			double MetricMs;
+			GetMetricMs(Step.Latency, MetricName, MetricMs);
+			StepObject->SetNumberField(FString(MetricName) + TEXT("Ms"), MetricMs);
+		}
+		StepValues.Add(MakeShared<FJsonValueObject>(StepObject));
+	}
+	BaselineObject->SetArrayField(TEXT("Steps"), StepValues);
+
+	FString BaselineText;
+	if (!FJsonSerializer::Serialize(BaselineObject, TJsonWriterFactory<>::Create(&BaselineText)) || !FFileHelper::SaveStringToFile(BaselineText, *BaselinePath))
+	{
+		UE_LOG(LogMPSessionBenchmark, Error, TEXT("Could not write baseline %s"), *BaselinePath);
+		return false;
+	}
+	UE_LOG(LogMPSessionBenchmark, Display, TEXT("Recorded baseline %s"), *BaselinePath);
+	return true;
+}
+
+int32 UMPSessionBenchmarkCommandlet::CompareWithBaseline(
+	const FString& BaselinePath,
+	const FString& Metric,
+	const float Threshold,
+	const float MinRegressionMs
+) const
+{
+	FString BaselineText;
+	TSharedPtr<FJsonObject> BaselineObject;
+	const TArray<TSharedPtr<FJsonValue>>* BaselineStepValues;
+	if (!FFileHelper::LoadFileToString(BaselineText, *BaselinePath)
+		|| !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BaselineText), BaselineObject)
+		|| !BaselineObject.IsValid()
+		|| !BaselineObject->TryGetArrayField(TEXT("Steps"), BaselineStepValues))
+	{
+		UE_LOG(LogMPSessionBenchmark, Error, TEXT("Could not read baseline %s"), *BaselinePath);
+		return INDEX_NONE;
+	}
+	TMap<FString, double> BaselineMs;
+	const FString MetricField = Metric + TEXT("Ms");
+	for (const TSharedPtr<FJsonValue>& BaselineStepValue : *BaselineStepValues)
+	{
+		const TSharedPtr<FJsonObject>* BaselineStep;
+		FString Name;
+		double StepMs;
+		if (BaselineStepValue->TryGetObject(BaselineStep) && (*BaselineStep)->TryGetStringField(TEXT("Name"), Name) && (*BaselineStep)->TryGetNumberField(MetricField, StepMs))
+		{
+			BaselineMs.Add(Name, StepMs);
+		}
+	}
+
+	int32 NumRegressions = 0;
+	for (const FStep& Step : Steps)
+	{
+		if (Step.Latency.Num() == 0)
+		{
+			continue;
+		}
+		const double* StepBaselineMs = BaselineMs.Find(Step.Name);
+		if (StepBaselineMs == nullptr)
+		{
+			UE_LOG(LogMPSessionBenchmark, Warning, TEXT("  %-20s has no %s baseline"), *Step.Name, *Metric);
+			continue;
+		}
+		double StepMs;
+		GetMetricMs(Step.Latency, Metric, StepMs);
+		// The absolute floor keeps sub-millisecond steps from failing on noise
+		if (StepMs > *StepBaselineMs * (1.0 + Threshold) && StepMs - *StepBaselineMs > MinRegressionMs)
+		{
+			++NumRegressions;
+			UE_LOG(LogMPSessionBenchmark, Error, TEXT("  %-20s %s %.1fms, baseline %.1fms: regressed"), *Step.Name, *Metric, StepMs, *StepBaselineMs);
+		}
+		else
+		{
+			UE_LOG(LogMPSessionBenchmark, Display, TEXT("  %-20s %s %.1fms, baseline %.1fms"), *Step.Name, *Metric, StepMs, *StepBaselineMs);
+		}
+	}
+	return NumRegressions;
+}
+
+bool UMPSessionBenchmarkCommandlet::GetMetricMs(const FMPLatencyStats& Latency, const FString& Metric, double& OutMs)
+{
+	double Seconds;
+	if (Metric.Equals(MetricNames[0], ESearchCase::IgnoreCase))
+	{
+		Seconds = Latency.GetMean();
+	}
+	else if (Metric.Equals(MetricNames[1], ESearchCase::IgnoreCase))
+	{
+		Seconds = Latency.GetPercentile(50.0);
+	}
+	else if (Metric.Equals(MetricNames[2], ESearchCase::IgnoreCase))
+	{
+		Seconds = Latency.GetPercentile(95.0);
+	}
+	else if (Metric.Equals(MetricNames[3], ESearchCase::IgnoreCase))
+	{
+		Seconds = Latency.GetPercentile(99.0);
+	}
+	else if (Metric.Equals(MetricNames[4], ESearchCase::IgnoreCase))
+	{
+		Seconds = Latency.GetMax();
+	}
+	else
+	{
+		return false;
+	}
+	OutMs = Seconds * 1000.0;
+	return true;
+}
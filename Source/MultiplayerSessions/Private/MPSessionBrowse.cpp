@@ -0,0 +1,256 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionBrowse.h"
+
+#include "Algo/Sort.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Tasks/Task.h"
+
+DEFINE_LOG_CATEGORY(LogMPSessionBrowse);
+
+namespace
+{
+	// Results evaluated per ParallelFor batch, filters are cheap so small batches cost more in scheduling than they save
+	constexpr int32 FilterBatchSize { 512 };
+	// Below this many sessions per chunk, sorting on more workers doesn't pay off
+	constexpr int32 MinSortChunkSize { 4096 };
+}
+
+void FMPSessionBrowsePipeline::Launch(const FMPSessionResultsSnapshot& Snapshot, const FMPSessionBrowseSpec& Spec, FMPOnSessionsBrowsed&& OnBrowsed)
+{
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [Snapshot, Spec, OnBrowsed = MoveTemp(OnBrowsed)]() mutable
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		FMPSessionBrowseResult Result;
+		Result.Order = Run(*Snapshot, Spec);
+		Result.Snapshot = Snapshot;
+		Result.Seconds = FPlatformTime::Seconds() - StartTime;
+		UE_LOG(LogMPSessionBrowse, Verbose, TEXT("Browsed %d sessions in %.2f ms, %d shown"), Snapshot->Num(), Result.Seconds * 1000.0, Result.Order.Num());
+
+		AsyncTask(ENamedThreads::GameThread, [Result = MoveTemp(Result), OnBrowsed = MoveTemp(OnBrowsed)]()
+		{
+			OnBrowsed.ExecuteIfBound(Result);
+		});
+	});
+}
+
+TArray<int32> FMPSessionBrowsePipeline::Run(const TArray<FOnlineSessionSearchResult>& Results, const FMPSessionBrowseSpec& Spec)
+{
+	const int32 NumResults = Results.Num();
+	const bool bIsSorted = Spec.SortBy != EMPSessionSortKey::None;
+
+	// Each worker only writes the entries of its own results
+	TArray<uint8> Passes;
+	Passes.SetNumZeroed(NumResults);
+	TArray<FSortKey> SortKeys;
+	if (bIsSorted)
+	{
+		SortKeys.SetNum(NumResults);
+	}
+	ParallelFor(TEXT("MPSessionBrowse.Filter"), NumResults, FilterBatchSize, [&Results, &Spec, &Passes, &SortKeys, bIsSorted](const int32 Index)
+	{
+		if (!PassesFilters(Results[Index], Spec))
+		{
+			return;
+		}
+		Passes[Index] = 1;
+		if (bIsSorted)
+		{
+			SortKeys[Index] = MakeSortKey(Results[Index], Spec);
+		}
+	});
+
+	TArray<int32> Order;
+	Order.Reserve(NumResults);
+	for (int32 Index = 0; Index < NumResults; ++Index)
+	{
+		if (Passes[Index])
+		{
+			Order.Add(Index);
+		}
+	}
+	const int32 NumOrdered = Order.Num();
+	if (!bIsSorted || NumOrdered < 2)
+	{
+		return Order;
+	}
+
+	const auto Less = [&SortKeys, bDescending = Spec.bDescending](const int32 A, const int32 B)
+	{
+		return IsBefore(SortKeys[A], A, SortKeys[B], B, bDescending);
+	};
+
+	// Sorted in chunks, at most one per worker and the calling thread
+	const int32 NumChunks = FMath::Clamp(NumOrdered / MinSortChunkSize, 1, FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+	TArray<int32> RunStarts;
+	RunStarts.SetNum(NumChunks + 1);
+	for (int32 Chunk = 0; Chunk <= NumChunks; ++Chunk)
+	{
+		RunStarts[Chunk] = static_cast<int32>(static_cast<int64>(NumOrdered) * Chunk / NumChunks);
+	}
+	ParallelFor(TEXT("MPSessionBrowse.Sort"), NumChunks, 1, [&Order, &RunStarts, &Less](const int32 Chunk)
+	{
+		Algo::Sort(MakeArrayView(Order.GetData() + RunStarts[Chunk], RunStarts[Chunk + 1] - RunStarts[Chunk]), Less);
+	});
+
+	// Then merged pairwise, each pass halves the number of sorted runs
+	TArray<int32> Merged;
+	Merged.SetNumUninitialized(NumOrdered);
+	while (RunStarts.Num() > 2)
+	{
+		const int32 NumRuns = RunStarts.Num() - 1;
+		ParallelFor(TEXT("MPSessionBrowse.Merge"), (NumRuns + 1) / 2, 1, [&Order, &Merged, &RunStarts, &Less, NumRuns](const int32 Pair)
+		{
+			const int32 Begin = RunStarts[Pair * 2];
+			// The last run of an odd count has no pair and is only copied
+			const int32 Middle = RunStarts[FMath::Min(Pair * 2 + 1, NumRuns)];
+			const int32 End = RunStarts[FMath::Min(Pair * 2 + 2, NumRuns)];
+			int32 Left = Begin;
+			int32 Right = Middle;
+			int32 Out = Begin;
+			while (Left < Middle && Right < End)
+			{
+				Merged[Out++] = Less(Order[Right], Order[Left]) ? Order[Right++] : Order[Left++];
+			}
+			while (Left < Middle)
+			{
+				Merged[Out++] = Order[Left++];
+			}
+			while (Right < End)
+			{
+				Merged[Out++] = Order[Right++];
+			}
+		});
+		Swap(Order, Merged);
+
+		TArray<int32> MergedRunStarts;
+		MergedRunStarts.Reserve(NumRuns / 2 + 2);
+		for (int32 Run = 0; Run < NumRuns; Run += 2)
+		{
+			MergedRunStarts.Add(RunStarts[Run]);
+		}
+		MergedRunStarts.Add(NumOrdered);
+		RunStarts = MoveTemp(MergedRunStarts);
+	}
+	return Order;
+}
+
+bool FMPSessionBrowsePipeline::PassesFilters(const FOnlineSessionSearchResult& Result, const FMPSessionBrowseSpec& Spec)
+{
+	if (Result.Session.NumOpenPublicConnections < Spec.MinOpenSlots)
+	{
+		return false;
+	}
+	if (Spec.MaxPingMs > 0 && Result.PingInMs > Spec.MaxPingMs)
+	{
+		return false;
+	}
+	if (!Spec.OwnerNameContains.IsEmpty() && !Result.Session.OwningUserName.Contains(Spec.OwnerNameContains))
+	{
+		return false;
+	}
+	for (const TPair<FName, FString>& RequiredSetting : Spec.RequiredSettings)
+	{
+		const FOnlineSessionSetting* Setting = Result.Session.SessionSettings.Settings.Find(RequiredSetting.Key);
+		if (Setting == nullptr || Setting->Data.ToString() != RequiredSetting.Value)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+FMPSessionBrowsePipeline::FSortKey FMPSessionBrowsePipeline::MakeSortKey(const FOnlineSessionSearchResult& Result, const FMPSessionBrowseSpec& Spec)
+{
+	FSortKey SortKey;
+	switch (Spec.SortBy)
+	{
+	case EMPSessionSortKey::OpenSlots:
+		SortKey.Rank = 0;
+		SortKey.Number = Result.Session.NumOpenPublicConnections;
+		break;
+	case EMPSessionSortKey::Ping:
+		SortKey.Rank = 0;
+		SortKey.Number = Result.PingInMs;
+		break;
+	case EMPSessionSortKey::OwnerName:
+		SortKey.Rank = 1;
+		SortKey.Text = Result.Session.OwningUserName;
+		break;
+	case EMPSessionSortKey::SettingValue:
+		if (const FOnlineSessionSetting* Setting = Result.Session.SessionSettings.Settings.Find(Spec.SortSettingKey))
+		{
+			SetSortKey(Setting->Data, SortKey);
+		}
+		break;
+	default:
+		break;
+	}
+	return SortKey;
+}
+
+void FMPSessionBrowsePipeline::SetSortKey(const FVariantData& Data, FSortKey& OutSortKey)
+{
+	const auto SetNumber = [&Data, &OutSortKey](auto Value)
+	{
+		Data.GetValue(Value);
+		OutSortKey.Rank = 0;
+		OutSortKey.Number = static_cast<double>(Value);
+	};
+	switch (Data.GetType())
+	{
+	case EOnlineKeyValuePairDataType::Int32:
+		SetNumber(int32 { 0 });
+		break;
+	case EOnlineKeyValuePairDataType::UInt32:
+		SetNumber(uint32 { 0 });
+		break;
+	case EOnlineKeyValuePairDataType::Int64:
+		SetNumber(int64 { 0 });
+		break;
+	case EOnlineKeyValuePairDataType::UInt64:
+		SetNumber(uint64 { 0 });
+		break;
+	case EOnlineKeyValuePairDataType::Float:
+		SetNumber(float { 0.f });
+		break;
+	case EOnlineKeyValuePairDataType::Double:
+		SetNumber(double { 0.0 });
+		break;
+	case EOnlineKeyValuePairDataType::Bool:
+		SetNumber(bool { false });
+		break;
+	case EOnlineKeyValuePairDataType::String:
+		OutSortKey.Rank = 1;
+		Data.GetValue(OutSortKey.Text);
+		break;
+	default:
+		// Blobs and empty values sort as missing
+		break;
+	}
+}
+
+bool FMPSessionBrowsePipeline::IsBefore(const FSortKey& A, const int32 IndexA, const FSortKey& B, const int32 IndexB, const bool bDescending)
+{
+	// Sessions without a value stay last in either direction
+	if (A.Rank != B.Rank)
+	{
+		return A.Rank < B.Rank;
+	}
+	int32 Comparison = 0;
+	if (A.Rank == 0)
+	{
+		Comparison = A.Number < B.Number ? -1 : (A.Number > B.Number ? 1 : 0);
+	}
+	else if (A.Rank == 1)
+	{
+		Comparison = A.Text.Compare(B.Text, ESearchCase::IgnoreCase);
+	}
+	if (Comparison != 0)
+	{
+		return bDescending ? Comparison > 0 : Comparison < 0;
+	}
+	return IndexA < IndexB;
+}
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionBrowserDiff.h"
+
+const FName FMPSessionResultTracker::OwningUserNameField(TEXT("OwningUserName"));
+const FName FMPSessionResultTracker::NumOpenPublicConnectionsField(TEXT("NumOpenPublicConnections"));
+const FName FMPSessionResultTracker::NumOpenPrivateConnectionsField(TEXT("NumOpenPrivateConnections"));
+
+TArray<FMPChangedSessionFields> FMPSessionBrowserDiff::GetChangedFields() const
+{
+	TArray<FMPChangedSessionFields> ChangedFields;
+	ChangedFields.Reserve(Changed.Num());
+	for (const FMPChangedSessionResult& ChangedResult : Changed)
+	{
+		FMPChangedSessionFields& Fields = ChangedFields.AddDefaulted_GetRef();
+		Fields.SessionId = ChangedResult.SearchResult.GetSessionIdStr();
+		Fields.Fields = ChangedResult.ChangedFields;
+	}
+	return ChangedFields;
+}
+
+FMPSessionBrowserDiff FMPSessionResultTracker::Update(const TArray<FOnlineSessionSearchResult>& SearchResults)
+{
+	FMPSessionBrowserDiff Diff;
+	TMap<FString, FSessionFingerprint> CurrentFingerprints;
+	CurrentFingerprints.Reserve(SearchResults.Num());
+
+	for (const FOnlineSessionSearchResult& SearchResult : SearchResults)
+	{
+		FString SessionId = SearchResult.GetSessionIdStr();
+		if (CurrentFingerprints.Contains(SessionId))
+		{
+			// Some backends report the same session twice in one search
+			continue;
+		}
+
+		FSessionFingerprint Fingerprint = MakeFingerprint(SearchResult);
+		if (const FSessionFingerprint* PreviousFingerprint = Fingerprints.Find(SessionId))
+		{
+			if (PreviousFingerprint->Hash != Fingerprint.Hash)
+			{
+				FMPChangedSessionResult& ChangedResult = Diff.Changed.AddDefaulted_GetRef();
+				ChangedResult.SearchResult = SearchResult;
+				GetChangedFields(*PreviousFingerprint, Fingerprint, ChangedResult.ChangedFields);
+			}
+		}
+		else
+		{
+			Diff.Added.Add(SearchResult);
+		}
+		CurrentFingerprints.Add(MoveTemp(SessionId), MoveTemp(Fingerprint));
+	}
+
+	for (const auto& PreviousFingerprint : Fingerprints)
+	{
+		if (!CurrentFingerprints.Contains(PreviousFingerprint.Key))
+		{
+			Diff.RemovedSessionIds.Add(PreviousFingerprint.Key);
+		}
+	}
+
+	Fingerprints = MoveTemp(CurrentFingerprints);
+	return Diff;
+}
+
+void FMPSessionResultTracker::Reset()
+{
+	Fingerprints.Reset();
+}
+
+FMPSessionResultTracker::FSessionFingerprint FMPSessionResultTracker::MakeFingerprint(const FOnlineSessionSearchResult& SearchResult)
+{
+	const FOnlineSession& Session = SearchResult.Session;
+
+	// Ping is left out, it changes on every search without the session changing
+	FSessionFingerprint Fingerprint;
+	Fingerprint.FieldHashes.Reserve(Session.SessionSettings.Settings.Num() + 3);
+	Fingerprint.FieldHashes.Add(OwningUserNameField, GetTypeHash(Session.OwningUserName));
+	Fingerprint.FieldHashes.Add(NumOpenPublicConnectionsField, GetTypeHash(Session.NumOpenPublicConnections));
+	Fingerprint.FieldHashes.Add(NumOpenPrivateConnectionsField, GetTypeHash(Session.NumOpenPrivateConnections));
+	for (const auto& Setting : Session.SessionSettings.Settings)
+	{
+		Fingerprint.FieldHashes.Add(Setting.Key, HashCombine(GetTypeHash(Setting.Value.Data.GetType()), GetTypeHash(Setting.Value.Data.ToString())));
+	}
+
+	// Combined independently of the map order, so the same settings always give the same hash
+	for (const auto& FieldHash : Fingerprint.FieldHashes)
+	{
+		Fingerprint.Hash ^= HashCombine(GetTypeHash(FieldHash.Key), FieldHash.Value);
+	}
+	return Fingerprint;
+}
+
+void FMPSessionResultTracker::GetChangedFields(
+	const FSessionFingerprint& Previous,
+	const FSessionFingerprint& Current,
+	TArray<FName>& OutChangedFields
+)
+{
+	for (const auto& FieldHash : Current.FieldHashes)
+	{
+		const uint32* PreviousFieldHash = Previous.FieldHashes.Find(FieldHash.Key);
+		if (PreviousFieldHash == nullptr || *PreviousFieldHash != FieldHash.Value)
+		{
+			OutChangedFields.Add(FieldHash.Key);
+		}
+	}
+	for (const auto& FieldHash : Previous.FieldHashes)
+	{
+		if (!Current.FieldHashes.Contains(FieldHash.Key))
+		{
+			OutChangedFields.Add(FieldHash.Key);
+		}
+	}
+}
@@ -0,0 +1,240 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionBrowserWidget.h"
+
+#include "Components/ListView.h"
+#include "MPSessionListItem.h"
+#include "MultiplayerSessionsSubsystem.h"
+
+DEFINE_LOG_CATEGORY(LogMPSessionBrowserWidget);
+
+void UMPSessionBrowserWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	if (const UGameInstance* GameInstance = GetGameInstance())
+	{
+		MultiplayerSessionsSubsystem = GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>();
+	}
+	if (MultiplayerSessionsSubsystem)
+	{
+		SubsystemBindings.Reset();
+		SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsComplete, this, &ThisClass::OnFindSessionsComplete));
+		SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnSessionBrowserUpdated, this, &ThisClass::OnSessionBrowserUpdated));
+	}
+	else
+	{
+		UE_LOG(LogMPSessionBrowserWidget, Error, TEXT("MultiplayerSessionsSubsystem is null, the session browser will stay empty"));
+	}
+
+	if (SessionListView)
+	{
+		SessionListView->OnItemClicked().AddUObject(this, &ThisClass::OnListItemClicked);
+	}
+}
+
+void UMPSessionBrowserWidget::NativeDestruct()
+{
+	SubsystemBindings.Reset();
+	if (SessionListView)
+	{
+		SessionListView->OnItemClicked().RemoveAll(this);
+	}
+
+	Super::NativeDestruct();
+}
+
+void UMPSessionBrowserWidget::SetSortMode(const EMPSessionSortField InSortField, const bool bInSortAscending)
+{
+	SortField = InSortField;
+	bSortAscending = bInSortAscending;
+	RebuildVisibleItems();
+}
+
+void UMPSessionBrowserWidget::SetFilter(const FMPSessionBrowserFilter& InFilter)
+{
+	Filter = InFilter;
+	RebuildVisibleItems();
+}
+
+void UMPSessionBrowserWidget::JoinSession(UMPSessionListItem* Item)
+{
+	if (MultiplayerSessionsSubsystem == nullptr || Item == nullptr || !Item->GetSearchResult().IsValid())
+	{
+		UE_LOG(LogMPSessionBrowserWidget, Error, TEXT("Failed to issue JoinSession, no subsystem or no session"));
+		return;
+	}
+	MultiplayerSessionsSubsystem->JoinSession(*Item->GetSearchResult());
+}
+
+void UMPSessionBrowserWidget::SetSessions(const TArray<FOnlineSessionSearchResult>& SearchResults)
+{
+	for (const auto& Item : ItemsBySessionId)
+	{
+		ReleaseItem(Item.Value);
+	}
+	ItemsBySessionId.Reset();
+	ItemsBySessionId.Reserve(SearchResults.Num());
+
+	for (const FOnlineSessionSearchResult& SearchResult : SearchResults)
+	{
+		UMPSessionListItem* Item = AcquireItem(SearchResult);
+		if (UMPSessionListItem** ExistingItem = ItemsBySessionId.Find(Item->GetSessionId()))
+		{
+			ReleaseItem(*ExistingItem);
+		}
+		ItemsBySessionId.Add(Item->GetSessionId(), Item);
+	}
+	RebuildVisibleItems();
+}
+
+void UMPSessionBrowserWidget::ApplyDiff(const FMPSessionBrowserDiff& Diff)
+{
+	bool bNeedsRebuild = !Diff.Added.IsEmpty() || !Diff.RemovedSessionIds.IsEmpty();
+
+	for (const FString& RemovedSessionId : Diff.RemovedSessionIds)
+	{
+		UMPSessionListItem* RemovedItem = nullptr;
+		if (ItemsBySessionId.RemoveAndCopyValue(RemovedSessionId, RemovedItem))
+		{
+			ReleaseItem(RemovedItem);
+		}
+	}
+	for (const FOnlineSessionSearchResult& AddedResult : Diff.Added)
+	{
+		UMPSessionListItem* Item = AcquireItem(AddedResult);
+		if (UMPSessionListItem** ExistingItem = ItemsBySessionId.Find(Item->GetSessionId()))
+		{
+			ReleaseItem(*ExistingItem);
+		}
+		ItemsBySessionId.Add(Item->GetSessionId(), Item);
+	}
+	for (const FMPChangedSessionResult& ChangedResult : Diff.Changed)
+	{
+		UMPSessionListItem** Item = ItemsBySessionId.Find(ChangedResult.SearchResult.GetSessionIdStr());
+		if (Item == nullptr)
+		{
+			continue;
+		}
+		// Displayed entries refresh themselves through the item, the list only changes if filtering or order can
+		const bool bWasVisible = PassesFilter(**Item);
+		(*Item)->SetSearchResult(MakeShared<const FOnlineSessionSearchResult>(ChangedResult.SearchResult));
+		bNeedsRebuild |= SortField != EMPSessionSortField::None || bWasVisible != PassesFilter(**Item);
+	}
+
+	if (bNeedsRebuild)
+	{
+		RebuildVisibleItems();
+	}
+}
+
+void UMPSessionBrowserWidget::OnFindSessionsComplete(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful)
+{
+	if (bWasSuccessful)
+	{
+		SetSessions(SearchResults);
+	}
+}
+
+void UMPSessionBrowserWidget::OnSessionBrowserUpdated(const FMPSessionBrowserDiff& Diff, bool bWasSuccessful)
+{
+	if (bWasSuccessful)
+	{
+		ApplyDiff(Diff);
+	}
+}
+
+void UMPSessionBrowserWidget::OnListItemClicked(UObject* Item)
+{
+	OnSessionSelected(Cast<UMPSessionListItem>(Item));
+}
+
+UMPSessionListItem* UMPSessionBrowserWidget::AcquireItem(const FOnlineSessionSearchResult& SearchResult)
+{
+	UMPSessionListItem* Item = FreeItems.Num() > 0 ? FreeItems.Pop() : NewObject<UMPSessionListItem>(this);
+	Item->SetSearchResult(MakeShared<const FOnlineSessionSearchResult>(SearchResult));
+	return Item;
+}
+
+void UMPSessionBrowserWidget::ReleaseItem(UMPSessionListItem* Item)
+{
+	Item->Reset();
+	FreeItems.Add(Item);
+}
+
+bool UMPSessionBrowserWidget::PassesFilter(const UMPSessionListItem& Item) const
+{
+	if (Filter.bHideFullSessions && Item.GetNumOpenPublicConnections() <= 0)
+	{
+		return false;
+	}
+	if (Filter.MaxPingInMs > 0 && Item.GetPingInMs() > Filter.MaxPingInMs)
+	{
+		return false;
+	}
+	if (!Filter.OwnerNameContains.IsEmpty() && !Item.GetOwnerName().Contains(Filter.OwnerNameContains))
+	{
+		return false;
+	}
+	for (const auto& RequiredSetting : Filter.RequiredSettings)
+	{
+		FString SettingValue;
+		if (!Item.GetSessionSetting(RequiredSetting.Key, SettingValue) || SettingValue != RequiredSetting.Value)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool UMPSessionBrowserWidget::IsSortedBefore(const UMPSessionListItem& A, const UMPSessionListItem& B) const
+{
+	int32 Comparison = 0;
+	switch (SortField)
+	{
+	case EMPSessionSortField::OwnerName:
+		Comparison = A.GetOwnerName().Compare(B.GetOwnerName(), ESearchCase::IgnoreCase);
+		break;
+	case EMPSessionSortField::OpenConnections:
+		Comparison = A.GetNumOpenPublicConnections() - B.GetNumOpenPublicConnections();
+		break;
+	case EMPSessionSortField::MaxConnections:
+		Comparison = A.GetMaxPublicConnections() - B.GetMaxPublicConnections();
+		break;
+	case EMPSessionSortField::Ping:
+		Comparison = A.GetPingInMs() - B.GetPingInMs();
+		break;
+	default:
+		break;
+	}
+	if (Comparison == 0)
+	{
+		// Ties are broken by session id so the order does not shuffle between refreshes
+		return A.GetSessionId() < B.GetSessionId();
+	}
+	return bSortAscending ? Comparison < 0 : Comparison > 0;
+}
+
+void UMPSessionBrowserWidget::RebuildVisibleItems()
+{
+	VisibleItems.Reset(ItemsBySessionId.Num());
+	for (const auto& Item : ItemsBySessionId)
+	{
+		if (PassesFilter(*Item.Value))
+		{
+			VisibleItems.Add(Item.Value);
+		}
+	}
+	VisibleItems.Sort([this](const UMPSessionListItem& A, const UMPSessionListItem& B)
+	{
+		return IsSortedBefore(A, B);
+	});
+
+	if (SessionListView)
+	{
+		// The list view keeps its entry widgets and only re-targets the ones in view
+		SessionListView->SetListItems(VisibleItems);
+	}
+	OnVisibleSessionsChanged(VisibleItems.Num(), ItemsBySessionId.Num());
+}
@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionEventQueue.h"
+
+DEFINE_LOG_CATEGORY(LogMPSessionEventQueue);
+
+FMPSessionEventQueue::FMPSessionEventQueue(const float InFrameBudgetSeconds)
+{
+	SetFrameBudgetSeconds(InFrameBudgetSeconds);
+}
+
+FMPSessionEventQueue::~FMPSessionEventQueue()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+}
+
+void FMPSessionEventQueue::Enqueue(const EMPSessionEventKind Kind, TUniqueFunction<void()>&& Dispatch, const bool bCoalesce, const FName Subject)
+{
+	const uint64 Sequence = NextSequence++;
+	if (bCoalesce)
+	{
+		const TPair<uint8, FName> CoalesceKey(static_cast<uint8>(Kind), Subject);
+		if (const uint64* PendingSequence = PendingCoalescableEvents.Find(CoalesceKey))
+		{
+			// Pending events are never in front of Events[0], so their index follows from their sequence
+			FQueuedEvent& PendingEvent = Events[static_cast<int32>(*PendingSequence - Events[0].Sequence)];
+			PendingEvent.bIsCoalesced = true;
+			PendingEvent.Dispatch = TUniqueFunction<void()>();
+			++NumCoalescedPending;
+			UE_LOG(LogMPSessionEventQueue, Verbose, TEXT("Coalesced event %d"), static_cast<int32>(Kind));
+		}
+		PendingCoalescableEvents.Add(CoalesceKey, Sequence);
+	}
+
+	FQueuedEvent& Event = Events.AddDefaulted_GetRef();
+	Event.Sequence = Sequence;
+	Event.Kind = Kind;
+	Event.Subject = Subject;
+	Event.Dispatch = MoveTemp(Dispatch);
+	ScheduleTick();
+}
+
+int32 FMPSessionEventQueue::Flush()
+{
+	const int32 NumDispatched = DispatchEvents(0.0);
+	if (Events.IsEmpty())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+		TickerHandle.Reset();
+	}
+	return NumDispatched;
+}
+
+void FMPSessionEventQueue::Reset()
+{
+	if (Num() > 0)
+	{
+		UE_LOG(LogMPSessionEventQueue, Log, TEXT("Dropping %d pending events"), Num());
+	}
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+	if (bIsDispatching)
+	{
+		// The dispatch in progress owns the front of the array, only the events it has not reached are dropped
+		for (int32 Index = HeadIndex; Index < Events.Num(); ++Index)
+		{
+			Events[Index].bIsCoalesced = true;
+			Events[Index].Dispatch = TUniqueFunction<void()>();
+		}
+		NumCoalescedPending = Events.Num() - HeadIndex;
+	}
+	else
+	{
+		Events.Reset();
+		HeadIndex = 0;
+		NumCoalescedPending = 0;
+	}
+	PendingCoalescableEvents.Reset();
+}
+
+bool FMPSessionEventQueue::Tick(float DeltaTime)
+{
+	DispatchEvents(FrameBudgetSeconds);
+	if (Events.IsEmpty())
+	{
+		TickerHandle.Reset();
+		return false;
+	}
+	return true;
+}
+
+int32 FMPSessionEventQueue::DispatchEvents(const double BudgetSeconds)
+{
+	if (bIsDispatching)
+	{
+		return 0;
+	}
+	TGuardValue<bool> DispatchingGuard(bIsDispatching, true);
+
+	const double StartTime = FPlatformTime::Seconds();
+	int32 NumDispatched = 0;
+	while (HeadIndex < Events.Num())
+	{
+		if (NumDispatched > 0 && BudgetSeconds > 0.0 && FPlatformTime::Seconds() - StartTime >= BudgetSeconds)
+		{
+			UE_LOG(LogMPSessionEventQueue, Verbose, TEXT("Frame budget spent after %d events, %d left for the next tick"), NumDispatched, Num());
+			break;
+		}
+
+		FQueuedEvent& Event = Events[HeadIndex++];
+		if (Event.bIsCoalesced)
+		{
+			--NumCoalescedPending;
+			continue;
+		}
+		const TPair<uint8, FName> CoalesceKey(static_cast<uint8>(Event.Kind), Event.Subject);
+		if (const uint64* PendingSequence = PendingCoalescableEvents.Find(CoalesceKey); PendingSequence && *PendingSequence == Event.Sequence)
+		{
+			PendingCoalescableEvents.Remove(CoalesceKey);
+		}
+		// Moved out first, listeners may queue events and grow the array while this one runs
+		TUniqueFunction<void()> Dispatch = MoveTemp(Event.Dispatch);
+		if (Dispatch)
+		{
+			Dispatch();
+		}
+		++NumDispatched;
+	}
+
+	Events.RemoveAt(0, HeadIndex);
+	HeadIndex = 0;
+	return NumDispatched;
+}
+
+void FMPSessionEventQueue::ScheduleTick()
+{
+	if (TickerHandle.IsValid())
+	{
+		return;
+	}
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMPSessionEventQueue::Tick));
+}
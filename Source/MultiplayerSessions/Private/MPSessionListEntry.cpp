@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionListEntry.h"
+
+#include "MPSessionListItem.h"
+
+void UMPSessionListEntry::NativeOnListItemObjectSet(UObject* ListItemObject)
+{
+	IUserObjectListEntry::NativeOnListItemObjectSet(ListItemObject);
+
+	UnbindSessionItem();
+	SessionItem = Cast<UMPSessionListItem>(ListItemObject);
+	if (SessionItem)
+	{
+		ItemChangedDelegateHandle = SessionItem->OnItemChanged.AddWeakLambda(this, [this]()
+		{
+			OnSessionItemSet(SessionItem);
+		});
+	}
+	OnSessionItemSet(SessionItem);
+}
+
+void UMPSessionListEntry::NativeOnEntryReleased()
+{
+	UnbindSessionItem();
+	SessionItem = nullptr;
+
+	IUserObjectListEntry::NativeOnEntryReleased();
+}
+
+void UMPSessionListEntry::UnbindSessionItem()
+{
+	if (SessionItem)
+	{
+		SessionItem->OnItemChanged.Remove(ItemChangedDelegateHandle);
+	}
+	ItemChangedDelegateHandle.Reset();
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionListItem.h"
+
+void UMPSessionListItem::SetSearchResult(const TSharedRef<const FOnlineSessionSearchResult>& InSearchResult)
+{
+	SearchResult = InSearchResult;
+	SessionId = InSearchResult->GetSessionIdStr();
+	OwnerName = InSearchResult->Session.OwningUserName;
+	NumOpenPublicConnections = InSearchResult->Session.NumOpenPublicConnections;
+	MaxPublicConnections = InSearchResult->Session.SessionSettings.NumPublicConnections;
+	PingInMs = InSearchResult->PingInMs;
+	OnItemChanged.Broadcast();
+}
+
+void UMPSessionListItem::Reset()
+{
+	// OnItemChanged stays bound, entries unbind themselves when the list view releases them
+	SearchResult.Reset();
+	SessionId.Reset();
+	OwnerName.Reset();
+	NumOpenPublicConnections = 0;
+	MaxPublicConnections = 0;
+	PingInMs = 0;
+}
+
+bool UMPSessionListItem::GetSessionSetting(const FName SettingName, FString& OutValue) const
+{
+	if (!SearchResult.IsValid())
+	{
+		return false;
+	}
+	const FOnlineSessionSetting* Setting = SearchResult->Session.SessionSettings.Settings.Find(SettingName);
+	if (Setting == nullptr)
+	{
+		return false;
+	}
+	OutValue = Setting->Data.ToString();
+	return true;
+}
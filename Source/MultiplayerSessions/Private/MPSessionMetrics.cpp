@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionMetrics.h"
+
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_LOG_CATEGORY(LogMPSessionMetrics);
+
+TSet<FString> FMPSessionMetrics::ExportedRegionNames;
+
+FMPSessionMetrics::FMPSessionMetrics(const FString& InRegionName):
+	RegionName(InRegionName)
+{
+	FMemory::Memzero(Data);
+	FMemory::Memzero(OperationStartTimes);
+	Data.ProcessId = FPlatformProcess::GetCurrentProcessId();
+
+	if (ExportedRegionNames.Contains(RegionName))
+	{
+		UE_LOG(LogMPSessionMetrics, Error, TEXT("The metrics region '%s' is already exported by this process, metrics are not exported"), *RegionName);
+		return;
+	}
+	Region = FPlatformMemory::MapNamedSharedMemoryRegion(
+		RegionName,
+		true,
+		static_cast<uint32>(FPlatformMemory::ESharedMemoryAccess::Read) | static_cast<uint32>(FPlatformMemory::ESharedMemoryAccess::Write),
+		sizeof(FMPSessionMetricsBlock)
+	);
+	if (Region == nullptr)
+	{
+		UE_LOG(LogMPSessionMetrics, Error, TEXT("Failed to map the metrics region '%s', metrics are not exported"), *RegionName);
+		return;
+	}
+
+	// The region may be left over from a previous run, readers see an odd sequence until the first publish
+	Block = new (Region->GetAddress()) FMPSessionMetricsBlock();
+	Block->Sequence.store(1, std::memory_order_relaxed);
+	Block->Magic = MPSessionMetricsMagic;
+	Block->Version = MPSessionMetricsVersion;
+	Block->DataSize = sizeof(FMPSessionMetricsData);
+	ExportedRegionNames.Add(RegionName);
+	UE_LOG(LogMPSessionMetrics, Log, TEXT("Exporting session metrics to the shared memory region '%s' (%d bytes)"),
+		*RegionName, static_cast<int32>(sizeof(FMPSessionMetricsBlock)));
+}
+
+FMPSessionMetrics::~FMPSessionMetrics()
+{
+	if (Region != nullptr)
+	{
+		Block = nullptr;
+		FPlatformMemory::UnmapNamedSharedMemoryRegion(Region);
+		Region = nullptr;
+		ExportedRegionNames.Remove(RegionName);
+	}
+}
+
+void FMPSessionMetrics::OnOperationStarted(const int32 Operation)
+{
+	if (OperationStartTimes[Operation] != 0.0)
+	{
+		return;
+	}
+	OperationStartTimes[Operation] = FPlatformTime::Seconds();
+	++Data.Operations[Operation].NumStarted;
+}
+
+void FMPSessionMetrics::OnOperationCompleted(const int32 Operation, const bool bWasSuccessful)
+{
+	if (OperationStartTimes[Operation] == 0.0)
+	{
+		return;
+	}
+	const double LatencySeconds = FPlatformTime::Seconds() - OperationStartTimes[Operation];
+	OperationStartTimes[Operation] = 0.0;
+
+	FMPSessionMetricsOperation& OperationData = Data.Operations[Operation];
+	if (bWasSuccessful)
+	{
+		++OperationData.NumSucceeded;
+	}
+	else
+	{
+		++OperationData.NumFailed;
+	}
+	OperationData.LatencySumMicroseconds += static_cast<uint64>(LatencySeconds * 1e6);
+	int32 Bucket = 0;
+	while (Bucket < MPSessionMetricsNumLatencyBuckets - 1 && LatencySeconds > MPSessionMetricsLatencyBucketBoundsSeconds[Bucket])
+	{
+		++Bucket;
+	}
+	++OperationData.LatencyBuckets[Bucket];
+}
+
+void FMPSessionMetrics::OnOperationRejected(const EMPSessionOperation Kind)
+{
+	++Data.Operations[static_cast<int32>(Kind)].NumRejected;
+}
+
+void FMPSessionMetrics::Publish(const FMPSessionMetricsGauges& Gauges)
+{
+	if (Block == nullptr)
+	{
+		return;
+	}
+	++Data.NumPublishes;
+	Data.PublishTimeUnixMs = static_cast<uint64>((FDateTime::UtcNow() - FDateTime(1970, 1, 1)).GetTotalMilliseconds());
+	Data.SessionState = static_cast<int32>(Gauges.SessionState);
+	Data.NumQueuedOperations = Gauges.NumQueuedOperations;
+	Data.NumAdvertisedSessions = Gauges.NumAdvertisedSessions;
+	Data.NumRegisteredPlayers = Gauges.NumRegisteredPlayers;
+	Data.NumReadyPooledSessions = Gauges.NumReadyPooledSessions;
+	Data.NumPendingSessionEvents = Gauges.NumPendingSessionEvents;
+
+	// Single writer: odd while the copy is in progress, readers retry until they see the same even value on both sides
+	const uint32 Sequence = Block->Sequence.load(std::memory_order_relaxed) | 1u;
+	Block->Sequence.store(Sequence, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	FMemory::Memcpy(&Block->Data, &Data, sizeof(FMPSessionMetricsData));
+	Block->Sequence.store(Sequence + 1, std::memory_order_release);
+}
@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionMirrors.h"
+
+#include "MPSessionSchema.h"
+#include "OnlineSubsystem.h"
+#include "Interfaces/OnlineIdentityInterface.h"
+
+DEFINE_LOG_CATEGORY(LogMPSessionMirrors);
+
+namespace
+{
+	// A backend that refuses a destroy often only needs a moment, the session stays advertised on it otherwise
+	constexpr int32 MaxMirrorDestroyAttempts { 3 };
+	constexpr float MirrorDestroyRetryDelaySeconds { 1.f };
+}
+
+FMPSessionMirrors::FMPSessionMirrors(const TArray<FName>& OnlineSubsystemNames, const int32 InHostingPlayerNum):
+	HostingPlayerNum(InHostingPlayerNum)
+{
+	for (const FName& OnlineSubsystemName : OnlineSubsystemNames)
+	{
+		const IOnlineSubsystem* OnlineSubsystem = IOnlineSubsystem::Get(OnlineSubsystemName);
+		IOnlineSessionPtr Sessions = OnlineSubsystem ? OnlineSubsystem->GetSessionInterface() : nullptr;
+		if (!Sessions.IsValid())
+		{
+			UE_LOG(LogMPSessionMirrors, Error, TEXT("Online subsystem '%s' isn't available, the session won't be advertised on it"), *OnlineSubsystemName.ToString());
+			continue;
+		}
+		FMirror& Mirror = Mirrors.AddDefaulted_GetRef();
+		Mirror.OnlineSubsystemName = OnlineSubsystemName;
+		Mirror.Sessions = MoveTemp(Sessions);
+	}
+}
+
+FMPSessionMirrors::~FMPSessionMirrors()
+{
+	for (const FMirror& Mirror : Mirrors)
+	{
+		if (Mirror.RetryHandle.IsValid())
+		{
+			FTSTicker::GetCoreTicker().RemoveTicker(Mirror.RetryHandle);
+		}
+	}
+}
+
+void FMPSessionMirrors::Create(const FOnlineSessionSettings& Settings, FMPOnSessionMirrorsComplete&& OnComplete)
+{
+	IssueCall(ECall::Create, &Settings, MoveTemp(OnComplete));
+}
+
+void FMPSessionMirrors::Update(const FOnlineSessionSettings& Settings, FMPOnSessionMirrorsComplete&& OnComplete)
+{
+	IssueCall(ECall::Update, &Settings, MoveTemp(OnComplete));
+}
+
+void FMPSessionMirrors::Destroy(FMPOnSessionMirrorsComplete&& OnComplete)
+{
+	IssueCall(ECall::Destroy, nullptr, MoveTemp(OnComplete));
+}
+
+void FMPSessionMirrors::SetNumPlayers(const int32 NumPlayers)
+{
+	if (IsBusy())
+	{
+		PendingNumPlayers = NumPlayers;
+		return;
+	}
+	PendingNumPlayers.Reset();
+
+	bool bHasChanged = false;
+	for (FMirror& Mirror : Mirrors)
+	{
+		FNamedOnlineSession* NamedSession = Mirror.bIsCreated ? Mirror.Sessions->GetNamedSession(NAME_GameSession) : nullptr;
+		if (NamedSession == nullptr)
+		{
+			continue;
+		}
+		const int32 NumOpenPublicConnections = FMath::Max(NamedSession->SessionSettings.NumPublicConnections - NumPlayers, 0);
+		if (NamedSession->NumOpenPublicConnections != NumOpenPublicConnections)
+		{
+			NamedSession->NumOpenPublicConnections = NumOpenPublicConnections;
+			bHasChanged = true;
+		}
+	}
+	// Re-advertised with their own settings and the new open slots, nobody waits for it
+	if (bHasChanged)
+	{
+		IssueCall(ECall::Update, nullptr, FMPOnSessionMirrorsComplete());
+	}
+}
+
+bool FMPSessionMirrors::HasCreatedMirrors() const
+{
+	return Mirrors.ContainsByPredicate([](const FMirror& Mirror) { return Mirror.bIsCreated; });
+}
+
+TArray<FName> FMPSessionMirrors::GetCreatedOnlineSubsystems() const
+{
+	TArray<FName> OnlineSubsystemNames;
+	for (const FMirror& Mirror : Mirrors)
+	{
+		if (Mirror.bIsCreated)
+		{
+			OnlineSubsystemNames.Add(Mirror.OnlineSubsystemName);
+		}
+	}
+	return OnlineSubsystemNames;
+}
+
+void FMPSessionMirrors::IssueCall(const ECall Call, const FOnlineSessionSettings* Settings, FMPOnSessionMirrorsComplete&& OnComplete)
+{
+	if (IsBusy())
+	{
+		TOptional<FOnlineSessionSettings> QueuedSettings;
+		if (Settings)
+		{
+			QueuedSettings = *Settings;
+		}
+		QueuedCalls.Add([this, Call, QueuedSettings = MoveTemp(QueuedSettings), OnComplete = MoveTemp(OnComplete)]() mutable
+		{
+			IssueCall(Call, QueuedSettings.GetPtrOrNull(), MoveTemp(OnComplete));
+		});
+		return;
+	}
+
+	OnInFlightCallComplete = MoveTemp(OnComplete);
+	bHaveAllSucceeded = true;
+	// Counts the issuing itself, so mirrors answering synchronously can't complete the call early
+	NumPendingMirrors = 1;
+	for (int32 MirrorIndex = 0; MirrorIndex < Mirrors.Num(); ++MirrorIndex)
+	{
+		// Only created mirrors are updated or destroyed, a create updates the ones a failed destroy left created
+		FMirror& Mirror = Mirrors[MirrorIndex];
+		if (!Mirror.bIsCreated && Call != ECall::Create)
+		{
+			continue;
+		}
+		Mirror.Call = Mirror.bIsCreated && Call == ECall::Create ? ECall::Update : Call;
+		Mirror.NumAttempts = 1;
+		++NumPendingMirrors;
+		if (!IssueMirrorCall(MirrorIndex, Settings))
+		{
+			FinishMirror(MirrorIndex, false);
+		}
+	}
+	FinishMirror(INDEX_NONE, true);
+}
+
+bool FMPSessionMirrors::IssueMirrorCall(const int32 MirrorIndex, const FOnlineSessionSettings* Settings)
+{
+	FMirror& Mirror = Mirrors[MirrorIndex];
+	IOnlineSession& Sessions = *Mirror.Sessions;
+	const FOnCreateSessionCompleteDelegate OnComplete = FOnCreateSessionCompleteDelegate::CreateRaw(this, &FMPSessionMirrors::OnMirrorComplete, MirrorIndex);
+	switch (Mirror.Call)
+	{
+	case ECall::Create:
+	{
+		Mirror.CompleteBinding = FMPScopedDelegateBinding::ForInterface(Mirror.Sessions, Sessions.AddOnCreateSessionCompleteDelegate_Handle(OnComplete), &IOnlineSession::ClearOnCreateSessionCompleteDelegate_Handle);
+		const FOnlineSessionSettings MirrorSettings = MakeMirrorSettings(Mirror, *Settings);
+		const FUniqueNetIdPtr HostingPlayerId = GetHostingPlayerId(Mirror.OnlineSubsystemName);
+		return HostingPlayerId.IsValid()
+			? Sessions.CreateSession(*HostingPlayerId, NAME_GameSession, MirrorSettings)
+			: Sessions.CreateSession(HostingPlayerNum, NAME_GameSession, MirrorSettings);
+	}
+	case ECall::Update:
+	{
+		const FNamedOnlineSession* NamedSession = Sessions.GetNamedSession(NAME_GameSession);
+		if (NamedSession == nullptr)
+		{
+			return false;
+		}
+		Mirror.CompleteBinding = FMPScopedDelegateBinding::ForInterface(Mirror.Sessions, Sessions.AddOnUpdateSessionCompleteDelegate_Handle(OnComplete), &IOnlineSession::ClearOnUpdateSessionCompleteDelegate_Handle);
+		// Without settings the mirror's own are sent again, e.g. to advertise a new player count
+		FOnlineSessionSettings MirrorSettings = MakeMirrorSettings(Mirror, Settings ? *Settings : NamedSession->SessionSettings);
+		return Sessions.UpdateSession(NAME_GameSession, MirrorSettings, true);
+	}
+	case ECall::Destroy:
+		Mirror.CompleteBinding = FMPScopedDelegateBinding::ForInterface(Mirror.Sessions, Sessions.AddOnDestroySessionCompleteDelegate_Handle(OnComplete), &IOnlineSession::ClearOnDestroySessionCompleteDelegate_Handle);
+		return Sessions.DestroySession(NAME_GameSession);
+	default:
+		return false;
+	}
+}
+
+void FMPSessionMirrors::OnMirrorComplete(FName SessionName, bool bWasSuccessful, int32 MirrorIndex)
+{
+	if (SessionName != NAME_GameSession || !Mirrors[MirrorIndex].CompleteBinding.IsBound())
+	{
+		return;
+	}
+	FinishMirror(MirrorIndex, bWasSuccessful);
+}
+
+bool FMPSessionMirrors::RetryMirrorDestroy(float DeltaTime, int32 MirrorIndex)
+{
+	FMirror& Mirror = Mirrors[MirrorIndex];
+	Mirror.RetryHandle.Reset();
+	++Mirror.NumAttempts;
+	if (!IssueMirrorCall(MirrorIndex, nullptr))
+	{
+		FinishMirror(MirrorIndex, false);
+	}
+	return false;
+}
+
+void FMPSessionMirrors::FinishMirror(const int32 MirrorIndex, bool bWasSuccessful)
+{
+	if (Mirrors.IsValidIndex(MirrorIndex))
+	{
+		FMirror& Mirror = Mirrors[MirrorIndex];
+		Mirror.CompleteBinding.Reset();
+		if (Mirror.Call == ECall::Destroy && !bWasSuccessful)
+		{
+			// Refused because the backend has no such session anymore, it's gone all the same
+			bWasSuccessful = Mirror.Sessions->GetNamedSession(NAME_GameSession) == nullptr;
+			if (!bWasSuccessful && Mirror.NumAttempts < MaxMirrorDestroyAttempts)
+			{
+				UE_LOG(LogMPSessionMirrors, Warning, TEXT("Destroy of the session on '%s' failed, attempt %d of %d"), *Mirror.OnlineSubsystemName.ToString(), Mirror.NumAttempts, MaxMirrorDestroyAttempts);
+				Mirror.RetryHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMPSessionMirrors::RetryMirrorDestroy, MirrorIndex), MirrorDestroyRetryDelaySeconds);
+				return;
+			}
+		}
+		if (Mirror.Call == ECall::Create)
+		{
+			Mirror.bIsCreated = bWasSuccessful;
+		}
+		else if (Mirror.Call == ECall::Destroy)
+		{
+			// Until the backend confirms, the session is still advertised on it
+			Mirror.bIsCreated = !bWasSuccessful;
+		}
+		if (bWasSuccessful)
+		{
+			UE_LOG(LogMPSessionMirrors, Log, TEXT("%s of the session on '%s' succeeded"), LexToString(Mirror.Call), *Mirror.OnlineSubsystemName.ToString());
+		}
+		else
+		{
+			UE_LOG(LogMPSessionMirrors, Error, TEXT("%s of the session on '%s' failed"), LexToString(Mirror.Call), *Mirror.OnlineSubsystemName.ToString());
+		}
+		bHaveAllSucceeded &= bWasSuccessful;
+	}
+	if (--NumPendingMirrors > 0)
+	{
+		return;
+	}
+
+	const FMPOnSessionMirrorsComplete OnComplete = MoveTemp(OnInFlightCallComplete);
+	OnInFlightCallComplete.Unbind();
+	OnComplete.ExecuteIfBound(bHaveAllSucceeded);
+
+	// The callback may have issued the next call
+	if (IsBusy())
+	{
+		return;
+	}
+	if (QueuedCalls.Num() > 0)
+	{
+		TUniqueFunction<void()> Call = MoveTemp(QueuedCalls[0]);
+		QueuedCalls.RemoveAt(0);
+		Call();
+	}
+	else if (PendingNumPlayers.IsSet())
+	{
+		SetNumPlayers(PendingNumPlayers.GetValue());
+	}
+}
+
+FOnlineSessionSettings FMPSessionMirrors::MakeMirrorSettings(const FMirror& Mirror, const FOnlineSessionSettings& Settings)
+{
+	FOnlineSessionSettings MirrorSettings = Settings;
+	// The null subsystem only advertises on the local network
+	MirrorSettings.bIsLANMatch = Mirror.OnlineSubsystemName == "NULL";
+	// The session id is the one of the backend in use, the mirror's backend can't find the session by it
+	MirrorSettings.Remove(FMPSessionIdKey::GetName());
+	return MirrorSettings;
+}
+
+const TCHAR* FMPSessionMirrors::LexToString(const ECall Call)
+{
+	switch (Call)
+	{
+	case ECall::Create: return TEXT("Create");
+	case ECall::Update: return TEXT("Update");
+	case ECall::Destroy: return TEXT("Destroy");
+	default: return TEXT("Unknown");
+	}
+}
+
+FUniqueNetIdPtr FMPSessionMirrors::GetHostingPlayerId(const FName OnlineSubsystemName) const
+{
+	const IOnlineSubsystem* OnlineSubsystem = IOnlineSubsystem::Get(OnlineSubsystemName);
+	const IOnlineIdentityPtr Identity = OnlineSubsystem ? OnlineSubsystem->GetIdentityInterface() : nullptr;
+	return Identity.IsValid() ? Identity->GetUniquePlayerId(HostingPlayerNum) : nullptr;
+}
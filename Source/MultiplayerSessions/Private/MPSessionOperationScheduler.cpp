@@ -0,0 +1,300 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionOperationScheduler.h"
+
+DEFINE_LOG_CATEGORY(LogMPSessionOperationScheduler);
+
+FMPTokenBucket::FMPTokenBucket(const float InTokensPerSecond, const float InCapacity):
+	TokensPerSecond(InTokensPerSecond),
+	Capacity(FMath::Max(InCapacity, 1.f)),
+	Tokens(Capacity),
+	LastRefillTime(FPlatformTime::Seconds())
+{
+}
+
+bool FMPTokenBucket::TryConsume(const double Now)
+{
+	if (TokensPerSecond <= 0.0)
+	{
+		return true;
+	}
+	Tokens = GetTokens(Now);
+	LastRefillTime = Now;
+	if (Tokens < 1.0)
+	{
+		return false;
+	}
+	Tokens -= 1.0;
+	return true;
+}
+
+double FMPTokenBucket::GetSecondsUntilNextToken(const double Now) const
+{
+	if (TokensPerSecond <= 0.0)
+	{
+		return 0.0;
+	}
+	return FMath::Max(0.0, (1.0 - GetTokens(Now)) / TokensPerSecond);
+}
+
+double FMPTokenBucket::GetTokens(const double Now) const
+{
+	return FMath::Min(Capacity, Tokens + (Now - LastRefillTime) * TokensPerSecond);
+}
+
+FMPSessionOperationScheduler::FMPSessionOperationScheduler(const FName InBackendName, const float OperationsPerSecond, const float OperationsBurst):
+	BackendName(InBackendName),
+	TokenBucket(OperationsPerSecond, OperationsBurst)
+{
+}
+
+FMPSessionOperationScheduler::~FMPSessionOperationScheduler()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+}
+
+void FMPSessionOperationScheduler::Schedule(
+	const EMPSessionOperation Kind,
+	TUniqueFunction<void()>&& Execute,
+	TUniqueFunction<void()>&& Reject,
+	const EMPSessionOperationPriority Priority,
+	const FName MergeKey
+)
+{
+	// Operations of another priority or key are kept apart, e.g. an internal update does not take over a caller's one
+	const auto IsMergeable = [Kind, Priority, MergeKey](const FOperation& Operation)
+	{
+		return Operation.Kind == Kind && Operation.Priority == Priority && Operation.MergeKey == MergeKey;
+	};
+	// Create and join carry the caller's target, each of them is issued
+	const bool bCanMerge = Kind != EMPSessionOperation::Create && Kind != EMPSessionOperation::Join;
+	if (FOperation* QueuedOperation = bCanMerge ? Queue.FindByPredicate(IsMergeable) : nullptr)
+	{
+		if (Kind == EMPSessionOperation::Start || Kind == EMPSessionOperation::Destroy)
+		{
+			UE_LOG(LogMPSessionOperationScheduler, Log, TEXT("%s: %s already queued"), *BackendName.ToString(), LexToString(Kind));
+			return;
+		}
+		// Update and find carry the full state, the newer one keeps the turn and the superseded one is rejected
+		UE_LOG(LogMPSessionOperationScheduler, Log, TEXT("%s: merged %s with the queued one"), *BackendName.ToString(), LexToString(Kind));
+		TUniqueFunction<void()> SupersededReject = MoveTemp(QueuedOperation->Reject);
+		QueuedOperation->Execute = MoveTemp(Execute);
+		QueuedOperation->Reject = MoveTemp(Reject);
+		if (SupersededReject)
+		{
+			SupersededReject();
+		}
+		return;
+	}
+
+	FOperation& Operation = Queue.AddDefaulted_GetRef();
+	Operation.Kind = Kind;
+	Operation.Priority = Priority;
+	Operation.MergeKey = MergeKey;
+	Operation.Sequence = NextSequence++;
+	Operation.Execute = MoveTemp(Execute);
+	Operation.Reject = MoveTemp(Reject);
+	IssueReadyOperations();
+}
+
+void FMPSessionOperationScheduler::ScheduleFirst(const EMPSessionOperation Kind, TUniqueFunction<void()>&& Execute, TUniqueFunction<void()>&& Reject)
+{
+	FOperation& Operation = Queue.AddDefaulted_GetRef();
+	Operation.Kind = Kind;
+	Operation.Priority = EMPSessionOperationPriority::High;
+	Operation.Sequence = NextFirstSequence--;
+	Operation.Execute = MoveTemp(Execute);
+	Operation.Reject = MoveTemp(Reject);
+	IssueReadyOperations();
+}
+
+void FMPSessionOperationScheduler::Complete(const EMPSessionOperation Kind)
+{
+	TOptional<EMPSessionOperation>& LaneInFlight = InFlight[static_cast<int32>(GetLane(Kind))];
+	if (!LaneInFlight.IsSet() || LaneInFlight.GetValue() != Kind)
+	{
+		return;
+	}
+	LaneInFlight.Reset();
+	// Completions arrive from the backend's callbacks, the next operation is issued from the ticker
+	if (!Queue.IsEmpty())
+	{
+		ScheduleIssue(0.f);
+	}
+}
+
+void FMPSessionOperationScheduler::SetState(const EMPSessionState NewState)
+{
+	if (State == NewState)
+	{
+		return;
+	}
+	UE_LOG(LogMPSessionOperationScheduler, Verbose, TEXT("%s: session %s -> %s"), *BackendName.ToString(), LexToString(State), LexToString(NewState));
+	State = NewState;
+	if (IsSettled(State) && !Queue.IsEmpty())
+	{
+		ScheduleIssue(0.f);
+	}
+}
+
+bool FMPSessionOperationScheduler::IsInFlight(const EMPSessionOperation Kind) const
+{
+	const TOptional<EMPSessionOperation>& LaneInFlight = InFlight[static_cast<int32>(GetLane(Kind))];
+	return LaneInFlight.IsSet() && LaneInFlight.GetValue() == Kind;
+}
+
+void FMPSessionOperationScheduler::Reset()
+{
+	if (!Queue.IsEmpty())
+	{
+		UE_LOG(LogMPSessionOperationScheduler, Log, TEXT("%s: dropping %d queued operations"), *BackendName.ToString(), Queue.Num());
+	}
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+	Queue.Reset();
+	for (TOptional<EMPSessionOperation>& LaneInFlight : InFlight)
+	{
+		LaneInFlight.Reset();
+	}
+}
+
+const TCHAR* FMPSessionOperationScheduler::LexToString(const EMPSessionOperation Kind)
+{
+	switch (Kind)
+	{
+	case EMPSessionOperation::Create: return TEXT("Create");
+	case EMPSessionOperation::Update: return TEXT("Update");
+	case EMPSessionOperation::Start: return TEXT("Start");
+	case EMPSessionOperation::Destroy: return TEXT("Destroy");
+	case EMPSessionOperation::Join: return TEXT("Join");
+	case EMPSessionOperation::Find: return TEXT("Find");
+	default: return TEXT("Unknown");
+	}
+}
+
+const TCHAR* FMPSessionOperationScheduler::LexToString(const EMPSessionState InState)
+{
+	switch (InState)
+	{
+	case EMPSessionState::Idle: return TEXT("Idle");
+	case EMPSessionState::LoggingIn: return TEXT("LoggingIn");
+	case EMPSessionState::Creating: return TEXT("Creating");
+	case EMPSessionState::Created: return TEXT("Created");
+	case EMPSessionState::Starting: return TEXT("Starting");
+	case EMPSessionState::InProgress: return TEXT("InProgress");
+	case EMPSessionState::Destroying: return TEXT("Destroying");
+	default: return TEXT("Unknown");
+	}
+}
+
+FMPSessionOperationScheduler::ELane FMPSessionOperationScheduler::GetLane(const EMPSessionOperation Kind)
+{
+	return Kind == EMPSessionOperation::Find ? ELane::Search : ELane::Lifecycle;
+}
+
+bool FMPSessionOperationScheduler::IsSettled(const EMPSessionState InState)
+{
+	return InState == EMPSessionState::Idle || InState == EMPSessionState::Created || InState == EMPSessionState::InProgress;
+}
+
+bool FMPSessionOperationScheduler::CanApply(const EMPSessionOperation Kind) const
+{
+	switch (Kind)
+	{
+	case EMPSessionOperation::Update:
+		return State == EMPSessionState::Created || State == EMPSessionState::InProgress;
+	case EMPSessionOperation::Start:
+		return State == EMPSessionState::Created;
+	case EMPSessionOperation::Destroy:
+		return State != EMPSessionState::Idle;
+	default:
+		// Create replaces an existing session itself
+		return true;
+	}
+}
+
+bool FMPSessionOperationScheduler::CanIssueInLane(const ELane Lane) const
+{
+	if (InFlight[static_cast<int32>(Lane)].IsSet())
+	{
+		return false;
+	}
+	return Lane != ELane::Lifecycle || IsSettled(State);
+}
+
+int32 FMPSessionOperationScheduler::FindNextOperation() const
+{
+	int32 NextIndex = INDEX_NONE;
+	for (int32 Index = 0; Index < Queue.Num(); ++Index)
+	{
+		const FOperation& Operation = Queue[Index];
+		if (!CanIssueInLane(GetLane(Operation.Kind)))
+		{
+			continue;
+		}
+		if (NextIndex == INDEX_NONE
+			|| Operation.Priority > Queue[NextIndex].Priority
+			|| (Operation.Priority == Queue[NextIndex].Priority && Operation.Sequence < Queue[NextIndex].Sequence))
+		{
+			NextIndex = Index;
+		}
+	}
+	return NextIndex;
+}
+
+void FMPSessionOperationScheduler::IssueReadyOperations()
+{
+	if (bIsIssuing)
+	{
+		// Picked up by the loop below
+		return;
+	}
+	TGuardValue<bool> IssuingGuard(bIsIssuing, true);
+
+	for (int32 NextIndex = FindNextOperation(); NextIndex != INDEX_NONE; NextIndex = FindNextOperation())
+	{
+		const EMPSessionOperation Kind = Queue[NextIndex].Kind;
+		if (!CanApply(Kind))
+		{
+			UE_LOG(LogMPSessionOperationScheduler, Warning, TEXT("%s: rejected %s, session is %s"), *BackendName.ToString(), LexToString(Kind), LexToString(State));
+			TUniqueFunction<void()> Reject = MoveTemp(Queue[NextIndex].Reject);
+			Queue.RemoveAt(NextIndex);
+			if (Reject)
+			{
+				Reject();
+			}
+			continue;
+		}
+
+		const double Now = FPlatformTime::Seconds();
+		if (!TokenBucket.TryConsume(Now))
+		{
+			const double WaitSeconds = TokenBucket.GetSecondsUntilNextToken(Now);
+			UE_LOG(LogMPSessionOperationScheduler, Verbose, TEXT("%s: rate limited, %s waits %.2fs"), *BackendName.ToString(), LexToString(Kind), WaitSeconds);
+			ScheduleIssue(static_cast<float>(WaitSeconds));
+			return;
+		}
+
+		// Moved out first, Execute may schedule and grow the queue
+		TUniqueFunction<void()> Execute = MoveTemp(Queue[NextIndex].Execute);
+		Queue.RemoveAt(NextIndex);
+		InFlight[static_cast<int32>(GetLane(Kind))] = Kind;
+		UE_LOG(LogMPSessionOperationScheduler, Verbose, TEXT("%s: issuing %s"), *BackendName.ToString(), LexToString(Kind));
+		Execute();
+	}
+}
+
+void FMPSessionOperationScheduler::ScheduleIssue(const float DelaySeconds)
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateLambda([this](float)
+		{
+			TickerHandle.Reset();
+			IssueReadyOperations();
+			return false;
+		}),
+		DelaySeconds
+	);
+}
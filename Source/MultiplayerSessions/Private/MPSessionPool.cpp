@@ -0,0 +1,397 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionPool.h"
+
+DEFINE_LOG_CATEGORY(LogMPSessionPool);
+
+FMPSessionPool::FMPSessionPool(
+	const IOnlineSessionPtr& InSessionInterface,
+	const FOnlineSessionSettings& InBaseSessionSettings,
+	const int32 PoolSize,
+	const int32 InHostingPlayerNum
+):
+	SessionInterface(InSessionInterface),
+	BaseSessionSettings(InBaseSessionSettings),
+	HostingPlayerNum(InHostingPlayerNum)
+{
+	// Pooled sessions stay hidden until they are claimed
+	BaseSessionSettings.bShouldAdvertise = false;
+
+	PooledSessions.SetNum(FMath::Max(PoolSize, 0));
+	for (int32 Index = 0; Index < PooledSessions.Num(); ++Index)
+	{
+		// FName numbering gives MPPooledSession_0, MPPooledSession_1, ...
+		PooledSessions[Index].SessionName = FName(TEXT("MPPooledSession"), Index + 1);
+	}
+
+	if (SessionInterface.IsValid())
+	{
+		CreateSessionCompleteBinding = FMPScopedDelegateBinding::ForInterface(SessionInterface, SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(
+			FOnCreateSessionCompleteDelegate::CreateRaw(this, &FMPSessionPool::OnCreateSessionComplete)), &IOnlineSession::ClearOnCreateSessionCompleteDelegate_Handle);
+		UpdateSessionCompleteBinding = FMPScopedDelegateBinding::ForInterface(SessionInterface, SessionInterface->AddOnUpdateSessionCompleteDelegate_Handle(
+			FOnUpdateSessionCompleteDelegate::CreateRaw(this, &FMPSessionPool::OnUpdateSessionComplete)), &IOnlineSession::ClearOnUpdateSessionCompleteDelegate_Handle);
+		DestroySessionCompleteBinding = FMPScopedDelegateBinding::ForInterface(SessionInterface, SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(
+			FOnDestroySessionCompleteDelegate::CreateRaw(this, &FMPSessionPool::OnDestroySessionComplete)), &IOnlineSession::ClearOnDestroySessionCompleteDelegate_Handle);
+	}
+	else
+	{
+		UE_LOG(LogMPSessionPool, Error, TEXT("SessionInterface is not valid, the session pool will stay empty"));
+	}
+}
+
+FMPSessionPool::~FMPSessionPool()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(RefillTickerHandle);
+}
+
+void FMPSessionPool::Fill()
+{
+	if (bIsShuttingDown || !SessionInterface.IsValid())
+	{
+		return;
+	}
+
+	bool bHasFailedToIssue = false;
+	for (FMPPooledSession& PooledSession : PooledSessions)
+	{
+		if (PooledSession.State == EMPPooledSessionState::Empty && !TryCreatePooledSession(PooledSession))
+		{
+			bHasFailedToIssue = true;
+		}
+	}
+	if (bHasFailedToIssue)
+	{
+		ScheduleRefill();
+	}
+}
+
+FName FMPSessionPool::Claim(const FSessionSettings& Attributes)
+{
+	if (!SessionInterface.IsValid())
+	{
+		return NAME_None;
+	}
+
+	FMPPooledSession* ReadySession = PooledSessions.FindByPredicate([](const FMPPooledSession& PooledSession)
+	{
+		return PooledSession.State == EMPPooledSessionState::Ready;
+	});
+	if (ReadySession == nullptr)
+	{
+		UE_LOG(LogMPSessionPool, Warning, TEXT("No pooled session ready to claim"));
+		return NAME_None;
+	}
+
+	const FOnlineSessionSettings* CurrentSettings = SessionInterface->GetSessionSettings(ReadySession->SessionName);
+	FOnlineSessionSettings ClaimedSettings = CurrentSettings ? *CurrentSettings : BaseSessionSettings;
+	ClaimedSettings.bShouldAdvertise = true;
+	for (const auto& Attribute : Attributes)
+	{
+		ClaimedSettings.Set(Attribute.Key, Attribute.Value);
+	}
+
+	ReadySession->State = EMPPooledSessionState::Claiming;
+	FMPOnlineTrafficEvent UpdateCall(EMPOnlineTrafficEvent::UpdateSessionCall, ReadySession->SessionName);
+	UpdateCall.SessionSettings = ClaimedSettings;
+	if (!IssuePooledSessionCall(MoveTemp(UpdateCall), [this, ReadySession, &ClaimedSettings]()
+		{
+			return SessionInterface->UpdateSession(ReadySession->SessionName, ClaimedSettings, true);
+		}))
+	{
+		UE_LOG(LogMPSessionPool, Error, TEXT("Failed to issue claim of pooled session %s"), *ReadySession->SessionName.ToString());
+		ReadySession->State = EMPPooledSessionState::Ready;
+		return NAME_None;
+	}
+	UE_LOG(LogMPSessionPool, Log, TEXT("Claiming pooled session %s"), *ReadySession->SessionName.ToString());
+	return ReadySession->SessionName;
+}
+
+bool FMPSessionPool::Release(const FName SessionName)
+{
+	FMPPooledSession* PooledSession = FindPooledSession(SessionName);
+	if (PooledSession == nullptr || PooledSession->State != EMPPooledSessionState::Claimed || !SessionInterface.IsValid())
+	{
+		UE_LOG(LogMPSessionPool, Warning, TEXT("Cannot release %s, it is not a claimed pooled session"), *SessionName.ToString());
+		return false;
+	}
+
+	// A destroyed and recreated session gets a fresh id and no stale registered players
+	PooledSession->State = EMPPooledSessionState::Recycling;
+	if (!IssuePooledSessionCall(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::DestroySessionCall, SessionName), [this, SessionName]()
+		{
+			return SessionInterface->DestroySession(SessionName);
+		}))
+	{
+		UE_LOG(LogMPSessionPool, Error, TEXT("Failed to issue recycling of pooled session %s"), *SessionName.ToString());
+		PooledSession->State = EMPPooledSessionState::Claimed;
+		return false;
+	}
+	return true;
+}
+
+void FMPSessionPool::DestroyAll(FSimpleDelegate&& OnDestroyed)
+{
+	bIsShuttingDown = true;
+	OnAllDestroyed = MoveTemp(OnDestroyed);
+	FTSTicker::GetCoreTicker().RemoveTicker(RefillTickerHandle);
+	RefillTickerHandle.Reset();
+	if (!SessionInterface.IsValid())
+	{
+		return;
+	}
+
+	for (FMPPooledSession& PooledSession : PooledSessions)
+	{
+		// Sessions being created or claimed are destroyed once that completes, the backend may refuse destroying them before
+		if (PooledSession.State != EMPPooledSessionState::Ready && PooledSession.State != EMPPooledSessionState::Claimed)
+		{
+			continue;
+		}
+		if (SessionInterface->GetNamedSession(PooledSession.SessionName) == nullptr)
+		{
+			PooledSession.State = EMPPooledSessionState::Empty;
+			continue;
+		}
+		TryDestroyPooledSession(PooledSession);
+	}
+}
+
+bool FMPSessionPool::IsDestroyed() const
+{
+	return bIsShuttingDown && !PooledSessions.ContainsByPredicate([](const FMPPooledSession& PooledSession)
+	{
+		return PooledSession.State == EMPPooledSessionState::Creating
+			|| PooledSession.State == EMPPooledSessionState::Claiming
+			|| PooledSession.State == EMPPooledSessionState::Recycling;
+	});
+}
+
+bool FMPSessionPool::IsPooledSession(const FName SessionName) const
+{
+	return FindPooledSession(SessionName) != nullptr;
+}
+
+int32 FMPSessionPool::GetNumSessionsInState(const EMPPooledSessionState State) const
+{
+	int32 NumSessions = 0;
+	for (const FMPPooledSession& PooledSession : PooledSessions)
+	{
+		NumSessions += PooledSession.State == State ? 1 : 0;
+	}
+	return NumSessions;
+}
+
+int32 FMPSessionPool::GetNumRegisteredPlayers() const
+{
+	if (!SessionInterface.IsValid())
+	{
+		return 0;
+	}
+	int32 NumPlayers = 0;
+	for (const FMPPooledSession& PooledSession : PooledSessions)
+	{
+		if (PooledSession.State != EMPPooledSessionState::Claimed)
+		{
+			continue;
+		}
+		if (const FNamedOnlineSession* NamedSession = SessionInterface->GetNamedSession(PooledSession.SessionName))
+		{
+			NumPlayers += NamedSession->RegisteredPlayers.Num();
+		}
+	}
+	return NumPlayers;
+}
+
+void FMPSessionPool::OnCreateSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	FMPPooledSession* PooledSession = FindPooledSession(SessionName);
+	if (PooledSession == nullptr || PooledSession->State != EMPPooledSessionState::Creating)
+	{
+		return;
+	}
+	if (OnOnlineCallback)
+	{
+		OnOnlineCallback(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::CreateSessionComplete, SessionName, bWasSuccessful));
+	}
+
+	if (bIsShuttingDown)
+	{
+		PooledSession->State = EMPPooledSessionState::Empty;
+		if (bWasSuccessful)
+		{
+			TryDestroyPooledSession(*PooledSession);
+		}
+		CompleteDestroyAll();
+		return;
+	}
+
+	if (bWasSuccessful)
+	{
+		UE_LOG(LogMPSessionPool, Log, TEXT("Pooled session %s ready"), *SessionName.ToString());
+		PooledSession->State = EMPPooledSessionState::Ready;
+	}
+	else
+	{
+		UE_LOG(LogMPSessionPool, Error, TEXT("Failed to create pooled session %s"), *SessionName.ToString());
+		PooledSession->State = EMPPooledSessionState::Empty;
+		ScheduleRefill();
+	}
+}
+
+void FMPSessionPool::OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	FMPPooledSession* PooledSession = FindPooledSession(SessionName);
+	if (PooledSession == nullptr || PooledSession->State != EMPPooledSessionState::Claiming)
+	{
+		return;
+	}
+	if (OnOnlineCallback)
+	{
+		OnOnlineCallback(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::UpdateSessionComplete, SessionName, bWasSuccessful));
+	}
+
+	if (bIsShuttingDown)
+	{
+		UE_LOG(LogMPSessionPool, Warning, TEXT("Pooled session %s claimed while the pool shuts down, destroying it"), *SessionName.ToString());
+		PooledSession->State = EMPPooledSessionState::Claimed;
+		TryDestroyPooledSession(*PooledSession);
+		OnSessionClaimed.ExecuteIfBound(SessionName, FString(), false);
+		CompleteDestroyAll();
+		return;
+	}
+
+	FString SessionId;
+	if (bWasSuccessful)
+	{
+		PooledSession->State = EMPPooledSessionState::Claimed;
+		if (const FNamedOnlineSession* NamedSession = SessionInterface->GetNamedSession(SessionName))
+		{
+			SessionId = NamedSession->GetSessionIdStr();
+		}
+		UE_LOG(LogMPSessionPool, Log, TEXT("Pooled session %s claimed, Session ID %s"), *SessionName.ToString(), *SessionId);
+	}
+	else
+	{
+		UE_LOG(LogMPSessionPool, Error, TEXT("Failed to claim pooled session %s"), *SessionName.ToString());
+		PooledSession->State = EMPPooledSessionState::Ready;
+	}
+	OnSessionClaimed.ExecuteIfBound(SessionName, SessionId, bWasSuccessful);
+}
+
+void FMPSessionPool::OnDestroySessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	FMPPooledSession* PooledSession = FindPooledSession(SessionName);
+	if (PooledSession == nullptr || PooledSession->State != EMPPooledSessionState::Recycling)
+	{
+		return;
+	}
+	if (OnOnlineCallback)
+	{
+		OnOnlineCallback(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::DestroySessionComplete, SessionName, bWasSuccessful));
+	}
+
+	if (!bWasSuccessful && SessionInterface->GetNamedSession(SessionName) != nullptr)
+	{
+		UE_LOG(LogMPSessionPool, Error, TEXT("Failed to recycle pooled session %s"), *SessionName.ToString());
+		PooledSession->State = EMPPooledSessionState::Claimed;
+		CompleteDestroyAll();
+		return;
+	}
+
+	PooledSession->State = EMPPooledSessionState::Empty;
+	if (bIsShuttingDown)
+	{
+		CompleteDestroyAll();
+		return;
+	}
+	if (!TryCreatePooledSession(*PooledSession))
+	{
+		ScheduleRefill();
+	}
+}
+
+bool FMPSessionPool::IssuePooledSessionCall(FMPOnlineTrafficEvent&& Call, TFunctionRef<bool()> IssueCall)
+{
+	return IssueOnlineCall ? IssueOnlineCall(MoveTemp(Call), IssueCall) : IssueCall();
+}
+
+bool FMPSessionPool::TryCreatePooledSession(FMPPooledSession& PooledSession)
+{
+	PooledSession.State = EMPPooledSessionState::Creating;
+	// Pooled sessions are owned by the server, they are created through the hosting player number rather than a player id
+	FMPOnlineTrafficEvent CreateCall(EMPOnlineTrafficEvent::CreateSessionCall, PooledSession.SessionName);
+	CreateCall.SessionSettings = BaseSessionSettings;
+	if (!IssuePooledSessionCall(MoveTemp(CreateCall), [this, &PooledSession]()
+		{
+			return SessionInterface->CreateSession(HostingPlayerNum, PooledSession.SessionName, BaseSessionSettings);
+		}))
+	{
+		UE_LOG(LogMPSessionPool, Error, TEXT("Failed to issue creation of pooled session %s"), *PooledSession.SessionName.ToString());
+		PooledSession.State = EMPPooledSessionState::Empty;
+		return false;
+	}
+	return true;
+}
+
+bool FMPSessionPool::TryDestroyPooledSession(FMPPooledSession& PooledSession)
+{
+	const EMPPooledSessionState PreviousState = PooledSession.State;
+	PooledSession.State = EMPPooledSessionState::Recycling;
+	if (!IssuePooledSessionCall(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::DestroySessionCall, PooledSession.SessionName), [this, &PooledSession]()
+		{
+			return SessionInterface->DestroySession(PooledSession.SessionName);
+		}))
+	{
+		UE_LOG(LogMPSessionPool, Error, TEXT("Failed to issue destruction of pooled session %s"), *PooledSession.SessionName.ToString());
+		PooledSession.State = PreviousState;
+		return false;
+	}
+	return true;
+}
+
+void FMPSessionPool::CompleteDestroyAll()
+{
+	if (!IsDestroyed() || !OnAllDestroyed.IsBound())
+	{
+		return;
+	}
+	UE_LOG(LogMPSessionPool, Log, TEXT("Session pool destroyed"));
+	// Moved out first, the callback may delete the pool
+	const FSimpleDelegate OnDestroyed = MoveTemp(OnAllDestroyed);
+	OnAllDestroyed.Unbind();
+	OnDestroyed.Execute();
+}
+
+void FMPSessionPool::ScheduleRefill()
+{
+	if (bIsShuttingDown || RefillTickerHandle.IsValid())
+	{
+		return;
+	}
+	RefillTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateLambda([this](float)
+		{
+			RefillTickerHandle.Reset();
+			Fill();
+			return false;
+		}),
+		RefillRetryDelaySeconds
+	);
+}
+
+FMPPooledSession* FMPSessionPool::FindPooledSession(const FName SessionName)
+{
+	return PooledSessions.FindByPredicate([SessionName](const FMPPooledSession& PooledSession)
+	{
+		return PooledSession.SessionName == SessionName;
+	});
+}
+
+const FMPPooledSession* FMPSessionPool::FindPooledSession(const FName SessionName) const
+{
+	return PooledSessions.FindByPredicate([SessionName](const FMPPooledSession& PooledSession)
+	{
+		return PooledSession.SessionName == SessionName;
+	});
+}
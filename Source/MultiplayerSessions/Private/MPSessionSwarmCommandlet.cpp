@@ -0,0 +1,407 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionSwarmCommandlet.h"
+
+#include "MPSessionSchema.h"
+#include "Containers/Ticker.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_LOG_CATEGORY(LogMPSessionSwarm);
+
+namespace
+{
+	const TCHAR* BehaviourNames[] = { TEXT("Browse"), TEXT("QuickJoin"), TEXT("Host"), TEXT("Leave") };
+}
+
+UMPSessionSwarmCommandlet::UMPSessionSwarmCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UMPSessionSwarmCommandlet::Main(const FString& Params)
+{
+	int32 NumHosts = 50;
+	int32 NumClients = 500;
+	float DurationSeconds = 60.f;
+	float HostArrivalRate = 10.f;
+	float ClientArrivalRate = 50.f;
+	FString Mix = TEXT("Browse:40,QuickJoin:40,Leave:20");
+	FMPSimulatedBackendSettings BackendSettings;
+	FParse::Value(*Params, TEXT("Hosts="), NumHosts);
+	FParse::Value(*Params, TEXT("Clients="), NumClients);
+	FParse::Value(*Params, TEXT("Duration="), DurationSeconds);
+	FParse::Value(*Params, TEXT("HostArrivalRate="), HostArrivalRate);
+	FParse::Value(*Params, TEXT("ClientArrivalRate="), ClientArrivalRate);
+	FParse::Value(*Params, TEXT("Mix="), Mix, false);
+	FParse::Value(*Params, TEXT("ThinkSeconds="), ThinkSeconds);
+	FParse::Value(*Params, TEXT("MaxPlayers="), MaxPlayers);
+	FParse::Value(*Params, TEXT("MaxSearchResults="), MaxSearchResults);
+	FParse::Value(*Params, TEXT("OpsPerSecond="), OperationsPerSecond);
+	FParse::Value(*Params, TEXT("OpsBurst="), OperationsBurst);
+	FParse::Value(*Params, TEXT("LatencyMs="), BackendSettings.LatencyMs);
+	FParse::Value(*Params, TEXT("LatencyJitterMs="), BackendSettings.LatencyJitterMs);
+	FParse::Value(*Params, TEXT("FailureRate="), BackendSettings.FailureRate);
+	FParse::Value(*Params, TEXT("Seed="), BackendSettings.Seed);
+
+	TArray<FString> MixEntries;
+	Mix.ParseIntoArray(MixEntries, TEXT(","));
+	for (const FString& MixEntry : MixEntries)
+	{
+		FString BehaviourName;
+		FString Weight;
+		if (!MixEntry.Split(TEXT(":"), &BehaviourName, &Weight))
+		{
+			continue;
+		}
+		for (int32 Behaviour = 0; Behaviour < static_cast<int32>(EBehaviour::Num); ++Behaviour)
+		{
+			if (BehaviourName.Equals(BehaviourNames[Behaviour], ESearchCase::IgnoreCase))
+			{
+				ClientBehaviourWeights[Behaviour] = FMath::Max(FCString::Atoi(*Weight), 0);
+			}
+		}
+	}
+	// Hosting is driven by the host count, not by the client mix
+	ClientBehaviourWeights[static_cast<int32>(EBehaviour::Host)] = 0;
+
+	UE_LOG(LogMPSessionSwarm, Display, TEXT("Swarm: %d hosts at %.1f/s, %d clients at %.1f/s, %.0fs, mix %s, backend latency %.0f+-%.0fms, failure rate %.3f"),
+		NumHosts, HostArrivalRate, NumClients, ClientArrivalRate, DurationSeconds, *Mix,
+		BackendSettings.LatencyMs, BackendSettings.LatencyJitterMs, BackendSettings.FailureRate);
+
+	RandomStream.Initialize(BackendSettings.Seed);
+	Backend = MakeUnique<FMPSimulatedSessionBackend>(BackendSettings);
+	Players.Reserve(NumHosts + NumClients);
+	const uint64 UsedMemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+
+	int32 NumHostsSpawned = 0;
+	int32 NumClientsSpawned = 0;
+	const double StartTime = FPlatformTime::Seconds();
+	double LastTickTime = StartTime;
+	for (double Now = StartTime; Now - StartTime < DurationSeconds; Now = FPlatformTime::Seconds())
+	{
+		const double ElapsedSeconds = Now - StartTime;
+		while (NumHostsSpawned < NumHosts && NumHostsSpawned < HostArrivalRate * ElapsedSeconds)
+		{
+			SpawnPlayer(true);
+			++NumHostsSpawned;
+		}
+		while (NumClientsSpawned < NumClients && NumClientsSpawned < ClientArrivalRate * ElapsedSeconds)
+		{
+			SpawnPlayer(false);
+			++NumClientsSpawned;
+		}
+
+		Backend->Tick(Now);
+		// Schedulers issue rate limited operations from the core ticker
+		FTSTicker::GetCoreTicker().Tick(static_cast<float>(Now - LastTickTime));
+		LastTickTime = Now;
+		for (const TUniquePtr<FLogicalPlayer>& Player : Players)
+		{
+			if (!Player->bIsBusy && Now >= Player->NextBehaviourTime)
+			{
+				RunBehaviour(*Player);
+			}
+		}
+		FPlatformProcess::Sleep(0.001f);
+	}
+
+	const double ElapsedSeconds = FPlatformTime::Seconds() - StartTime;
+	Report(ElapsedSeconds, UsedMemoryBefore, FPlatformMemory::GetStats().UsedPhysical);
+
+	// In-flight completions reference the players, they go first
+	Backend.Reset();
+	Players.Reset();
+	return 0;
+}
+
+void UMPSessionSwarmCommandlet::SpawnPlayer(const bool bIsHost)
+{
+	FLogicalPlayer& Player = *Players.Add_GetRef(MakeUnique<FLogicalPlayer>());
+	Player.PlayerId = Players.Num() - 1;
+	Player.bIsHost = bIsHost;
+	Player.Scheduler = MakeUnique<FMPSessionOperationScheduler>(FName(TEXT("MPSimulated")), OperationsPerSecond, OperationsBurst);
+	Player.NextBehaviourTime = FPlatformTime::Seconds();
+}
+
+void UMPSessionSwarmCommandlet::RunBehaviour(FLogicalPlayer& Player)
+{
+	Player.bIsBusy = true;
+	if (Player.bIsHost)
+	{
+		// Hosts hold their session for a while, then tear it down and host again
+		if (Player.SessionId.IsEmpty())
+		{
+			Host(Player);
+		}
+		else
+		{
+			Leave(Player);
+		}
+		return;
+	}
+
+	EBehaviour Behaviour = PickClientBehaviour();
+	if (Behaviour == EBehaviour::QuickJoin && !Player.SessionId.IsEmpty())
+	{
+		Behaviour = EBehaviour::Leave;
+	}
+	else if (Behaviour == EBehaviour::Leave && Player.SessionId.IsEmpty())
+	{
+		Behaviour = EBehaviour::Browse;
+	}
+	switch (Behaviour)
+	{
+	case EBehaviour::QuickJoin:
+		Browse(Player, true);
+		break;
+	case EBehaviour::Leave:
+		Leave(Player);
+		break;
+	default:
+		Browse(Player, false);
+		break;
+	}
+}
+
+void UMPSessionSwarmCommandlet::Browse(FLogicalPlayer& Player, const bool bJoinFirstResult)
+{
+	++NumBehaviours[static_cast<int32>(bJoinFirstResult ? EBehaviour::QuickJoin : EBehaviour::Browse)];
+	FLogicalPlayer* PlayerPtr = &Player;
+	Player.Scheduler->Schedule(
+		EMPSessionOperation::Find,
+		[this, PlayerPtr, bJoinFirstResult]()
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			Backend->FindSessions(MaxSearchResults, [this, PlayerPtr, bJoinFirstResult, StartTime](bool bWasSuccessful, const TArray<FOnlineSessionSearchResult>& SearchResults)
+			{
+				CompleteOperation(*PlayerPtr, EMPSessionOperation::Find, StartTime, bWasSuccessful);
+				if (!bWasSuccessful)
+				{
+					FinishBehaviour(*PlayerPtr);
+					return;
+				}
+				// What a session browser does with every refresh
+				PlayerPtr->ResultTracker.Update(SearchResults);
+				FString SessionId;
+				if (bJoinFirstResult && SearchResults.Num() > 0 && FMPSessionSchema::Get<FMPSessionIdKey>(SearchResults[0].Session.SessionSettings, SessionId))
+				{
+					Join(*PlayerPtr, SessionId);
+					return;
+				}
+				FinishBehaviour(*PlayerPtr);
+			});
+		},
+		[this, PlayerPtr]()
+		{
+			RejectOperation(*PlayerPtr, EMPSessionOperation::Find);
+		},
+		EMPSessionOperationPriority::Low
+	);
+}
+
+void UMPSessionSwarmCommandlet::Join(FLogicalPlayer& Player, const FString& SessionId)
+{
+	FLogicalPlayer* PlayerPtr = &Player;
+	Player.Scheduler->Schedule(
+		EMPSessionOperation::Join,
+		[this, PlayerPtr, SessionId]()
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			PlayerPtr->Scheduler->SetState(EMPSessionState::Creating);
+			Backend->JoinSession(SessionId, [this, PlayerPtr, SessionId, StartTime](EOnJoinSessionCompleteResult::Type Result)
+			{
+				++NumJoinResults[Result];
+				const bool bWasSuccessful = Result == EOnJoinSessionCompleteResult::Success;
+				if (bWasSuccessful)
+				{
+					PlayerPtr->SessionId = SessionId;
+				}
+				PlayerPtr->Scheduler->SetState(bWasSuccessful ? EMPSessionState::Created : EMPSessionState::Idle);
+				CompleteOperation(*PlayerPtr, EMPSessionOperation::Join, StartTime, bWasSuccessful);
+				FinishBehaviour(*PlayerPtr);
+			});
+		},
+		[this, PlayerPtr]()
+		{
+			RejectOperation(*PlayerPtr, EMPSessionOperation::Join);
+		}
+	);
+}
+
+void UMPSessionSwarmCommandlet::Host(FLogicalPlayer& Player)
+{
+	++NumBehaviours[static_cast<int32>(EBehaviour::Host)];
+	FLogicalPlayer* PlayerPtr = &Player;
+	Player.Scheduler->Schedule(
+		EMPSessionOperation::Create,
+		[this, PlayerPtr]()
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			PlayerPtr->Scheduler->SetState(EMPSessionState::Creating);
+			FOnlineSessionSettings SessionSettings;
+			SessionSettings.NumPublicConnections = MaxPlayers;
+			SessionSettings.bShouldAdvertise = true;
+			FMPSessionSchema::Set<FMPMatchTypeKey>(SessionSettings, TEXT("Swarm"));
+			Backend->CreateSession(FString::Printf(TEXT("SwarmHost%d"), PlayerPtr->PlayerId), SessionSettings, [this, PlayerPtr, StartTime](bool bWasSuccessful, const FString& SessionId)
+			{
+				PlayerPtr->SessionId = SessionId;
+				PlayerPtr->Scheduler->SetState(bWasSuccessful ? EMPSessionState::Created : EMPSessionState::Idle);
+				CompleteOperation(*PlayerPtr, EMPSessionOperation::Create, StartTime, bWasSuccessful);
+				if (!bWasSuccessful)
+				{
+					FinishBehaviour(*PlayerPtr);
+				}
+			});
+		},
+		[this, PlayerPtr]()
+		{
+			RejectOperation(*PlayerPtr, EMPSessionOperation::Create);
+		}
+	);
+	// Queued behind the create, rejected by the scheduler if the create failed
+	Player.Scheduler->Schedule(
+		EMPSessionOperation::Start,
+		[this, PlayerPtr]()
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			PlayerPtr->Scheduler->SetState(EMPSessionState::Starting);
+			Backend->StartSession(PlayerPtr->SessionId, [this, PlayerPtr, StartTime](bool bWasSuccessful)
+			{
+				PlayerPtr->Scheduler->SetState(bWasSuccessful ? EMPSessionState::InProgress : EMPSessionState::Created);
+				CompleteOperation(*PlayerPtr, EMPSessionOperation::Start, StartTime, bWasSuccessful);
+				FinishBehaviour(*PlayerPtr);
+			});
+		},
+		// Not counted, the failure is the create's and it already ended the behaviour
+		nullptr
+	);
+}
+
+void UMPSessionSwarmCommandlet::Leave(FLogicalPlayer& Player)
+{
+	++NumBehaviours[static_cast<int32>(EBehaviour::Leave)];
+	if (!Player.bIsHost)
+	{
+		Backend->LeaveSession(Player.SessionId);
+		Player.SessionId.Reset();
+		Player.Scheduler->SetState(EMPSessionState::Idle);
+		FinishBehaviour(Player);
+		return;
+	}
+
+	FLogicalPlayer* PlayerPtr = &Player;
+	Player.Scheduler->Schedule(
+		EMPSessionOperation::Destroy,
+		[this, PlayerPtr]()
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			PlayerPtr->Scheduler->SetState(EMPSessionState::Destroying);
+			Backend->DestroySession(PlayerPtr->SessionId, [this, PlayerPtr, StartTime](bool bWasSuccessful)
+			{
+				// A session that failed to be destroyed is given up on, as a crashed host would
+				PlayerPtr->SessionId.Reset();
+				PlayerPtr->Scheduler->SetState(EMPSessionState::Idle);
+				CompleteOperation(*PlayerPtr, EMPSessionOperation::Destroy, StartTime, bWasSuccessful);
+				FinishBehaviour(*PlayerPtr);
+			});
+		},
+		[this, PlayerPtr]()
+		{
+			RejectOperation(*PlayerPtr, EMPSessionOperation::Destroy);
+		}
+	);
+}
+
+void UMPSessionSwarmCommandlet::FinishBehaviour(FLogicalPlayer& Player)
+{
+	Player.bIsBusy = false;
+	// Exponential pauses, arrivals of behaviours are then a Poisson process per player
+	Player.NextBehaviourTime = FPlatformTime::Seconds() - ThinkSeconds * FMath::Loge(FMath::Max(1.f - RandomStream.FRand(), UE_KINDA_SMALL_NUMBER));
+}
+
+UMPSessionSwarmCommandlet::EBehaviour UMPSessionSwarmCommandlet::PickClientBehaviour()
+{
+	int32 TotalWeight = 0;
+	for (const int32 Weight : ClientBehaviourWeights)
+	{
+		TotalWeight += Weight;
+	}
+	if (TotalWeight <= 0)
+	{
+		return EBehaviour::Browse;
+	}
+	int32 Pick = RandomStream.RandRange(0, TotalWeight - 1);
+	for (int32 Behaviour = 0; Behaviour < static_cast<int32>(EBehaviour::Num); ++Behaviour)
+	{
+		if (Pick < ClientBehaviourWeights[Behaviour])
+		{
+			return static_cast<EBehaviour>(Behaviour);
+		}
+		Pick -= ClientBehaviourWeights[Behaviour];
+	}
+	return EBehaviour::Browse;
+}
+
+void UMPSessionSwarmCommandlet::CompleteOperation(FLogicalPlayer& Player, const EMPSessionOperation Kind, const double StartTime, const bool bWasSuccessful)
+{
+	FOperationStats& Stats = OperationStats[static_cast<int32>(Kind)];
+	Stats.Latency.Add(FPlatformTime::Seconds() - StartTime);
+	if (bWasSuccessful)
+	{
+		++Stats.NumSucceeded;
+	}
+	else
+	{
+		++Stats.NumFailed;
+	}
+	Player.Scheduler->Complete(Kind);
+}
+
+void UMPSessionSwarmCommandlet::RejectOperation(FLogicalPlayer& Player, const EMPSessionOperation Kind)
+{
+	++OperationStats[static_cast<int32>(Kind)].NumRejected;
+	FinishBehaviour(Player);
+}
+
+void UMPSessionSwarmCommandlet::Report(const double ElapsedSeconds, const uint64 UsedMemoryBefore, const uint64 UsedMemoryAfter) const
+{
+	UE_LOG(LogMPSessionSwarm, Display, TEXT("Swarm ran %.1fs with %d logical players, %d sessions left on the backend"),
+		ElapsedSeconds, Players.Num(), Backend->GetNumSessions());
+	for (int32 Behaviour = 0; Behaviour < static_cast<int32>(EBehaviour::Num); ++Behaviour)
+	{
+		UE_LOG(LogMPSessionSwarm, Display, TEXT("  %-10s %d"), BehaviourNames[Behaviour], NumBehaviours[Behaviour]);
+	}
+	for (int32 Kind = 0; Kind < NumOperationKinds; ++Kind)
+	{
+		const FOperationStats& Stats = OperationStats[Kind];
+		const int32 NumCompleted = Stats.NumSucceeded + Stats.NumFailed;
+		if (NumCompleted + Stats.NumRejected == 0)
+		{
+			continue;
+		}
+		UE_LOG(LogMPSessionSwarm, Display, TEXT("  %-8s %.1f ops/s, failed %.2f%%, rejected %d, %s"),
+			FMPSessionOperationScheduler::LexToString(static_cast<EMPSessionOperation>(Kind)),
+			NumCompleted / FMath::Max(ElapsedSeconds, UE_SMALL_NUMBER),
+			NumCompleted > 0 ? 100.0 * Stats.NumFailed / NumCompleted : 0.0,
+			Stats.NumRejected,
+			*Stats.Latency.ToString());
+	}
+	for (int32 Result = 0; Result <= EOnJoinSessionCompleteResult::UnknownError; ++Result)
+	{
+		if (NumJoinResults[Result] > 0)
+		{
+			UE_LOG(LogMPSessionSwarm, Display, TEXT("  join %-24s %d"), LexToString(static_cast<EOnJoinSessionCompleteResult::Type>(Result)), NumJoinResults[Result]);
+		}
+	}
+	// The process figure includes the allocator's slack and everything else the process did, it isn't split per player
+	UE_LOG(LogMPSessionSwarm, Display, TEXT("  process memory %.1f MiB (%+.1f MiB during the run), %d bytes of state per logical player"),
+		UsedMemoryAfter / (1024.0 * 1024.0),
+		(static_cast<int64>(UsedMemoryAfter) - static_cast<int64>(UsedMemoryBefore)) / (1024.0 * 1024.0),
+		static_cast<int32>(sizeof(FLogicalPlayer) + sizeof(FMPSessionOperationScheduler)));
+}
@@ -5,8 +5,10 @@
 
 #include "BlueprintSessionResult.h"
 #include "MultiplayerSessionsSubsystem.h"
+#include "MPScopedDelegateBinding.h"
 #include "OnlineSessionSettings.h"
 #include "MPSessionSettings.h"
+#include "MPSessionSchema.h"
 
 DEFINE_LOG_CATEGORY(LogMPSessionTravelWidget);
 
@@ -50,7 +52,32 @@ void UMPSessionTravelWidget::CreateSession(
 		UE_LOG(LogMPSessionTravelWidget, Error, TEXT("Failed to issue CreateSession, MultiplayerSessionsSubsystem is null"));
 		return;
 	}
-	MultiplayerSessionsSubsystem->CreateSession(NumPublicConnections, SessionSettings, ExtraSessionSettings);
+	// Advertise the lobby we are about to travel to, so joining clients can start loading it early
+	TMap<FName, FString> AdvertisedSessionSettings = ExtraSessionSettings;
+	if (!AdvertisedSessionSettings.Contains(FMPMapNameKey::GetName()))
+	{
+		FString LobbyMapPackageName;
+		GetServerTravelLobbyMapPath().Split(TEXT("?"), &LobbyMapPackageName, nullptr);
+		AdvertisedSessionSettings.Add(FMPMapNameKey::GetName(), LobbyMapPackageName);
+	}
+	MultiplayerSessionsSubsystem->CreateSession(NumPublicConnections, SessionSettings, AdvertisedSessionSettings);
+}
+
+void UMPSessionTravelWidget::HostSession(
+	const TSoftObjectPtr<UWorld> LobbyServerTravelMap,
+	const FMPSessionSettings& SessionSettings,
+	const TMap<FName, FString>& ExtraSessionSettings
+	)
+{
+	LobbyMapAsset = LobbyServerTravelMap;
+	if (MultiplayerSessionsSubsystem == nullptr)
+	{
+		UE_LOG(LogMPSessionTravelWidget, Error, TEXT("Failed to issue HostSession, MultiplayerSessionsSubsystem is null"));
+		return;
+	}
+	// Creates (and starts, with bStartAfterCreate), advertises and preloads the lobby, then travels to it in one call
+	bIsHosting = true;
+	MultiplayerSessionsSubsystem->HostSession(NumPublicConnections, SessionSettings, GetServerTravelLobbyMapPath(), ExtraSessionSettings);
 }
 
 void UMPSessionTravelWidget::FindSessions(const int32 MaxSearchResults) const 
@@ -73,6 +100,41 @@ void UMPSessionTravelWidget::JoinSession(const FBPSessionResult& SearchResult)
 	MultiplayerSessionsSubsystem->JoinSession(SearchResult.SearchResult);
 }
 
+void UMPSessionTravelWidget::JoinSessionById(const FString& SessionId)
+{
+	if (MultiplayerSessionsSubsystem == nullptr)
+	{
+		UE_LOG(LogMPSessionTravelWidget, Error, TEXT("Failed to issue JoinSessionById, MultiplayerSessionsSubsystem is null"));
+		return;
+	}
+	MultiplayerSessionsSubsystem->JoinSessionById(SessionId);
+}
+
+void UMPSessionTravelWidget::StartAutoRefresh(const int32 MaxSearchResults, const float MinIntervalSeconds, const float MaxIntervalSeconds)
+{
+	if (MultiplayerSessionsSubsystem == nullptr)
+	{
+		UE_LOG(LogMPSessionTravelWidget, Error, TEXT("Failed to start auto refresh, MultiplayerSessionsSubsystem is null"));
+		return;
+	}
+	// Restarting keeps this widget's single subscription
+	if (bIsAutoRefreshing)
+	{
+		MultiplayerSessionsSubsystem->StopSessionBrowserRefresh();
+	}
+	MultiplayerSessionsSubsystem->StartSessionBrowserRefresh(MaxSearchResults, FOnlineSearchSettings(), MinIntervalSeconds, MaxIntervalSeconds);
+	bIsAutoRefreshing = true;
+}
+
+void UMPSessionTravelWidget::StopAutoRefresh()
+{
+	if (MultiplayerSessionsSubsystem && bIsAutoRefreshing)
+	{
+		MultiplayerSessionsSubsystem->StopSessionBrowserRefresh();
+	}
+	bIsAutoRefreshing = false;
+}
+
 bool UMPSessionTravelWidget::TryFocusWidgetAndShowMouse()
 {
 	bool bHasSuccessfullyFocusedWidgetAndShownMouse = false;
@@ -132,10 +194,13 @@ bool UMPSessionTravelWidget::TryBindCallbacksToMultiplayerSessionsSubsystem()
 	{
 		return false;
 	}
-	
-	MultiplayerSessionsSubsystem->MultiplayerOnCreateSessionComplete.AddUObject(this, &ThisClass::OnCreateSessionComplete);
-	MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsComplete.AddUObject(this, &ThisClass::OnFindSessionsComplete);
-	MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionComplete.AddUObject(this, &ThisClass::OnJoinSessionComplete);
+	// Bindings from a previous setup are removed first, so they never pile up
+	SubsystemBindings.Reset();
+	SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnCreateSessionComplete, this, &ThisClass::OnCreateSessionComplete));
+	SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsComplete, this, &ThisClass::OnFindSessionsComplete));
+	SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionComplete, this, &ThisClass::OnJoinSessionComplete));
+	SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnSessionBrowserUpdated, this, &ThisClass::OnSessionBrowserUpdated));
+	SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnHostReady, this, &ThisClass::OnHostReady));
 	// MultiplayerSessionsSubsystem->MultiplayerOnStartSessionComplete.AddUObject(this, &ThisClass::OnStartSessionComplete);
 	// MultiplayerSessionsSubsystem->MultiplayerOnDestroySessionComplete.AddUObject(this, &ThisClass::OnDestroySessionComplete);
 	return true;
@@ -155,6 +220,11 @@ void UMPSessionTravelWidget::StartMultiplayerSession() const
 
 void UMPSessionTravelWidget::OnCreateSessionComplete(FName SessionName, FString SessionId, bool bWasSuccessful)
 {
+	// HostSession travels by itself and reports through OnHostReady
+	if (bIsHosting)
+	{
+		return;
+	}
 	if (!bWasSuccessful)
 	{
 		UE_LOG(LogMPSessionTravelWidget, Error, TEXT("Menu: Failed to create session"));
@@ -190,16 +260,8 @@ FString UMPSessionTravelWidget::GetServerTravelLobbyMapPath() const
 	FString ServerTravelLobbyMapPath;
 	if (!LobbyMapAsset.IsNull())
 	{
-		// CanonicalAssetPath is something like "/Game/ThirdPerson/Maps/LobbyMap.LobbyMap"
-		const FString CanonicalAssetPath = LobbyMapAsset.ToString();
-		// Remove the ".*" part and add "?listen" to the end
-		if (
-			const int32 DotPosition = CanonicalAssetPath.Find(".");
-			DotPosition != INDEX_NONE
-		)
-		{
-			ServerTravelLobbyMapPath = CanonicalAssetPath.Left(DotPosition) + "?listen";
-		}
+		// The same package name the subsystem advertises and joining clients preload, e.g. "/Game/ThirdPerson/Maps/LobbyMap"
+		ServerTravelLobbyMapPath = UMultiplayerSessionsSubsystem::GetMapPackageName(LobbyMapAsset) + TEXT("?listen");
 	}
 	else
 	{
@@ -211,43 +273,93 @@ FString UMPSessionTravelWidget::GetServerTravelLobbyMapPath() const
 
 void UMPSessionTravelWidget::OnFindSessionsComplete(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful)
 {
-	TArray<FBPSessionResult> BlueprintSearchResults {};
 	if (!bWasSuccessful)
 	{
 		UE_LOG(LogMPSessionTravelWidget, Error, TEXT("FindSessions Was unsuccesful"));
-		OnSessionsFound(BlueprintSearchResults, bWasSuccessful);
-		return;
 	}
-	
-	UE_LOG(LogMPSessionTravelWidget, Warning, TEXT("%d Sessions Found"), SearchResults.Num());
-	for (const FOnlineSessionSearchResult& SearchResult : SearchResults)
-	{
-		UE_LOG(LogMPSessionTravelWidget, Log, TEXT("Session Found:"));
-		FString Id = SearchResult.GetSessionIdStr();
-		UE_LOG(LogMPSessionTravelWidget, Log, TEXT("SessionId %s:"), *Id);
-		FString Name = SearchResult.Session.OwningUserName;
-		UE_LOG(LogMPSessionTravelWidget, Log, TEXT("OwningUserName %s:"), *Id);
-		TMap<FName, FString> SessionSettings;
-		UE_LOG(LogMPSessionTravelWidget, Log, TEXT("Session Settings:"));
-		for (auto& Setting : SearchResult.Session.SessionSettings.Settings)
+	else
+	{
+		UE_LOG(LogMPSessionTravelWidget, Warning, TEXT("%d Sessions Found"), SearchResults.Num());
+	}
+
+	// Shared with the subsystem, which never modifies results once found
+	ConvertedSearchResults.Reset(SearchResults.Num());
+	FindSessionsConversion.Start(
+		bWasSuccessful ? MultiplayerSessionsSubsystem->ShareSearchResults(SearchResults) : MakeShared<const TArray<FOnlineSessionSearchResult>, ESPMode::ThreadSafe>(),
+		ResultConversionBudgetMicroseconds,
+		[](const FOnlineSessionSearchResult& SearchResult, FBPSessionResult& BPSearchResult)
 		{
-			const FName SettingName = Setting.Key;
-			FString SettingValue;
-			Setting.Value.Data.GetValue(SettingValue);
-			SessionSettings.Add(SettingName, SettingValue);
-			UE_LOG(LogMPSessionTravelWidget, Log, TEXT("SettingName %s SettingValue %s"), *SettingName.ToString(), *SettingValue);
+			BPSearchResult.SetFromOnlineResult(SearchResult);
+			UE_LOG(LogMPSessionTravelWidget, Verbose, TEXT("Session Found: SessionId %s OwningUserName %s"), *BPSearchResult.Id, *BPSearchResult.OwningUserName);
+			for (const TPair<FName, FString>& Setting : BPSearchResult.SessionSettings)
+			{
+				UE_LOG(LogMPSessionTravelWidget, Verbose, TEXT("SettingName %s SettingValue %s"), *Setting.Key.ToString(), *Setting.Value);
+			}
+		},
+		[this, bWasSuccessful](TArray<FBPSessionResult>&& BatchResults, const bool bIsFinalBatch)
+		{
+			OnFindSessionsBatchConverted(MoveTemp(BatchResults), bIsFinalBatch, bWasSuccessful);
 		}
-		
-		FBPSessionResult BPSearchResult;
-		BPSearchResult.Id = Id;
-		BPSearchResult.OwningUserName = Name;
-		BPSearchResult.SessionSettings = SessionSettings;
-		BPSearchResult.SearchResult = SearchResult;
-		BlueprintSearchResults.Add(BPSearchResult);
+	);
+}
+
+void UMPSessionTravelWidget::OnFindSessionsBatchConverted(TArray<FBPSessionResult>&& BatchResults, bool bIsFinalBatch, bool bWasSuccessful)
+{
+	OnSessionsFoundBatch(BatchResults, bIsFinalBatch, bWasSuccessful);
+	ConvertedSearchResults.Append(MoveTemp(BatchResults));
+	if (!bIsFinalBatch)
+	{
+		return;
 	}
+
+	// Moved out first, OnSessionsFound may start the next search
+	const TArray<FBPSessionResult> BlueprintSearchResults = MoveTemp(ConvertedSearchResults);
+	ConvertedSearchResults.Reset();
 	OnSessionsFound(BlueprintSearchResults, bWasSuccessful);
 }
 
+void UMPSessionTravelWidget::OnHostReady(FName SessionName, const FString& SessionId, const FMPHostTimings& Timings, bool bWasSuccessful)
+{
+	if (!bIsHosting)
+	{
+		return;
+	}
+	bIsHosting = false;
+	if (!bWasSuccessful)
+	{
+		UE_LOG(LogMPSessionTravelWidget, Error, TEXT("Menu: Failed to host session"));
+	}
+	else
+	{
+		UE_LOG(LogMPSessionTravelWidget, Log, TEXT("Menu: Session hosted in %.3fs, travelling to LobbyMap"), Timings.TotalSeconds);
+	}
+	OnSessionCreated(SessionName, SessionId, bWasSuccessful);
+}
+
+void UMPSessionTravelWidget::OnSessionBrowserUpdated(const FMPSessionBrowserDiff& Diff, bool bWasSuccessful)
+{
+	if (!bWasSuccessful)
+	{
+		UE_LOG(LogMPSessionTravelWidget, Warning, TEXT("Session browser refresh failed, keeping the current list"));
+		return;
+	}
+
+	// Only the entries that changed are converted, the work per refresh follows the size of the diff
+	TArray<FBPSessionResult> AddedSessions;
+	AddedSessions.SetNum(Diff.Added.Num());
+	for (int32 Index = 0; Index < Diff.Added.Num(); ++Index)
+	{
+		AddedSessions[Index].SetFromOnlineResult(Diff.Added[Index]);
+	}
+	TArray<FBPSessionResult> ChangedSessions;
+	ChangedSessions.SetNum(Diff.Changed.Num());
+	for (int32 Index = 0; Index < Diff.Changed.Num(); ++Index)
+	{
+		ChangedSessions[Index].SetFromOnlineResult(Diff.Changed[Index].SearchResult);
+	}
+	OnSessionsChanged(AddedSessions, Diff.RemovedSessionIds, ChangedSessions, Diff.GetChangedFields());
+}
+
 void UMPSessionTravelWidget::OnJoinSessionComplete(const FName& SessionName, EOnJoinSessionCompleteResult::Type Result)
 {
 	if (MultiplayerSessionsSubsystem == nullptr)
@@ -309,16 +421,8 @@ FString UMPSessionTravelWidget::GetServerTravelSessionMapPath() const
 	FString ServerTravelSessionMapPath;
 	if (!LobbyMapAsset.IsNull())
 	{
-		// CanonicalAssetPath is something like "/Game/ThirdPerson/Maps/LobbyMap.LobbyMap"
-		const FString CanonicalAssetPath = LobbyMapAsset.ToString();
-		// Remove the ".*" part and add "?listen" to the end
-		if (
-			const int32 DotPosition = CanonicalAssetPath.Find(".");
-			DotPosition != INDEX_NONE
-		)
-		{
-			ServerTravelSessionMapPath = CanonicalAssetPath.Left(DotPosition) + "?listen";
-		}
+		// The same package name the subsystem advertises and joining clients preload, e.g. "/Game/ThirdPerson/Maps/LobbyMap"
+		ServerTravelSessionMapPath = UMultiplayerSessionsSubsystem::GetMapPackageName(LobbyMapAsset) + TEXT("?listen");
 	}
 	else
 	{
@@ -330,6 +434,9 @@ FString UMPSessionTravelWidget::GetServerTravelSessionMapPath() const
 
 void UMPSessionTravelWidget::NativeDestruct()
 {
+	StopAutoRefresh();
+	SubsystemBindings.Reset();
+	FindSessionsConversion.Cancel();
 	MenuTeardown();
 	
 	Super::NativeDestruct();
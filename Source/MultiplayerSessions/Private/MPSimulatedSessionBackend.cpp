@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSimulatedSessionBackend.h"
+
+#include "MPSessionSchema.h"
+#include "MPStandInSessionInfo.h"
+
+DEFINE_LOG_CATEGORY(LogMPSimulatedSessionBackend);
+
+FMPSimulatedSessionBackend::FMPSimulatedSessionBackend(const FMPSimulatedBackendSettings& InSettings):
+	Settings(InSettings),
+	RandomStream(InSettings.Seed)
+{
+}
+
+FMPSimulatedSessionBackend::~FMPSimulatedSessionBackend()
+{
+	if (PendingCompletions.Num() > 0)
+	{
+		UE_LOG(LogMPSimulatedSessionBackend, Verbose, TEXT("Dropping %d pending completions"), PendingCompletions.Num());
+	}
+}
+
+void FMPSimulatedSessionBackend::CreateSession(
+	const FString& OwnerName,
+	const FOnlineSessionSettings& SessionSettings,
+	TUniqueFunction<void(bool bWasSuccessful, const FString& SessionId)>&& OnComplete
+)
+{
+	Respond([this, OwnerName, SessionSettings, OnComplete = MoveTemp(OnComplete)]()
+	{
+		if (ShouldFail())
+		{
+			OnComplete(false, FString());
+			return;
+		}
+		const FString SessionId = FString::Printf(TEXT("Simulated-%d"), NextSessionNumber++);
+		FSimulatedSession& Session = Sessions.Add(SessionId);
+		Session.OwnerName = OwnerName;
+		Session.SessionSettings = SessionSettings;
+		FMPSessionSchema::Set<FMPSessionIdKey>(Session.SessionSettings, SessionId);
+		OnComplete(true, SessionId);
+	});
+}
+
+void FMPSimulatedSessionBackend::UpdateSession(
+	const FString& SessionId,
+	const FOnlineSessionSettings& SessionSettings,
+	TUniqueFunction<void(bool bWasSuccessful)>&& OnComplete
+)
+{
+	Respond([this, SessionId, SessionSettings, OnComplete = MoveTemp(OnComplete)]()
+	{
+		FSimulatedSession* Session = Sessions.Find(SessionId);
+		if (Session == nullptr || ShouldFail())
+		{
+			OnComplete(false);
+			return;
+		}
+		Session->SessionSettings = SessionSettings;
+		FMPSessionSchema::Set<FMPSessionIdKey>(Session->SessionSettings, SessionId);
+		OnComplete(true);
+	});
+}
+
+void FMPSimulatedSessionBackend::StartSession(const FString& SessionId, TUniqueFunction<void(bool bWasSuccessful)>&& OnComplete)
+{
+	Respond([this, SessionId, OnComplete = MoveTemp(OnComplete)]()
+	{
+		FSimulatedSession* Session = Sessions.Find(SessionId);
+		if (Session == nullptr || ShouldFail())
+		{
+			OnComplete(false);
+			return;
+		}
+		Session->bIsStarted = true;
+		OnComplete(true);
+	});
+}
+
+void FMPSimulatedSessionBackend::DestroySession(const FString& SessionId, TUniqueFunction<void(bool bWasSuccessful)>&& OnComplete)
+{
+	Respond([this, SessionId, OnComplete = MoveTemp(OnComplete)]()
+	{
+		if (ShouldFail())
+		{
+			OnComplete(false);
+			return;
+		}
+		OnComplete(Sessions.Remove(SessionId) > 0);
+	});
+}
+
+void FMPSimulatedSessionBackend::FindSessions(
+	const int32 MaxSearchResults,
+	TUniqueFunction<void(bool bWasSuccessful, const TArray<FOnlineSessionSearchResult>& SearchResults)>&& OnComplete
+)
+{
+	Respond([this, MaxSearchResults, OnComplete = MoveTemp(OnComplete)]()
+	{
+		TArray<FOnlineSessionSearchResult> SearchResults;
+		if (ShouldFail())
+		{
+			OnComplete(false, SearchResults);
+			return;
+		}
+		// A real backend does not return sessions in a useful order, neither does this one
+		TArray<const TPair<FString, FSimulatedSession>*> Candidates;
+		Candidates.Reserve(Sessions.Num());
+		for (const TPair<FString, FSimulatedSession>& Session : Sessions)
+		{
+			if (Session.Value.SessionSettings.bShouldAdvertise && Session.Value.NumPlayers < Session.Value.SessionSettings.NumPublicConnections)
+			{
+				Candidates.Add(&Session);
+			}
+		}
+		const int32 NumResults = FMath::Min(FMath::Max(MaxSearchResults, 0), Candidates.Num());
+		SearchResults.Reserve(NumResults);
+		for (int32 Index = 0; Index < NumResults; ++Index)
+		{
+			Candidates.Swap(Index, RandomStream.RandRange(Index, Candidates.Num() - 1));
+			SearchResults.Add(MakeSearchResult(Candidates[Index]->Key, Candidates[Index]->Value));
+		}
+		OnComplete(true, SearchResults);
+	});
+}
+
+void FMPSimulatedSessionBackend::JoinSession(const FString& SessionId, TUniqueFunction<void(EOnJoinSessionCompleteResult::Type Result)>&& OnComplete)
+{
+	Respond([this, SessionId, OnComplete = MoveTemp(OnComplete)]()
+	{
+		FSimulatedSession* Session = Sessions.Find(SessionId);
+		if (Session == nullptr)
+		{
+			OnComplete(EOnJoinSessionCompleteResult::SessionDoesNotExist);
+		}
+		else if (Session->NumPlayers >= Session->SessionSettings.NumPublicConnections)
+		{
+			OnComplete(EOnJoinSessionCompleteResult::SessionIsFull);
+		}
+		else if (ShouldFail())
+		{
+			OnComplete(EOnJoinSessionCompleteResult::UnknownError);
+		}
+		else
+		{
+			++Session->NumPlayers;
+			OnComplete(EOnJoinSessionCompleteResult::Success);
+		}
+	});
+}
+
+void FMPSimulatedSessionBackend::LeaveSession(const FString& SessionId)
+{
+	if (FSimulatedSession* Session = Sessions.Find(SessionId))
+	{
+		Session->NumPlayers = FMath::Max(Session->NumPlayers - 1, 0);
+	}
+}
+
+void FMPSimulatedSessionBackend::Tick(const double Now)
+{
+	// Completions issuing new operations queue them behind Now, at least one round trip away
+	while (PendingCompletions.Num() > 0 && PendingCompletions.HeapTop().DueTime <= Now)
+	{
+		FPendingCompletion Completion;
+		PendingCompletions.HeapPop(Completion, &FMPSimulatedSessionBackend::IsDueFirst);
+		Completion.Complete();
+	}
+}
+
+void FMPSimulatedSessionBackend::Respond(TUniqueFunction<void()>&& Complete)
+{
+	const float LatencyMs = FMath::Max(Settings.LatencyMs + RandomStream.FRandRange(-Settings.LatencyJitterMs, Settings.LatencyJitterMs), 0.f);
+	FPendingCompletion Completion;
+	Completion.DueTime = FPlatformTime::Seconds() + LatencyMs / 1000.0;
+	Completion.Sequence = NextSequence++;
+	Completion.Complete = MoveTemp(Complete);
+	PendingCompletions.HeapPush(MoveTemp(Completion), &FMPSimulatedSessionBackend::IsDueFirst);
+}
+
+bool FMPSimulatedSessionBackend::IsDueFirst(const FPendingCompletion& A, const FPendingCompletion& B)
+{
+	return A.DueTime < B.DueTime || (A.DueTime == B.DueTime && A.Sequence < B.Sequence);
+}
+
+bool FMPSimulatedSessionBackend::ShouldFail()
+{
+	return Settings.FailureRate > 0.f && RandomStream.FRand() < Settings.FailureRate;
+}
+
+FOnlineSessionSearchResult FMPSimulatedSessionBackend::MakeSearchResult(const FString& SessionId, const FSimulatedSession& Session) const
+{
+	FOnlineSessionSearchResult SearchResult;
+	SearchResult.Session.OwningUserName = Session.OwnerName;
+	SearchResult.Session.SessionSettings = Session.SessionSettings;
+	SearchResult.Session.NumOpenPublicConnections = Session.SessionSettings.NumPublicConnections - Session.NumPlayers;
+	SearchResult.Session.SessionInfo = MakeShared<FMPStandInSessionInfo>(SessionId, FName(TEXT("MPSimulated")));
+	SearchResult.PingInMs = FMath::RoundToInt32(Settings.LatencyMs);
+	return SearchResult;
+}
@@ -3,6 +3,7 @@
 #include "Menu.h"
 
 #include "MultiplayerSessionsSubsystem.h"
+#include "MPScopedDelegateBinding.h"
 #include "OnlineSessionSettings.h"
 #include "Engine/Engine.h"
 #include "Engine/GameInstance.h"
@@ -10,6 +11,7 @@
 #include "Components/Button.h"
 #include "GameFramework/PlayerController.h"
 #include "MPSessionSettings.h"
+#include "MPSessionSchema.h"
 
 DEFINE_LOG_CATEGORY(LogMultiplayerSessionsMenu);
 
@@ -108,12 +110,15 @@ bool UMenu::TryBindCallbacksToMultiplayerSessionsSubsystem()
 	{
 		return false;
 	}
-	
-	MultiplayerSessionsSubsystem->MultiplayerOnCreateSessionComplete.AddUObject(this, &ThisClass::OnCreateSessionComplete);
-	MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsComplete.AddUObject(this, &ThisClass::OnFindSessionsComplete);
-	MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionComplete.AddUObject(this, &ThisClass::OnJoinSessionComplete);
+	// Bindings from a previous setup are removed first, so they never pile up
+	SubsystemBindings.Reset();
+	SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnCreateSessionComplete, this, &ThisClass::OnCreateSessionComplete));
+	SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsComplete, this, &ThisClass::OnFindSessionsComplete));
+	SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionComplete, this, &ThisClass::OnJoinSessionComplete));
 	// MultiplayerSessionsSubsystem->MultiplayerOnStartSessionComplete.AddUObject(this, &ThisClass::OnStartSessionComplete);
-	MultiplayerSessionsSubsystem->MultiplayerOnDestroySessionComplete.AddUObject(this, &ThisClass::OnDestroySessionComplete);
+	SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnDestroySessionComplete, this, &ThisClass::OnDestroySessionComplete));
+	SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnHostReady, this, &ThisClass::OnHostReady));
+	SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(MultiplayerSessionsSubsystem, MultiplayerSessionsSubsystem->MultiplayerOnJoinBestOfComplete, this, &ThisClass::OnJoinBestOfComplete));
 	return true;
 }
 
@@ -140,7 +145,9 @@ void UMenu::HostButtonClicked()
 	
 	if (MultiplayerSessionsSubsystem)
 	{
-		MultiplayerSessionsSubsystem->CreateSession(NumPublicConnections, FMPSessionSettings (), TMap<FName, FString> ());
+		// Creates, advertises and preloads the lobby, then travels to it; completion arrives through OnHostReady
+		bIsHosting = true;
+		MultiplayerSessionsSubsystem->HostSession(NumPublicConnections, FMPSessionSettings (), GetServerTravelLobbyMapPath());
 	}
 }
 
@@ -174,6 +181,11 @@ void UMenu::DisableJoinAndHostButtons()
 
 void UMenu::OnCreateSessionComplete(FName SessionName, FString SessionId, bool bWasSuccessful)
 {
+	// HostSession travels by itself and reports through OnHostReady
+	if (bIsHosting)
+	{
+		return;
+	}
 	if (!bWasSuccessful)
 	{
 		UE_LOG(LogMultiplayerSessionsMenu, Error, TEXT("Menu: Failed to create session"));
@@ -208,16 +220,8 @@ FString UMenu::GetServerTravelLobbyMapPath() const
 	FString ServerTravelLobbyMapPath;
 	if (!LobbyMapAsset.IsNull())
 	{
-		// CanonicalAssetPath is something like "/Game/ThirdPerson/Maps/LobbyMap.LobbyMap"
-		const FString CanonicalAssetPath = LobbyMapAsset.ToString();
-		// Remove the ".*" part and add "?listen" to the end
-		if (
-			const int32 DotPosition = CanonicalAssetPath.Find(".");
-			DotPosition != INDEX_NONE
-		)
-		{
-			ServerTravelLobbyMapPath = CanonicalAssetPath.Left(DotPosition) + "?listen";
-		}
+		// The same package name the subsystem advertises and joining clients preload, e.g. "/Game/ThirdPerson/Maps/LobbyMap"
+		ServerTravelLobbyMapPath = UMultiplayerSessionsSubsystem::GetMapPackageName(LobbyMapAsset) + TEXT("?listen");
 	}
 	else
 	{
@@ -243,24 +247,35 @@ void UMenu::OnFindSessionsComplete(const TArray<FOnlineSessionSearchResult>& Sea
 	bool SuccessfullyFoundSessionToJoin = false;
 	if (bWasSuccessful)
 	{
+		TArray<FOnlineSessionSearchResult> Candidates;
 		for (const FOnlineSessionSearchResult& SearchResult : SearchResults)
 		{
 			FString Id = SearchResult.GetSessionIdStr();
 			FString Name = SearchResult.Session.OwningUserName;
 			FString RetrievedMatchType {""};
-			SearchResult.Session.SessionSettings.Get(FName("MatchType"), RetrievedMatchType);
+			FMPSessionSchema::Get<FMPMatchTypeKey>(SearchResult.Session.SessionSettings, RetrievedMatchType);
 			FString SecretKeyValue {""};
-			SearchResult.Session.SessionSettings.Get(FName("SecretKey"), SecretKeyValue);
+			FMPSessionSchema::Get<FMPSecretKeyKey>(SearchResult.Session.SessionSettings, SecretKeyValue);
 			UE_LOG(LogMultiplayerSessionsMenu, Log, TEXT("Menu: Session found | Id: %s | Name: %s | MatchType %s | SecretKeyValue: %s |"), *Id, *Name, *MatchType, *SecretKeyValue);
 			if (SecretKeyValue == FString("PREMIERE"))
 			{
-				UE_LOG(LogTemp, Log, TEXT("Joining session: %s"), *Id);
-				if (GEngine)
+				Candidates.Add(SearchResult);
+			}
+		}
+		if (Candidates.Num() > 0)
+		{
+			// Closest hosts first, the next one is joined only if the previous one is full or gone
+			Candidates.StableSort([](const FOnlineSessionSearchResult& A, const FOnlineSessionSearchResult& B) { return A.PingInMs < B.PingInMs; });
+			UE_LOG(LogMultiplayerSessionsMenu, Log, TEXT("Menu: Joining the best of %d sessions"), Candidates.Num());
+			SuccessfullyFoundSessionToJoin = MultiplayerSessionsSubsystem->JoinBestOf(Candidates);
+			if (SuccessfullyFoundSessionToJoin)
+			{
+				// The session actually joined is only known once JoinBestOf completes
+				JoinCandidateSessionIds.Reset(Candidates.Num());
+				for (const FOnlineSessionSearchResult& Candidate : Candidates)
 				{
-					GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, FString::Printf(TEXT("Joining session: %s"), *Id));
+					JoinCandidateSessionIds.Add(Candidate.GetSessionIdStr());
 				}
-				MultiplayerSessionsSubsystem->JoinSession(SearchResult);
-				SuccessfullyFoundSessionToJoin = true;
 			}
 		}
 	}
@@ -273,6 +288,20 @@ void UMenu::OnFindSessionsComplete(const TArray<FOnlineSessionSearchResult>& Sea
 	HostButton->SetIsEnabled(!SuccessfullyFoundSessionToJoin);
 }
 
+void UMenu::OnJoinBestOfComplete(const FMPJoinBestOfResult& Result)
+{
+	if (!Result.WasSuccessful() || !JoinCandidateSessionIds.IsValidIndex(Result.JoinedCandidateIndex))
+	{
+		UE_LOG(LogMultiplayerSessionsMenu, Error, TEXT("Menu: Failed to join any of %d sessions after %d attempts"), JoinCandidateSessionIds.Num(), Result.NumAttempts);
+	}
+	else
+	{
+		UE_LOG(LogMultiplayerSessionsMenu, Log, TEXT("Menu: Joined session %s (candidate %d of %d, %d attempts)"),
+			*JoinCandidateSessionIds[Result.JoinedCandidateIndex], Result.JoinedCandidateIndex + 1, JoinCandidateSessionIds.Num(), Result.NumAttempts);
+	}
+	JoinCandidateSessionIds.Reset();
+}
+
 void UMenu::OnJoinSessionComplete(const FName& SessionName, EOnJoinSessionCompleteResult::Type Result)
 {
 	if (MultiplayerSessionsSubsystem == nullptr)
@@ -360,16 +389,8 @@ FString UMenu::GetServerTravelSessionMapPath() const
 	FString ServerTravelSessionMapPath;
 	if (!LobbyMapAsset.IsNull())
 	{
-		// CanonicalAssetPath is something like "/Game/ThirdPerson/Maps/LobbyMap.LobbyMap"
-		const FString CanonicalAssetPath = LobbyMapAsset.ToString();
-		// Remove the ".*" part and add "?listen" to the end
-		if (
-			const int32 DotPosition = CanonicalAssetPath.Find(".");
-			DotPosition != INDEX_NONE
-		)
-		{
-			ServerTravelSessionMapPath = CanonicalAssetPath.Left(DotPosition) + "?listen";
-		}
+		// The same package name the subsystem advertises and joining clients preload, e.g. "/Game/ThirdPerson/Maps/LobbyMap"
+		ServerTravelSessionMapPath = UMultiplayerSessionsSubsystem::GetMapPackageName(LobbyMapAsset) + TEXT("?listen");
 	}
 	else
 	{
@@ -383,8 +404,22 @@ void UMenu::OnDestroySessionComplete(bool bWasSuccessful)
 {
 }
 
+void UMenu::OnHostReady(FName SessionName, const FString& SessionId, const FMPHostTimings& Timings, bool bWasSuccessful)
+{
+	bIsHosting = false;
+	if (!bWasSuccessful)
+	{
+		UE_LOG(LogMultiplayerSessionsMenu, Error, TEXT("Menu: Failed to host session"));
+		HostButton->SetIsEnabled(true);
+		JoinButton->SetIsEnabled(true);
+		return;
+	}
+	UE_LOG(LogMultiplayerSessionsMenu, Log, TEXT("Menu: Session %s hosted in %.3fs, travelling to LobbyMap"), *SessionId, Timings.TotalSeconds);
+}
+
 void UMenu::NativeDestruct()
 {
+	SubsystemBindings.Reset();
 	MenuTeardown();
 	
 	Super::NativeDestruct();
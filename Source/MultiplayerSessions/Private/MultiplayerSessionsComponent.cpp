@@ -4,6 +4,7 @@
 #include "OnlineSessionSettings.h"
 #include "JoinSessionResult.h"
 #include "Algo/Transform.h"
+#include "MPListenerProfiler.h"
 
 UMultiplayerSessionsComponent::UMultiplayerSessionsComponent()
 {
@@ -14,16 +15,120 @@ void UMultiplayerSessionsComponent::InitializeComponent()
 {
     Super::InitializeComponent();
 
+    SubsystemBindings.Reset();
     if (UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem())
     {
-        Subsystem->MultiplayerOnCreateSessionComplete.AddUObject(this, &UMultiplayerSessionsComponent::HandleCreateSessionComplete);
-        Subsystem->MultiplayerOnFindSessionsComplete.AddUObject(this, &UMultiplayerSessionsComponent::HandleFindSessionsComplete);
-        Subsystem->MultiplayerOnJoinSessionComplete.AddUObject(this, &UMultiplayerSessionsComponent::HandleJoinSessionComplete);
-        Subsystem->MultiplayerOnStartSessionComplete.AddUObject(this, &UMultiplayerSessionsComponent::HandleStartSessionComplete);
-        Subsystem->MultiplayerOnDestroySessionComplete.AddUObject(this, &UMultiplayerSessionsComponent::HandleDestroySessionComplete);
+        SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(Subsystem, Subsystem->MultiplayerOnCreateSessionComplete, this, &UMultiplayerSessionsComponent::HandleCreateSessionComplete));
+        SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(Subsystem, Subsystem->MultiplayerOnFindSessionsComplete, this, &UMultiplayerSessionsComponent::HandleFindSessionsComplete));
+        SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(Subsystem, Subsystem->MultiplayerOnJoinSessionComplete, this, &UMultiplayerSessionsComponent::HandleJoinSessionComplete));
+        SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(Subsystem, Subsystem->MultiplayerOnStartSessionComplete, this, &UMultiplayerSessionsComponent::HandleStartSessionComplete));
+        SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(Subsystem, Subsystem->MultiplayerOnDestroySessionComplete, this, &UMultiplayerSessionsComponent::HandleDestroySessionComplete));
+        SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(Subsystem, Subsystem->MultiplayerOnUpdateSessionComplete, this, &UMultiplayerSessionsComponent::HandleUpdateSessionComplete));
+        SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(Subsystem, Subsystem->MultiplayerOnFindSessionsPageComplete, this, &UMultiplayerSessionsComponent::HandleFindSessionsPageComplete));
+        SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(Subsystem, Subsystem->MultiplayerOnSessionBrowserUpdated, this, &UMultiplayerSessionsComponent::HandleSessionBrowserUpdated));
+        SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(Subsystem, Subsystem->MultiplayerOnReconnectComplete, this, &UMultiplayerSessionsComponent::HandleReconnectComplete));
+        SubsystemBindings.Add(FMPScopedDelegateBinding::AddUObject(Subsystem, Subsystem->MultiplayerOnHostReady, this, &UMultiplayerSessionsComponent::HandleHostReady));
     }
 }
 
+void UMultiplayerSessionsComponent::UninitializeComponent()
+{
+    StopSessionBrowserRefresh();
+    SubsystemBindings.Reset();
+    FindSessionsConversion.Cancel();
+
+    Super::UninitializeComponent();
+}
+
+void UMultiplayerSessionsComponent::HostSession(
+    const int32 NumPublicConnections,
+    const FMPSessionSettings& SessionSettings,
+    const FString& TravelURL,
+    const TMap<FName, FString>& ExtraSessionSettings
+)
+{
+    if (UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem())
+    {
+        Subsystem->HostSession(NumPublicConnections, SessionSettings, TravelURL, ExtraSessionSettings);
+    }
+}
+
+void UMultiplayerSessionsComponent::FindSessionsPage(const int32 PageSize)
+{
+    if (UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem())
+    {
+        NextSessionsPageCursor = FMPSessionSearchCursor();
+        Subsystem->FindSessionsPaged(PageSize);
+    }
+}
+
+bool UMultiplayerSessionsComponent::LoadMoreSessions()
+{
+    UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem();
+    return Subsystem && NextSessionsPageCursor.IsValid() && Subsystem->FindSessionsNextPage(NextSessionsPageCursor);
+}
+
+void UMultiplayerSessionsComponent::StartSessionBrowserRefresh(const int32 MaxSearchResults, const float MinIntervalSeconds, const float MaxIntervalSeconds)
+{
+    UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem();
+    if (!Subsystem)
+    {
+        return;
+    }
+    // Restarting keeps this component's single subscription
+    if (bIsRefreshingSessionBrowser)
+    {
+        Subsystem->StopSessionBrowserRefresh();
+    }
+    Subsystem->StartSessionBrowserRefresh(MaxSearchResults, FOnlineSearchSettings(), MinIntervalSeconds, MaxIntervalSeconds);
+    bIsRefreshingSessionBrowser = true;
+}
+
+void UMultiplayerSessionsComponent::StopSessionBrowserRefresh()
+{
+    if (!bIsRefreshingSessionBrowser)
+    {
+        return;
+    }
+    bIsRefreshingSessionBrowser = false;
+    if (UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem())
+    {
+        Subsystem->StopSessionBrowserRefresh();
+    }
+}
+
+void UMultiplayerSessionsComponent::JoinSessionById(const FString& SessionId)
+{
+    if (UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem())
+    {
+        Subsystem->JoinSessionById(SessionId);
+    }
+}
+
+bool UMultiplayerSessionsComponent::Reconnect()
+{
+    UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem();
+    return Subsystem && Subsystem->Reconnect();
+}
+
+bool UMultiplayerSessionsComponent::CanReconnect() const
+{
+    const UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem();
+    return Subsystem && Subsystem->CanReconnect();
+}
+
+bool UMultiplayerSessionsComponent::BrowseSessions(const FMPSessionBrowseSpec& Spec)
+{
+    const UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem();
+    return Subsystem && Subsystem->BrowseLastSearchResults(Spec, FMPOnSessionsBrowsed::CreateUObject(this, &UMultiplayerSessionsComponent::HandleSessionsBrowsed));
+}
+
+EMPSessionState UMultiplayerSessionsComponent::GetSessionState() const
+{
+    const UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem();
+    return Subsystem ? Subsystem->GetSessionState() : EMPSessionState::Idle;
+}
+
 void UMultiplayerSessionsComponent::BeginPlay()
 {
     Super::BeginPlay();
@@ -40,43 +145,189 @@ UMultiplayerSessionsSubsystem* UMultiplayerSessionsComponent::GetMultiplayerSess
 
 void UMultiplayerSessionsComponent::HandleCreateSessionComplete(FName SessionName, FString SessionId, bool bWasSuccessful)
 {
-    OnCreateSessionComplete.Broadcast(bWasSuccessful);
-    OnCreateSession(bWasSuccessful);
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnCreateSessionComplete"), OnCreateSessionComplete, bWasSuccessful);
+    {
+        FMPListenerProfiler::FScope Scope(TEXT("OnCreateSession"), this, GET_FUNCTION_NAME_CHECKED(UMultiplayerSessionsComponent, OnCreateSession));
+        OnCreateSession(bWasSuccessful);
+    }
 }
 
 void UMultiplayerSessionsComponent::HandleFindSessionsComplete(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful)
 {
-    TArray<FMultiplayerSessionsSearchResult> BPSearchResults;
-    Algo::Transform(
-        SearchResults,
-        BPSearchResults,
-        [](const FOnlineSessionSearchResult& SearchResult)
+    const UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem();
+    if (!Subsystem)
+    {
+        return;
+    }
+
+    // Shared with the subsystem, which never modifies results once found
+    ConvertedSearchResults.Reset(SearchResults.Num());
+    FindSessionsConversion.Start(
+        Subsystem->ShareSearchResults(SearchResults),
+        ResultConversionBudgetMicroseconds,
+        [](const FOnlineSessionSearchResult& SearchResult, FMultiplayerSessionsSearchResult& BPSearchResult)
         {
-            FMultiplayerSessionsSearchResult BPSearchResult;
             BPSearchResult.SetFromOnlineResult(SearchResult);
-            return BPSearchResult;
+        },
+        [this, bWasSuccessful](TArray<FMultiplayerSessionsSearchResult>&& BatchResults, const bool bIsFinalBatch)
+        {
+            HandleFindSessionsBatchConverted(MoveTemp(BatchResults), bIsFinalBatch, bWasSuccessful);
         }
     );
-        
-    OnFindSessionsComplete.Broadcast(BPSearchResults, bWasSuccessful);
-    OnFindSessions(BPSearchResults, bWasSuccessful);
+}
+
+void UMultiplayerSessionsComponent::HandleFindSessionsBatchConverted(
+    TArray<FMultiplayerSessionsSearchResult>&& BatchResults,
+    bool bIsFinalBatch,
+    bool bWasSuccessful
+)
+{
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnFindSessionsBatch"), OnFindSessionsBatch, BatchResults, bIsFinalBatch, bWasSuccessful);
+    {
+        FMPListenerProfiler::FScope Scope(TEXT("OnFindSessionsBatchReceived"), this, GET_FUNCTION_NAME_CHECKED(UMultiplayerSessionsComponent, OnFindSessionsBatchReceived));
+        OnFindSessionsBatchReceived(BatchResults, bIsFinalBatch, bWasSuccessful);
+    }
+    ConvertedSearchResults.Append(MoveTemp(BatchResults));
+    if (!bIsFinalBatch)
+    {
+        return;
+    }
+
+    // Moved out first, a listener may start the next search
+    const TArray<FMultiplayerSessionsSearchResult> BPSearchResults = MoveTemp(ConvertedSearchResults);
+    ConvertedSearchResults.Reset();
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnFindSessionsComplete"), OnFindSessionsComplete, BPSearchResults, bWasSuccessful);
+    {
+        FMPListenerProfiler::FScope Scope(TEXT("OnFindSessions"), this, GET_FUNCTION_NAME_CHECKED(UMultiplayerSessionsComponent, OnFindSessions));
+        OnFindSessions(BPSearchResults, bWasSuccessful);
+    }
+}
+
+void UMultiplayerSessionsComponent::HandleSessionsBrowsed(const FMPSessionBrowseResult& Result)
+{
+    // The indices only make sense against the results Blueprints last got, a search that completed meanwhile replaced them
+    const UMultiplayerSessionsSubsystem* Subsystem = GetMultiplayerSessionsSubsystem();
+    if (!Subsystem || Subsystem->GetLastSearchResults() != Result.Snapshot)
+    {
+        return;
+    }
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnSessionsBrowsed"), OnSessionsBrowsed, Result.Order);
 }
 
 void UMultiplayerSessionsComponent::HandleJoinSessionComplete(const FName& SessionName, const EOnJoinSessionCompleteResult::Type Result)
 {
     const EJoinSessionResult JoinSessionResult = ConvertJoinResult(Result);
-    OnJoinSessionComplete.Broadcast(SessionName, JoinSessionResult);
-    OnJoinSession(SessionName, JoinSessionResult);
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnJoinSessionComplete"), OnJoinSessionComplete, SessionName, JoinSessionResult);
+    {
+        FMPListenerProfiler::FScope Scope(TEXT("OnJoinSession"), this, GET_FUNCTION_NAME_CHECKED(UMultiplayerSessionsComponent, OnJoinSession));
+        OnJoinSession(SessionName, JoinSessionResult);
+    }
 }
 
 void UMultiplayerSessionsComponent::HandleStartSessionComplete(bool bWasSuccessful)
 {
-    OnStartSessionComplete.Broadcast(bWasSuccessful);
-    OnStartSession(bWasSuccessful);
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnStartSessionComplete"), OnStartSessionComplete, bWasSuccessful);
+    {
+        FMPListenerProfiler::FScope Scope(TEXT("OnStartSession"), this, GET_FUNCTION_NAME_CHECKED(UMultiplayerSessionsComponent, OnStartSession));
+        OnStartSession(bWasSuccessful);
+    }
 }
 
 void UMultiplayerSessionsComponent::HandleDestroySessionComplete(bool bWasSuccessful)
 {
-    OnDestroySessionComplete.Broadcast(bWasSuccessful);
-    OnDestroySession(bWasSuccessful);
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnDestroySessionComplete"), OnDestroySessionComplete, bWasSuccessful);
+    {
+        FMPListenerProfiler::FScope Scope(TEXT("OnDestroySession"), this, GET_FUNCTION_NAME_CHECKED(UMultiplayerSessionsComponent, OnDestroySession));
+        OnDestroySession(bWasSuccessful);
+    }
+}
+
+void UMultiplayerSessionsComponent::HandleUpdateSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnUpdateSessionComplete"), OnUpdateSessionComplete, bWasSuccessful);
+    {
+        FMPListenerProfiler::FScope Scope(TEXT("OnUpdateSession"), this, GET_FUNCTION_NAME_CHECKED(UMultiplayerSessionsComponent, OnUpdateSession));
+        OnUpdateSession(bWasSuccessful);
+    }
+}
+
+void UMultiplayerSessionsComponent::HandleFindSessionsPageComplete(
+    const TArray<FOnlineSessionSearchResult>& PageResults,
+    const FMPSessionSearchCursor& NextCursor,
+    bool bWasSuccessful
+)
+{
+    NextSessionsPageCursor = NextCursor;
+
+    TArray<FMultiplayerSessionsSearchResult> BPPageResults;
+    Algo::Transform(
+        PageResults,
+        BPPageResults,
+        [](const FOnlineSessionSearchResult& SearchResult)
+        {
+            FMultiplayerSessionsSearchResult BPSearchResult;
+            BPSearchResult.SetFromOnlineResult(SearchResult);
+            return BPSearchResult;
+        }
+    );
+
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnFindSessionsPageComplete"), OnFindSessionsPageComplete, BPPageResults, NextCursor.IsValid(), bWasSuccessful);
+    {
+        FMPListenerProfiler::FScope Scope(TEXT("OnFindSessionsPage"), this, GET_FUNCTION_NAME_CHECKED(UMultiplayerSessionsComponent, OnFindSessionsPage));
+        OnFindSessionsPage(BPPageResults, NextCursor.IsValid(), bWasSuccessful);
+    }
+}
+
+void UMultiplayerSessionsComponent::HandleSessionBrowserUpdated(const FMPSessionBrowserDiff& Diff, bool bWasSuccessful)
+{
+    if (!bWasSuccessful)
+    {
+        // A failed refresh leaves the list as it is
+        return;
+    }
+
+    const auto ToBPSearchResult = [](const FOnlineSessionSearchResult& SearchResult)
+    {
+        FMultiplayerSessionsSearchResult BPSearchResult;
+        BPSearchResult.SetFromOnlineResult(SearchResult);
+        return BPSearchResult;
+    };
+
+    TArray<FMultiplayerSessionsSearchResult> BPAddedSessions;
+    Algo::Transform(Diff.Added, BPAddedSessions, ToBPSearchResult);
+    TArray<FMultiplayerSessionsSearchResult> BPChangedSessions;
+    Algo::Transform(
+        Diff.Changed,
+        BPChangedSessions,
+        [&ToBPSearchResult](const FMPChangedSessionResult& ChangedResult)
+        {
+            return ToBPSearchResult(ChangedResult.SearchResult);
+        }
+    );
+
+    const TArray<FMPChangedSessionFields> ChangedFields = Diff.GetChangedFields();
+
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnSessionBrowserUpdated"), OnSessionBrowserUpdated, BPAddedSessions, Diff.RemovedSessionIds, BPChangedSessions, ChangedFields);
+    {
+        FMPListenerProfiler::FScope Scope(TEXT("OnSessionBrowserUpdate"), this, GET_FUNCTION_NAME_CHECKED(UMultiplayerSessionsComponent, OnSessionBrowserUpdate));
+        OnSessionBrowserUpdate(BPAddedSessions, Diff.RemovedSessionIds, BPChangedSessions, ChangedFields);
+    }
+}
+
+void UMultiplayerSessionsComponent::HandleReconnectComplete(bool bWasSuccessful)
+{
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnReconnectComplete"), OnReconnectComplete, bWasSuccessful);
+    {
+        FMPListenerProfiler::FScope Scope(TEXT("OnReconnect"), this, GET_FUNCTION_NAME_CHECKED(UMultiplayerSessionsComponent, OnReconnect));
+        OnReconnect(bWasSuccessful);
+    }
 }
+
+void UMultiplayerSessionsComponent::HandleHostReady(FName SessionName, const FString& SessionId, const FMPHostTimings& Timings, bool bWasSuccessful)
+{
+    FMPListenerProfiler::BroadcastDynamic(TEXT("OnHostReady"), OnHostReady, Timings, bWasSuccessful);
+    {
+        FMPListenerProfiler::FScope Scope(TEXT("OnHostSessionReady"), this, GET_FUNCTION_NAME_CHECKED(UMultiplayerSessionsComponent, OnHostSessionReady));
+        OnHostSessionReady(Timings, bWasSuccessful);
+    }
+}
\ No newline at end of file
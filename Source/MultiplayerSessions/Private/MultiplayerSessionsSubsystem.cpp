@@ -4,7 +4,12 @@
 #include "MultiplayerSessionsSubsystem.h"
 
 #include "MPSessionSettings.h"
+#include "MPSessionSchema.h"
+#include "MPReconnectSaveGame.h"
+#include "MPScopedDelegateBinding.h"
+#include "Kismet/GameplayStatics.h"
 #include "Engine/LocalPlayer.h"
+#include "GameFramework/GameModeBase.h"
 #include "GameFramework/PlayerController.h"
 #include "OnlineSessionSettings.h"
 #include "OnlineSubsystem.h"
@@ -12,9 +17,25 @@
 #include "OnlineSubsystemTypes.h"
 #include "Interfaces/OnlineIdentityInterface.h"
 #include "Online/OnlineSessionNames.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+#include "HAL/PlatformProcess.h"
+#include "UObject/UObjectGlobals.h"
 
 DEFINE_LOG_CATEGORY(LogMultiplayerSessionsSubsystem);
 
+namespace
+{
+	// Scheduler merge keys, operations of the same kind only replace each other when they are the same flavour
+	const FName FederatedSearchMergeKey(TEXT("FederatedSearch"));
+	const FName SessionIdAdvertMergeKey(TEXT("SessionIdAdvert"));
+	const FName MapAdvertMergeKey(TEXT("MapAdvert"));
+	// A caller's queued destroy would otherwise swallow the one the reconnect waits for
+	const FName ReconnectDestroyMergeKey(TEXT("ReconnectDestroy"));
+}
+
 UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem():
 	LoginCompleteDelegate(FOnLoginCompleteDelegate::CreateUObject(this, &ThisClass::OnLoginComplete)),
 	CreateSessionCompleteDelegate(FOnCreateSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnCreateSessionComplete)),
@@ -22,23 +43,449 @@ UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem():
 	JoinSessionCompleteDelegate(FOnJoinSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnJoinSessionComplete)),
 	DestroySessionCompleteDelegate(FOnDestroySessionCompleteDelegate::CreateUObject(this, &ThisClass::OnDestroySessionComplete)),
 	StartSessionCompleteDelegate(FOnStartSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnStartSessionComplete)),
+	UpdateSessionCompleteDelegate(FOnUpdateSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnUpdateSessionComplete)),
 	SessionInterface(nullptr),
 	IdentityInterface(nullptr),
 	IsLoggedIn(false)
 {
-	const IOnlineSubsystem* Subsystem = IOnlineSubsystem::Get();
+	// Allows running against another backend than the default one, e.g. -MPSessionsOSS=NULL for a local stand-in
+	FString OnlineSubsystemOverride;
+	FParse::Value(FCommandLine::Get(), TEXT("MPSessionsOSS="), OnlineSubsystemOverride);
+
+	const IOnlineSubsystem* Subsystem = IOnlineSubsystem::Get(OnlineSubsystemOverride.IsEmpty() ? NAME_None : FName(*OnlineSubsystemOverride));
 	if (Subsystem == nullptr)
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("No Online Subsystem found"));
 		return;
 	}
-	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Using Online Subsystem ( OSS ): '%s'"), *Subsystem->GetSubsystemName().ToString());
+	OnlineSubsystemName = Subsystem->GetSubsystemName();
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Using Online Subsystem ( OSS ): '%s'"), *OnlineSubsystemName.ToString());
 
 	SessionInterface = Subsystem->GetSessionInterface();
 	IdentityInterface = Subsystem->GetIdentityInterface();
 }
 
-bool UMultiplayerSessionsSubsystem::TryAsyncLogin(const FPendingLoginAction& PendingLoginAction)
+void UMultiplayerSessionsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	PostLoadMapBinding = FMPScopedDelegateBinding::ForMulticast(
+		FCoreUObjectDelegates::PostLoadMapWithWorld,
+		FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &ThisClass::OnPostLoadMapWithWorld)
+	);
+
+	if (IsRunningDedicatedServer())
+	{
+		// Clients preload the host's map, a server never joins
+		bPreloadDestinationMapOnJoin = false;
+		bAutoHostPending = FParse::Param(FCommandLine::Get(), TEXT("MPAutoHost"));
+	}
+	else if (bPersistReconnectInfo)
+	{
+		LoadPersistedReconnectInfo();
+	}
+
+	OperationScheduler = MakeUnique<FMPSessionOperationScheduler>(OnlineSubsystemName, BackendOperationsPerSecond, BackendOperationsBurst);
+
+	if (AdvertisingOnlineSubsystems.Num() > 0)
+	{
+		// Mirrors advertise their open slots themselves, the game session only registers players on the backend in use
+		PostLoginBinding = FMPScopedDelegateBinding::ForMulticast(
+			FGameModeEvents::GameModePostLoginEvent,
+			FGameModeEvents::GameModePostLoginEvent.AddUObject(this, &ThisClass::OnGameModePostLogin)
+		);
+		LogoutBinding = FMPScopedDelegateBinding::ForMulticast(
+			FGameModeEvents::GameModeLogoutEvent,
+			FGameModeEvents::GameModeLogoutEvent.AddUObject(this, &ThisClass::OnGameModeLogout)
+		);
+	}
+
+	if (bDeferSessionEvents || FParse::Param(FCommandLine::Get(), TEXT("MPDeferSessionEvents")))
+	{
+		SetDeferSessionEvents(true);
+	}
+
+	FString RegionName = MetricsRegionName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("MPMetricsRegion="), RegionName) || bExportMetrics)
+	{
+		StartMetricsExport(RegionName);
+	}
+
+	FString OnlineTrafficPath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("MPReplayOnlineTraffic="), OnlineTrafficPath))
+	{
+		StartOnlineTrafficReplay(OnlineTrafficPath, FParse::Param(FCommandLine::Get(), TEXT("MPReplayAsFastAsPossible")));
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("MPRecordOnlineTraffic="), OnlineTrafficPath))
+	{
+		StartOnlineTrafficRecording(OnlineTrafficPath);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::Deinitialize()
+{
+	PostLoadMapBinding.Reset();
+	PostLoginBinding.Reset();
+	LogoutBinding.Reset();
+	// Operations still in flight are not reported once the subsystem is gone
+	LoginCompleteBinding.Reset();
+	CreateSessionCompleteBinding.Reset();
+	FindSessionsCompleteBinding.Reset();
+	JoinSessionCompleteBinding.Reset();
+	DestroySessionCompleteBinding.Reset();
+	StartSessionCompleteBinding.Reset();
+	UpdateSessionCompleteBinding.Reset();
+	CancelDestinationMapPreload();
+	StopSessionPool();
+	// Destroys still in flight are not waited for once the subsystem is gone
+	StoppingSessionPool.Reset();
+	// Whoever still subscribes, the refresh ends with the subsystem
+	FTSTicker::GetCoreTicker().RemoveTicker(SessionBrowserSubscription.RefreshTickerHandle);
+	SessionBrowserSubscription = FSessionBrowserSubscription();
+	FederatedSearch.Reset();
+	FederatedOwnSearch.Reset();
+	FTSTicker::GetCoreTicker().RemoveTicker(HostPipeline.TimeoutHandle);
+	HostPipeline = FHostPipeline();
+	JoinBestOfState = FJoinBestOfState();
+	SessionMirrors.Reset();
+	PendingMirroredCompletion = nullptr;
+	StopMetricsExport();
+	StopOnlineTrafficRecording();
+	StopOnlineTrafficReplay();
+	if (OperationScheduler)
+	{
+		OperationScheduler->Reset();
+	}
+	// Listeners are going away with the game instance, pending events are dropped rather than flushed
+	if (SessionEventQueue)
+	{
+		SessionEventQueue->Reset();
+		SessionEventQueue.Reset();
+	}
+	Super::Deinitialize();
+}
+
+void UMultiplayerSessionsSubsystem::SetDeferSessionEvents(const bool bDefer)
+{
+	if (bDefer == IsDeferringSessionEvents())
+	{
+		return;
+	}
+	if (bDefer)
+	{
+		SessionEventQueue = MakeUnique<FMPSessionEventQueue>(EventDispatchBudgetMs / 1000.f);
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Session events are dispatched once per tick, budget %.2f ms"), EventDispatchBudgetMs);
+		return;
+	}
+	if (SessionEventQueue->IsDispatching())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Session events can't be switched back to immediate broadcasts from a listener"));
+		return;
+	}
+	// Events already queued keep their order ahead of the ones broadcast right away from now on
+	SessionEventQueue->Flush();
+	SessionEventQueue.Reset();
+}
+
+void UMultiplayerSessionsSubsystem::FlushSessionEvents()
+{
+	if (SessionEventQueue)
+	{
+		SessionEventQueue->Flush();
+	}
+}
+
+void UMultiplayerSessionsSubsystem::DispatchSessionEvent(
+	const EMPSessionEventKind Kind,
+	TUniqueFunction<void()>&& Broadcast,
+	const bool bCoalescable,
+	const FName Subject
+)
+{
+	if (!SessionEventQueue)
+	{
+		Broadcast();
+		return;
+	}
+	SessionEventQueue->Enqueue(Kind, MoveTemp(Broadcast), bCoalescable && bCoalesceSessionEvents, Subject);
+}
+
+void UMultiplayerSessionsSubsystem::StartMetricsExport(const FString& RegionName)
+{
+	StopMetricsExport();
+	// One region per server process unless the orchestrator assigns names
+	FString InstanceRegionName = RegionName.IsEmpty()
+		? FString::Printf(TEXT("MPSessionMetrics.%u"), FPlatformProcess::GetCurrentProcessId())
+		: RegionName;
+	// PIE runs every client and server in one process with the same config, each game instance gets its own region
+	const UGameInstance* GameInstance = GetGameInstance();
+	if (const FWorldContext* WorldContext = GameInstance ? GameInstance->GetWorldContext() : nullptr; WorldContext && WorldContext->PIEInstance != INDEX_NONE)
+	{
+		InstanceRegionName += FString::Printf(TEXT(".PIE%d"), WorldContext->PIEInstance);
+	}
+	Metrics = MakeUnique<FMPSessionMetrics>(InstanceRegionName);
+	if (!Metrics->IsExporting())
+	{
+		Metrics.Reset();
+		return;
+	}
+	PublishMetrics();
+	MetricsTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateWeakLambda(this, [this](float)
+		{
+			PublishMetrics();
+			return true;
+		}),
+		FMath::Max(MetricsPublishIntervalSeconds, 0.f)
+	);
+}
+
+void UMultiplayerSessionsSubsystem::StopMetricsExport()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(MetricsTickerHandle);
+	MetricsTickerHandle.Reset();
+	// Unmapping removes the region, a scraper then sees the server as gone
+	Metrics.Reset();
+}
+
+void UMultiplayerSessionsSubsystem::PublishMetrics()
+{
+	if (!Metrics)
+	{
+		return;
+	}
+	FMPSessionMetricsGauges Gauges;
+	Gauges.SessionState = GetSessionState();
+	Gauges.NumQueuedOperations = OperationScheduler ? OperationScheduler->GetNumQueued() : 0;
+	Gauges.NumPendingSessionEvents = SessionEventQueue ? SessionEventQueue->Num() : 0;
+	if (const FNamedOnlineSession* NamedSession = SessionInterface.IsValid() ? SessionInterface->GetNamedSession(NAME_GameSession) : nullptr)
+	{
+		Gauges.NumAdvertisedSessions += NamedSession->SessionSettings.bShouldAdvertise ? 1 : 0;
+		Gauges.NumRegisteredPlayers += NamedSession->RegisteredPlayers.Num();
+	}
+	if (SessionPool.IsValid())
+	{
+		// Pooled sessions are only advertised once claimed
+		Gauges.NumAdvertisedSessions += SessionPool->GetNumSessionsInState(EMPPooledSessionState::Claimed);
+		Gauges.NumRegisteredPlayers += SessionPool->GetNumRegisteredPlayers();
+		Gauges.NumReadyPooledSessions = SessionPool->GetNumSessionsInState(EMPPooledSessionState::Ready);
+	}
+	Metrics->Publish(Gauges);
+}
+
+void UMultiplayerSessionsSubsystem::StartOnlineTrafficRecording(const FString& Path)
+{
+	StopOnlineTrafficReplay();
+	OnlineTrafficRecorder = MakeUnique<FMPOnlineTrafficRecorder>(Path);
+	if (!OnlineTrafficRecorder->IsRecording())
+	{
+		OnlineTrafficRecorder.Reset();
+	}
+}
+
+void UMultiplayerSessionsSubsystem::StopOnlineTrafficRecording()
+{
+	OnlineTrafficRecorder.Reset();
+}
+
+void UMultiplayerSessionsSubsystem::StartOnlineTrafficReplay(const FString& Path, const bool bAsFastAsPossible)
+{
+	if (SessionPool.IsValid() || StoppingSessionPool.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Can't replay online traffic while a session pool is running"));
+		return;
+	}
+	StopOnlineTrafficRecording();
+	OnlineTrafficReplay = MakeUnique<FMPOnlineTrafficReplay>(Path, bAsFastAsPossible);
+	if (!OnlineTrafficReplay->IsLoaded())
+	{
+		OnlineTrafficReplay.Reset();
+	}
+	ReplayedNamedSessionState.Reset();
+}
+
+void UMultiplayerSessionsSubsystem::StopOnlineTrafficReplay()
+{
+	// Calls waiting for a replayed callback are left unanswered
+	OnlineTrafficReplay.Reset();
+	ReplayedNamedSessionState.Reset();
+}
+
+bool UMultiplayerSessionsSubsystem::IssueOnlineCall(
+	FMPOnlineTrafficEvent&& Call,
+	TFunctionRef<bool()> IssueCall,
+	FMPOnlineTrafficReplay::FDeliverCallback&& DeliverReplayed
+)
+{
+	if (OnlineTrafficReplay)
+	{
+		return OnlineTrafficReplay->Issue(Call.Kind, [this, DeliverReplayed = MoveTemp(DeliverReplayed)](const FMPOnlineTrafficEvent& Callback)
+		{
+			ReplayedNamedSessionState.Reset();
+			if (Callback.bHasNamedSession)
+			{
+				ReplayedNamedSessionState = static_cast<EOnlineSessionState::Type>(Callback.NamedSessionState);
+			}
+			if (DeliverReplayed)
+			{
+				DeliverReplayed(Callback);
+			}
+			else
+			{
+				DeliverReplayedCallback(Callback);
+			}
+		});
+	}
+	if (!OnlineTrafficRecorder)
+	{
+		return IssueCall();
+	}
+	// Stamped before issuing, some backends complete synchronously
+	Call.Time = OnlineTrafficRecorder->GetTime();
+	Call.bWasSuccessful = IssueCall();
+	if (OnlineTrafficRecorder)
+	{
+		OnlineTrafficRecorder->Record(Call);
+	}
+	return Call.bWasSuccessful;
+}
+
+void UMultiplayerSessionsSubsystem::RecordOnlineCallback(FMPOnlineTrafficEvent&& Callback)
+{
+	if (!OnlineTrafficRecorder)
+	{
+		return;
+	}
+	Callback.Time = OnlineTrafficRecorder->GetTime();
+	if (const FNamedOnlineSession* NamedSession = SessionInterface.IsValid() ? SessionInterface->GetNamedSession(NAME_GameSession) : nullptr)
+	{
+		Callback.bHasNamedSession = true;
+		Callback.NamedSessionState = static_cast<uint8>(NamedSession->SessionState);
+	}
+	OnlineTrafficRecorder->Record(Callback);
+}
+
+void UMultiplayerSessionsSubsystem::DeliverReplayedCallback(const FMPOnlineTrafficEvent& Callback)
+{
+	switch (Callback.Kind)
+	{
+	case EMPOnlineTrafficEvent::LoginComplete:
+		OnLoginComplete(Callback.Value, Callback.bWasSuccessful, *FUniqueNetIdString::Create(Callback.Id, OnlineSubsystemName), Callback.Error);
+		break;
+	case EMPOnlineTrafficEvent::CreateSessionComplete:
+		OnCreateSessionComplete(Callback.SessionName, Callback.bWasSuccessful);
+		break;
+	case EMPOnlineTrafficEvent::UpdateSessionComplete:
+		OnUpdateSessionComplete(Callback.SessionName, Callback.bWasSuccessful);
+		break;
+	case EMPOnlineTrafficEvent::StartSessionComplete:
+		OnStartSessionComplete(Callback.SessionName, Callback.bWasSuccessful);
+		break;
+	case EMPOnlineTrafficEvent::DestroySessionComplete:
+		OnDestroySessionComplete(Callback.SessionName, Callback.bWasSuccessful);
+		break;
+	case EMPOnlineTrafficEvent::JoinSessionComplete:
+		OnJoinSessionComplete(Callback.SessionName, static_cast<EOnJoinSessionCompleteResult::Type>(Callback.Value));
+		break;
+	default:
+		// Searches are answered through the delivery given with their call
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("No handler for the replayed %s"), FMPOnlineTrafficEvent::LexToString(Callback.Kind));
+		break;
+	}
+}
+
+EMPSessionState UMultiplayerSessionsSubsystem::GetSessionState() const
+{
+	return OperationScheduler ? OperationScheduler->GetState() : EMPSessionState::Idle;
+}
+
+void UMultiplayerSessionsSubsystem::ScheduleOperation(
+	const EMPSessionOperation Kind,
+	TUniqueFunction<void()>&& Execute,
+	TUniqueFunction<void()>&& Reject,
+	const EMPSessionOperationPriority Priority,
+	const FName MergeKey
+)
+{
+	if (!OperationScheduler)
+	{
+		Execute();
+		return;
+	}
+	if (Metrics)
+	{
+		Reject = [this, Kind, RejectOperation = MoveTemp(Reject)]()
+		{
+			if (Metrics)
+			{
+				Metrics->OnOperationRejected(Kind);
+			}
+			if (RejectOperation)
+			{
+				RejectOperation();
+			}
+		};
+	}
+	OperationScheduler->Schedule(Kind, MoveTemp(Execute), MoveTemp(Reject), Priority, MergeKey);
+}
+
+void UMultiplayerSessionsSubsystem::CompleteOperation(const EMPSessionOperation Kind, const bool bWasSuccessful)
+{
+	if (Metrics)
+	{
+		Metrics->OnOperationCompleted(Kind, bWasSuccessful);
+	}
+	if (OperationScheduler)
+	{
+		OperationScheduler->Complete(Kind);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::SetSessionState(const EMPSessionState State)
+{
+	if (OperationScheduler)
+	{
+		OperationScheduler->SetState(State);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::SyncSessionState()
+{
+	// The online subsystem knows nothing of replayed sessions, the recorded backend state is followed instead
+	TOptional<EOnlineSessionState::Type> NamedSessionState = ReplayedNamedSessionState;
+	if (!OnlineTrafficReplay)
+	{
+		if (const FNamedOnlineSession* NamedSession = SessionInterface.IsValid() ? SessionInterface->GetNamedSession(NAME_GameSession) : nullptr)
+		{
+			NamedSessionState = NamedSession->SessionState;
+		}
+	}
+	if (!NamedSessionState.IsSet())
+	{
+		SetSessionState(EMPSessionState::Idle);
+		return;
+	}
+	switch (NamedSessionState.GetValue())
+	{
+	case EOnlineSessionState::Creating:
+		SetSessionState(EMPSessionState::Creating);
+		break;
+	case EOnlineSessionState::Starting:
+		SetSessionState(EMPSessionState::Starting);
+		break;
+	case EOnlineSessionState::InProgress:
+		SetSessionState(EMPSessionState::InProgress);
+		break;
+	case EOnlineSessionState::Destroying:
+		SetSessionState(EMPSessionState::Destroying);
+		break;
+	default:
+		// Pending, Ending and Ended sessions can be started again
+		SetSessionState(EMPSessionState::Created);
+		break;
+	}
+}
+
+bool UMultiplayerSessionsSubsystem::TryAsyncLogin(const FPendingLoginAction& PendingLoginAction, const FPendingLoginAction& OnLoginFailed)
 {
     /*
     Tutorial 2: This function will access the EOS OSS via the OSS identity interface to log first into Epic Account Services, and then into Epic Game Services.
@@ -47,6 +494,10 @@ bool UMultiplayerSessionsSubsystem::TryAsyncLogin(const FPendingLoginAction& Pen
     */
     // If you're logged in, don't try to login again.
     // This can happen if your player travels to a dedicated server or different maps as BeginPlay() will be called each time.
+	if (IsServerHostingMode())
+	{
+		return TryAsyncServerLogin(PendingLoginAction, OnLoginFailed);
+	}
 	if (IsIdentityInterfaceInvalid())
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Login failed. IdentityInterface is invalid."));
@@ -71,14 +522,25 @@ bool UMultiplayerSessionsSubsystem::TryAsyncLogin(const FPendingLoginAction& Pen
     	UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Could not retrieve Logged In status. NetId is null."));
     }
 	// These actions will be executed on successful Login
-	PendingLoginActionsQueue.push(PendingLoginAction);
+	PendingLoginActionsQueue.push({ PendingLoginAction, OnLoginFailed });
 	
     
     /* This binds a delegate so we can run our function when the callback completes. 0 represents the player number.
     You should parametrize this Login function and pass the parameter here for splitscreen. 
     */
-    LoginCompleteDelegateHandle = IdentityInterface->AddOnLoginCompleteDelegate_Handle(0, LoginCompleteDelegate);
+    LoginCompleteBinding = FMPScopedDelegateBinding::ForInterface(
+		IdentityInterface,
+		IdentityInterface->AddOnLoginCompleteDelegate_Handle(0, LoginCompleteDelegate),
+		[LocalUserNum = 0](IOnlineIdentity& Identity, FDelegateHandle& Handle)
+		{
+			Identity.ClearOnLoginCompleteDelegate_Handle(LocalUserNum, Handle);
+		}
+	);
  
+	if (Metrics)
+	{
+		Metrics->OnLoginStarted();
+	}
     // Grab command line parameters. If empty call hardcoded login function - Hardcoded login function useful for Play In Editor. 
     FString AuthType; 
     FParse::Value(FCommandLine::Get(), TEXT("AUTH_TYPE="), AuthType);
@@ -91,12 +553,15 @@ bool UMultiplayerSessionsSubsystem::TryAsyncLogin(const FPendingLoginAction& Pen
         */
         UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Logging into EOS..."));
       
-        if (!IdentityInterface->AutoLogin(0))
+        if (!IssueOnlineCall(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::LoginCall, NAME_None, false, 0), [this]() { return IdentityInterface->AutoLogin(0); }))
         {
             UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Failed to login. AutoLogin failed"));
 			// Clear our handle and reset the delegate.
-			IdentityInterface->ClearOnLoginCompleteDelegate_Handle(0, LoginCompleteDelegateHandle);
-            LoginCompleteDelegateHandle.Reset();
+			LoginCompleteBinding.Reset();
+			if (Metrics)
+			{
+				Metrics->OnLoginCompleted(false);
+			}
         	return false;
         }
     }
@@ -110,36 +575,183 @@ bool UMultiplayerSessionsSubsystem::TryAsyncLogin(const FPendingLoginAction& Pen
  
         UE_LOG(LogTemp, Log, TEXT("Logging into EOS...")); // Log to the UE logs that we are trying to log in. 
         
-        if (!IdentityInterface->Login(0, Credentials))
+        if (!IssueOnlineCall(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::LoginCall, NAME_None, false, 0), [this, &Credentials]() { return IdentityInterface->Login(0, Credentials); }))
         {
             UE_LOG(LogTemp, Warning, TEXT("Failed to login. Login with Credentials failed "));
 			// Clear our handle and reset the delegate. 
-            IdentityInterface->ClearOnLoginCompleteDelegate_Handle(0, LoginCompleteDelegateHandle);
-            LoginCompleteDelegateHandle.Reset();
+            LoginCompleteBinding.Reset();
+			if (Metrics)
+			{
+				Metrics->OnLoginCompleted(false);
+			}
         	return false;
         }        
     }
+	if (GetSessionState() == EMPSessionState::Idle)
+	{
+		SetSessionState(EMPSessionState::LoggingIn);
+	}
+	return true;
+}
+
+/**
+ * @return  True if an async login was issued. False if the server does not need to log in, in which case IsLoggedIn is set.
+ */
+bool UMultiplayerSessionsSubsystem::TryAsyncServerLogin(const FPendingLoginAction& PendingLoginAction, const FPendingLoginAction& OnLoginFailed)
+{
+	FString AuthType = ServerAuthType;
+	FString AuthId = ServerAuthId;
+	FString AuthToken = ServerAuthToken;
+	FParse::Value(FCommandLine::Get(), TEXT("MPServerAuthType="), AuthType);
+	FParse::Value(FCommandLine::Get(), TEXT("MPServerAuthId="), AuthId);
+	FParse::Value(FCommandLine::Get(), TEXT("MPServerAuthToken="), AuthToken);
+
+	if (AuthType.IsEmpty() || !IdentityInterface.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Dedicated server hosting without login"));
+		IsLoggedIn = true;
+		return false;
+	}
+	if (IdentityInterface->GetLoginStatus(ServerHostingPlayerNum) == ELoginStatus::LoggedIn)
+	{
+		IsLoggedIn = true;
+		return false;
+	}
+
+	// Some backends complete the login synchronously, queue the action before issuing it
+	PendingLoginActionsQueue.push({ PendingLoginAction, OnLoginFailed });
+	LoginCompleteBinding = FMPScopedDelegateBinding::ForInterface(
+		IdentityInterface,
+		IdentityInterface->AddOnLoginCompleteDelegate_Handle(ServerHostingPlayerNum, LoginCompleteDelegate),
+		[LocalUserNum = ServerHostingPlayerNum](IOnlineIdentity& Identity, FDelegateHandle& Handle)
+		{
+			Identity.ClearOnLoginCompleteDelegate_Handle(LocalUserNum, Handle);
+		}
+	);
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Logging in dedicated server with '%s' credentials"), *AuthType);
+	if (Metrics)
+	{
+		Metrics->OnLoginStarted();
+	}
+	const bool bHasIssuedLogin = IssueOnlineCall(
+		FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::LoginCall, NAME_None, false, ServerHostingPlayerNum),
+		[this, &AuthType, &AuthId, &AuthToken]()
+		{
+			return IdentityInterface->Login(ServerHostingPlayerNum, FOnlineAccountCredentials(AuthType, AuthId, AuthToken));
+		}
+	);
+	if (!bHasIssuedLogin)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Failed to issue dedicated server login"));
+		ClearPendingLoginActions();
+		LoginCompleteBinding.Reset();
+		if (Metrics)
+		{
+			Metrics->OnLoginCompleted(false);
+		}
+		return false;
+	}
+	if (GetSessionState() == EMPSessionState::Idle)
+	{
+		SetSessionState(EMPSessionState::LoggingIn);
+	}
 	return true;
 }
 
+bool UMultiplayerSessionsSubsystem::IsServerHostingMode() const
+{
+	if (IsRunningDedicatedServer())
+	{
+		return true;
+	}
+	const UWorld* World = GetWorld();
+	return World != nullptr && World->GetNetMode() == NM_DedicatedServer;
+}
+
+FUniqueNetIdPtr UMultiplayerSessionsSubsystem::GetFirstLocalPlayerNetId() const
+{
+	if (const UWorld* World = GetWorld())
+	{
+		if (const ULocalPlayer* LocalPlayer = World->GetFirstLocalPlayerFromController())
+		{
+			return LocalPlayer->GetPreferredUniqueNetId().GetUniqueNetId();
+		}
+	}
+	return nullptr;
+}
+
 void UMultiplayerSessionsSubsystem::CreateSession(
 	const int32 NumPublicConnections,
 	const FMPSessionSettings& SessionSettings,
 	const TMap<FName, FString>& ExtraSessionSettings
 )
 {
-	// if a session already exists, destroy it first, and return early, then it will be created on the OnDestroySessionComplete callback
-	if (DestroyPreviousSessionIfExists(NumPublicConnections)) return;
+	CreateSession(NumPublicConnections, SessionSettings, ToSessionAttributes(ExtraSessionSettings));
+}
+
+void UMultiplayerSessionsSubsystem::CreateSession(
+	const int32 NumPublicConnections,
+	const FMPSessionSettings& SessionSettings,
+	const FSessionSettings& ExtraSessionSettings
+)
+{
+	ScheduleOperation(
+		EMPSessionOperation::Create,
+		[this, NumPublicConnections, SessionSettings, ExtraSessionSettings]()
+		{
+			IssueCreateSession(NumPublicConnections, SessionSettings, ExtraSessionSettings);
+		},
+		[this]()
+		{
+			BroadcastCreateSessionComplete(FName(), FString(), false);
+		}
+	);
+}
+
+void UMultiplayerSessionsSubsystem::IssueCreateSession(
+	const int32 NumPublicConnections,
+	const FMPSessionSettings& SessionSettings,
+	const FSessionSettings& ExtraSessionSettings
+)
+{
+	if (Metrics)
+	{
+		Metrics->OnOperationStarted(EMPSessionOperation::Create);
+	}
+	bStartAfterCreatePending = SessionSettings.bStartAfterCreate;
+
+	// if we already host a session and only mutable settings differ, update it in place instead of destroying it
+	if (IsHostingSession() && !RequiresSessionRecreation(SessionSettings))
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Session already hosted. Updating it in place."));
+		bReportUpdateAsCreate = true;
+		FMPSessionSettings UpdatedSessionSettings = SessionSettings;
+		UpdatedSessionSettings.PublicConnections = NumPublicConnections;
+		IssueUpdateSession(UpdatedSessionSettings, ExtraSessionSettings);
+		return;
+	}
+	// if a session already exists, destroy it first, the creation is queued right behind the destroy
+	if (!IsSessionInterfaceInvalid() && SessionInterface->GetNamedSession(NAME_GameSession) != nullptr)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Session already exists"));
+		RecreateSession(NumPublicConnections, SessionSettings, ExtraSessionSettings, EMPSessionOperation::Create);
+		return;
+	}
 	if (!IsLoggedIn)
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("User not logged in. Attempting to log in."));
 		const bool bHasIssuedAsyncLogin =  
-			TryAsyncLogin(FPendingLoginAction::CreateLambda(
+			TryAsyncLogin(FPendingLoginAction::CreateWeakLambda(this,
 				[this, NumPublicConnections, SessionSettings, ExtraSessionSettings]()
 					{
-					CreateSession(NumPublicConnections, SessionSettings, ExtraSessionSettings);
+					IssueCreateSession(NumPublicConnections, SessionSettings, ExtraSessionSettings);
 					}
-				)
+				),
+				FPendingLoginAction::CreateWeakLambda(this, [this]()
+				{
+					UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login failed. Can't create session"));
+					BroadcastCreateSessionComplete(FName(), FString(), false);
+				})
 			);
 		
 		if(bHasIssuedAsyncLogin)
@@ -152,7 +764,7 @@ void UMultiplayerSessionsSubsystem::CreateSession(
 		if (!IsLoggedIn)
 		{
 			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Failed to issue session creation. Async Login failed and player not already logged in."));
-			MultiplayerOnCreateSessionComplete.Broadcast(FName (), FString(), false);
+			BroadcastCreateSessionComplete(FName (), FString(), false);
 			return;	
 		}
 	}
@@ -161,292 +773,2362 @@ void UMultiplayerSessionsSubsystem::CreateSession(
 	if(!bHasSuccessfullyIssuedAsyncCreateSession)
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("CreateSession failed to issue"));
-		MultiplayerOnCreateSessionComplete.Broadcast(FName(), FString(), false);
+		BroadcastCreateSessionComplete(FName(), FString(), false);
 	}
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("CreateSession successfully issued"));
 	}
 }
 
-/**
- * @return  True if a session was destroyed, false if no session was destroyed
- */
-bool UMultiplayerSessionsSubsystem::DestroyPreviousSessionIfExists(const int32 NumPublicConnections)
-{
+void UMultiplayerSessionsSubsystem::HostSession(
+	const int32 NumPublicConnections,
+	const FMPSessionSettings& SessionSettings,
+	const FString& TravelURL,
+	const TMap<FName, FString>& ExtraSessionSettings
+)
+{
+	if (HostPipeline.bIsActive)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("HostSession: already hosting"));
+		return;
+	}
+
+	HostPipeline = FHostPipeline();
+	HostPipeline.bIsActive = true;
+	HostPipeline.TravelURL = TravelURL;
+	HostPipeline.StartTime = FPlatformTime::Seconds();
+	// Whatever path drops the create, the pipeline can't stay active and block every later HostSession
+	HostPipeline.TimeoutHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateWeakLambda(this, [this](float)
+		{
+			HostPipeline.TimeoutHandle.Reset();
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("HostSession: host not ready after %.0f s"), HostSessionTimeoutSeconds);
+			FinishHostPipeline(false);
+			return false;
+		}),
+		FMath::Max(HostSessionTimeoutSeconds, 1.f)
+	);
+
+	// Advertise the map we are about to travel to, and load it while the session round trips are in flight
+	FString MapPackageName;
+	if (!TravelURL.Split(TEXT("?"), &MapPackageName, nullptr))
+	{
+		MapPackageName = TravelURL;
+	}
+	TMap<FName, FString> AdvertisedSessionSettings = ExtraSessionSettings;
+	if (!AdvertisedSessionSettings.Contains(FMPMapNameKey::GetName()))
+	{
+		AdvertisedSessionSettings.Add(FMPMapNameKey::GetName(), MapPackageName);
+	}
+	StartDestinationMapPreload(MapPackageName);
+
+	CreateSession(NumPublicConnections, SessionSettings, AdvertisedSessionSettings);
+}
+
+void UMultiplayerSessionsSubsystem::BroadcastCreateSessionComplete(const FName SessionName, const FString& SessionId, const bool bWasSuccessful)
+{
+	CompleteOperation(EMPSessionOperation::Create, bWasSuccessful);
+	const bool bStartAfterCreate = bWasSuccessful && bStartAfterCreatePending;
+	bStartAfterCreatePending = false;
+
+	// A session updated in place may already be in progress, only a pending one can be started
+	const FNamedOnlineSession* NamedSession = SessionInterface.IsValid() ? SessionInterface->GetNamedSession(NAME_GameSession) : nullptr;
+	const bool bCanStart = NamedSession != nullptr && NamedSession->SessionState == EOnlineSessionState::Pending;
+
+	// Broadcast while hosting too, MultiplayerOnHostReady follows once the pipeline is done
+	DispatchSessionEvent(EMPSessionEventKind::CreateSession, [this, SessionName, SessionId, bWasSuccessful]()
+	{
+		MultiplayerOnCreateSessionComplete.Broadcast(SessionName, SessionId, bWasSuccessful);
+	});
+	if (HostPipeline.bIsActive)
+	{
+		HostPipeline.Timings.CreateSeconds = FPlatformTime::Seconds() - HostPipeline.StartTime;
+		HostPipeline.SessionId = SessionId;
+		if (!bWasSuccessful)
+		{
+			FinishHostPipeline(false);
+		}
+		// Issued straight from the create completion, without a round trip through the UI
+		else if (bStartAfterCreate && bCanStart)
+		{
+			IssueStartSession();
+		}
+		else
+		{
+			TravelHostPipeline();
+		}
+		return;
+	}
+	if (bStartAfterCreate && bCanStart)
+	{
+		IssueStartSession();
+	}
+}
+
+void UMultiplayerSessionsSubsystem::BroadcastStartSessionComplete(const bool bWasSuccessful)
+{
+	CompleteOperation(EMPSessionOperation::Start, bWasSuccessful);
+	DispatchSessionEvent(EMPSessionEventKind::StartSession, [this, bWasSuccessful]()
+	{
+		MultiplayerOnStartSessionComplete.Broadcast(bWasSuccessful);
+	});
+	if (!HostPipeline.bIsActive)
+	{
+		return;
+	}
+
+	HostPipeline.Timings.StartSeconds = FPlatformTime::Seconds() - HostPipeline.StartTime;
+	if (bWasSuccessful)
+	{
+		TravelHostPipeline();
+	}
+	else
+	{
+		FinishHostPipeline(false);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::TravelHostPipeline()
+{
+	// The preload keeps loading during the travel if it has not finished, its timing then stays at -1
+	UWorld* World = GetWorld();
+	const bool bHasTravelled = World != nullptr && World->ServerTravel(HostPipeline.TravelURL);
+	if (!bHasTravelled)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("HostSession: failed to server travel to %s"), *HostPipeline.TravelURL);
+	}
+	FinishHostPipeline(bHasTravelled);
+}
+
+void UMultiplayerSessionsSubsystem::FinishHostPipeline(const bool bWasSuccessful)
+{
+	if (!HostPipeline.bIsActive)
+	{
+		return;
+	}
+	if (!bWasSuccessful)
+	{
+		CancelDestinationMapPreload();
+	}
+	FTSTicker::GetCoreTicker().RemoveTicker(HostPipeline.TimeoutHandle);
+
+	const FHostPipeline FinishedPipeline = HostPipeline;
+	HostPipeline = FHostPipeline();
+	FMPHostTimings Timings = FinishedPipeline.Timings;
+	Timings.TotalSeconds = FPlatformTime::Seconds() - FinishedPipeline.StartTime;
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("HostSession %s: create %.3fs, start %.3fs, map preload %.3fs, total %.3fs"),
+		bWasSuccessful ? TEXT("ready") : TEXT("failed"), Timings.CreateSeconds, Timings.StartSeconds, Timings.MapPreloadSeconds, Timings.TotalSeconds);
+	DispatchSessionEvent(EMPSessionEventKind::HostReady, [this, SessionId = FinishedPipeline.SessionId, Timings, bWasSuccessful]()
+	{
+		MultiplayerOnHostReady.Broadcast(NAME_GameSession, SessionId, Timings, bWasSuccessful);
+	});
+}
+
+void UMultiplayerSessionsSubsystem::RecreateSession(
+	const int32 NumPublicConnections,
+	const FMPSessionSettings& SessionSettings,
+	const FSessionSettings& ExtraSessionSettings,
+	const EMPSessionOperation InFlightOperation
+)
+{
+	if (!OperationScheduler)
+	{
+		return;
+	}
+	// The destroy goes first, a create that fails because the session could not be destroyed is still reported
+	OperationScheduler->ScheduleFirst(
+		EMPSessionOperation::Create,
+		[this, NumPublicConnections, SessionSettings, ExtraSessionSettings]()
+		{
+			IssueCreateSession(NumPublicConnections, SessionSettings, ExtraSessionSettings);
+		},
+		[this]()
+		{
+			BroadcastCreateSessionComplete(FName(), FString(), false);
+		}
+	);
+	OperationScheduler->ScheduleFirst(
+		EMPSessionOperation::Destroy,
+		[this]()
+		{
+			IssueDestroySession();
+		},
+		// Already gone, nothing to report
+		nullptr
+	);
+	// Handed over to the recreation, which reports the outcome
+	CompleteOperation(InFlightOperation, true);
+}
+
+void UMultiplayerSessionsSubsystem::UpdateSession(
+	const FMPSessionSettings& SessionSettings,
+	const TMap<FName, FString>& ExtraSessionSettings
+)
+{
+	UpdateSession(SessionSettings, ToSessionAttributes(ExtraSessionSettings));
+}
+
+void UMultiplayerSessionsSubsystem::UpdateSession(
+	const FMPSessionSettings& SessionSettings,
+	const FSessionSettings& ExtraSessionSettings
+)
+{
+	ScheduleOperation(
+		EMPSessionOperation::Update,
+		[this, SessionSettings, ExtraSessionSettings]()
+		{
+			IssueUpdateSession(SessionSettings, ExtraSessionSettings);
+		},
+		[this]()
+		{
+			DispatchSessionEvent(EMPSessionEventKind::UpdateSession, [this]()
+			{
+				MultiplayerOnUpdateSessionComplete.Broadcast(NAME_GameSession, false);
+			});
+		}
+	);
+}
+
+void UMultiplayerSessionsSubsystem::IssueUpdateSession(
+	const FMPSessionSettings& SessionSettings,
+	const FSessionSettings& ExtraSessionSettings
+)
+{
+	const bool bReportAsCreate = bReportUpdateAsCreate;
+	bReportUpdateAsCreate = false;
+	// An update serving a create is measured as the create
+	if (Metrics && !bReportAsCreate)
+	{
+		Metrics->OnOperationStarted(EMPSessionOperation::Update);
+	}
+	const auto BroadcastUpdateFailure = [this, bReportAsCreate]()
+	{
+		if (bReportAsCreate)
+		{
+			BroadcastCreateSessionComplete(NAME_GameSession, FString(), false);
+		}
+		else
+		{
+			CompleteOperation(EMPSessionOperation::Update, false);
+			DispatchSessionEvent(EMPSessionEventKind::UpdateSession, [this]()
+			{
+				MultiplayerOnUpdateSessionComplete.Broadcast(NAME_GameSession, false);
+			});
+		}
+	};
+
+	if (IsSessionInterfaceInvalid() || !IsHostingSession() || !LastSessionSettings.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("UpdateSession failed. No hosted session to update."));
+		BroadcastUpdateFailure();
+		return;
+	}
+
+	if (RequiresSessionRecreation(SessionSettings))
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Immutable session setting changed. Recreating session."));
+		// Completion is then reported as a create
+		RecreateSession(SessionSettings.PublicConnections, SessionSettings, ExtraSessionSettings,
+			bReportAsCreate ? EMPSessionOperation::Create : EMPSessionOperation::Update);
+		return;
+	}
+
+	// An update still in flight is what the backend will have, not the last accepted settings
+	const FOnlineSessionSettings& CurrentSettings = PendingUpdatedSessionSettings.IsValid() ? *PendingUpdatedSessionSettings : *LastSessionSettings;
+	const TSharedPtr<FOnlineSessionSettings> UpdatedSettings = MakeShareable(new FOnlineSessionSettings(CurrentSettings));
+	const int32 NumChangedSettings = ApplySessionSettingsDiff(SessionSettings, ExtraSessionSettings, *UpdatedSettings);
+	LastExtraSessionSettingNames.Empty(ExtraSessionSettings.Num());
+	for (const auto& ExtraSessionSetting : ExtraSessionSettings)
+	{
+		LastExtraSessionSettingNames.Add(ExtraSessionSetting.Key);
+	}
+
+	if (NumChangedSettings == 0)
+	{
+		// Nothing to send, skip the backend round trip
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("UpdateSession: session settings unchanged"));
+		// Reported without going through OnUpdateSessionComplete, which would clear the state of an update in flight
+		if (bReportAsCreate)
+		{
+			const FNamedOnlineSession* NamedSession = SessionInterface->GetNamedSession(NAME_GameSession);
+			BroadcastCreateSessionComplete(NAME_GameSession, NamedSession ? NamedSession->GetSessionIdStr() : FString(), true);
+			return;
+		}
+		CompleteOperation(EMPSessionOperation::Update, true);
+		DispatchSessionEvent(EMPSessionEventKind::UpdateSession, [this]()
+		{
+			MultiplayerOnUpdateSessionComplete.Broadcast(NAME_GameSession, true);
+		});
+		return;
+	}
+
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("UpdateSession: %d session settings changed"), NumChangedSettings);
+	bReportUpdateAsCreate = bReportAsCreate;
+	PendingUpdatedSessionSettings = UpdatedSettings;
+	if (!TryAsyncUpdateSession(*UpdatedSettings))
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("UpdateSession failed to issue"));
+		bReportUpdateAsCreate = false;
+		PendingUpdatedSessionSettings.Reset();
+		BroadcastUpdateFailure();
+	}
+}
+
+void UMultiplayerSessionsSubsystem::StartSessionPool(const int32 PoolSize, const FMPSessionSettings& SessionSettings)
+{
+	if (IsSessionInterfaceInvalid()) return;
+	// Replays only answer the game session's calls, pooled sessions would be created on the live backend
+	if (IsReplayingOnlineTraffic())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Can't start session pool while replaying online traffic"));
+		return;
+	}
+
+	if (!IsLoggedIn)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("User not logged in. Attempting to log in."));
+		const bool bHasIssuedAsyncLogin =
+			TryAsyncLogin(FPendingLoginAction::CreateWeakLambda(this,
+				[this, PoolSize, SessionSettings]()
+					{
+						StartSessionPool(PoolSize, SessionSettings);
+					}
+				),
+				FPendingLoginAction::CreateWeakLambda(this, []()
+				{
+					UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed. Can't start session pool"));
+				})
+			);
+		if (bHasIssuedAsyncLogin)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Async login initiated. Will fill session pool after login."));
+			return;
+		}
+		if (!IsLoggedIn)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed. Can't start session pool"));
+			return;
+		}
+	}
+
+	StopSessionPool();
+	if (StoppingSessionPool.IsValid())
+	{
+		// The new pool reuses the session names of the stopping one, they must be destroyed before being created again
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Will fill session pool once the previous one is destroyed"));
+		PendingSessionPoolStart = [this, PoolSize, SessionSettings]()
+		{
+			StartSessionPool(PoolSize, SessionSettings);
+		};
+		return;
+	}
+
+	FOnlineSessionSettings PooledSessionSettings;
+	ApplySessionSettings(SessionSettings, FSessionSettings(), PooledSessionSettings);
+	// Pooled sessions belong to the server, like the mirrors they go through its hosting player
+	SessionPool = MakeUnique<FMPSessionPool>(SessionInterface, PooledSessionSettings, PoolSize, IsServerHostingMode() ? ServerHostingPlayerNum : 0);
+	SessionPool->IssueOnlineCall = [this](FMPOnlineTrafficEvent&& Call, TFunctionRef<bool()> IssueCall)
+	{
+		return IssueOnlineCall(MoveTemp(Call), IssueCall);
+	};
+	SessionPool->OnOnlineCallback = [this](FMPOnlineTrafficEvent&& Callback)
+	{
+		RecordOnlineCallback(MoveTemp(Callback));
+	};
+	SessionPool->OnSessionClaimed.BindWeakLambda(this, [this](FName SessionName, const FString& SessionId, bool bWasSuccessful)
+	{
+		DispatchSessionEvent(EMPSessionEventKind::PooledSessionClaimed, [this, SessionName, SessionId = FString(SessionId), bWasSuccessful]()
+		{
+			MultiplayerOnPooledSessionClaimed.Broadcast(SessionName, SessionId, bWasSuccessful);
+		});
+	});
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Filling session pool with %d sessions"), PoolSize);
+	SessionPool->Fill();
+}
+
+FName UMultiplayerSessionsSubsystem::ClaimPooledSession(const TMap<FName, FString>& ExtraSessionSettings)
+{
+	return ClaimPooledSession(ToSessionAttributes(ExtraSessionSettings));
+}
+
+FName UMultiplayerSessionsSubsystem::ClaimPooledSession(const FSessionSettings& ExtraSessionSettings)
+{
+	if (!SessionPool.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("ClaimPooledSession failed. Session pool not started."));
+		return NAME_None;
+	}
+	return SessionPool->Claim(ExtraSessionSettings);
+}
+
+bool UMultiplayerSessionsSubsystem::ReleasePooledSession(const FName SessionName)
+{
+	return SessionPool.IsValid() && SessionPool->Release(SessionName);
+}
+
+void UMultiplayerSessionsSubsystem::StopSessionPool()
+{
+	PendingSessionPoolStart = nullptr;
+	if (!SessionPool.IsValid())
+	{
+		return;
+	}
+
+	SessionPool->OnSessionClaimed.Unbind();
+	SessionPool->DestroyAll(FSimpleDelegate::CreateUObject(this, &ThisClass::OnSessionPoolDestroyed));
+	if (SessionPool->IsDestroyed())
+	{
+		SessionPool.Reset();
+		return;
+	}
+	// Kept alive until its destroys complete, no new pool is created meanwhile
+	StoppingSessionPool = MoveTemp(SessionPool);
+}
+
+bool UMultiplayerSessionsSubsystem::IsSessionPoolStopping() const
+{
+	return StoppingSessionPool.IsValid();
+}
+
+void UMultiplayerSessionsSubsystem::OnSessionPoolDestroyed()
+{
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Session pool destroyed"));
+	StoppingSessionPool.Reset();
+	if (PendingSessionPoolStart)
+	{
+		const TUniqueFunction<void()> StartPendingSessionPool = MoveTemp(PendingSessionPoolStart);
+		PendingSessionPoolStart = nullptr;
+		StartPendingSessionPool();
+	}
+}
+
+int32 UMultiplayerSessionsSubsystem::GetNumReadyPooledSessions() const
+{
+	return SessionPool.IsValid() ? SessionPool->GetNumSessionsInState(EMPPooledSessionState::Ready) : 0;
+}
+
+bool UMultiplayerSessionsSubsystem::IsHostingSession() const
+{
+	if (!SessionInterface.IsValid())
+	{
+		return false;
+	}
+	const FNamedOnlineSession* ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession);
+	return ExistingSession != nullptr && ExistingSession->bHosting;
+}
+
+/**
+ * These settings cannot be changed on a live session by most backends, changing them requires a new session.
+ */
+bool UMultiplayerSessionsSubsystem::RequiresSessionRecreation(const FMPSessionSettings& SessionSettings) const
+{
+	if (!LastSessionSettings.IsValid())
+	{
+		return true;
+	}
+	// Compared as the session would be created, server hosting mode overrides some of the requested settings
+	FOnlineSessionSettings RequestedSettings;
+	ApplySessionSettings(SessionSettings, FSessionSettings(), RequestedSettings);
+	return LastSessionSettings->bIsLANMatch != RequestedSettings.bIsLANMatch
+		|| LastSessionSettings->bIsDedicated != RequestedSettings.bIsDedicated
+		|| LastSessionSettings->bUsesPresence != RequestedSettings.bUsesPresence
+		|| LastSessionSettings->bUseLobbiesIfAvailable != RequestedSettings.bUseLobbiesIfAvailable;
+}
+
+/**
+ * Applies the mutable settings that differ from OutUpdatedSettings to it.
+ * @return  The number of settings that changed
+ */
+int32 UMultiplayerSessionsSubsystem::ApplySessionSettingsDiff(
+	const FMPSessionSettings& SessionSettings,
+	const FSessionSettings& ExtraSessionSettings,
+	FOnlineSessionSettings& OutUpdatedSettings
+) const
+{
+	int32 NumChangedSettings = 0;
+	const auto ApplyIfChanged = [&NumChangedSettings](auto& Current, const auto& New, const TCHAR* Name)
+	{
+		if (Current != New)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Verbose, TEXT("UpdateSession: %s changed"), Name);
+			Current = New;
+			++NumChangedSettings;
+		}
+	};
+	FOnlineSessionSettings RequestedSettings;
+	ApplySessionSettings(SessionSettings, FSessionSettings(), RequestedSettings);
+	ApplyIfChanged(OutUpdatedSettings.NumPublicConnections, RequestedSettings.NumPublicConnections, TEXT("NumPublicConnections"));
+	ApplyIfChanged(OutUpdatedSettings.bAllowJoinInProgress, RequestedSettings.bAllowJoinInProgress, TEXT("bAllowJoinInProgress"));
+	ApplyIfChanged(OutUpdatedSettings.bAllowJoinViaPresence, RequestedSettings.bAllowJoinViaPresence, TEXT("bAllowJoinViaPresence"));
+	ApplyIfChanged(OutUpdatedSettings.bShouldAdvertise, RequestedSettings.bShouldAdvertise, TEXT("bShouldAdvertise"));
+	ApplyIfChanged(OutUpdatedSettings.bAllowInvites, RequestedSettings.bAllowInvites, TEXT("bAllowInvites"));
+
+	for (const auto& ExtraSessionSetting : ExtraSessionSettings)
+	{
+		const FOnlineSessionSetting* CurrentSetting = OutUpdatedSettings.Settings.Find(ExtraSessionSetting.Key);
+		if (
+			CurrentSetting == nullptr
+			|| CurrentSetting->Data != ExtraSessionSetting.Value.Data
+			|| CurrentSetting->AdvertisementType != ExtraSessionSetting.Value.AdvertisementType
+		)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Verbose, TEXT("UpdateSession: %s changed"), *ExtraSessionSetting.Key.ToString());
+			OutUpdatedSettings.Set(ExtraSessionSetting.Key, ExtraSessionSetting.Value);
+			++NumChangedSettings;
+		}
+	}
+	for (const FName& PreviousSettingName : LastExtraSessionSettingNames)
+	{
+		// The advertised map is maintained by the subsystem, it is only replaced, never dropped
+		if (PreviousSettingName != FMPMapNameKey::GetName() && !ExtraSessionSettings.Contains(PreviousSettingName))
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Verbose, TEXT("UpdateSession: %s removed"), *PreviousSettingName.ToString());
+			OutUpdatedSettings.Remove(PreviousSettingName);
+			++NumChangedSettings;
+		}
+	}
+	return NumChangedSettings;
+}
+
+bool UMultiplayerSessionsSubsystem::TryAsyncUpdateSession(const FOnlineSessionSettings& UpdatedSettings)
+{
+	UpdateSessionCompleteBinding = FMPScopedDelegateBinding::ForInterface(SessionInterface, SessionInterface->AddOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteDelegate), &IOnlineSession::ClearOnUpdateSessionCompleteDelegate_Handle);
+	// UpdateSession takes a non-const reference, the backend reads from it
+	FOnlineSessionSettings SettingsToSend = UpdatedSettings;
+	FMPOnlineTrafficEvent UpdateCall(EMPOnlineTrafficEvent::UpdateSessionCall, NAME_GameSession);
+	if (OnlineTrafficRecorder)
+	{
+		UpdateCall.SessionSettings = SettingsToSend;
+	}
+	// Mirrors go first, the backend in use may complete synchronously
+	if (SessionMirrors && SessionMirrors->HasCreatedMirrors())
+	{
+		IssueSessionMirrorsCall([this, &UpdatedSettings](FMPOnSessionMirrorsComplete&& OnComplete)
+		{
+			SessionMirrors->Update(UpdatedSettings, MoveTemp(OnComplete));
+		});
+	}
+	if (!IssueOnlineCall(MoveTemp(UpdateCall), [this, &SettingsToSend]() { return SessionInterface->UpdateSession(NAME_GameSession, SettingsToSend, true); }))
+	{
+		UpdateSessionCompleteBinding.Reset();
+		return false;
+	}
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::IsSessionInterfaceInvalid() const
+{
+	if(!SessionInterface.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("SessionInterface is not valid"));
+		return true;
+	}
+	return false;
+}
+
+bool UMultiplayerSessionsSubsystem::IsIdentityInterfaceInvalid() const
+{
+	if(!IdentityInterface.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("IdentityInterface is not valid"));
+		return true;
+	}
+	return false;
+}
+
+bool UMultiplayerSessionsSubsystem::TryAsyncCreateSession(
+	const FMPSessionSettings& SessionSettings,
+	const FSessionSettings& ExtraSessionSettings
+)
+{
+	CreateSessionCompleteBinding = FMPScopedDelegateBinding::ForInterface(SessionInterface, SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate), &IOnlineSession::ClearOnCreateSessionCompleteDelegate_Handle);
+	
+	SetupLastSessionSettings(SessionSettings, ExtraSessionSettings);
+	// A new key for every session, advertised on each backend it is created on, unless the caller brings its own
+	if (!ExtraSessionSettings.Contains(FMPSessionKeyKey::GetName()))
+	{
+		FMPSessionSchema::Set<FMPSessionKeyKey>(*LastSessionSettings, FGuid::NewGuid().ToString(EGuidFormats::Digits));
+	}
+	
+	// Created alongside the session in use rather than after it, and issued first as the backend in use may complete synchronously
+	if (AdvertisingOnlineSubsystems.Num() > 0 && !IsReplayingOnlineTraffic())
+	{
+		if (!SessionMirrors)
+		{
+			TArray<FName> MirrorOnlineSubsystemNames = AdvertisingOnlineSubsystems;
+			MirrorOnlineSubsystemNames.Remove(OnlineSubsystemName);
+			SessionMirrors = MakeUnique<FMPSessionMirrors>(MirrorOnlineSubsystemNames, IsServerHostingMode() ? ServerHostingPlayerNum : 0);
+		}
+		IssueSessionMirrorsCall([this](FMPOnSessionMirrorsComplete&& OnComplete)
+		{
+			SessionMirrors->Create(*LastSessionSettings, MoveTemp(OnComplete));
+		});
+	}
+
+	bool bHasSuccessfullyIssuedAsyncCreateSession = false;
+	const FUniqueNetIdPtr HostingPlayerId = IsServerHostingMode() ? nullptr : GetFirstLocalPlayerNetId();
+	FMPOnlineTrafficEvent CreateCall(EMPOnlineTrafficEvent::CreateSessionCall, NAME_GameSession);
+	if (OnlineTrafficRecorder)
+	{
+		CreateCall.SessionSettings = *LastSessionSettings;
+	}
+	if (IssueOnlineCall(MoveTemp(CreateCall), [this, &HostingPlayerId]()
+		{
+			return HostingPlayerId.IsValid()
+				? SessionInterface->CreateSession(*HostingPlayerId, NAME_GameSession, *LastSessionSettings)
+				// Headless servers have no local player, the session is owned by the hosting player number
+				: SessionInterface->CreateSession(ServerHostingPlayerNum, NAME_GameSession, *LastSessionSettings);
+		}))
+	{
+		bHasSuccessfullyIssuedAsyncCreateSession = true;
+		SetSessionState(EMPSessionState::Creating);
+	}
+	else
+	{
+		CreateSessionCompleteBinding.Reset();
+		if (SessionMirrors)
+		{
+			SessionMirrors->Destroy(FMPOnSessionMirrorsComplete());
+		}
+	}
+	return bHasSuccessfullyIssuedAsyncCreateSession;
+}
+
+void UMultiplayerSessionsSubsystem::SetupLastSessionSettings(
+	const FMPSessionSettings& SessionSettings,
+	const FSessionSettings& ExtraSessionSettings
+)
+{
+	if (!LastSessionSettings.IsValid())
+	{
+		LastSessionSettings = MakeShareable(new FOnlineSessionSettings);
+	}
+	ApplySessionSettings(SessionSettings, ExtraSessionSettings, *LastSessionSettings);
+
+	LastExtraSessionSettingNames.Empty(ExtraSessionSettings.Num());
+	for (const auto& ExtraSessionSetting : ExtraSessionSettings)
+	{
+		LastExtraSessionSettingNames.Add(ExtraSessionSetting.Key);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ApplySessionSettings(
+	const FMPSessionSettings& SessionSettings,
+	const FSessionSettings& ExtraSessionSettings,
+	FOnlineSessionSettings& OutSettings
+) const
+{
+	OutSettings.bIsLANMatch = SessionSettings.bUseLAN;
+	OutSettings.bIsDedicated = SessionSettings.bIsDedicatedServer;
+	OutSettings.NumPublicConnections = SessionSettings.PublicConnections;
+	OutSettings.bAllowJoinInProgress = SessionSettings.bAllowJoinInProgress;
+	OutSettings.bAllowJoinViaPresence = SessionSettings.bAllowJoinViaPresence;
+	OutSettings.bShouldAdvertise = SessionSettings.bShouldAdvertise;
+	OutSettings.bUsesPresence = SessionSettings.bUsePresence;
+	OutSettings.bUseLobbiesIfAvailable = SessionSettings.bUseLobbiesIfAvailable;
+	OutSettings.bUseLobbiesVoiceChatIfAvailable = SessionSettings.bUseLobbiesIfAvailable;
+	OutSettings.bAllowInvites = SessionSettings.bAllowInvites;
+
+	if (IsServerHostingMode())
+	{
+		// Presence and lobbies belong to a user, a headless server advertises a plain dedicated session
+		OutSettings.bIsDedicated = true;
+		OutSettings.bUsesPresence = false;
+		OutSettings.bAllowJoinViaPresence = false;
+		OutSettings.bUseLobbiesIfAvailable = false;
+		OutSettings.bUseLobbiesVoiceChatIfAvailable = false;
+	}
+
+	// Advertise the map joining clients will end up in, so they can start loading it before the join completes.
+	// Callers that server travel after creating pass their destination map in the extra settings; otherwise it is the current map.
+	if (!ExtraSessionSettings.Contains(FMPMapNameKey::GetName()))
+	{
+		FMPSessionSchema::Set<FMPMapNameKey>(OutSettings, GetCurrentMapPackageName());
+	}
+	
+	 for (const auto& ExtraSessionSetting : ExtraSessionSettings)
+	 {
+	 	OutSettings.Set(ExtraSessionSetting.Key, ExtraSessionSetting.Value);
+	 }
+}
+
+
+bool UMultiplayerSessionsSubsystem::TryAsyncFindSessions(const int32 MaxSearchResults, const FOnlineSearchSettings& QuerySettings)
+{
+	bool bHasSuccessfullyIssuedAsyncFindSessions = false;
+	if (const UWorld* World = GetWorld())
+	{
+		SetupLastSessionSearchOptions(MaxSearchResults, QuerySettings);
+		
+		if (LastSessionSearch->bIsLanQuery)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Will perform Session Search in Lan"));
+		}
+		else
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Will perform Session Search in Web"));
+		}
+		
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("List of query search params (name, value):"));
+		for (const auto& QuerySetting: LastSessionSearch->QuerySettings.SearchParams)
+		{
+			const FName SearchSettingName = QuerySetting.Key;
+			const FOnlineSessionSearchParam SearchParam = QuerySetting.Value;
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("(%s: %s)"), *SearchSettingName.ToString(), *SearchParam.Data.ToString());
+		}
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("****************************************"));
+		
+		if (!TryIssueSessionSearch(
+			LastSessionSearch.ToSharedRef(),
+			FMPOnSessionSearchComplete::CreateUObject(this, &ThisClass::OnLastSessionSearchComplete)
+		))
+		{
+			// the caller broadcasts that we failed to find sessions
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("SessionInterface->FindSessions failed"));
+		}
+		else
+		{
+			bHasSuccessfullyIssuedAsyncFindSessions = true;
+		}
+	}
+	else
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("World is null"));
+	}
+	return bHasSuccessfullyIssuedAsyncFindSessions;
+}
+
+/**
+ * Issues a search on the session interface, OnComplete is called when it finishes.
+ * Only one search can be in flight, later ones are queued and issued in order.
+ * @return  False if the search could not be issued, OnComplete is not called in that case
+ */
+bool UMultiplayerSessionsSubsystem::TryIssueSessionSearch(
+	const TSharedRef<FOnlineSessionSearch>& SessionSearch,
+	const FMPOnSessionSearchComplete& OnComplete
+)
+{
 	if (IsSessionInterfaceInvalid()) return false;
+	if (InFlightSessionSearch.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("A session search is already in progress, queueing the new one"));
+		QueuedSessionSearches.Emplace(SessionSearch, OnComplete);
+		return true;
+	}
+
+	// Set before issuing, some backends complete the search synchronously
+	InFlightSessionSearch = SessionSearch;
+	InFlightSessionSearchComplete = OnComplete;
+	FindSessionsCompleteBinding = FMPScopedDelegateBinding::ForInterface(SessionInterface, SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate), &IOnlineSession::ClearOnFindSessionsCompleteDelegate_Handle);
+
+	const FUniqueNetIdPtr SearchingPlayerId = GetFirstLocalPlayerNetId();
+	const bool bHasIssuedSearch = IssueOnlineCall(
+		FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::FindSessionsCall, NAME_None, false, SessionSearch->MaxSearchResults),
+		[this, &SearchingPlayerId, &SessionSearch]()
+		{
+			return SearchingPlayerId.IsValid()
+				? SessionInterface->FindSessions(*SearchingPlayerId, SessionSearch)
+				: SessionInterface->FindSessions(ServerHostingPlayerNum, SessionSearch);
+		},
+		[this, SessionSearch](const FMPOnlineTrafficEvent& Callback)
+		{
+			SessionSearch->SearchResults = Callback.SearchResults;
+			SessionSearch->SearchState = Callback.bWasSuccessful ? EOnlineAsyncTaskState::Done : EOnlineAsyncTaskState::Failed;
+			OnFindSessionsComplete(Callback.bWasSuccessful);
+		}
+	);
+	if (!bHasIssuedSearch)
+	{
+		FindSessionsCompleteBinding.Reset();
+		InFlightSessionSearch.Reset();
+		InFlightSessionSearchComplete.Unbind();
+	}
+	return bHasIssuedSearch;
+}
+
+void UMultiplayerSessionsSubsystem::SetupLastSessionSearchOptions(const int32 MaxSearchResults, const FOnlineSearchSettings& QuerySettings)
+{
+	LastSessionSearch = MakeSessionSearch(MaxSearchResults, QuerySettings);
+}
+
+TSharedRef<FOnlineSessionSearch> UMultiplayerSessionsSubsystem::MakeSessionSearch(
+	const int32 MaxSearchResults,
+	const FOnlineSearchSettings& QuerySettings
+) const
+{
+	TSharedRef<FOnlineSessionSearch> SessionSearch = MakeShared<FOnlineSessionSearch>();
+	SessionSearch->bIsLanQuery = OnlineSubsystemName == "NULL";
+	SessionSearch->MaxSearchResults = MaxSearchResults;
+	if (!IsServerHostingMode())
+	{
+		SessionSearch->QuerySettings.Set(SEARCH_PRESENCE, true, EOnlineComparisonOp::Equals);
+		SessionSearch->QuerySettings.Set(SEARCH_LOBBIES, true, EOnlineComparisonOp::Equals);
+	}
+	for (const auto& SearchParam : QuerySettings.SearchParams)
+	{
+		SessionSearch->QuerySettings.SearchParams.Add(SearchParam.Key, SearchParam.Value);
+	}
+	return SessionSearch;
+}
+
+bool UMultiplayerSessionsSubsystem::ExecutePendingLoginActions()
+{
+	bool HasAnyActionBeenExecuted = false;
+	while (!PendingLoginActionsQueue.empty())
+	{
+		FPendingLoginAction PendingAction = PendingLoginActionsQueue.front().OnLoggedIn;
+		PendingLoginActionsQueue.pop();
+		if(PendingAction.ExecuteIfBound())
+		{
+			HasAnyActionBeenExecuted = true;
+		}
+	}
+	return HasAnyActionBeenExecuted;
+}
+
+void UMultiplayerSessionsSubsystem::FailPendingLoginActions()
+{
+	// Taken out first, actions queued from a failure action wait for the next login
+	std::queue<FPendingLogin> FailedLogins;
+	FailedLogins.swap(PendingLoginActionsQueue);
+	while (!FailedLogins.empty())
+	{
+		const FPendingLoginAction OnLoginFailed = FailedLogins.front().OnLoginFailed;
+		FailedLogins.pop();
+		OnLoginFailed.ExecuteIfBound();
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ClearPendingLoginActions()
+{
+	std::queue<FPendingLogin>().swap(PendingLoginActionsQueue);
+}
+
+void UMultiplayerSessionsSubsystem::FindSessions(const int32 MaxSearchResults)
+{
+	FindSessions(MaxSearchResults, FOnlineSearchSettings());
+}
+
+void UMultiplayerSessionsSubsystem::FindSessions(const int32 MaxSearchResults, const FOnlineSearchSettings& QuerySettings)
+{
+	ScheduleOperation(
+		EMPSessionOperation::Find,
+		[this, MaxSearchResults, QuerySettings]()
+		{
+			IssueFindSessions(MaxSearchResults, QuerySettings);
+		},
+		nullptr,
+		EMPSessionOperationPriority::Low
+	);
+}
+
+void UMultiplayerSessionsSubsystem::IssueFindSessions(const int32 MaxSearchResults, const FOnlineSearchSettings& QuerySettings)
+{
+	if (Metrics)
+	{
+		Metrics->OnOperationStarted(EMPSessionOperation::Find);
+	}
+	if (IsSessionInterfaceInvalid())
+	{
+		CompleteOperation(EMPSessionOperation::Find, false);
+		return;
+	}
+	
+	if (!IsLoggedIn)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("User not logged in. Attempting to log in."));
+		const bool HasIssuedAsyncLogin =  
+			TryAsyncLogin(FPendingLoginAction::CreateWeakLambda(this,
+				[this, MaxSearchResults, QuerySettings]()
+					{
+						IssueFindSessions(MaxSearchResults, QuerySettings);
+					}
+				),
+				FPendingLoginAction::CreateUObject(this, &ThisClass::FailFindSessionsLogin)
+			);
+		
+		if(HasIssuedAsyncLogin)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Async login initiated. Will find sessions after login."));
+			return;
+		}
+		
+		if (!HasIssuedAsyncLogin && !IsLoggedIn)
+		{
+			FailFindSessionsLogin();
+			return;	
+		}
+	}
+	
+
+	if (!TryAsyncFindSessions(MaxSearchResults, QuerySettings))
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("FindSessions failed to issue"));
+		CompleteOperation(EMPSessionOperation::Find, false);
+		DispatchSessionEvent(EMPSessionEventKind::FindSessions, [this]()
+		{
+			MultiplayerOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		}, true);
+	}
+	else
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("FindSessions issued successfully"));
+	}
+}
+
+void UMultiplayerSessionsSubsystem::FailFindSessionsLogin()
+{
+	UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed. Can't find sessions"));
+	CompleteOperation(EMPSessionOperation::Find, false);
+	DispatchSessionEvent(EMPSessionEventKind::FindSessions, [this]()
+	{
+		MultiplayerOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult> (),false);
+	}, true);
+}
+
+void UMultiplayerSessionsSubsystem::FindSessionsFederated(
+	const int32 MaxSearchResults,
+	const FOnlineSearchSettings& QuerySettings,
+	const TArray<FName>& OnlineSubsystemNames
+)
+{
+	ScheduleOperation(
+		EMPSessionOperation::Find,
+		[this, MaxSearchResults, QuerySettings, OnlineSubsystemNames = OnlineSubsystemNames.Num() > 0 ? OnlineSubsystemNames : FederatedOnlineSubsystems]()
+		{
+			IssueFindSessionsFederated(MaxSearchResults, QuerySettings, OnlineSubsystemNames);
+		},
+		[this]()
+		{
+			DispatchSessionEvent(EMPSessionEventKind::FederatedSearch, [this]()
+			{
+				MultiplayerOnFederatedSearchComplete.Broadcast(TArray<FMPFederatedSearchResult>(), false);
+			});
+		},
+		EMPSessionOperationPriority::Low,
+		FederatedSearchMergeKey
+	);
+}
+
+void UMultiplayerSessionsSubsystem::IssueFindSessionsFederated(
+	const int32 MaxSearchResults,
+	const FOnlineSearchSettings& QuerySettings,
+	const TArray<FName>& OnlineSubsystemNames
+)
+{
+	if (Metrics)
+	{
+		Metrics->OnOperationStarted(EMPSessionOperation::Find);
+	}
+	// The online subsystem in use is searched through the regular path, which needs the user logged in
+	if (!IsLoggedIn && !IsSessionInterfaceInvalid())
+	{
+		// Searched either way, a failed login only leaves the online subsystem in use out
+		const FPendingLoginAction IssueSearches = FPendingLoginAction::CreateWeakLambda(this, [this, MaxSearchResults, QuerySettings, OnlineSubsystemNames]()
+		{
+			IssueFederatedSearches(MaxSearchResults, QuerySettings, OnlineSubsystemNames);
+		});
+		const bool HasIssuedAsyncLogin = TryAsyncLogin(IssueSearches, IssueSearches);
+		if (HasIssuedAsyncLogin)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Async login initiated. Will search the federated backends after login."));
+			return;
+		}
+	}
+	IssueFederatedSearches(MaxSearchResults, QuerySettings, OnlineSubsystemNames);
+}
+
+void UMultiplayerSessionsSubsystem::IssueFederatedSearches(
+	const int32 MaxSearchResults,
+	const FOnlineSearchSettings& QuerySettings,
+	const TArray<FName>& OnlineSubsystemNames
+)
+{
+	if (!IsLoggedIn)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Not logged in. '%s' is left out of the federated search"), *OnlineSubsystemName.ToString());
+	}
+
+	const int32 SearchId = ++LastFederatedSearchId;
+	FederatedSearch = MakeUnique<FMPFederatedSessionSearch>(
+		FMPOnFederatedSearchResults::CreateUObject(this, &ThisClass::OnFederatedSearchResults, SearchId),
+		FMPOnFederatedSearchComplete::CreateUObject(this, &ThisClass::OnFederatedSearchComplete, SearchId),
+		FederatedSearchTimeoutSeconds
+	);
+	FederatedOwnSearch.Reset();
+	if (IsLoggedIn && SessionInterface.IsValid())
+	{
+		FederatedOwnSearch = MakeSessionSearch(MaxSearchResults, QuerySettings);
+		FederatedSearch->AddPendingBackend(OnlineSubsystemName);
+		if (!TryIssueSessionSearch(
+			FederatedOwnSearch.ToSharedRef(),
+			FMPOnSessionSearchComplete::CreateUObject(this, &ThisClass::OnFederatedOwnSearchComplete, SearchId)
+		))
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("SessionInterface->FindSessions failed for the federated search"));
+			FederatedSearch->OnBackendSearchComplete(OnlineSubsystemName, TArray<FOnlineSessionSearchResult>(), false);
+		}
+	}
+
+	TSet<FName> IssuedOnlineSubsystemNames { OnlineSubsystemName };
+	for (const FName& FederatedOnlineSubsystemName : OnlineSubsystemNames)
+	{
+		if (IssuedOnlineSubsystemNames.Contains(FederatedOnlineSubsystemName))
+		{
+			continue;
+		}
+		if (IsReplayingOnlineTraffic())
+		{
+			// Replays answer the backend in use only, the other backends would be searched live
+			UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("'%s' is left out of the federated search while replaying online traffic"), *FederatedOnlineSubsystemName.ToString());
+			continue;
+		}
+		IssuedOnlineSubsystemNames.Add(FederatedOnlineSubsystemName);
+		TSharedRef<FOnlineSessionSearch> Search = MakeSessionSearch(MaxSearchResults, QuerySettings);
+		Search->bIsLanQuery = FederatedOnlineSubsystemName == "NULL";
+		FederatedSearch->IssueSearch(FederatedOnlineSubsystemName, Search, IsServerHostingMode() ? ServerHostingPlayerNum : 0);
+	}
+	// Completes right here if no backend could be searched
+	FederatedSearch->FinishIssuing();
+}
+
+void UMultiplayerSessionsSubsystem::OnFederatedOwnSearchComplete(const bool bWasSuccessful, const int32 SearchId)
+{
+	if (SearchId != LastFederatedSearchId || !FederatedSearch.IsValid() || !FederatedOwnSearch.IsValid())
+	{
+		return;
+	}
+	const TSharedPtr<FOnlineSessionSearch> Search = MoveTemp(FederatedOwnSearch);
+	FederatedSearch->OnBackendSearchComplete(OnlineSubsystemName, Search->SearchResults, bWasSuccessful);
+}
+
+void UMultiplayerSessionsSubsystem::OnFederatedSearchResults(FName ResultsOnlineSubsystemName, const TArray<FMPFederatedSearchResult>& NewResults, const int32 SearchId)
+{
+	if (SearchId != LastFederatedSearchId)
+	{
+		return;
+	}
+	TArray<FMPFederatedSearchResult> ListedResults = NewResults;
+	RemoveJoinBlacklisted(ListedResults);
+	if (ListedResults.Num() == 0)
+	{
+		return;
+	}
+	// Each batch only holds new sessions, they are never coalesced
+	DispatchSessionEvent(EMPSessionEventKind::FederatedSearch, [this, ResultsOnlineSubsystemName, ListedResults = MoveTemp(ListedResults)]()
+	{
+		MultiplayerOnFederatedSearchResults.Broadcast(ResultsOnlineSubsystemName, ListedResults);
+	});
+}
+
+void UMultiplayerSessionsSubsystem::OnFederatedSearchComplete(const bool bWasSuccessful, const int32 SearchId)
+{
+	if (SearchId != LastFederatedSearchId || !FederatedSearch.IsValid())
+	{
+		return;
+	}
+	CompleteOperation(EMPSessionOperation::Find, bWasSuccessful);
+	if (!bWasSuccessful)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Federated search failed on every backend"));
+	}
+	TArray<FMPFederatedSearchResult> SearchResults = FederatedSearch->GetResults();
+	RemoveJoinBlacklisted(SearchResults);
+	DispatchSessionEvent(EMPSessionEventKind::FederatedSearch, [this, SearchResults = MoveTemp(SearchResults), bWasSuccessful]()
+	{
+		MultiplayerOnFederatedSearchComplete.Broadcast(SearchResults, bWasSuccessful);
+	});
+}
+
+void UMultiplayerSessionsSubsystem::FindSessionsPaged(const int32 PageSize, const FOnlineSearchSettings& QuerySettings)
+{
+	if (IsSessionInterfaceInvalid()) return;
+
+	if (PageSize <= 0)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("FindSessionsPaged needs a positive page size"));
+		DispatchSessionEvent(EMPSessionEventKind::FindSessionsPage, [this]()
+		{
+			MultiplayerOnFindSessionsPageComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), FMPSessionSearchCursor(), false);
+		});
+		return;
+	}
 	
+	if (!IsLoggedIn)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("User not logged in. Attempting to log in."));
+		const FPendingLoginAction FailFindSessionsPaged = FPendingLoginAction::CreateWeakLambda(this, [this]()
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed. Can't find sessions"));
+			DispatchSessionEvent(EMPSessionEventKind::FindSessionsPage, [this]()
+			{
+				MultiplayerOnFindSessionsPageComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), FMPSessionSearchCursor(), false);
+			});
+		});
+		const bool HasIssuedAsyncLogin =  
+			TryAsyncLogin(FPendingLoginAction::CreateWeakLambda(this,
+				[this, PageSize, QuerySettings]()
+					{
+						FindSessionsPaged(PageSize, QuerySettings);
+					}
+				),
+				FailFindSessionsPaged
+			);
+		
+		if(HasIssuedAsyncLogin)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Async login initiated. Will find sessions after login."));
+			return;
+		}
+		
+		if (!IsLoggedIn)
+		{
+			FailFindSessionsPaged.Execute();
+			return;	
+		}
+	}
+
+	// A new search makes the cursors and prefetched page of the previous one stale
+	PagedSessionSearch = FPagedSessionSearch();
+	PagedSessionSearch.SearchId = ++LastPagedSearchId;
+	PagedSessionSearch.PageSize = PageSize;
+	// The first page is always searched in full
+	PagedSessionSearch.MaxSearchResults = FMath::Max(MaxPagedSearchResults, PageSize);
+	PagedSessionSearch.QuerySettings = QuerySettings;
+	PagedSessionSearch.bIsNextPageRequested = true;
+
+	if (!TryIssueSessionSearchPage(0))
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("FindSessionsPaged failed to issue"));
+		PagedSessionSearch = FPagedSessionSearch();
+		DispatchSessionEvent(EMPSessionEventKind::FindSessionsPage, [this]()
+		{
+			MultiplayerOnFindSessionsPageComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), FMPSessionSearchCursor(), false);
+		});
+	}
+}
+
+bool UMultiplayerSessionsSubsystem::FindSessionsNextPage(const FMPSessionSearchCursor& Cursor)
+{
+	if (!Cursor.IsValid()
+		|| Cursor.SearchId != PagedSessionSearch.SearchId
+		|| Cursor.PageIndex != PagedSessionSearch.NumDeliveredPages
+		|| PagedSessionSearch.bIsNextPageRequested)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("FindSessionsNextPage called with a stale cursor"));
+		return false;
+	}
+
+	PagedSessionSearch.bIsNextPageRequested = true;
+	if (PagedSessionSearch.bIsNextPageReady)
+	{
+		DeliverSessionSearchPage();
+		return true;
+	}
+	if (PagedSessionSearch.bIsNextPageInFlight)
+	{
+		// Delivered as soon as the prefetch completes
+		return true;
+	}
+	if (!TryIssueSessionSearchPage(Cursor.PageIndex))
+	{
+		PagedSessionSearch.bIsNextPageRequested = false;
+		return false;
+	}
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::TryIssueSessionSearchPage(const int32 PageIndex)
+{
+	// The session interface has no offset, the page is the tail of a search for every result up to it. Each page costs
+	// more than the previous one, so the results a paged search reaches are capped
+	const int32 MaxSearchResults = FMath::Min((PageIndex + 1) * PagedSessionSearch.PageSize, PagedSessionSearch.MaxSearchResults);
+	PagedSessionSearch.NextPageSearch = MakeSessionSearch(MaxSearchResults, PagedSessionSearch.QuerySettings);
+	PagedSessionSearch.bIsNextPageReady = false;
+	PagedSessionSearch.bIsNextPageInFlight = TryIssueSessionSearch(
+		PagedSessionSearch.NextPageSearch.ToSharedRef(),
+		FMPOnSessionSearchComplete::CreateUObject(
+			this, &ThisClass::OnSessionSearchPageComplete, PagedSessionSearch.SearchId, PageIndex)
+	);
+	if (!PagedSessionSearch.bIsNextPageInFlight)
+	{
+		PagedSessionSearch.NextPageSearch.Reset();
+	}
+	return PagedSessionSearch.bIsNextPageInFlight;
+}
+
+void UMultiplayerSessionsSubsystem::OnSessionSearchPageComplete(
+	const bool bWasSuccessful,
+	const int32 SearchId,
+	const int32 PageIndex
+)
+{
+	if (SearchId != PagedSessionSearch.SearchId || PageIndex != PagedSessionSearch.NumDeliveredPages)
+	{
+		// Page of a search that has since been replaced
+		return;
+	}
+
+	PagedSessionSearch.bIsNextPageInFlight = false;
+	PagedSessionSearch.bIsNextPageReady = true;
+	PagedSessionSearch.bWasNextPageSuccessful = bWasSuccessful;
+	if (PagedSessionSearch.bIsNextPageRequested)
+	{
+		DeliverSessionSearchPage();
+	}
+}
+
+void UMultiplayerSessionsSubsystem::DeliverSessionSearchPage()
+{
+	const TSharedPtr<FOnlineSessionSearch> PageSearch = PagedSessionSearch.NextPageSearch;
+	const bool bWasSuccessful = PagedSessionSearch.bWasNextPageSuccessful && PageSearch.IsValid();
+	const int32 PageIndex = PagedSessionSearch.NumDeliveredPages;
+	PagedSessionSearch.NextPageSearch.Reset();
+	PagedSessionSearch.bIsNextPageReady = false;
+	PagedSessionSearch.bIsNextPageRequested = false;
+
+	TArray<FOnlineSessionSearchResult> PageResults;
+	FMPSessionSearchCursor NextCursor;
+	if (bWasSuccessful)
+	{
+		PageResults.Reserve(PagedSessionSearch.PageSize);
+		for (const FOnlineSessionSearchResult& SearchResult : PageSearch->SearchResults)
+		{
+			if (PageResults.Num() >= PagedSessionSearch.PageSize)
+			{
+				break;
+			}
+			bool bIsAlreadyDelivered = false;
+			const FString SessionId = SearchResult.GetSessionIdStr();
+			PagedSessionSearch.DeliveredSessionIds.Add(SessionId, &bIsAlreadyDelivered);
+			if (!bIsAlreadyDelivered && !JoinBlacklist.Contains(SessionId))
+			{
+				PageResults.Add(SearchResult);
+			}
+		}
+		PagedSessionSearch.NumDeliveredPages = PageIndex + 1;
+
+		// A full search means the backend may hold more sessions, unless the cap is reached
+		if (PageSearch->SearchResults.Num() >= PageSearch->MaxSearchResults && PageSearch->MaxSearchResults < PagedSessionSearch.MaxSearchResults)
+		{
+			NextCursor = FMPSessionSearchCursor(PagedSessionSearch.SearchId, PagedSessionSearch.NumDeliveredPages);
+		}
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Delivering page %d with %d sessions"), PageIndex, PageResults.Num());
+	}
+	else
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Failed to find sessions for page %d"), PageIndex);
+		// Keep the cursor of this page so the caller can retry it
+		NextCursor = FMPSessionSearchCursor(PagedSessionSearch.SearchId, PageIndex);
+	}
+
+	const int32 DeliveredSearchId = PagedSessionSearch.SearchId;
+	DispatchSessionEvent(EMPSessionEventKind::FindSessionsPage, [this, PageResults = MoveTemp(PageResults), NextCursor, bWasSuccessful]()
+	{
+		MultiplayerOnFindSessionsPageComplete.Broadcast(PageResults, NextCursor, bWasSuccessful);
+	});
+
+	// Prefetch the next page while this one is displayed, unless a listener already asked for it or started another search
+	if (bWasSuccessful
+		&& NextCursor.IsValid()
+		&& DeliveredSearchId == PagedSessionSearch.SearchId
+		&& !PagedSessionSearch.bIsNextPageInFlight
+		&& !PagedSessionSearch.bIsNextPageReady)
+	{
+		TryIssueSessionSearchPage(NextCursor.PageIndex);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::StartSessionBrowserRefresh(
+	const int32 MaxSearchResults,
+	const FOnlineSearchSettings& QuerySettings,
+	const float MinIntervalSeconds,
+	const float MaxIntervalSeconds
+)
+{
+	if (IsSessionInterfaceInvalid()) return;
+
+	const bool bIsRefreshing = IsSessionBrowserRefreshing();
+	if (!bIsRefreshing)
+	{
+		SessionBrowserSubscription.SubscriptionId = ++LastSessionBrowserSubscriptionId;
+	}
+	++SessionBrowserSubscription.NumSubscribers;
+	// The latest subscriber's parameters apply to all, the tracked sessions are kept so the others' diffs stay consistent
+	SessionBrowserSubscription.MaxSearchResults = MaxSearchResults;
+	SessionBrowserSubscription.QuerySettings = QuerySettings;
+	// At 0 searches would be issued back to back, keeping the search lane and the backend busy
+	SessionBrowserSubscription.MinIntervalSeconds = FMath::Max3(MinIntervalSeconds, MinSessionBrowserRefreshIntervalSeconds, 0.f);
+	SessionBrowserSubscription.MaxIntervalSeconds = FMath::Max(MaxIntervalSeconds, SessionBrowserSubscription.MinIntervalSeconds);
+	SessionBrowserSubscription.IntervalSeconds = SessionBrowserSubscription.MinIntervalSeconds;
+	if (!bIsRefreshing)
+	{
+		IssueSessionBrowserRefresh();
+	}
+	else if (SessionBrowserSubscription.RefreshTickerHandle.IsValid())
+	{
+		// Waiting for the next refresh, the new interval applies from now
+		ScheduleSessionBrowserRefresh();
+	}
+}
+
+void UMultiplayerSessionsSubsystem::StopSessionBrowserRefresh()
+{
+	if (!IsSessionBrowserRefreshing())
+	{
+		return;
+	}
+	if (--SessionBrowserSubscription.NumSubscribers > 0)
+	{
+		return;
+	}
+	FTSTicker::GetCoreTicker().RemoveTicker(SessionBrowserSubscription.RefreshTickerHandle);
+	// An in-flight refresh completes against a stale subscription id and is dropped
+	SessionBrowserSubscription = FSessionBrowserSubscription();
+}
+
+bool UMultiplayerSessionsSubsystem::IsSessionBrowserRefreshing() const
+{
+	return SessionBrowserSubscription.SubscriptionId != INDEX_NONE;
+}
+
+bool UMultiplayerSessionsSubsystem::BrowseLastSearchResults(const FMPSessionBrowseSpec& Spec, FMPOnSessionsBrowsed&& OnBrowsed) const
+{
+	if (!LastSearchResults.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("No search results to browse, find sessions first"));
+		return false;
+	}
+	FMPSessionBrowsePipeline::Launch(LastSearchResults.ToSharedRef(), Spec, MoveTemp(OnBrowsed));
+	return true;
+}
+
+FMPSessionResultsSnapshot UMultiplayerSessionsSubsystem::ShareSearchResults(const TArray<FOnlineSessionSearchResult>& SearchResults) const
+{
+	if (LastSearchResults.IsValid() && LastSearchResults.Get() == &SearchResults)
+	{
+		return LastSearchResults.ToSharedRef();
+	}
+	return MakeShared<const TArray<FOnlineSessionSearchResult>, ESPMode::ThreadSafe>(SearchResults);
+}
+
+bool UMultiplayerSessionsSubsystem::IsJoinBlacklisted(const FOnlineSessionSearchResult& SearchResult) const
+{
+	return JoinBlacklist.Contains(SearchResult.GetSessionIdStr());
+}
+
+void UMultiplayerSessionsSubsystem::ClearJoinBlacklist()
+{
+	JoinBlacklist.Reset();
+}
+
+float UMultiplayerSessionsSubsystem::GetJoinBlacklistSeconds(const EOnJoinSessionCompleteResult::Type Reason) const
+{
+	switch (Reason)
+	{
+	case EOnJoinSessionCompleteResult::SessionIsFull:
+		return JoinBlacklistSessionIsFullSeconds;
+	case EOnJoinSessionCompleteResult::SessionDoesNotExist:
+		return JoinBlacklistSessionDoesNotExistSeconds;
+	case EOnJoinSessionCompleteResult::CouldNotRetrieveAddress:
+		return JoinBlacklistCouldNotRetrieveAddressSeconds;
+	default:
+		return 0.f;
+	}
+}
+
+void UMultiplayerSessionsSubsystem::RemoveJoinBlacklisted(TArray<FMPFederatedSearchResult>& SearchResults) const
+{
+	if (JoinBlacklist.Num() == 0)
+	{
+		return;
+	}
+	SearchResults.RemoveAll([this](const FMPFederatedSearchResult& SearchResult)
+	{
+		return IsJoinBlacklisted(SearchResult.SearchResult);
+	});
+}
+
+void UMultiplayerSessionsSubsystem::IssueSessionBrowserRefresh()
+{
+	if (!IsSessionBrowserRefreshing()) return;
+
+	if (!IsLoggedIn)
+	{
+		const int32 SubscriptionId = SessionBrowserSubscription.SubscriptionId;
+		const bool HasIssuedAsyncLogin = TryAsyncLogin(
+			FPendingLoginAction::CreateWeakLambda(this, [this, SubscriptionId]()
+			{
+				if (SubscriptionId == SessionBrowserSubscription.SubscriptionId)
+				{
+					IssueSessionBrowserRefresh();
+				}
+			}),
+			FPendingLoginAction::CreateWeakLambda(this, [this, SubscriptionId]()
+			{
+				UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed. Can't refresh the session browser"));
+				OnSessionBrowserRefreshComplete(false, SubscriptionId);
+			})
+		);
+		if (HasIssuedAsyncLogin)
+		{
+			return;
+		}
+		if (!IsLoggedIn)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed. Can't refresh the session browser"));
+			OnSessionBrowserRefreshComplete(false, SessionBrowserSubscription.SubscriptionId);
+			return;
+		}
+	}
+
+	SessionBrowserSubscription.Search = MakeSessionSearch(SessionBrowserSubscription.MaxSearchResults, SessionBrowserSubscription.QuerySettings);
+	if (!TryIssueSessionSearch(
+		SessionBrowserSubscription.Search.ToSharedRef(),
+		FMPOnSessionSearchComplete::CreateUObject(
+			this, &ThisClass::OnSessionBrowserRefreshComplete, SessionBrowserSubscription.SubscriptionId)
+	))
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("SessionInterface->FindSessions failed for the session browser refresh"));
+		OnSessionBrowserRefreshComplete(false, SessionBrowserSubscription.SubscriptionId);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnSessionBrowserRefreshComplete(const bool bWasSuccessful, const int32 SubscriptionId)
+{
+	if (SubscriptionId != SessionBrowserSubscription.SubscriptionId)
+	{
+		return;
+	}
+
+	const TSharedPtr<FOnlineSessionSearch> Search = MoveTemp(SessionBrowserSubscription.Search);
+	FSessionBrowserSubscription& Subscription = SessionBrowserSubscription;
+	if (!bWasSuccessful || !Search.IsValid())
+	{
+		// Keep the tracked results, a failed search says nothing about the sessions; back off like an unchanged refresh
+		Subscription.IntervalSeconds = FMath::Min(Subscription.IntervalSeconds * 2.f, Subscription.MaxIntervalSeconds);
+		DispatchSessionEvent(EMPSessionEventKind::SessionBrowserUpdated, [this]()
+		{
+			MultiplayerOnSessionBrowserUpdated.Broadcast(FMPSessionBrowserDiff(), false);
+		});
+	}
+	else
+	{
+		// A blacklisted session is reported as removed, and added back once its entry expires
+		JoinBlacklist.Filter(Search->SearchResults);
+		FMPSessionBrowserDiff Diff = Subscription.ResultTracker.Update(Search->SearchResults);
+		if (Diff.IsEmpty())
+		{
+			Subscription.IntervalSeconds = FMath::Min(Subscription.IntervalSeconds * 2.f, Subscription.MaxIntervalSeconds);
+		}
+		else
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Verbose, TEXT("Session browser: %d added, %d removed, %d changed"),
+				Diff.Added.Num(), Diff.RemovedSessionIds.Num(), Diff.Changed.Num());
+			Subscription.IntervalSeconds = Subscription.MinIntervalSeconds;
+			// Diffs build on each other, they are never coalesced
+			DispatchSessionEvent(EMPSessionEventKind::SessionBrowserUpdated, [this, Diff = MoveTemp(Diff)]()
+			{
+				MultiplayerOnSessionBrowserUpdated.Broadcast(Diff, true);
+			});
+		}
+	}
+
+	// A listener may have stopped or restarted the subscription
+	if (SubscriptionId == SessionBrowserSubscription.SubscriptionId)
+	{
+		ScheduleSessionBrowserRefresh();
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ScheduleSessionBrowserRefresh()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(SessionBrowserSubscription.RefreshTickerHandle);
+	SessionBrowserSubscription.RefreshTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateWeakLambda(this, [this](float)
+		{
+			SessionBrowserSubscription.RefreshTickerHandle.Reset();
+			IssueSessionBrowserRefresh();
+			return false;
+		}),
+		SessionBrowserSubscription.IntervalSeconds
+	);
+}
+
+void UMultiplayerSessionsSubsystem::JoinSession(const FOnlineSessionSearchResult& SearchResult)
+{
+	ScheduleOperation(
+		EMPSessionOperation::Join,
+		[this, SearchResult]()
+		{
+			IssueJoinSession(SearchResult);
+		},
+		[this]()
+		{
+			BroadcastJoinSessionResult(NAME_GameSession, EOnJoinSessionCompleteResult::UnknownError);
+		}
+	);
+}
+
+void UMultiplayerSessionsSubsystem::JoinFederatedSession(const FMPFederatedSearchResult& SearchResult)
+{
+	ScheduleOperation(
+		EMPSessionOperation::Join,
+		[this, SearchResult]()
+		{
+			IssueJoinFederatedSession(SearchResult);
+		},
+		[this]()
+		{
+			BroadcastJoinSessionResult(NAME_GameSession, EOnJoinSessionCompleteResult::UnknownError);
+		}
+	);
+}
+
+void UMultiplayerSessionsSubsystem::IssueJoinFederatedSession(const FMPFederatedSearchResult& SearchResult)
+{
+	if (SearchResult.OnlineSubsystemName == OnlineSubsystemName)
+	{
+		IssueJoinSession(SearchResult.SearchResult);
+		return;
+	}
+	const FName PreviousOnlineSubsystemName = OnlineSubsystemName;
+	if (!TrySwitchOnlineSubsystem(SearchResult.OnlineSubsystemName))
+	{
+		BroadcastJoinSessionResult(NAME_GameSession, EOnJoinSessionCompleteResult::UnknownError);
+		return;
+	}
+	// Joining from a backend switched to earlier still goes back to the first one
+	if (HomeOnlineSubsystemName.IsNone())
+	{
+		HomeOnlineSubsystemName = PreviousOnlineSubsystemName;
+	}
+	if (!IsLoggedIn)
+	{
+		const bool HasIssuedAsyncLogin = TryAsyncLogin(
+			FPendingLoginAction::CreateWeakLambda(this, [this, SearchResult]()
+			{
+				IssueJoinSession(SearchResult.SearchResult);
+			}),
+			FPendingLoginAction::CreateWeakLambda(this, [this]()
+			{
+				UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed on '%s'. Can't join the session"), *OnlineSubsystemName.ToString());
+				BroadcastJoinSessionResult(NAME_GameSession, EOnJoinSessionCompleteResult::UnknownError);
+			})
+		);
+		if (HasIssuedAsyncLogin)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Async login initiated on '%s'. Will join the session after login."), *OnlineSubsystemName.ToString());
+			return;
+		}
+		if (!IsLoggedIn)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed on '%s'. Can't join the session"), *OnlineSubsystemName.ToString());
+			BroadcastJoinSessionResult(NAME_GameSession, EOnJoinSessionCompleteResult::UnknownError);
+			return;
+		}
+	}
+	IssueJoinSession(SearchResult.SearchResult);
+}
+
+bool UMultiplayerSessionsSubsystem::TrySwitchOnlineSubsystem(const FName NewOnlineSubsystemName)
+{
+	IOnlineSubsystem* Subsystem = IOnlineSubsystem::Get(NewOnlineSubsystemName);
+	if (Subsystem == nullptr || !Subsystem->GetSessionInterface().IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Online subsystem '%s' isn't available"), *NewOnlineSubsystemName.ToString());
+		return false;
+	}
+	// Bindings and cached state belong to the interfaces in use, they can't be carried over while anything is in flight
+	const bool bHasNamedSession = SessionInterface.IsValid() && SessionInterface->GetNamedSession(NAME_GameSession) != nullptr;
 	if (
-		const FNamedOnlineSession* ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession);
-		ExistingSession != nullptr
+		GetSessionState() != EMPSessionState::Idle
+		|| bHasNamedSession
+		|| InFlightSessionSearch.IsValid()
+		|| SessionPool.IsValid()
+		|| StoppingSessionPool.IsValid()
+		|| IsSessionBrowserRefreshing()
+		|| LoginCompleteBinding.IsBound()
 	)
 	{
-		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Session already exists"));
-		bCreateSessionOnDestroy = true;
-		LastNumPublicConnections = NumPublicConnections;
-		DestroySession();
-		return true;
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Can't switch to online subsystem '%s' with a session or a search in flight"), *NewOnlineSubsystemName.ToString());
+		return false;
+	}
+
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Switching Online Subsystem ( OSS ) from '%s' to '%s'"), *OnlineSubsystemName.ToString(), *NewOnlineSubsystemName.ToString());
+	OnlineSubsystemName = Subsystem->GetSubsystemName();
+	SessionInterface = Subsystem->GetSessionInterface();
+	IdentityInterface = Subsystem->GetIdentityInterface();
+	IsLoggedIn = IdentityInterface.IsValid() && IdentityInterface->GetLoginStatus(0) == ELoginStatus::LoggedIn;
+	if (OperationScheduler)
+	{
+		OperationScheduler->SetBackendName(OnlineSubsystemName);
+	}
+	// Results of the previous backend can't be joined through this one
+	LastSessionSearch.Reset();
+	LastSearchResults.Reset();
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::RestoreHomeOnlineSubsystem()
+{
+	if (HomeOnlineSubsystemName.IsNone())
+	{
+		return;
+	}
+	// Refused while something is still in flight, tried again when the next session is left
+	if (TrySwitchOnlineSubsystem(HomeOnlineSubsystemName))
+	{
+		HomeOnlineSubsystemName = NAME_None;
+	}
+}
+
+void UMultiplayerSessionsSubsystem::IssueJoinSession(const FOnlineSessionSearchResult& SearchResult)
+{
+	if (Metrics)
+	{
+		Metrics->OnOperationStarted(EMPSessionOperation::Join);
+	}
+	if(!SessionInterface.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("SessionInterface is not valid"));
+		BroadcastJoinSessionResult(NAME_GameSession, EOnJoinSessionCompleteResult::UnknownError);
+		return;
+	}
+	if (IsServerHostingMode())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Dedicated servers cannot join sessions"));
+		BroadcastJoinSessionResult(NAME_GameSession, EOnJoinSessionCompleteResult::UnknownError);
+		return;
+	}
+
+	JoinSessionCompleteBinding = FMPScopedDelegateBinding::ForInterface(SessionInterface, SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate), &IOnlineSession::ClearOnJoinSessionCompleteDelegate_Handle);
+	PendingJoinSearchResult = MakeShared<const FOnlineSessionSearchResult>(SearchResult);
+
+	// Overlap the backend join latency with loading the host's map from disk
+	if (FString DestinationMap; bPreloadDestinationMapOnJoin && FMPSessionSchema::Get<FMPMapNameKey>(SearchResult.Session.SessionSettings, DestinationMap))
+	{
+		StartDestinationMapPreload(DestinationMap);
+	}
+
+	// Without a local player (headless benchmarks) join as ServerHostingPlayerNum, as searches do
+	const FUniqueNetIdPtr JoiningPlayerId = GetFirstLocalPlayerNetId();
+	FMPOnlineTrafficEvent JoinCall(EMPOnlineTrafficEvent::JoinSessionCall, NAME_GameSession);
+	if (OnlineTrafficRecorder)
+	{
+		JoinCall.SearchResults.Add(SearchResult);
+	}
+	const bool bJoinSuccess = IssueOnlineCall(MoveTemp(JoinCall), [this, &JoiningPlayerId, &SearchResult]()
+	{
+		return JoiningPlayerId.IsValid()
+			? SessionInterface->JoinSession(*JoiningPlayerId, NAME_GameSession, SearchResult)
+			: SessionInterface->JoinSession(ServerHostingPlayerNum, NAME_GameSession, SearchResult);
+	});
+	if (!bJoinSuccess)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("MultiplayerSessionSubsystem: Failed to join session"));
+	}
+	else
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("MultiplayerSessionSubsystem: Joining session %s"), *SearchResult.GetSessionIdStr());
+		SetSessionState(EMPSessionState::Creating);
+	}
+	if (!bJoinSuccess)
+	{
+		CancelDestinationMapPreload();
+		JoinSessionCompleteBinding.Reset();
+		PendingJoinSearchResult.Reset();
+		BroadcastJoinSessionResult(NAME_GameSession, EOnJoinSessionCompleteResult::UnknownError);
 	}
-	return false;
 }
 
-bool UMultiplayerSessionsSubsystem::IsSessionInterfaceInvalid() const
+bool UMultiplayerSessionsSubsystem::JoinBestOf(const TArray<FOnlineSessionSearchResult>& Candidates, const FMPJoinBestOfPolicy& Policy)
 {
-	if(!SessionInterface.IsValid())
+	if (IsSessionInterfaceInvalid()) return false;
+	if (JoinBestOfState.bIsActive || bIsReconnecting)
 	{
-		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("SessionInterface is not valid"));
-		return true;
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("JoinBestOf: already joining with fallback or reconnecting"));
+		return false;
 	}
-	return false;
+	if (Candidates.Num() == 0)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("JoinBestOf: no candidates to join"));
+		return false;
+	}
+
+	JoinBestOfState = FJoinBestOfState();
+	JoinBestOfState.bIsActive = true;
+	JoinBestOfState.Candidates = Candidates;
+	JoinBestOfState.Policy = Policy;
+	JoinBestOfState.StartTime = FPlatformTime::Seconds();
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("JoinBestOf: %d candidates, at most %d attempts"),
+		Candidates.Num(), Policy.MaxAttempts > 0 ? FMath::Min(Policy.MaxAttempts, Candidates.Num()) : Candidates.Num());
+	AttemptNextJoinBestOf();
+	return true;
 }
 
-bool UMultiplayerSessionsSubsystem::IsIdentityInterfaceInvalid() const
+void UMultiplayerSessionsSubsystem::AttemptNextJoinBestOf()
 {
-	if(!IdentityInterface.IsValid())
+	FJoinBestOfState& State = JoinBestOfState;
+	const int32 MaxAttempts = State.Policy.MaxAttempts > 0 ? State.Policy.MaxAttempts : State.Candidates.Num();
+	while (State.NextCandidateIndex < State.Candidates.Num() && State.Result.NumAttempts < MaxAttempts)
 	{
-		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("IdentityInterface is not valid"));
-		return true;
+		const int32 CandidateIndex = State.NextCandidateIndex++;
+		const FOnlineSessionSearchResult& Candidate = State.Candidates[CandidateIndex];
+		if (!Candidate.IsValid() || IsJoinBlacklisted(Candidate))
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("JoinBestOf: skipping session %s, it is invalid or recently failed to join"), *Candidate.GetSessionIdStr());
+			++State.Result.NumSkipped;
+			continue;
+		}
+		// The join goes ahead with the searched result if the lookup can't be issued
+		if (State.Policy.bReverifySlots && TryAsyncFindSessionById(
+			Candidate.GetSessionIdStr(),
+			FOnSingleSessionResultCompleteDelegate::CreateUObject(this, &ThisClass::OnJoinBestOfCandidateFound, CandidateIndex)
+		))
+		{
+			return;
+		}
+		IssueJoinBestOfAttempt(CandidateIndex, Candidate);
+		return;
 	}
-	return false;
+
+	FinishJoinBestOf(
+		NAME_GameSession,
+		State.Result.AttemptResults.Num() > 0 ? State.Result.AttemptResults.Last() : EOnJoinSessionCompleteResult::SessionDoesNotExist
+	);
 }
 
-bool UMultiplayerSessionsSubsystem::TryAsyncCreateSession(
-	const FMPSessionSettings& SessionSettings,
-	const TMap<FName, FString>& ExtraSessionSettings
+void UMultiplayerSessionsSubsystem::OnJoinBestOfCandidateFound(
+	int32 LocalUserNum,
+	bool bWasSuccessful,
+	const FOnlineSessionSearchResult& SearchResult,
+	int32 CandidateIndex
 )
 {
-	CreateSessionCompleteDelegateHandle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate);
-	
-	SetupLastSessionSettings(SessionSettings, ExtraSessionSettings);
-	
-	bool bHasSuccessfullyIssuedAsyncCreateSession = false;
-	if (
-		const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-		SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, *LastSessionSettings)
-	)
+	if (!JoinBestOfState.bIsActive)
 	{
-		bHasSuccessfullyIssuedAsyncCreateSession = true;
+		return;
 	}
-	else
+	const FString SessionId = JoinBestOfState.Candidates[CandidateIndex].GetSessionIdStr();
+	// A lookup is not a join, skipped candidates are left out of the blacklist
+	if (!bWasSuccessful || !SearchResult.IsValid())
 	{
-		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("JoinBestOf: skipping session %s, it no longer exists"), *SessionId);
+		++JoinBestOfState.Result.NumSkipped;
+		AttemptNextJoinBestOf();
+		return;
 	}
-	return bHasSuccessfullyIssuedAsyncCreateSession;
+	if (SearchResult.Session.NumOpenPublicConnections <= 0)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("JoinBestOf: skipping session %s, it is full"), *SessionId);
+		++JoinBestOfState.Result.NumSkipped;
+		AttemptNextJoinBestOf();
+		return;
+	}
+	IssueJoinBestOfAttempt(CandidateIndex, SearchResult);
 }
 
-void UMultiplayerSessionsSubsystem::SetupLastSessionSettings(
-	const FMPSessionSettings& SessionSettings,
-	const TMap<FName, FString>& ExtraSessionSettings
-)
+void UMultiplayerSessionsSubsystem::IssueJoinBestOfAttempt(const int32 CandidateIndex, const FOnlineSessionSearchResult& SearchResult)
 {
-	if (!LastSessionSettings.IsValid())
+	JoinBestOfState.AttemptedCandidateIndex = CandidateIndex;
+	++JoinBestOfState.Result.NumAttempts;
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("JoinBestOf: attempt %d, joining candidate %d (session %s)"),
+		JoinBestOfState.Result.NumAttempts, CandidateIndex, *SearchResult.GetSessionIdStr());
+	JoinSession(SearchResult);
+}
+
+void UMultiplayerSessionsSubsystem::OnJoinBestOfAttemptComplete(const FName SessionName, const EOnJoinSessionCompleteResult::Type Result)
+{
+	FJoinBestOfState& State = JoinBestOfState;
+	const int32 CandidateIndex = State.AttemptedCandidateIndex;
+	State.AttemptedCandidateIndex = INDEX_NONE;
+	State.Result.AttemptResults.Add(Result);
+	if (Result == EOnJoinSessionCompleteResult::Success)
 	{
-		LastSessionSettings = MakeShareable(new FOnlineSessionSettings);
+		State.Result.JoinedCandidateIndex = CandidateIndex;
+		FinishJoinBestOf(SessionName, Result);
+		return;
 	}
-	LastSessionSettings->bIsLANMatch = SessionSettings.bUseLAN;
-	LastSessionSettings->bIsDedicated = SessionSettings.bIsDedicatedServer;
-	LastSessionSettings->NumPublicConnections = SessionSettings.PublicConnections;
-	LastSessionSettings->bAllowJoinInProgress = SessionSettings.bAllowJoinInProgress;
-	LastSessionSettings->bAllowJoinViaPresence = SessionSettings.bAllowJoinViaPresence;
-	LastSessionSettings->bShouldAdvertise = SessionSettings.bShouldAdvertise;
-	LastSessionSettings->bUsesPresence = SessionSettings.bUsePresence;
-	LastSessionSettings->bUseLobbiesIfAvailable = SessionSettings.bUseLobbiesIfAvailable;
-	LastSessionSettings->bUseLobbiesVoiceChatIfAvailable = SessionSettings.bUseLobbiesIfAvailable;
-	LastSessionSettings->bAllowInvites = SessionSettings.bAllowInvites;
-	
-	 for (const auto& ExtraSessionSetting : ExtraSessionSettings)
-	 {
-	 	const FName SettingName = ExtraSessionSetting.Key;
-		const FString SettingValue = ExtraSessionSetting.Value;
-	 	LastSessionSettings->Set(SettingName, SettingValue, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
-	 }
+
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("JoinBestOf: attempt %d failed (%s)"), State.Result.NumAttempts, LexToString(Result));
+	// The reasons the blacklist keeps are the ones tied to the candidate, the others would fail on every candidate
+	if (!State.Policy.bFailOverOnAnyError && !FMPJoinBlacklist::IsBlacklistedReason(Result))
+	{
+		FinishJoinBestOf(SessionName, Result);
+		return;
+	}
+	AttemptNextJoinBestOf();
 }
 
+void UMultiplayerSessionsSubsystem::FinishJoinBestOf(const FName SessionName, const EOnJoinSessionCompleteResult::Type Result)
+{
+	FJoinBestOfState& State = JoinBestOfState;
+	State.bIsActive = false;
+	State.Result.Result = Result;
+	State.Result.Seconds = FPlatformTime::Seconds() - State.StartTime;
+	State.Candidates.Empty();
+	// Moved out first, listeners may start another JoinBestOf
+	FMPJoinBestOfResult BestOfResult = MoveTemp(State.Result);
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("JoinBestOf %s after %d attempts (%d candidates skipped) in %.0f ms"),
+		BestOfResult.WasSuccessful() ? TEXT("succeeded") : TEXT("failed"),
+		BestOfResult.NumAttempts, BestOfResult.NumSkipped, BestOfResult.Seconds * 1000.0);
+
+	DispatchSessionEvent(EMPSessionEventKind::JoinSession, [this, SessionName, Result]()
+	{
+		MultiplayerOnJoinSessionComplete.Broadcast(SessionName, Result);
+	});
+	DispatchSessionEvent(EMPSessionEventKind::JoinBestOf, [this, BestOfResult = MoveTemp(BestOfResult)]()
+	{
+		MultiplayerOnJoinBestOfComplete.Broadcast(BestOfResult);
+	});
+}
 
-bool UMultiplayerSessionsSubsystem::TryAsyncFindSessions(const int32 MaxSearchResults)
+bool UMultiplayerSessionsSubsystem::Reconnect()
 {
-	bool bHasSuccessfullyIssuedAsyncFindSessions = false;
-	if (const UWorld* World = GetWorld())
+	if (IsSessionInterfaceInvalid()) return false;
+	if (IsServerHostingMode())
 	{
-		SetupLastSessionSearchOptions(MaxSearchResults);
-		
-		FindSessionsCompleteDelegateHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate);
-		if (LastSessionSearch->bIsLanQuery)
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Dedicated servers cannot reconnect to sessions"));
+		return false;
+	}
+	if (!CanReconnect())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Reconnect: no session to reconnect to"));
+		return false;
+	}
+	if (bIsReconnecting)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Reconnect: already reconnecting"));
+		return true;
+	}
+
+	bIsReconnecting = true;
+	bHasReconnectLookedUp = false;
+	ReconnectStartTime = FPlatformTime::Seconds();
+
+	// Still registered locally, e.g. after a network failure: no round trip at all
+	if (SessionInterface->GetNamedSession(NAME_GameSession) != nullptr)
+	{
+		FString Address;
+		if (GetResolvedConnectString(NAME_GameSession, Address))
 		{
-			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Will perform Session Search in Lan"));
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Reconnect: session %s still registered, travelling to %s"), *ReconnectInfo.SessionId, *Address);
+			FinishReconnect(TryFirstLocalPlayerControllerClientTravel(Address));
+			return true;
 		}
-		else
+
+		// Registered but unusable, it has to go before the session can be joined again. Scheduled like any destroy so it
+		// does not interleave with the session operations already queued
+		ScheduleOperation(
+			EMPSessionOperation::Destroy,
+			[this]()
+			{
+				IssueReconnectDestroySession();
+			},
+			[this]()
+			{
+				// Rejected because the session is already gone
+				ContinueReconnect();
+			},
+			EMPSessionOperationPriority::Normal,
+			ReconnectDestroyMergeKey
+		);
+		return true;
+	}
+
+	ContinueReconnect();
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::IssueReconnectDestroySession()
+{
+	if (Metrics)
+	{
+		Metrics->OnOperationStarted(EMPSessionOperation::Destroy);
+	}
+	// May have gone while the destroy was queued
+	if (!SessionInterface.IsValid() || SessionInterface->GetNamedSession(NAME_GameSession) == nullptr)
+	{
+		CompleteOperation(EMPSessionOperation::Destroy, true);
+		ContinueReconnect();
+		return;
+	}
+
+	bReconnectAfterDestroy = true;
+	DestroySessionCompleteBinding = FMPScopedDelegateBinding::ForInterface(SessionInterface, SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate), &IOnlineSession::ClearOnDestroySessionCompleteDelegate_Handle);
+	if (!IssueOnlineCall(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::DestroySessionCall, NAME_GameSession), [this]() { return SessionInterface->DestroySession(NAME_GameSession); }))
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Reconnect: failed to destroy the stale session"));
+		bReconnectAfterDestroy = false;
+		DestroySessionCompleteBinding.Reset();
+		CompleteOperation(EMPSessionOperation::Destroy, false);
+		FinishReconnect(false);
+		return;
+	}
+	SetSessionState(EMPSessionState::Destroying);
+}
+
+bool UMultiplayerSessionsSubsystem::CanReconnect() const
+{
+	return !ReconnectInfo.SessionId.IsEmpty();
+}
+
+void UMultiplayerSessionsSubsystem::ClearReconnectInfo()
+{
+	ReconnectInfo = FReconnectInfo();
+	if (bPersistReconnectInfo)
+	{
+		UGameplayStatics::DeleteGameInSlot(UMPReconnectSaveGame::SlotName, 0);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ContinueReconnect()
+{
+	if (!IsLoggedIn)
+	{
+		// After a restart the player has to log in before the session can be looked up
+		const bool HasIssuedAsyncLogin = TryAsyncLogin(
+			FPendingLoginAction::CreateUObject(this, &ThisClass::ContinueReconnect),
+			FPendingLoginAction::CreateUObject(this, &ThisClass::FinishReconnect, false)
+		);
+		if (HasIssuedAsyncLogin)
 		{
-			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Will perform Session Search in Web"));
+			return;
 		}
-		
-		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("List of query search params (name, value):"));
-		for (const auto& QuerySetting: LastSessionSearch->QuerySettings.SearchParams)
+		if (!IsLoggedIn)
 		{
-			const FName SearchSettingName = QuerySetting.Key;
-			const FOnlineSessionSearchParam SearchParam = QuerySetting.Value;
-			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("(%s: %s)"), *SearchSettingName.ToString(), *SearchParam.Data.ToString());
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed. Can't reconnect"));
+			FinishReconnect(false);
+			return;
 		}
-		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("****************************************"));
-		
-		if(
-			const ULocalPlayer* LocalPlayer = World->GetFirstLocalPlayerFromController();
-			!SessionInterface->FindSessions(*LocalPlayer->GetPreferredUniqueNetId(), LastSessionSearch.ToSharedRef())
-		)
-		{
-			SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+	}
 
-			// broadcast that we failed to find sessions
-			const TArray<FOnlineSessionSearchResult> EmptySearchResults;
-			MultiplayerOnFindSessionsComplete.Broadcast(EmptySearchResults, false);
-			
-			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("SessionInterface->FindSessions failed"));
-		}
-		else
-		{
-			bHasSuccessfullyIssuedAsyncFindSessions = true;
-		}
+	// Joining the cached result costs a single round trip, JoinSession reports through FinishReconnect
+	if (ReconnectInfo.SearchResult.IsValid() && ReconnectInfo.SearchResult->IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Reconnect: joining cached session %s"), *ReconnectInfo.SessionId);
+		JoinSession(*ReconnectInfo.SearchResult);
+		return;
 	}
-	else
+
+	LookUpReconnectSession();
+}
+
+void UMultiplayerSessionsSubsystem::LookUpReconnectSession()
+{
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Reconnect: looking up session %s"), *ReconnectInfo.SessionId);
+	bHasReconnectLookedUp = true;
+	if (!TryAsyncFindSessionById(
+		ReconnectInfo.SessionId,
+		FOnSingleSessionResultCompleteDelegate::CreateUObject(this, &ThisClass::OnReconnectSessionFound)
+	))
 	{
-		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("World is null"));
+		FinishReconnect(false);
 	}
-	return bHasSuccessfullyIssuedAsyncFindSessions;
 }
 
-void UMultiplayerSessionsSubsystem::SetupLastSessionSearchOptions(const int32 MaxSearchResults)
+void UMultiplayerSessionsSubsystem::OnReconnectSessionFound(
+	int32 LocalUserNum,
+	bool bWasSuccessful,
+	const FOnlineSessionSearchResult& SearchResult
+)
+{
+	if (!bIsReconnecting)
+	{
+		return;
+	}
+	if (!bWasSuccessful || !SearchResult.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Reconnect: session %s no longer exists"), *ReconnectInfo.SessionId);
+		ClearReconnectInfo();
+		FinishReconnect(false);
+		return;
+	}
+	JoinSession(SearchResult);
+}
+
+void UMultiplayerSessionsSubsystem::FinishReconnect(const bool bWasSuccessful)
 {
-	LastSessionSearch = MakeShareable(new FOnlineSessionSearch);
-	LastSessionSearch->bIsLanQuery = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL";
-	LastSessionSearch->MaxSearchResults = MaxSearchResults;
-	LastSessionSearch->QuerySettings.Set(SEARCH_PRESENCE, true, EOnlineComparisonOp::Equals);
-	LastSessionSearch->QuerySettings.Set(SEARCH_LOBBIES, true, EOnlineComparisonOp::Equals);
+	if (!bIsReconnecting)
+	{
+		return;
+	}
+	bIsReconnecting = false;
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Reconnect %s after %.0f ms"),
+		bWasSuccessful ? TEXT("succeeded") : TEXT("failed"), (FPlatformTime::Seconds() - ReconnectStartTime) * 1000.0);
+	DispatchSessionEvent(EMPSessionEventKind::Reconnect, [this, bWasSuccessful]()
+	{
+		MultiplayerOnReconnectComplete.Broadcast(bWasSuccessful);
+	});
 }
 
-bool UMultiplayerSessionsSubsystem::ExecutePendingLoginActions()
+void UMultiplayerSessionsSubsystem::BroadcastJoinSessionResult(const FName SessionName, const EOnJoinSessionCompleteResult::Type Result)
 {
-	bool HasAnyActionBeenExecuted = false;
-	while (!PendingLoginActionsQueue.empty())
+	CompleteOperation(EMPSessionOperation::Join, Result == EOnJoinSessionCompleteResult::Success);
+	// A backend switched to for this join is only kept while its session is
+	if (Result != EOnJoinSessionCompleteResult::Success)
 	{
-		FPendingLoginAction PendingAction = PendingLoginActionsQueue.front();
-		PendingLoginActionsQueue.pop();
-		if(PendingAction.ExecuteIfBound())
+		RestoreHomeOnlineSubsystem();
+	}
+	// Attempts of JoinBestOf report once it is done, a failed one only moves on to the next candidate
+	if (JoinBestOfState.bIsActive && JoinBestOfState.AttemptedCandidateIndex != INDEX_NONE)
+	{
+		OnJoinBestOfAttemptComplete(SessionName, Result);
+		return;
+	}
+	if (!bIsReconnecting)
+	{
+		DispatchSessionEvent(EMPSessionEventKind::JoinSession, [this, SessionName, Result]()
 		{
-			HasAnyActionBeenExecuted = true;
-		}
+			MultiplayerOnJoinSessionComplete.Broadcast(SessionName, Result);
+		});
+		return;
 	}
-	return HasAnyActionBeenExecuted;
+
+	// The cached result may be stale (session moved host, address changed), the session is looked up by id once instead
+	if (Result != EOnJoinSessionCompleteResult::Success && !bHasReconnectLookedUp)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Reconnect: joining the cached session %s failed (%s)"), *ReconnectInfo.SessionId, LexToString(Result));
+		ReconnectInfo.SearchResult.Reset();
+		LookUpReconnectSession();
+		return;
+	}
+
+	// Joins issued by Reconnect travel on their own, listeners of the join delegate would travel a second time
+	FString Address;
+	const bool bHasJoined = Result == EOnJoinSessionCompleteResult::Success
+		&& GetResolvedConnectString(SessionName, Address)
+		&& TryFirstLocalPlayerControllerClientTravel(Address);
+	FinishReconnect(bHasJoined);
 }
 
-void UMultiplayerSessionsSubsystem::ClearPendingLoginActions()
+void UMultiplayerSessionsSubsystem::RememberJoinedSession(const FOnlineSessionSearchResult& SearchResult)
 {
-	std::queue<FPendingLoginAction>().swap(PendingLoginActionsQueue);
+	ReconnectInfo.SessionId = SearchResult.GetSessionIdStr();
+	ReconnectInfo.SearchResult = MakeShared<const FOnlineSessionSearchResult>(SearchResult);
+
+	if (bPersistReconnectInfo)
+	{
+		UMPReconnectSaveGame* SaveGame = Cast<UMPReconnectSaveGame>(UGameplayStatics::CreateSaveGameObject(UMPReconnectSaveGame::StaticClass()));
+		SaveGame->SessionId = ReconnectInfo.SessionId;
+		SaveGame->SavedAtUtc = FDateTime::UtcNow();
+		UGameplayStatics::AsyncSaveGameToSlot(SaveGame, UMPReconnectSaveGame::SlotName, 0);
+	}
 }
 
-void UMultiplayerSessionsSubsystem::FindSessions(const int32 MaxSearchResults)
+void UMultiplayerSessionsSubsystem::LoadPersistedReconnectInfo()
+{
+	UGameplayStatics::AsyncLoadGameFromSlot(
+		UMPReconnectSaveGame::SlotName,
+		0,
+		FAsyncLoadGameFromSlotDelegate::CreateWeakLambda(this, [this](const FString&, const int32, USaveGame* LoadedGame)
+		{
+			const UMPReconnectSaveGame* SaveGame = Cast<UMPReconnectSaveGame>(LoadedGame);
+			if (SaveGame == nullptr || !ReconnectInfo.SessionId.IsEmpty())
+			{
+				return;
+			}
+			if ((FDateTime::UtcNow() - SaveGame->SavedAtUtc).GetTotalSeconds() > PersistedReconnectInfoMaxAgeSeconds)
+			{
+				UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Ignoring saved reconnect info, it is too old"));
+				return;
+			}
+			ReconnectInfo.SessionId = SaveGame->SessionId;
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Loaded reconnect info for session %s"), *ReconnectInfo.SessionId);
+		})
+	);
+}
+
+void UMultiplayerSessionsSubsystem::JoinSessionById(const FString& SessionId)
 {
 	if (IsSessionInterfaceInvalid()) return;
-	
+
 	if (!IsLoggedIn)
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("User not logged in. Attempting to log in."));
-		const bool HasIssuedAsyncLogin =  
-			TryAsyncLogin(FPendingLoginAction::CreateLambda(
-				[this, MaxSearchResults]()
+		const bool HasIssuedAsyncLogin =
+			TryAsyncLogin(FPendingLoginAction::CreateWeakLambda(this,
+				[this, SessionId]()
 					{
-						FindSessions(MaxSearchResults);
+						JoinSessionById(SessionId);
 					}
-				)
+				),
+				FPendingLoginAction::CreateWeakLambda(this, [this]()
+				{
+					UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed. Can't join session"));
+					BroadcastJoinSessionByIdFailure(EOnJoinSessionCompleteResult::UnknownError);
+				})
 			);
-		
+
 		if(HasIssuedAsyncLogin)
 		{
-			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Async login initiated. Will find sessions after login."));
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Async login initiated. Will join session after login."));
 			return;
 		}
-		
-		if (!HasIssuedAsyncLogin && !IsLoggedIn)
+
+		if (!IsLoggedIn)
 		{
-			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed. Can't find sessions"));
-			MultiplayerOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult> (),false);
-			return;	
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Login Failed. Can't join session"));
+			BroadcastJoinSessionByIdFailure(EOnJoinSessionCompleteResult::UnknownError);
+			return;
 		}
 	}
-	
 
-	if (!TryAsyncFindSessions(MaxSearchResults))
-	{
-		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("FindSessions failed to issue"));
-		MultiplayerOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
-	}
-	else
+	if (!TryAsyncFindSessionById(
+		SessionId,
+		FOnSingleSessionResultCompleteDelegate::CreateUObject(this, &ThisClass::OnJoinSessionByIdFound)
+	))
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Failed to issue the lookup of session %s"), *SessionId);
+		BroadcastJoinSessionByIdFailure(EOnJoinSessionCompleteResult::UnknownError);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnJoinSessionByIdFound(
+	int32 LocalUserNum,
+	bool bWasSuccessful,
+	const FOnlineSessionSearchResult& SearchResult
+)
+{
+	if (!bWasSuccessful || !SearchResult.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Session to join by id was not found"));
+		BroadcastJoinSessionByIdFailure(EOnJoinSessionCompleteResult::SessionDoesNotExist);
+		return;
+	}
+	JoinSession(SearchResult);
+}
+
+/**
+ * Failures before JoinSession is reached, no join is scheduled yet: the scheduler, the online subsystem in use and
+ * a JoinBestOf or Reconnect in flight belong to other joins and are left alone.
+ */
+void UMultiplayerSessionsSubsystem::BroadcastJoinSessionByIdFailure(const EOnJoinSessionCompleteResult::Type Result)
+{
+	DispatchSessionEvent(EMPSessionEventKind::JoinSession, [this, Result]()
+	{
+		MultiplayerOnJoinSessionComplete.Broadcast(NAME_GameSession, Result);
+	});
+}
+
+/**
+ * Looks up a single session by id, through the backend's find-by-id when it has one
+ * and otherwise through a search filtered on the advertised session id (see bAdvertiseSessionId).
+ * @return  False if the lookup could not be issued, OnComplete is not called in that case
+ */
+bool UMultiplayerSessionsSubsystem::TryAsyncFindSessionById(
+	const FString& SessionId,
+	const FOnSingleSessionResultCompleteDelegate& OnComplete
+)
+{
+	if (IsSessionInterfaceInvalid()) return false;
+
+	const FUniqueNetIdPtr SearchingPlayerId = GetFirstLocalPlayerNetId();
+	const FUniqueNetIdPtr SessionNetId = SessionInterface->CreateSessionIdFromString(SessionId);
+	if (!SearchingPlayerId.IsValid() || !SessionNetId.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("No find-by-id for session %s, using a filtered search"), *SessionId);
+		return TryAsyncFindSessionByIdAttribute(SessionId, OnComplete);
+	}
+
+	// Backends that do not implement find-by-id fail it, the filtered search is tried next
+	const FOnSingleSessionResultCompleteDelegate OnFoundById = FOnSingleSessionResultCompleteDelegate::CreateWeakLambda(
+		this,
+		[this, SessionId, OnComplete](int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult& SearchResult)
+		{
+			if (OnlineTrafficRecorder)
+			{
+				FMPOnlineTrafficEvent Callback(EMPOnlineTrafficEvent::FindSessionByIdComplete, NAME_None, bWasSuccessful, LocalUserNum);
+				Callback.SearchResults.Add(SearchResult);
+				RecordOnlineCallback(MoveTemp(Callback));
+			}
+			if (bWasSuccessful && SearchResult.IsValid())
+			{
+				OnComplete.ExecuteIfBound(LocalUserNum, true, SearchResult);
+				return;
+			}
+			if (!TryAsyncFindSessionByIdAttribute(SessionId, OnComplete))
+			{
+				OnComplete.ExecuteIfBound(LocalUserNum, false, FOnlineSessionSearchResult());
+			}
+		}
+	);
+
+	// The friend id is only used by backends that look sessions up through a friend, the searching player stands in for it
+	FMPOnlineTrafficEvent FindByIdCall(EMPOnlineTrafficEvent::FindSessionByIdCall, NAME_None);
+	FindByIdCall.Id = SessionId;
+	const bool bHasIssuedFindById = IssueOnlineCall(
+		MoveTemp(FindByIdCall),
+		[this, &SearchingPlayerId, &SessionNetId, &OnFoundById]()
+		{
+			return SessionInterface->FindSessionById(*SearchingPlayerId, *SessionNetId, *SearchingPlayerId, OnFoundById);
+		},
+		[OnFoundById](const FMPOnlineTrafficEvent& Callback)
+		{
+			OnFoundById.ExecuteIfBound(Callback.Value, Callback.bWasSuccessful, Callback.SearchResults.Num() > 0 ? Callback.SearchResults[0] : FOnlineSessionSearchResult());
+		}
+	);
+	if (!bHasIssuedFindById)
 	{
-		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("FindSessions issued successfully"));
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("SessionInterface->FindSessionById failed for session %s, using a filtered search"), *SessionId);
+		return TryAsyncFindSessionByIdAttribute(SessionId, OnComplete);
 	}
+	return true;
 }
 
-void UMultiplayerSessionsSubsystem::JoinSession(const FOnlineSessionSearchResult& SearchResult)
+bool UMultiplayerSessionsSubsystem::TryAsyncFindSessionByIdAttribute(
+	const FString& SessionId,
+	const FOnSingleSessionResultCompleteDelegate& OnComplete
+)
 {
-	if(!SessionInterface.IsValid())
-	{
-		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("SessionInterface is not valid"));
-		MultiplayerOnJoinSessionComplete.Broadcast(NAME_GameSession, EOnJoinSessionCompleteResult::UnknownError);
-		return;
-	}
+	FOnlineSearchSettings QuerySettings;
+	FMPSessionSchema::Query<FMPSessionIdKey>(QuerySettings, SessionId);
+	const TSharedRef<FOnlineSessionSearch> SessionSearch = MakeSessionSearch(FindSessionByIdMaxSearchResults, QuerySettings);
 
-	JoinSessionCompleteDelegateHandle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate);
-
-	bool bJoinSuccess; 
-	if (const UWorld* World = GetWorld())
-	{
-		if (const ULocalPlayer* LocalPlayer = World->GetFirstLocalPlayerFromController())
+	// Searched for the player the search is issued for, a dedicated server searches as its hosting player
+	const int32 LocalUserNum = IsServerHostingMode() ? ServerHostingPlayerNum : 0;
+	return TryIssueSessionSearch(
+		SessionSearch,
+		FMPOnSessionSearchComplete::CreateWeakLambda(this, [SessionSearch, SessionId, OnComplete, LocalUserNum](bool bWasSuccessful)
 		{
-			bJoinSuccess = SessionInterface->JoinSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, SearchResult);
-			if (!bJoinSuccess)
+			// Not every backend applies attribute filters, the id is checked on our side as well
+			const FOnlineSessionSearchResult* FoundResult = !bWasSuccessful ? nullptr : SessionSearch->SearchResults.FindByPredicate(
+				[&SessionId](const FOnlineSessionSearchResult& SearchResult)
+				{
+					FString AdvertisedSessionId;
+					return SearchResult.GetSessionIdStr() == SessionId
+						|| (FMPSessionSchema::Get<FMPSessionIdKey>(SearchResult.Session.SessionSettings, AdvertisedSessionId) && AdvertisedSessionId == SessionId);
+				});
+			if (FoundResult)
 			{
-				UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("MultiplayerSessionSubsystem: Failed to join session"));
+				OnComplete.ExecuteIfBound(LocalUserNum, true, *FoundResult);
 			}
 			else
 			{
-				UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("MultiplayerSessionSubsystem: Joining session %s"), *SearchResult.GetSessionIdStr());
+				OnComplete.ExecuteIfBound(LocalUserNum, false, FOnlineSessionSearchResult());
 			}
-		}
-		else
-		{
-			bJoinSuccess = false;
-			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("LocalPlayer is null"));
-		}
-	}
-	else
+		})
+	);
+}
+
+void UMultiplayerSessionsSubsystem::AdvertiseSessionId(const FString& SessionId)
+{
+	if (!bAdvertiseSessionId || SessionId.IsEmpty())
 	{
-		bJoinSuccess = false;
-		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("World is null"));
+		return;
 	}
-	if (!bJoinSuccess)
+	// The id is only known once the backend created the session, it goes out with a follow-up update
+	ScheduleInternalSessionUpdate(SessionIdAdvertMergeKey, [SessionId](FOnlineSessionSettings& UpdatedSettings)
 	{
-		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
-		MultiplayerOnJoinSessionComplete.Broadcast(NAME_GameSession, EOnJoinSessionCompleteResult::UnknownError);
-	}
+		FString AdvertisedSessionId;
+		if (FMPSessionSchema::Get<FMPSessionIdKey>(UpdatedSettings, AdvertisedSessionId) && AdvertisedSessionId == SessionId)
+		{
+			return false;
+		}
+		FMPSessionSchema::Set<FMPSessionIdKey>(UpdatedSettings, SessionId);
+		return true;
+	});
+}
+
+/**
+ * Schedules an update nobody asked for ahead of the queued operations, its completion is not broadcast.
+ * Apply changes the current settings, it returns false when they are already advertised.
+ */
+void UMultiplayerSessionsSubsystem::ScheduleInternalSessionUpdate(
+	const FName MergeKey,
+	TUniqueFunction<bool(FOnlineSessionSettings&)>&& Apply
+)
+{
+	ScheduleOperation(
+		EMPSessionOperation::Update,
+		[this, MergeKey, Apply = MoveTemp(Apply)]()
+		{
+			if (Metrics)
+			{
+				Metrics->OnOperationStarted(EMPSessionOperation::Update);
+			}
+			TSharedPtr<FOnlineSessionSettings> UpdatedSettings;
+			if (LastSessionSettings.IsValid() && !PendingUpdatedSessionSettings.IsValid())
+			{
+				UpdatedSettings = MakeShareable(new FOnlineSessionSettings(*LastSessionSettings));
+			}
+			if (!UpdatedSettings.IsValid() || !IsHostingSession() || !Apply(*UpdatedSettings))
+			{
+				CompleteOperation(EMPSessionOperation::Update, true);
+				return;
+			}
+			PendingUpdatedSessionSettings = UpdatedSettings;
+			bIsInternalUpdateInFlight = true;
+			if (!TryAsyncUpdateSession(*PendingUpdatedSessionSettings))
+			{
+				UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Failed to issue the %s update"), *MergeKey.ToString());
+				bIsInternalUpdateInFlight = false;
+				PendingUpdatedSessionSettings.Reset();
+				CompleteOperation(EMPSessionOperation::Update, false);
+			}
+		},
+		nullptr,
+		EMPSessionOperationPriority::High,
+		MergeKey
+	);
 }
 
 void UMultiplayerSessionsSubsystem::DestroySession()
 {
+	ScheduleOperation(
+		EMPSessionOperation::Destroy,
+		[this]()
+		{
+			IssueDestroySession();
+		},
+		[this]()
+		{
+			DispatchSessionEvent(EMPSessionEventKind::DestroySession, [this]()
+			{
+				MultiplayerOnDestroySessionComplete.Broadcast(false);
+			});
+		}
+	);
+}
+
+void UMultiplayerSessionsSubsystem::IssueDestroySession()
+{
+	if (Metrics)
+	{
+		Metrics->OnOperationStarted(EMPSessionOperation::Destroy);
+	}
 	if (!SessionInterface.IsValid())
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("During Destroy Session: SessionInterface is not valid"));
+		CompleteOperation(EMPSessionOperation::Destroy, false);
 		return;
 	}
 
-	DestroySessionCompleteDelegateHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate);
+	DestroySessionCompleteBinding = FMPScopedDelegateBinding::ForInterface(SessionInterface, SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate), &IOnlineSession::ClearOnDestroySessionCompleteDelegate_Handle);
+	// Torn down together, even if the backend in use refuses: the destroy completes once the session is gone from every backend
+	if (SessionMirrors && SessionMirrors->HasCreatedMirrors())
+	{
+		IssueSessionMirrorsCall([this](FMPOnSessionMirrorsComplete&& OnComplete)
+		{
+			SessionMirrors->Destroy(MoveTemp(OnComplete));
+		});
+	}
 	
-	if(!SessionInterface->DestroySession(NAME_GameSession))
+	if(!IssueOnlineCall(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::DestroySessionCall, NAME_GameSession), [this]() { return SessionInterface->DestroySession(NAME_GameSession); }))
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Failed to destroy session"));
-		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
-		MultiplayerOnDestroySessionComplete.Broadcast(false);
+		DestroySessionCompleteBinding.Reset();
+		CompleteOperation(EMPSessionOperation::Destroy, false);
+		DispatchSessionEvent(EMPSessionEventKind::DestroySession, [this]()
+		{
+			MultiplayerOnDestroySessionComplete.Broadcast(false);
+		});
 	}
 	else
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("DestroySession issued successfully"));
+		SetSessionState(EMPSessionState::Destroying);
 	}
 }
 
@@ -457,13 +3139,40 @@ bool UMultiplayerSessionsSubsystem::StartSession()
 		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("SessionInterface is not valid"));
 		return false;
 	}
+	ScheduleOperation(
+		EMPSessionOperation::Start,
+		[this]()
+		{
+			IssueStartSession();
+		},
+		[this]()
+		{
+			BroadcastStartSessionComplete(false);
+		}
+	);
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::IssueStartSession()
+{
+	if (Metrics)
+	{
+		Metrics->OnOperationStarted(EMPSessionOperation::Start);
+	}
+	if (!SessionInterface.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("SessionInterface is not valid"));
+		BroadcastStartSessionComplete(false);
+		return false;
+	}
 
-	StartSessionCompleteDelegateHandle = SessionInterface->AddOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate);
+	StartSessionCompleteBinding = FMPScopedDelegateBinding::ForInterface(SessionInterface, SessionInterface->AddOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate), &IOnlineSession::ClearOnStartSessionCompleteDelegate_Handle);
 	
-	const bool bSuccess = SessionInterface->StartSession(NAME_GameSession);
+	const bool bSuccess = IssueOnlineCall(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::StartSessionCall, NAME_GameSession), [this]() { return SessionInterface->StartSession(NAME_GameSession); });
 	if (bSuccess)
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("StartSession issued successfully"));
+		SetSessionState(EMPSessionState::Starting);
 	}
 	else
 	{
@@ -471,8 +3180,8 @@ bool UMultiplayerSessionsSubsystem::StartSession()
 	}
 	if (!bSuccess)
 	{
-		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
-		MultiplayerOnStartSessionComplete.Broadcast(false);
+		StartSessionCompleteBinding.Reset();
+		BroadcastStartSessionComplete(false);
 	}
 	return bSuccess;
 }
@@ -488,7 +3197,24 @@ void UMultiplayerSessionsSubsystem::OnLoginComplete(
 		This function handles the callback from logging in. You should not proceed with any EOS features until this function is called.
 		This function will remove the delegate that was bound in the Login() function.
 	*/
+	if (OnlineTrafficRecorder)
+	{
+		FMPOnlineTrafficEvent Callback(EMPOnlineTrafficEvent::LoginComplete, NAME_None, bWasSuccessful, LocalUserNum);
+		Callback.Id = UserId.ToString();
+		Callback.Error = Error;
+		RecordOnlineCallback(MoveTemp(Callback));
+	}
 	IsLoggedIn = bWasSuccessful;
+	// Unbound before the pending actions run, they may log in again or switch the online subsystem
+	LoginCompleteBinding.Reset();
+	if (Metrics)
+	{
+		Metrics->OnLoginCompleted(bWasSuccessful);
+	}
+	if (GetSessionState() == EMPSessionState::LoggingIn)
+	{
+		SyncSessionState();
+	}
 	if (bWasSuccessful)
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Login success."));
@@ -499,22 +3225,24 @@ void UMultiplayerSessionsSubsystem::OnLoginComplete(
 	}
 	else
 	{
-		ClearPendingLoginActions();
 		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Login failed. Reason: '%s'"), *Error);
+		// The operations waiting for the login won't be issued, each one reports its failure and frees its lane
+		FailPendingLoginActions();
 	}
-	MultiplayerOnLoginComplete.Broadcast(LocalUserNum, bWasSuccessful, UserId, Error);
-
-	if (!IsIdentityInterfaceInvalid())
+	DispatchSessionEvent(EMPSessionEventKind::Login, [this, LocalUserNum, bWasSuccessful, UserIdRef = UserId.AsShared(), Error]()
 	{
-		IdentityInterface->ClearOnLoginCompleteDelegate_Handle(LocalUserNum, LoginCompleteDelegateHandle);
-		LoginCompleteDelegateHandle.Reset();
-	}
+		MultiplayerOnLoginComplete.Broadcast(LocalUserNum, bWasSuccessful, *UserIdRef, Error);
+	});
 }
 
 void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, bool bWasSuccessful)
 {
 	if (IsSessionInterfaceInvalid())
 		return;
+	// Pooled sessions complete through the same interface delegates, they are handled by the pool
+	if (SessionName != NAME_GameSession)
+		return;
+	RecordOnlineCallback(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::CreateSessionComplete, SessionName, bWasSuccessful));
 	
 	if (bWasSuccessful)
 	{
@@ -525,11 +3253,24 @@ void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, b
 		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Failed to create session %s"), *SessionName.ToString());
 	}
 	const auto NamedSession = SessionInterface->GetNamedSession(SessionName);
-	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("MultiplayerSessionSubsystem: Session ID %s"), *NamedSession->GetSessionIdStr());
+	const FString SessionId = NamedSession ? NamedSession->GetSessionIdStr() : FString();
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("MultiplayerSessionSubsystem: Session ID %s"), *SessionId);
 
-	const FString SessionId = NamedSession->GetSessionIdStr();
-	SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
-	MultiplayerOnCreateSessionComplete.Broadcast(SessionName, SessionId, bWasSuccessful);
+	CreateSessionCompleteBinding.Reset();
+	SyncSessionState();
+	if (bWasSuccessful)
+	{
+		AdvertiseSessionId(SessionId);
+	}
+	CompleteWithSessionMirrors([this, SessionName, SessionId, bWasSuccessful]()
+	{
+		// Mirrors of a session that failed to be created would advertise a session nobody hosts
+		if (!bWasSuccessful && SessionMirrors && SessionMirrors->HasCreatedMirrors())
+		{
+			SessionMirrors->Destroy(FMPOnSessionMirrorsComplete());
+		}
+		BroadcastCreateSessionComplete(SessionName, SessionId, bWasSuccessful);
+	});
 }
 
 void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessful)
@@ -540,22 +3281,66 @@ void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessful)
 		return;
 	}
 
-	SessionInterface->ClearOnEndSessionCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+	FindSessionsCompleteBinding.Reset();
+	if (OnlineTrafficRecorder && InFlightSessionSearch.IsValid())
+	{
+		FMPOnlineTrafficEvent Callback(EMPOnlineTrafficEvent::FindSessionsComplete, NAME_None, bWasSuccessful);
+		Callback.SearchResults = InFlightSessionSearch->SearchResults;
+		RecordOnlineCallback(MoveTemp(Callback));
+	}
+
+	// Hand the result to whoever issued the search, it may issue the next one from its callback
+	const FMPOnSessionSearchComplete OnComplete = InFlightSessionSearchComplete;
+	InFlightSessionSearchComplete.Unbind();
+	InFlightSessionSearch.Reset();
+	OnComplete.ExecuteIfBound(bWasSuccessful);
+
+	// Issue the next queued search, unless the callback already issued one
+	while (!InFlightSessionSearch.IsValid() && QueuedSessionSearches.Num() > 0)
+	{
+		const TPair<TSharedRef<FOnlineSessionSearch>, FMPOnSessionSearchComplete> QueuedSearch = QueuedSessionSearches[0];
+		QueuedSessionSearches.RemoveAt(0);
+		if (!TryIssueSessionSearch(QueuedSearch.Key, QueuedSearch.Value))
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("SessionInterface->FindSessions failed for a queued search"));
+			QueuedSearch.Value.ExecuteIfBound(false);
+		}
+	}
+}
 
+void UMultiplayerSessionsSubsystem::OnLastSessionSearchComplete(bool bWasSuccessful)
+{
+	CompleteOperation(EMPSessionOperation::Find, bWasSuccessful);
 	if (!bWasSuccessful)
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Failed to find sessions"));
 	}
 	else
 	{
+		if (const int32 NumBlacklisted = JoinBlacklist.Filter(LastSessionSearch->SearchResults); NumBlacklisted > 0)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Left out %d sessions this client recently failed to join"), NumBlacklisted);
+		}
 		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Found %d sessions"), LastSessionSearch->SearchResults.Num());
 		for (const FOnlineSessionSearchResult& SearchResult : LastSessionSearch->SearchResults)
 		{
 			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Session found: %s"), *SearchResult.GetSessionIdStr());
 		}
+		// The search is done with its results, the snapshot and the listeners share them from here on
+		LastSearchResults = MakeShared<const TArray<FOnlineSessionSearchResult>, ESPMode::ThreadSafe>(MoveTemp(LastSessionSearch->SearchResults));
+		LastSessionSearch->SearchResults.Reset();
 	}
 	
-	MultiplayerOnFindSessionsComplete.Broadcast(LastSessionSearch->SearchResults, bWasSuccessful);
+	// Only the latest results matter to a listener, a pending older search result is dropped
+	TSharedPtr<const TArray<FOnlineSessionSearchResult>, ESPMode::ThreadSafe> SearchResults;
+	if (bWasSuccessful)
+	{
+		SearchResults = LastSearchResults;
+	}
+	DispatchSessionEvent(EMPSessionEventKind::FindSessions, [this, SearchResults = MoveTemp(SearchResults), bWasSuccessful]()
+	{
+		MultiplayerOnFindSessionsComplete.Broadcast(SearchResults.IsValid() ? *SearchResults : TArray<FOnlineSessionSearchResult>(), bWasSuccessful);
+	}, true);
 }
 
 void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
@@ -566,15 +3351,58 @@ void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOn
 		return;
 	}
 
-	SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
-	MultiplayerOnJoinSessionComplete.Broadcast(SessionName, Result);
+	RecordOnlineCallback(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::JoinSessionComplete, SessionName, Result == EOnJoinSessionCompleteResult::Success, Result));
+	JoinSessionCompleteBinding.Reset();
+	SyncSessionState();
+	if (Result != EOnJoinSessionCompleteResult::Success)
+	{
+		CancelDestinationMapPreload();
+		if (bBlacklistFailedJoins && PendingJoinSearchResult.IsValid())
+		{
+			JoinBlacklist.Add(PendingJoinSearchResult->GetSessionIdStr(), Result, GetJoinBlacklistSeconds(Result));
+		}
+	}
+	else if (PendingJoinSearchResult.IsValid())
+	{
+		JoinBlacklist.Remove(PendingJoinSearchResult->GetSessionIdStr());
+		RememberJoinedSession(*PendingJoinSearchResult);
+	}
+	PendingJoinSearchResult.Reset();
+	BroadcastJoinSessionResult(SessionName, Result);
 }
 
 void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName, bool bWasSuccessful)
 {
+	if (SessionName != NAME_GameSession)
+	{
+		return;
+	}
+	RecordOnlineCallback(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::DestroySessionComplete, SessionName, bWasSuccessful));
+	SyncSessionState();
+	if (bReconnectAfterDestroy)
+	{
+		// Stale session removed by Reconnect, internal to it so it is not broadcast
+		bReconnectAfterDestroy = false;
+		DestroySessionCompleteBinding.Reset();
+		CompleteOperation(EMPSessionOperation::Destroy, bWasSuccessful);
+		if (bWasSuccessful)
+		{
+			ContinueReconnect();
+		}
+		else
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Reconnect: failed to destroy the stale session"));
+			FinishReconnect(false);
+		}
+		return;
+	}
 	if (!bWasSuccessful)
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Failed to Destroy Session %s"), *SessionName.ToString());
+		CompleteWithSessionMirrors([this]()
+		{
+			CompleteOperation(EMPSessionOperation::Destroy, false);
+		});
 		return;
 	}
 	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Successfuly destroyed Session %s"), *SessionName.ToString());
@@ -585,17 +3413,38 @@ void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName,
 		return;
 	}
 
-	SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
-	if (bWasSuccessful && bCreateSessionOnDestroy)
+	DestroySessionCompleteBinding.Reset();
+	RestoreHomeOnlineSubsystem();
+	CompleteWithSessionMirrors([this]()
 	{
-		bCreateSessionOnDestroy = false;
-		CreateSession(LastNumPublicConnections, FMPSessionSettings ());
-	}
-	MultiplayerOnStartSessionComplete.Broadcast(bWasSuccessful);
+		// Torn down only once every mirror confirmed, one that refused still advertises the session and is retried by the next destroy
+		const bool bHasTornDown = !SessionMirrors || !SessionMirrors->HasCreatedMirrors();
+		if (!bHasTornDown)
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Session destroyed, but still advertised on %s"), *FString::JoinBy(SessionMirrors->GetCreatedOnlineSubsystems(), TEXT(", "), [](const FName Name) { return Name.ToString(); }));
+		}
+		// A create waiting for this destroy is issued next
+		CompleteOperation(EMPSessionOperation::Destroy, bHasTornDown);
+		DispatchSessionEvent(EMPSessionEventKind::DestroySession, [this, bHasTornDown]()
+		{
+			MultiplayerOnDestroySessionComplete.Broadcast(bHasTornDown);
+		});
+	});
 }
 
-void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessful) const 
+void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessful)
 {
+	if (SessionName != NAME_GameSession)
+	{
+		return;
+	}
+	RecordOnlineCallback(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::StartSessionComplete, SessionName, bWasSuccessful));
+	if (SessionInterface.IsValid())
+	{
+		StartSessionCompleteBinding.Reset();
+	}
+	SyncSessionState();
+
 	if (bWasSuccessful)
 	{
 		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Session %s has started"), *SessionName.ToString());
@@ -605,9 +3454,127 @@ void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bo
 		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Failed to start session"));
 	}
 
-	MultiplayerOnStartSessionComplete.Broadcast(bWasSuccessful);
+	BroadcastStartSessionComplete(bWasSuccessful);
+}
+
+void UMultiplayerSessionsSubsystem::OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	if (SessionName != NAME_GameSession)
+	{
+		return;
+	}
+	RecordOnlineCallback(FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::UpdateSessionComplete, SessionName, bWasSuccessful));
+	if (SessionInterface.IsValid())
+	{
+		UpdateSessionCompleteBinding.Reset();
+	}
+
+	if (bWasSuccessful)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Session %s has been updated"), *SessionName.ToString());
+		if (PendingUpdatedSessionSettings.IsValid())
+		{
+			LastSessionSettings = PendingUpdatedSessionSettings;
+		}
+	}
+	else
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Error, TEXT("Failed to update session %s"), *SessionName.ToString());
+	}
+	PendingUpdatedSessionSettings.Reset();
+
+	CompleteWithSessionMirrors([this, SessionName, bWasSuccessful]()
+	{
+		// Nobody asked for the internal updates (session id, map), so nobody is told about them
+		if (bIsInternalUpdateInFlight)
+		{
+			bIsInternalUpdateInFlight = false;
+			if (!bWasSuccessful)
+			{
+				UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("Failed to advertise the session id or map"));
+			}
+			CompleteOperation(EMPSessionOperation::Update, bWasSuccessful);
+			return;
+		}
+		if (bReportUpdateAsCreate)
+		{
+			bReportUpdateAsCreate = false;
+			const FNamedOnlineSession* NamedSession = SessionInterface.IsValid() ? SessionInterface->GetNamedSession(SessionName) : nullptr;
+			BroadcastCreateSessionComplete(SessionName, NamedSession ? NamedSession->GetSessionIdStr() : FString(), bWasSuccessful);
+			return;
+		}
+		CompleteOperation(EMPSessionOperation::Update, bWasSuccessful);
+		// Each result only tells whether one update passed, dropping a pending one would lose a failure
+		DispatchSessionEvent(EMPSessionEventKind::UpdateSession, [this, SessionName, bWasSuccessful]()
+		{
+			MultiplayerOnUpdateSessionComplete.Broadcast(SessionName, bWasSuccessful);
+		});
+	});
+}
+
+TArray<FName> UMultiplayerSessionsSubsystem::GetAdvertisedOnlineSubsystems() const
+{
+	TArray<FName> OnlineSubsystemNames;
+	if (SessionInterface.IsValid() && SessionInterface->GetNamedSession(NAME_GameSession) != nullptr)
+	{
+		OnlineSubsystemNames.Add(OnlineSubsystemName);
+	}
+	if (SessionMirrors)
+	{
+		OnlineSubsystemNames.Append(SessionMirrors->GetCreatedOnlineSubsystems());
+	}
+	return OnlineSubsystemNames;
+}
+
+void UMultiplayerSessionsSubsystem::IssueSessionMirrorsCall(TFunctionRef<void(FMPOnSessionMirrorsComplete&&)> Issue)
+{
+	// Counted before issuing, mirrors may answer synchronously
+	++NumAwaitedSessionMirrorsCalls;
+	Issue(FMPOnSessionMirrorsComplete::CreateUObject(this, &ThisClass::OnSessionMirrorsComplete));
+}
+
+void UMultiplayerSessionsSubsystem::OnSessionMirrorsComplete(const bool bWasSuccessful)
+{
+	--NumAwaitedSessionMirrorsCalls;
+	if (!bWasSuccessful && SessionMirrors)
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Warning, TEXT("The session is advertised on %d of its %d mirror backends"),
+			SessionMirrors->GetCreatedOnlineSubsystems().Num(), AdvertisingOnlineSubsystems.Num() - (AdvertisingOnlineSubsystems.Contains(OnlineSubsystemName) ? 1 : 0));
+	}
+	if (NumAwaitedSessionMirrorsCalls == 0 && PendingMirroredCompletion)
+	{
+		TUniqueFunction<void()> Completion = MoveTemp(PendingMirroredCompletion);
+		PendingMirroredCompletion = nullptr;
+		Completion();
+	}
+}
+
+void UMultiplayerSessionsSubsystem::CompleteWithSessionMirrors(TUniqueFunction<void()>&& Completion)
+{
+	if (NumAwaitedSessionMirrorsCalls > 0)
+	{
+		PendingMirroredCompletion = MoveTemp(Completion);
+		return;
+	}
+	Completion();
+}
+
+void UMultiplayerSessionsSubsystem::OnGameModePostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer)
+{
+	if (SessionMirrors && GameMode && GameMode->GetGameInstance() == GetGameInstance())
+	{
+		SessionMirrors->SetNumPlayers(GameMode->GetNumPlayers());
+	}
 }
 
+void UMultiplayerSessionsSubsystem::OnGameModeLogout(AGameModeBase* GameMode, AController* Exiting)
+{
+	if (SessionMirrors && GameMode && GameMode->GetGameInstance() == GetGameInstance())
+	{
+		// The leaving player is still counted during logout
+		SessionMirrors->SetNumPlayers(GameMode->GetNumPlayers() - (Cast<APlayerController>(Exiting) ? 1 : 0));
+	}
+}
 
 bool UMultiplayerSessionsSubsystem::GetResolvedConnectString(const FName& SessionName, FString& ConnectInfo) const
 {
@@ -642,3 +3609,124 @@ bool UMultiplayerSessionsSubsystem::TryFirstLocalPlayerControllerClientTravel(co
 	}
 	return false;
 }
+
+FString UMultiplayerSessionsSubsystem::GetMapPackageName(const TSoftObjectPtr<UWorld>& Map)
+{
+	return Map.IsNull() ? FString() : Map.ToSoftObjectPath().GetLongPackageName();
+}
+
+FSessionSettings UMultiplayerSessionsSubsystem::ToSessionAttributes(const TMap<FName, FString>& ExtraSessionSettings)
+{
+	FSessionSettings SessionAttributes;
+	for (const auto& ExtraSessionSetting : ExtraSessionSettings)
+	{
+		SessionAttributes.Add(
+			ExtraSessionSetting.Key,
+			FOnlineSessionSetting(ExtraSessionSetting.Value, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing)
+		);
+	}
+	return SessionAttributes;
+}
+
+FString UMultiplayerSessionsSubsystem::GetCurrentMapPackageName() const
+{
+	const UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return FString();
+	}
+	// In PIE the package is prefixed (e.g. UEDPIE_0_), joining clients need the real package name
+	return UWorld::RemovePIEPrefix(World->GetPackage()->GetName());
+}
+
+void UMultiplayerSessionsSubsystem::StartDestinationMapPreload(const FString& MapPackageName)
+{
+	CancelDestinationMapPreload();
+
+	if (!FPackageName::IsValidLongPackageName(MapPackageName) || !FPackageName::DoesPackageExist(MapPackageName))
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Not preloading destination map '%s', package not found"), *MapPackageName);
+		return;
+	}
+	if (MapPackageName == GetCurrentMapPackageName())
+	{
+		return;
+	}
+
+	// The world asset lives in its package with the same short name, e.g. /Game/Maps/Lobby.Lobby
+	const FSoftObjectPath MapAssetPath(MapPackageName + TEXT(".") + FPackageName::GetShortName(MapPackageName));
+	MapPreloadHandle = MapPreloadStreamableManager.RequestAsyncLoad(
+		MapAssetPath,
+		FStreamableDelegate::CreateWeakLambda(this, [this, MapPackageName]()
+		{
+			UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Destination map '%s' preloaded"), *MapPackageName);
+			if (HostPipeline.bIsActive)
+			{
+				HostPipeline.Timings.MapPreloadSeconds = FPlatformTime::Seconds() - HostPipeline.StartTime;
+			}
+		}),
+		FStreamableManager::AsyncLoadHighPriority
+	);
+	UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Preloading destination map '%s'"), *MapPackageName);
+}
+
+void UMultiplayerSessionsSubsystem::CancelDestinationMapPreload()
+{
+	if (!MapPreloadHandle.IsValid())
+	{
+		return;
+	}
+	if (MapPreloadHandle->IsLoadingInProgress())
+	{
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Cancelling destination map preload"));
+		MapPreloadHandle->CancelHandle();
+	}
+	else
+	{
+		MapPreloadHandle->ReleaseHandle();
+	}
+	MapPreloadHandle.Reset();
+}
+
+void UMultiplayerSessionsSubsystem::OnPostLoadMapWithWorld(UWorld* LoadedWorld)
+{
+	if (bAutoHostPending && LoadedWorld != nullptr)
+	{
+		bAutoHostPending = false;
+		FMPSessionSettings SessionSettings;
+		SessionSettings.bIsDedicatedServer = true;
+		FParse::Value(FCommandLine::Get(), TEXT("MPMaxPlayers="), SessionSettings.PublicConnections);
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Auto hosting dedicated server session for %d players"), SessionSettings.PublicConnections);
+		CreateSession(SessionSettings.PublicConnections, SessionSettings);
+	}
+
+	// The travelled-to world now keeps the map alive, the preload handle is no longer needed
+	if (MapPreloadHandle.IsValid())
+	{
+		MapPreloadHandle->ReleaseHandle();
+		MapPreloadHandle.Reset();
+	}
+
+	if (LoadedWorld == nullptr || !SessionInterface.IsValid() || !LastSessionSettings.IsValid())
+	{
+		return;
+	}
+
+	// Keep the advertised map in sync when the host travels, compared once the update's turn comes
+	if (!IsHostingSession())
+	{
+		return;
+	}
+	const FString LoadedMap = UWorld::RemovePIEPrefix(LoadedWorld->GetPackage()->GetName());
+	ScheduleInternalSessionUpdate(MapAdvertMergeKey, [LoadedMap](FOnlineSessionSettings& UpdatedSettings)
+	{
+		FString AdvertisedMap;
+		if (FMPSessionSchema::Get<FMPMapNameKey>(UpdatedSettings, AdvertisedMap) && AdvertisedMap == LoadedMap)
+		{
+			return false;
+		}
+		UE_LOG(LogMultiplayerSessionsSubsystem, Log, TEXT("Advertising map '%s'"), *LoadedMap);
+		FMPSessionSchema::Set<FMPMapNameKey>(UpdatedSettings, LoadedMap);
+		return true;
+	});
+}
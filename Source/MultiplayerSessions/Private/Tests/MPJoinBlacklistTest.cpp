@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPJoinBlacklist.h"
+#include "MPTestSearchResults.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPJoinBlacklistReasonTest, "MultiplayerSessions.JoinBlacklist.Reasons",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPJoinBlacklistReasonTest::RunTest(const FString& Parameters)
+{
+	FMPJoinBlacklist Blacklist;
+	TestTrue(TEXT("A full session is blacklisted"), Blacklist.Add(TEXT("Full"), EOnJoinSessionCompleteResult::SessionIsFull, 60.f));
+	TestFalse(TEXT("An unknown error is not"), Blacklist.Add(TEXT("Unknown"), EOnJoinSessionCompleteResult::UnknownError, 60.f));
+	TestFalse(TEXT("An empty id is not"), Blacklist.Add(FString(), EOnJoinSessionCompleteResult::SessionIsFull, 60.f));
+	TestFalse(TEXT("A ttl of 0 is not"), Blacklist.Add(TEXT("NoTtl"), EOnJoinSessionCompleteResult::SessionIsFull, 0.f));
+
+	EOnJoinSessionCompleteResult::Type Reason = EOnJoinSessionCompleteResult::UnknownError;
+	TestTrue(TEXT("The blacklisted session is found"), Blacklist.Contains(TEXT("Full"), &Reason));
+	TestTrue(TEXT("With its reason"), Reason == EOnJoinSessionCompleteResult::SessionIsFull);
+	TestFalse(TEXT("The others are not"), Blacklist.Contains(TEXT("Unknown")));
+
+	Blacklist.Remove(TEXT("Full"));
+	TestFalse(TEXT("A removed session is not blacklisted"), Blacklist.Contains(TEXT("Full")));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPJoinBlacklistExpiryTest, "MultiplayerSessions.JoinBlacklist.Expiry",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPJoinBlacklistExpiryTest::RunTest(const FString& Parameters)
+{
+	FMPJoinBlacklist Blacklist;
+	Blacklist.Add(TEXT("Short"), EOnJoinSessionCompleteResult::SessionDoesNotExist, 0.01f);
+	Blacklist.Add(TEXT("Long"), EOnJoinSessionCompleteResult::SessionDoesNotExist, 60.f);
+	FPlatformProcess::Sleep(0.05f);
+	TestFalse(TEXT("An expired entry no longer hides its session"), Blacklist.Contains(TEXT("Short")));
+	TestTrue(TEXT("A live entry still does"), Blacklist.Contains(TEXT("Long")));
+
+	TArray<FOnlineSessionSearchResult> SearchResults { MPTests::MakeSearchResult(TEXT("Short")), MPTests::MakeSearchResult(TEXT("Long")) };
+	TestEqual(TEXT("Filtering removes the live entry only"), Blacklist.Filter(SearchResults), 1);
+	TestEqual(TEXT("Filtering drops the expired entry"), Blacklist.Num(), 1);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPJoinBlacklistEvictionTest, "MultiplayerSessions.JoinBlacklist.Eviction",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPJoinBlacklistEvictionTest::RunTest(const FString& Parameters)
+{
+	FMPJoinBlacklist Blacklist(2);
+	Blacklist.Add(TEXT("Soonest"), EOnJoinSessionCompleteResult::SessionIsFull, 10.f);
+	Blacklist.Add(TEXT("Latest"), EOnJoinSessionCompleteResult::SessionIsFull, 100.f);
+	Blacklist.Add(TEXT("New"), EOnJoinSessionCompleteResult::SessionIsFull, 50.f);
+	TestEqual(TEXT("The blacklist stays within its capacity"), Blacklist.Num(), 2);
+	TestFalse(TEXT("The entry closest to expiring made room"), Blacklist.Contains(TEXT("Soonest")));
+	TestTrue(TEXT("The other entry is kept"), Blacklist.Contains(TEXT("Latest")));
+	TestTrue(TEXT("The new entry is added"), Blacklist.Contains(TEXT("New")));
+
+	TArray<FOnlineSessionSearchResult> SearchResults {
+		MPTests::MakeSearchResult(TEXT("Latest")),
+		MPTests::MakeSearchResult(TEXT("Open")),
+		MPTests::MakeSearchResult(TEXT("New")),
+		MPTests::MakeSearchResult(TEXT("Soonest"))
+	};
+	TestEqual(TEXT("Both blacklisted results are filtered"), Blacklist.Filter(SearchResults), 2);
+	TestEqual(TEXT("The others keep their order"), MPTests::GetSessionIds(SearchResults), TArray<FString> { TEXT("Open"), TEXT("Soonest") });
+	return true;
+}
+
+#endif
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPOnlineTraffic.h"
+#include "MPTestSearchResults.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/NameAsStringProxyArchive.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPOnlineTrafficEventArchiveTest, "MultiplayerSessions.OnlineTraffic.ArchiveRoundTrip",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPOnlineTrafficEventArchiveTest::RunTest(const FString& Parameters)
+{
+	const FName ModeSetting(TEXT("MPTestMode"));
+	const FName LevelSetting(TEXT("MPTestLevel"));
+
+	FMPOnlineTrafficEvent CreateCall(EMPOnlineTrafficEvent::CreateSessionCall, NAME_GameSession, true, 3);
+	CreateCall.Time = 1.25;
+	CreateCall.SessionSettings.NumPublicConnections = 8;
+	CreateCall.SessionSettings.bShouldAdvertise = true;
+	CreateCall.SessionSettings.Set(ModeSetting, FString(TEXT("Ctf")), EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+	CreateCall.SessionSettings.Set(LevelSetting, 7, EOnlineDataAdvertisementType::ViaOnlineService);
+
+	FMPOnlineTrafficEvent FindComplete(EMPOnlineTrafficEvent::FindSessionsComplete, NAME_None, true);
+	FindComplete.Time = 2.5;
+	FindComplete.bHasNamedSession = true;
+	FindComplete.NamedSessionState = static_cast<uint8>(EOnlineSessionState::InProgress);
+	FindComplete.SearchResults.Add(MPTests::MakeSearchResult(TEXT("Found"), TEXT("Alice"), 3, 42));
+	FindComplete.SearchResults[0].Session.SessionSettings.Set(ModeSetting, FString(TEXT("Dm")), EOnlineDataAdvertisementType::ViaOnlineService);
+
+	TArray<uint8> Bytes;
+	{
+		FMemoryWriter MemoryWriter(Bytes);
+		FNameAsStringProxyArchive Writer(MemoryWriter);
+		Writer << CreateCall;
+		Writer << FindComplete;
+	}
+
+	FMPOnlineTrafficEvent LoadedCreateCall;
+	FMPOnlineTrafficEvent LoadedFindComplete;
+	FMemoryReader MemoryReader(Bytes);
+	FNameAsStringProxyArchive Reader(MemoryReader);
+	Reader << LoadedCreateCall;
+	Reader << LoadedFindComplete;
+	TestFalse(TEXT("The events load without error"), Reader.IsError());
+	TestTrue(TEXT("Every byte written is read"), Reader.AtEnd());
+
+	TestTrue(TEXT("Call kind"), LoadedCreateCall.Kind == EMPOnlineTrafficEvent::CreateSessionCall);
+	TestEqual(TEXT("Call time"), LoadedCreateCall.Time, 1.25);
+	TestEqual(TEXT("Call session name"), LoadedCreateCall.SessionName, FName(NAME_GameSession));
+	TestTrue(TEXT("Call result"), LoadedCreateCall.bWasSuccessful);
+	TestEqual(TEXT("Call value"), LoadedCreateCall.Value, 3);
+	TestEqual(TEXT("Public connections"), LoadedCreateCall.SessionSettings.NumPublicConnections, 8);
+	TestTrue(TEXT("Advertised"), LoadedCreateCall.SessionSettings.bShouldAdvertise);
+	FString Mode;
+	int32 Level = 0;
+	TestTrue(TEXT("String setting"), LoadedCreateCall.SessionSettings.Get(ModeSetting, Mode) && Mode == TEXT("Ctf"));
+	TestTrue(TEXT("Numeric setting keeps its type"), LoadedCreateCall.SessionSettings.Get(LevelSetting, Level) && Level == 7);
+	const FOnlineSessionSetting* ModeSessionSetting = LoadedCreateCall.SessionSettings.Settings.Find(ModeSetting);
+	TestTrue(TEXT("Advertisement type"), ModeSessionSetting && ModeSessionSetting->AdvertisementType == EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+
+	TestTrue(TEXT("Callback kind"), LoadedFindComplete.Kind == EMPOnlineTrafficEvent::FindSessionsComplete);
+	TestTrue(TEXT("Callback named session state"), LoadedFindComplete.bHasNamedSession && LoadedFindComplete.NamedSessionState == static_cast<uint8>(EOnlineSessionState::InProgress));
+	if (TestEqual(TEXT("Search results"), LoadedFindComplete.SearchResults.Num(), 1))
+	{
+		const FOnlineSessionSearchResult& SearchResult = LoadedFindComplete.SearchResults[0];
+		TestEqual(TEXT("Loaded results keep their session id"), SearchResult.GetSessionIdStr(), FString(TEXT("Found")));
+		TestEqual(TEXT("Owner"), SearchResult.Session.OwningUserName, FString(TEXT("Alice")));
+		TestEqual(TEXT("Open slots"), SearchResult.Session.NumOpenPublicConnections, 3);
+		TestEqual(TEXT("Ping"), SearchResult.PingInMs, 42);
+		TestTrue(TEXT("Result settings"), SearchResult.Session.SessionSettings.Get(ModeSetting, Mode) && Mode == TEXT("Dm"));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPOnlineTrafficReplayTest, "MultiplayerSessions.OnlineTraffic.RecordReplay",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPOnlineTrafficReplayTest::RunTest(const FString& Parameters)
+{
+	const FString Path = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("MPOnlineTrafficTest.mpot"));
+	const FName PooledSessionName(TEXT("MPPooledSession"), 1);
+	{
+		FMPOnlineTrafficRecorder Recorder(Path);
+		if (!TestTrue(TEXT("The recorder opens its log"), Recorder.IsRecording()))
+		{
+			return false;
+		}
+		TArray<FMPOnlineTrafficEvent> Events {
+			FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::LoginCall, NAME_None, true),
+			FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::CreateSessionCall, NAME_GameSession, true),
+			// Pooled sessions are recorded, but never answer the game session's calls
+			FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::CreateSessionCall, PooledSessionName, true),
+			FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::CreateSessionComplete, PooledSessionName, false),
+			FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::LoginComplete, NAME_None, true),
+			FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::CreateSessionComplete, NAME_GameSession, true),
+			// Refused by the interface, answered by no callback
+			FMPOnlineTrafficEvent(EMPOnlineTrafficEvent::StartSessionCall, NAME_GameSession, false)
+		};
+		for (int32 Index = 0; Index < Events.Num(); ++Index)
+		{
+			Events[Index].Time = Index * 0.1;
+			Recorder.Record(Events[Index]);
+		}
+		TestEqual(TEXT("Every event is recorded"), Recorder.GetNumEvents(), Events.Num());
+	}
+
+	{
+		FMPOnlineTrafficReplay Replay(Path, true);
+		if (!TestTrue(TEXT("The replay loads the log"), Replay.IsLoaded()))
+		{
+			IFileManager::Get().Delete(*Path);
+			return false;
+		}
+		TestTrue(TEXT("A recorded login is issued"), Replay.Issue(EMPOnlineTrafficEvent::LoginCall, [](const FMPOnlineTrafficEvent&) {}));
+		TestTrue(TEXT("A recorded create is issued"), Replay.Issue(EMPOnlineTrafficEvent::CreateSessionCall, [](const FMPOnlineTrafficEvent&) {}));
+		TestEqual(TEXT("Both get their recorded callback"), Replay.GetNumPendingCallbacks(), 2);
+		TestFalse(TEXT("A pooled session's create is not replayed"), Replay.Issue(EMPOnlineTrafficEvent::CreateSessionCall, [](const FMPOnlineTrafficEvent&) {}));
+		TestFalse(TEXT("A refused call is refused again"), Replay.Issue(EMPOnlineTrafficEvent::StartSessionCall, [](const FMPOnlineTrafficEvent&) {}));
+		TestFalse(TEXT("A call missing from the log is refused"), Replay.Issue(EMPOnlineTrafficEvent::UpdateSessionCall, [](const FMPOnlineTrafficEvent&) {}));
+		TestEqual(TEXT("Refused calls get no callback"), Replay.GetNumPendingCallbacks(), 2);
+	}
+	IFileManager::Get().Delete(*Path);
+	return true;
+}
+
+#endif
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionBrowse.h"
+#include "MPTestSearchResults.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	const FName ModeSetting(TEXT("MPTestMode"));
+	const FName LevelSetting(TEXT("MPTestLevel"));
+
+	TArray<FOnlineSessionSearchResult> MakeBrowsedResults()
+	{
+		TArray<FOnlineSessionSearchResult> Results {
+			MPTests::MakeSearchResult(TEXT("0"), TEXT("Alice"), 2, 50),
+			MPTests::MakeSearchResult(TEXT("1"), TEXT("Bob"), 0, 20),
+			MPTests::MakeSearchResult(TEXT("2"), TEXT("Carol"), 4, 80),
+			MPTests::MakeSearchResult(TEXT("3"), TEXT("alex"), 1, 20)
+		};
+		Results[0].Session.SessionSettings.Set(ModeSetting, FString(TEXT("Ctf")), EOnlineDataAdvertisementType::ViaOnlineService);
+		Results[1].Session.SessionSettings.Set(ModeSetting, FString(TEXT("Dm")), EOnlineDataAdvertisementType::ViaOnlineService);
+		Results[2].Session.SessionSettings.Set(ModeSetting, FString(TEXT("Ctf")), EOnlineDataAdvertisementType::ViaOnlineService);
+		Results[3].Session.SessionSettings.Set(ModeSetting, FString(TEXT("Ctf")), EOnlineDataAdvertisementType::ViaOnlineService);
+		// The third session does not advertise a level
+		Results[0].Session.SessionSettings.Set(LevelSetting, 5, EOnlineDataAdvertisementType::ViaOnlineService);
+		Results[1].Session.SessionSettings.Set(LevelSetting, 9, EOnlineDataAdvertisementType::ViaOnlineService);
+		Results[3].Session.SessionSettings.Set(LevelSetting, 1, EOnlineDataAdvertisementType::ViaOnlineService);
+		return Results;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPSessionBrowseFilterTest, "MultiplayerSessions.SessionBrowse.Filter",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPSessionBrowseFilterTest::RunTest(const FString& Parameters)
+{
+	const TArray<FOnlineSessionSearchResult> Results = MakeBrowsedResults();
+
+	FMPSessionBrowseSpec Spec;
+	TestEqual(TEXT("No filter keeps every session in search order"), FMPSessionBrowsePipeline::Run(Results, Spec), TArray<int32> { 0, 1, 2, 3 });
+
+	Spec = FMPSessionBrowseSpec();
+	Spec.MinOpenSlots = 1;
+	TestEqual(TEXT("Full sessions are hidden"), FMPSessionBrowsePipeline::Run(Results, Spec), TArray<int32> { 0, 2, 3 });
+
+	Spec = FMPSessionBrowseSpec();
+	Spec.MaxPingMs = 60;
+	TestEqual(TEXT("Distant sessions are hidden"), FMPSessionBrowsePipeline::Run(Results, Spec), TArray<int32> { 0, 1, 3 });
+
+	Spec = FMPSessionBrowseSpec();
+	Spec.OwnerNameContains = TEXT("AL");
+	TestEqual(TEXT("Owner names match case insensitively"), FMPSessionBrowsePipeline::Run(Results, Spec), TArray<int32> { 0, 3 });
+
+	Spec = FMPSessionBrowseSpec();
+	Spec.RequiredSettings.Add(ModeSetting, TEXT("Ctf"));
+	Spec.MinOpenSlots = 2;
+	TestEqual(TEXT("Every filter must pass"), FMPSessionBrowsePipeline::Run(Results, Spec), TArray<int32> { 0, 2 });
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPSessionBrowseSortTest, "MultiplayerSessions.SessionBrowse.Sort",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPSessionBrowseSortTest::RunTest(const FString& Parameters)
+{
+	const TArray<FOnlineSessionSearchResult> Results = MakeBrowsedResults();
+
+	FMPSessionBrowseSpec Spec;
+	Spec.SortBy = EMPSessionSortKey::Ping;
+	TestEqual(TEXT("Equal pings keep their search order"), FMPSessionBrowsePipeline::Run(Results, Spec), TArray<int32> { 1, 3, 0, 2 });
+	Spec.bDescending = true;
+	TestEqual(TEXT("Descending too"), FMPSessionBrowsePipeline::Run(Results, Spec), TArray<int32> { 2, 0, 1, 3 });
+
+	Spec = FMPSessionBrowseSpec();
+	Spec.SortBy = EMPSessionSortKey::OwnerName;
+	TestEqual(TEXT("Owner names sort case insensitively"), FMPSessionBrowsePipeline::Run(Results, Spec), TArray<int32> { 3, 0, 1, 2 });
+
+	Spec = FMPSessionBrowseSpec();
+	Spec.SortBy = EMPSessionSortKey::SettingValue;
+	Spec.SortSettingKey = LevelSetting;
+	TestEqual(TEXT("Sessions without the setting sort last"), FMPSessionBrowsePipeline::Run(Results, Spec), TArray<int32> { 3, 0, 1, 2 });
+	Spec.bDescending = true;
+	TestEqual(TEXT("In either direction"), FMPSessionBrowsePipeline::Run(Results, Spec), TArray<int32> { 1, 0, 3, 2 });
+	return true;
+}
+
+#endif
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionBrowserDiff.h"
+#include "MPTestSearchResults.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPSessionResultTrackerTest, "MultiplayerSessions.SessionResultTracker.Diff",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPSessionResultTrackerTest::RunTest(const FString& Parameters)
+{
+	const FName ModeSetting(TEXT("MPTestMode"));
+	FMPSessionResultTracker Tracker;
+
+	TArray<FOnlineSessionSearchResult> FirstResults {
+		MPTests::MakeSearchResult(TEXT("Kept"), TEXT("Alice"), 2, 30),
+		MPTests::MakeSearchResult(TEXT("Changed"), TEXT("Bob"), 3),
+		MPTests::MakeSearchResult(TEXT("Removed"), TEXT("Carol"), 1),
+		// Reported twice by the backend
+		MPTests::MakeSearchResult(TEXT("Removed"), TEXT("Carol"), 1)
+	};
+	FirstResults[1].Session.SessionSettings.Set(ModeSetting, FString(TEXT("Ctf")), EOnlineDataAdvertisementType::ViaOnlineService);
+	FMPSessionBrowserDiff Diff = Tracker.Update(FirstResults);
+	TestEqual(TEXT("The first refresh adds every session once"), MPTests::GetSessionIds(Diff.Added), TArray<FString> { TEXT("Kept"), TEXT("Changed"), TEXT("Removed") });
+	TestTrue(TEXT("Nothing is removed or changed on the first refresh"), Diff.RemovedSessionIds.IsEmpty() && Diff.Changed.IsEmpty());
+	TestEqual(TEXT("Duplicates are tracked once"), Tracker.Num(), 3);
+
+	TArray<FOnlineSessionSearchResult> SecondResults {
+		// Only the ping differs, which is not part of the advertised state
+		MPTests::MakeSearchResult(TEXT("Kept"), TEXT("Alice"), 2, 90),
+		MPTests::MakeSearchResult(TEXT("Changed"), TEXT("Bob"), 2),
+		MPTests::MakeSearchResult(TEXT("Added"), TEXT("Dave"), 4)
+	};
+	SecondResults[1].Session.SessionSettings.Set(ModeSetting, FString(TEXT("Dm")), EOnlineDataAdvertisementType::ViaOnlineService);
+	Diff = Tracker.Update(SecondResults);
+	TestEqual(TEXT("New sessions are added"), MPTests::GetSessionIds(Diff.Added), TArray<FString> { TEXT("Added") });
+	TestEqual(TEXT("Missing sessions are removed"), Diff.RemovedSessionIds, TArray<FString> { TEXT("Removed") });
+	if (TestEqual(TEXT("Only the session whose advertised state changed is changed"), Diff.Changed.Num(), 1))
+	{
+		const FMPChangedSessionResult& Changed = Diff.Changed[0];
+		TestEqual(TEXT("The changed session"), Changed.SearchResult.GetSessionIdStr(), FString(TEXT("Changed")));
+		TestTrue(TEXT("Its open slots changed"), Changed.ChangedFields.Contains(FMPSessionResultTracker::NumOpenPublicConnectionsField));
+		TestTrue(TEXT("Its setting changed"), Changed.ChangedFields.Contains(ModeSetting));
+		TestFalse(TEXT("Its owner did not"), Changed.ChangedFields.Contains(FMPSessionResultTracker::OwningUserNameField));
+	}
+
+	Diff = Tracker.Update(SecondResults);
+	TestTrue(TEXT("The same results make an empty diff"), Diff.IsEmpty());
+
+	Tracker.Reset();
+	Diff = Tracker.Update(SecondResults);
+	TestEqual(TEXT("After a reset every session is added again"), Diff.Added.Num(), 3);
+	return true;
+}
+
+#endif
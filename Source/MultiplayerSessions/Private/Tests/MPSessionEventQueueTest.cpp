@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionEventQueue.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPSessionEventQueueCoalesceTest, "MultiplayerSessions.SessionEventQueue.Coalesce",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPSessionEventQueueCoalesceTest::RunTest(const FString& Parameters)
+{
+	FMPSessionEventQueue Queue(0.f);
+	TArray<FString> Dispatched;
+	const auto Enqueue = [&Queue, &Dispatched](const EMPSessionEventKind Kind, const FString& Name, const bool bCoalesce = false, const FName Subject = NAME_None)
+	{
+		Queue.Enqueue(Kind, [&Dispatched, Name]() { Dispatched.Add(Name); }, bCoalesce, Subject);
+	};
+
+	Enqueue(EMPSessionEventKind::Login, TEXT("Login"));
+	Enqueue(EMPSessionEventKind::FindSessions, TEXT("Find1"), true);
+	Enqueue(EMPSessionEventKind::CreateSession, TEXT("Create"));
+	Enqueue(EMPSessionEventKind::FindSessions, TEXT("Find2"), true);
+	Enqueue(EMPSessionEventKind::UpdateSession, TEXT("UpdateA1"), true, TEXT("A"));
+	Enqueue(EMPSessionEventKind::UpdateSession, TEXT("UpdateB"), true, TEXT("B"));
+	Enqueue(EMPSessionEventKind::UpdateSession, TEXT("UpdateA2"), true, TEXT("A"));
+	Enqueue(EMPSessionEventKind::JoinSession, TEXT("Join1"));
+	Enqueue(EMPSessionEventKind::JoinSession, TEXT("Join2"));
+	TestEqual(TEXT("Coalesced events are not pending"), Queue.Num(), 7);
+	TestTrue(TEXT("Nothing is dispatched before the queue ticks"), Dispatched.IsEmpty());
+
+	TestEqual(TEXT("Flush dispatches every pending event"), Queue.Flush(), 7);
+	TestEqual(TEXT("A coalesced event takes the place of the last one of its kind and subject, others keep their order"), Dispatched,
+		TArray<FString> { TEXT("Login"), TEXT("Create"), TEXT("Find2"), TEXT("UpdateB"), TEXT("UpdateA2"), TEXT("Join1"), TEXT("Join2") });
+	TestEqual(TEXT("Nothing is left"), Queue.Num(), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPSessionEventQueueReentryTest, "MultiplayerSessions.SessionEventQueue.Reentry",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPSessionEventQueueReentryTest::RunTest(const FString& Parameters)
+{
+	FMPSessionEventQueue Queue(0.f);
+	TArray<FString> Dispatched;
+	int32 NumNestedFlushed = INDEX_NONE;
+
+	Queue.Enqueue(EMPSessionEventKind::CreateSession, [&Queue, &Dispatched, &NumNestedFlushed]()
+	{
+		Dispatched.Add(TEXT("Create"));
+		// A listener reacting to an event queues the next one
+		Queue.Enqueue(EMPSessionEventKind::StartSession, [&Dispatched]() { Dispatched.Add(TEXT("Start")); });
+		NumNestedFlushed = Queue.Flush();
+	});
+	Queue.Enqueue(EMPSessionEventKind::FindSessions, [&Dispatched]() { Dispatched.Add(TEXT("Find")); }, true);
+
+	TestEqual(TEXT("Events queued while dispatching are dispatched in the same flush"), Queue.Flush(), 3);
+	TestEqual(TEXT("After the events queued before them"), Dispatched, TArray<FString> { TEXT("Create"), TEXT("Find"), TEXT("Start") });
+	TestEqual(TEXT("Flushing from a dispatched event does nothing"), NumNestedFlushed, 0);
+
+	Queue.Enqueue(EMPSessionEventKind::FindSessions, [&Dispatched]() { Dispatched.Add(TEXT("Dropped")); }, true);
+	Queue.Reset();
+	TestEqual(TEXT("Reset drops the pending events"), Queue.Flush(), 0);
+	TestFalse(TEXT("Without dispatching them"), Dispatched.Contains(TEXT("Dropped")));
+	return true;
+}
+
+#endif
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionOperationScheduler.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Operations that only note when they are issued or rejected */
+	struct FOperationLog
+	{
+		TArray<FString> Entries;
+
+		TUniqueFunction<void()> Execute(const FString& Name)
+		{
+			return [this, Name]() { Entries.Add(Name); };
+		}
+
+		TUniqueFunction<void()> Reject(const FString& Name)
+		{
+			return [this, Name]() { Entries.Add(Name + TEXT(" rejected")); };
+		}
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPSessionOperationSchedulerMergeTest, "MultiplayerSessions.OperationScheduler.Merge",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPSessionOperationSchedulerMergeTest::RunTest(const FString& Parameters)
+{
+	// No rate limit, operations are issued as soon as their lane is free
+	FMPSessionOperationScheduler Scheduler(TEXT("MPTest"), 0.f, 1.f);
+	FOperationLog Log;
+
+	Scheduler.Schedule(EMPSessionOperation::Find, Log.Execute(TEXT("Find1")), Log.Reject(TEXT("Find1")));
+	TestTrue(TEXT("A find is issued right away"), Scheduler.IsInFlight(EMPSessionOperation::Find));
+
+	Scheduler.Schedule(EMPSessionOperation::Find, Log.Execute(TEXT("Find2")), Log.Reject(TEXT("Find2")));
+	Scheduler.Schedule(EMPSessionOperation::Find, Log.Execute(TEXT("Find3")), Log.Reject(TEXT("Find3")));
+	TestEqual(TEXT("A queued find merges with a newer one"), Scheduler.GetNumQueued(), 1);
+	TestEqual(TEXT("The superseded find is rejected"), Log.Entries, TArray<FString> { TEXT("Find1"), TEXT("Find2 rejected") });
+
+	Scheduler.Schedule(EMPSessionOperation::Find, Log.Execute(TEXT("Federated")), Log.Reject(TEXT("Federated")), EMPSessionOperationPriority::Normal, TEXT("Federated"));
+	TestEqual(TEXT("A find with another merge key is kept apart"), Scheduler.GetNumQueued(), 2);
+
+	Scheduler.Schedule(EMPSessionOperation::Find, Log.Execute(TEXT("Find4")), Log.Reject(TEXT("Find4")), EMPSessionOperationPriority::High);
+	TestEqual(TEXT("A find of another priority is kept apart"), Scheduler.GetNumQueued(), 3);
+	TestEqual(TEXT("Nothing else was rejected"), Log.Entries.Num(), 2);
+
+	Scheduler.Reset();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPSessionOperationSchedulerLifecycleTest, "MultiplayerSessions.OperationScheduler.Lifecycle",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPSessionOperationSchedulerLifecycleTest::RunTest(const FString& Parameters)
+{
+	FMPSessionOperationScheduler Scheduler(TEXT("MPTest"), 0.f, 1.f);
+	FOperationLog Log;
+
+	Scheduler.Schedule(EMPSessionOperation::Update, Log.Execute(TEXT("Update")), Log.Reject(TEXT("Update")));
+	Scheduler.Schedule(EMPSessionOperation::Destroy, Log.Execute(TEXT("Destroy")), Log.Reject(TEXT("Destroy")));
+	TestEqual(TEXT("Update and destroy are rejected without a session"), Log.Entries, TArray<FString> { TEXT("Update rejected"), TEXT("Destroy rejected") });
+	TestEqual(TEXT("Rejected operations leave the queue"), Scheduler.GetNumQueued(), 0);
+
+	Log.Entries.Reset();
+	Scheduler.SetState(EMPSessionState::Created);
+	Scheduler.Schedule(EMPSessionOperation::Update, Log.Execute(TEXT("Update")), Log.Reject(TEXT("Update")));
+	TestTrue(TEXT("An update applies to a created session"), Scheduler.IsInFlight(EMPSessionOperation::Update));
+
+	Scheduler.Schedule(EMPSessionOperation::Start, Log.Execute(TEXT("Start1")), Log.Reject(TEXT("Start1")));
+	Scheduler.Schedule(EMPSessionOperation::Start, Log.Execute(TEXT("Start2")), Log.Reject(TEXT("Start2")));
+	TestEqual(TEXT("A start already queued is not queued again"), Scheduler.GetNumQueued(), 1);
+
+	Scheduler.Schedule(EMPSessionOperation::Create, Log.Execute(TEXT("Create1")), Log.Reject(TEXT("Create1")));
+	Scheduler.Schedule(EMPSessionOperation::Create, Log.Execute(TEXT("Create2")), Log.Reject(TEXT("Create2")));
+	TestEqual(TEXT("Creates are never merged"), Scheduler.GetNumQueued(), 3);
+	TestEqual(TEXT("Only the update was issued, nothing was rejected"), Log.Entries, TArray<FString> { TEXT("Update") });
+
+	Scheduler.Complete(EMPSessionOperation::Find);
+	TestTrue(TEXT("Completing another kind leaves the update in flight"), Scheduler.IsInFlight(EMPSessionOperation::Update));
+
+	Scheduler.Reset();
+	TestEqual(TEXT("Reset drops the queue"), Scheduler.GetNumQueued(), 0);
+	TestFalse(TEXT("Reset ends the operation in flight"), Scheduler.IsInFlight(EMPSessionOperation::Update));
+	return true;
+}
+
+#endif
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MPSessionSchema.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	enum class EMPTestMode : uint8
+	{
+		FreeForAll,
+		CaptureTheFlag
+	};
+
+	MP_DECLARE_SESSION_KEY(FMPTestModeKey, "MPTestMode", EMPTestMode, ViaOnlineServiceAndPing);
+	MP_DECLARE_SESSION_KEY(FMPTestRankKey, "MPTestRank", int32, ViaOnlineService);
+	using FMPTestSchema = TMPSessionSchema<FMPTestModeKey, FMPTestRankKey, FMPMapNameKey>;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPSessionSchemaRoundTripTest, "MultiplayerSessions.SessionSchema.RoundTrip",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPSessionSchemaRoundTripTest::RunTest(const FString& Parameters)
+{
+	FOnlineSessionSettings SessionSettings;
+	TestFalse(TEXT("An empty session is not complete"), FMPTestSchema::IsComplete(SessionSettings));
+
+	FMPTestSchema::Set<FMPTestModeKey>(SessionSettings, EMPTestMode::CaptureTheFlag);
+	FMPTestSchema::Set<FMPTestRankKey>(SessionSettings, 20);
+	TestFalse(TEXT("A session missing a key is not complete"), FMPTestSchema::IsComplete(SessionSettings));
+	FMPTestSchema::Set<FMPMapNameKey>(SessionSettings, TEXT("/Game/Maps/Lobby"));
+	TestTrue(TEXT("A session with every key is complete"), FMPTestSchema::IsComplete(SessionSettings));
+
+	EMPTestMode Mode = EMPTestMode::FreeForAll;
+	int32 Rank = 0;
+	FString MapName;
+	TestTrue(TEXT("Enum key"), FMPTestSchema::Get<FMPTestModeKey>(SessionSettings, Mode) && Mode == EMPTestMode::CaptureTheFlag);
+	TestTrue(TEXT("Integer key"), FMPTestSchema::Get<FMPTestRankKey>(SessionSettings, Rank) && Rank == 20);
+	TestTrue(TEXT("String key"), FMPTestSchema::Get<FMPMapNameKey>(SessionSettings, MapName) && MapName == TEXT("/Game/Maps/Lobby"));
+
+	const FOnlineSessionSetting* ModeSetting = SessionSettings.Settings.Find(FMPTestModeKey::GetName());
+	TestTrue(TEXT("Enums are advertised as their integer value"), ModeSetting && ModeSetting->Data.GetType() == EOnlineKeyValuePairDataType::Int32);
+	TestTrue(TEXT("With their key's advertisement"), ModeSetting && ModeSetting->AdvertisementType == EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+
+	// Advertised by another build with another type
+	SessionSettings.Set(FMPTestRankKey::GetName(), FString(TEXT("20")), EOnlineDataAdvertisementType::ViaOnlineService);
+	TestFalse(TEXT("A key advertised with another type is not read"), FMPTestSchema::Get<FMPTestRankKey>(SessionSettings, Rank));
+	TestFalse(TEXT("Nor counts towards completeness"), FMPTestSchema::IsComplete(SessionSettings));
+	SessionSettings.Remove(FMPMapNameKey::GetName());
+	TestFalse(TEXT("A missing key is not read"), FMPTestSchema::Get<FMPMapNameKey>(SessionSettings, MapName));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMPSessionSchemaQueryTest, "MultiplayerSessions.SessionSchema.Query",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FMPSessionSchemaQueryTest::RunTest(const FString& Parameters)
+{
+	FOnlineSearchSettings QuerySettings;
+	FMPTestSchema::Query<FMPTestRankKey>(QuerySettings, 20, EOnlineComparisonOp::LessThanEquals);
+	FMPTestSchema::Query<FMPTestModeKey>(QuerySettings, EMPTestMode::FreeForAll);
+
+	const FOnlineSessionSearchParam* RankParam = QuerySettings.SearchParams.Find(FMPTestRankKey::GetName());
+	if (TestNotNull(TEXT("The rank filter is added"), RankParam))
+	{
+		int32 Rank = 0;
+		RankParam->Data.GetValue(Rank);
+		TestTrue(TEXT("Compared in its native type"), RankParam->Data.GetType() == EOnlineKeyValuePairDataType::Int32);
+		TestEqual(TEXT("With the requested value"), Rank, 20);
+		TestTrue(TEXT("And comparison"), RankParam->ComparisonOp == EOnlineComparisonOp::LessThanEquals);
+	}
+	const FOnlineSessionSearchParam* ModeParam = QuerySettings.SearchParams.Find(FMPTestModeKey::GetName());
+	if (TestNotNull(TEXT("The mode filter is added"), ModeParam))
+	{
+		TestTrue(TEXT("Equality by default"), ModeParam->ComparisonOp == EOnlineComparisonOp::Equals);
+	}
+
+	FSessionSettings SessionAttributes;
+	FMPTestSchema::Set<FMPTestRankKey>(SessionAttributes, 12);
+	const FOnlineSessionSetting* RankAttribute = SessionAttributes.Find(FMPTestRankKey::GetName());
+	if (TestNotNull(TEXT("Attributes passed to the subsystem are typed too"), RankAttribute))
+	{
+		int32 Rank = 0;
+		RankAttribute->Data.GetValue(Rank);
+		TestEqual(TEXT("Attribute value"), Rank, 12);
+		TestTrue(TEXT("Attribute advertisement"), RankAttribute->AdvertisementType == EOnlineDataAdvertisementType::ViaOnlineService);
+	}
+	return true;
+}
+
+#endif
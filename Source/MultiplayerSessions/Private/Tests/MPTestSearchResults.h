@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "MPStandInSessionInfo.h"
+#include "OnlineSessionSettings.h"
+
+namespace MPTests
+{
+	/** A search result with a session id, without an online subsystem behind it */
+	inline FOnlineSessionSearchResult MakeSearchResult(
+		const FString& SessionId,
+		const FString& OwningUserName = FString(),
+		const int32 NumOpenPublicConnections = 1,
+		const int32 PingInMs = 0
+	)
+	{
+		FOnlineSessionSearchResult SearchResult;
+		SearchResult.Session.SessionInfo = MakeShared<FMPStandInSessionInfo>(SessionId, FName(TEXT("MPTest")));
+		SearchResult.Session.OwningUserName = OwningUserName;
+		SearchResult.Session.NumOpenPublicConnections = NumOpenPublicConnections;
+		SearchResult.PingInMs = PingInMs;
+		return SearchResult;
+	}
+
+	inline TArray<FString> GetSessionIds(const TArray<FOnlineSessionSearchResult>& SearchResults)
+	{
+		TArray<FString> SessionIds;
+		for (const FOnlineSessionSearchResult& SearchResult : SearchResults)
+		{
+			SessionIds.Add(SearchResult.GetSessionIdStr());
+		}
+		return SessionIds;
+	}
+}
+
+#endif
@@ -22,5 +22,6 @@ struct  MULTIPLAYERSESSIONS_API FBPSessionResult
 	FString OwningUserName;
 	UPROPERTY(BlueprintReadOnly)
 	TMap<FName, FString> SessionSettings;
-	
+
+	void SetFromOnlineResult(const FOnlineSessionSearchResult& OnlineResult);
 };
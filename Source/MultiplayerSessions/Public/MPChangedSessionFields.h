@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MPChangedSessionFields.generated.h"
+
+/** What changed in a session the session browser reports as changed, one per changed session and in the same order */
+USTRUCT(BlueprintType)
+struct MULTIPLAYERSESSIONS_API FMPChangedSessionFields
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Session Browser")
+	FString SessionId;
+
+	/** Session settings that changed, plus OwningUserName, NumOpenPublicConnections and NumOpenPrivateConnections */
+	UPROPERTY(BlueprintReadOnly, Category = "Session Browser")
+	TArray<FName> Fields;
+};
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "MPScopedDelegateBinding.h"
+#include "OnlineSessionSettings.h"
+#include "Interfaces/OnlineSessionInterface.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPFederatedSearch, Log, All);
+
+struct MULTIPLAYERSESSIONS_API FMPFederatedSearchResult
+{
+	/** Online subsystem the session was found on, it is joined through that one */
+	FName OnlineSubsystemName;
+	FOnlineSessionSearchResult SearchResult;
+	/** The stable key the host advertised (FMPSessionKeyKey), or where it has none, the backend and its session id */
+	FString SessionKey;
+};
+
+DECLARE_DELEGATE_TwoParams(FMPOnFederatedSearchResults, FName OnlineSubsystemName, const TArray<FMPFederatedSearchResult>& NewResults);
+DECLARE_DELEGATE_OneParam(FMPOnFederatedSearchComplete, bool bWasSuccessful);
+
+/**
+ * One session search run on several online subsystems at once, so it takes as long as the slowest of them instead of
+ * their sum. Results are merged as each backend answers: a session advertised on several backends under the same stable
+ * key is kept once, as found by the first backend to answer. OnResults gets the sessions each answer added,
+ * OnComplete fires once every backend answered, successfully if one of them did. Backends that haven't answered by the
+ * deadline are completed as failed, a backend that never calls back can't keep the search going.
+ *
+ * The caller may search some backends itself (AddPendingBackend, then OnBackendSearchComplete), e.g. the one whose
+ * searches it already serializes; IssueSearch searches the others directly.
+ */
+class MULTIPLAYERSESSIONS_API FMPFederatedSessionSearch
+{
+public:
+	FMPFederatedSessionSearch(FMPOnFederatedSearchResults&& InOnResults, FMPOnFederatedSearchComplete&& InOnComplete, const float TimeoutSeconds);
+	~FMPFederatedSessionSearch();
+
+	FMPFederatedSessionSearch(const FMPFederatedSessionSearch&) = delete;
+	FMPFederatedSessionSearch& operator=(const FMPFederatedSessionSearch&) = delete;
+
+	/**
+	 * Searches an online subsystem through its own session interface.
+	 * @return  False if it isn't loaded or refused the search, it then doesn't count as pending
+	 */
+	bool IssueSearch(const FName OnlineSubsystemName, const TSharedRef<FOnlineSessionSearch>& Search, const int32 SearchingPlayerNum);
+	void AddPendingBackend(const FName OnlineSubsystemName);
+	/** Merges a backend's results, completes the search once no backend is pending anymore. Ignored past the deadline */
+	void OnBackendSearchComplete(const FName OnlineSubsystemName, const TArray<FOnlineSessionSearchResult>& BackendResults, const bool bWasSuccessful);
+	/** Call once every backend is issued, a search with none pending completes here */
+	void FinishIssuing();
+
+	bool IsSearching() const { return NumPendingBackends > 0; }
+	const TArray<FMPFederatedSearchResult>& GetResults() const { return Results; }
+	const FMPFederatedSearchResult* FindResult(const FString& SessionKey) const;
+
+	static FString GetSessionKey(const FName OnlineSubsystemName, const FOnlineSessionSearchResult& SearchResult);
+
+private:
+	struct FRemoteSearch
+	{
+		FName OnlineSubsystemName;
+		TSharedPtr<FOnlineSessionSearch> Search;
+		FMPScopedDelegateBinding CompleteBinding;
+	};
+
+	void OnRemoteSearchComplete(bool bWasSuccessful, FName OnlineSubsystemName);
+	void OnTimeout();
+	void Complete();
+
+	FMPOnFederatedSearchResults OnResults;
+	FMPOnFederatedSearchComplete OnComplete;
+	TArray<FRemoteSearch> RemoteSearches;
+	TSet<FName> PendingBackendNames;
+	FTSTicker::FDelegateHandle TimeoutHandle;
+	TArray<FMPFederatedSearchResult> Results;
+	// Index in Results of each session key
+	TMap<FString, int32> ResultIndices;
+	// Starts at one for the issuing itself, so a backend answering synchronously can't complete the search early
+	int32 NumPendingBackends { 1 };
+	int32 NumBackends { 0 };
+	bool bHasAnySucceeded { false };
+	double StartTime { 0.0 };
+	FName SlowestBackend;
+	double SlowestBackendSeconds { 0.0 };
+};
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MPHostTimings.generated.h"
+
+/**
+ * Time spent in each stage of UMultiplayerSessionsSubsystem::HostSession, in seconds since the call.
+ * A stage that did not run (or had not finished when the host travelled) is -1.
+ */
+USTRUCT(BlueprintType)
+struct MULTIPLAYERSESSIONS_API FMPHostTimings
+{
+	GENERATED_BODY()
+
+	/** Session created (or updated in place) */
+	UPROPERTY(BlueprintReadOnly, Category = "Host Timings")
+	float CreateSeconds = -1.f;
+
+	/** Session started, only when FMPSessionSettings::bStartAfterCreate is set */
+	UPROPERTY(BlueprintReadOnly, Category = "Host Timings")
+	float StartSeconds = -1.f;
+
+	/** Destination map loaded in the background, overlapping the create and start round trips */
+	UPROPERTY(BlueprintReadOnly, Category = "Host Timings")
+	float MapPreloadSeconds = -1.f;
+
+	/** Server travel issued */
+	UPROPERTY(BlueprintReadOnly, Category = "Host Timings")
+	float TotalSeconds = -1.f;
+};
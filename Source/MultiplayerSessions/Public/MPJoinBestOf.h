@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/OnlineSessionInterface.h"
+
+/** How UMultiplayerSessionsSubsystem::JoinBestOf goes through its candidates */
+struct MULTIPLAYERSESSIONS_API FMPJoinBestOfPolicy
+{
+	/** Joins attempted at most, 0 attempts every candidate */
+	int32 MaxAttempts { 3 };
+
+	/**
+	 * Looks each candidate up again by id right before joining it and skips it if it has no open public slot left.
+	 * Costs a round trip per candidate, worth it when the search results may be several seconds old.
+	 */
+	bool bReverifySlots { false };
+
+	/**
+	 * By default only a full, gone or unreachable session moves on to the next candidate, any other failure (e.g. already
+	 * in a session) would fail the same way on every candidate and ends the join.
+	 */
+	bool bFailOverOnAnyError { false };
+};
+
+/** Outcome of UMultiplayerSessionsSubsystem::JoinBestOf */
+struct MULTIPLAYERSESSIONS_API FMPJoinBestOfResult
+{
+	/** Result of the last attempt, SessionDoesNotExist if every candidate was skipped */
+	EOnJoinSessionCompleteResult::Type Result { EOnJoinSessionCompleteResult::UnknownError };
+
+	/** Index in the candidates of the joined session, INDEX_NONE unless the join succeeded */
+	int32 JoinedCandidateIndex { INDEX_NONE };
+
+	/** Joins issued, 1 for a first-try success */
+	int32 NumAttempts { 0 };
+
+	/** Candidates left out without a join: blacklisted, or found full or gone when re-verified */
+	int32 NumSkipped { 0 };
+
+	/** From the call to the final result, including the re-verification round trips */
+	double Seconds { 0.0 };
+
+	/** Result of each join issued, in order */
+	TArray<EOnJoinSessionCompleteResult::Type> AttemptResults;
+
+	bool WasSuccessful() const { return Result == EOnJoinSessionCompleteResult::Success; }
+};
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+#include "Interfaces/OnlineSessionInterface.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPJoinBlacklist, Log, All);
+
+/**
+ * Sessions this client recently failed to join (full, gone, no address), left out of search results until their entry
+ * expires so players don't hit the same stale advertisement again. Entries are keyed by a 64-bit hash of the session id,
+ * 16 bytes each whatever the id's length; two ids sharing a hash would hide both, which a 64-bit hash makes negligible.
+ * Holds at most MaxEntries, the entry closest to expiring makes room for a new one.
+ */
+class MULTIPLAYERSESSIONS_API FMPJoinBlacklist
+{
+public:
+	explicit FMPJoinBlacklist(const int32 InMaxEntries = 256);
+
+	/** Only the reasons a later join would likely fail for again are blacklisted, @return  False for the others */
+	bool Add(const FString& SessionId, const EOnJoinSessionCompleteResult::Type Reason, const float TtlSeconds);
+	void Remove(const FString& SessionId);
+	bool Contains(const FString& SessionId, EOnJoinSessionCompleteResult::Type* OutReason = nullptr) const;
+	/** Removes the blacklisted results, keeping the order of the others. @return  The number removed */
+	int32 Filter(TArray<FOnlineSessionSearchResult>& SearchResults);
+	void Reset();
+	int32 Num() const { return Entries.Num(); }
+
+	static bool IsBlacklistedReason(const EOnJoinSessionCompleteResult::Type Reason);
+
+private:
+	struct FEntry
+	{
+		double ExpireTime { 0.0 };
+		EOnJoinSessionCompleteResult::Type Reason { EOnJoinSessionCompleteResult::UnknownError };
+	};
+
+	static uint64 HashSessionId(const FString& SessionId);
+	void RemoveExpired(const double Now);
+
+	TMap<uint64, FEntry> Entries;
+	int32 MaxEntries { 256 };
+};
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Latency samples of one operation, with their percentiles, for the load and benchmark tools */
+class MULTIPLAYERSESSIONS_API FMPLatencyStats
+{
+public:
+	void Add(const double Seconds);
+	void Reset();
+
+	int32 Num() const { return Samples.Num(); }
+	double GetMean() const;
+	double GetMax() const;
+	/** Nearest rank percentile, Percentile in [0, 100]. 0 without samples */
+	double GetPercentile(const double Percentile) const;
+
+	/** e.g. "n=120 mean=81.2ms p50=79.0ms p95=118.4ms p99=131.0ms max=140.2ms" */
+	FString ToString() const;
+
+private:
+	// Sorted on demand by GetPercentile
+	mutable TArray<double> Samples;
+	mutable bool bIsSorted { true };
+	double Sum { 0.0 };
+};
@@ -0,0 +1,353 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "UObject/ScriptDelegates.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPListenerProfiler, Log, All);
+
+// Defined to 0 by a target, the timing is left out of its other configurations too
+#ifndef MP_WITH_LISTENER_PROFILER
+#define MP_WITH_LISTENER_PROFILER !UE_BUILD_SHIPPING
+#endif
+
+/**
+ * Measures how long each listener of the subsystem's and the component's events takes, one listener at a time, so a slow
+ * one can be found without a profiler capture. A listener over the budget is logged with its object, totals per event
+ * and listener are kept until reset.
+ *
+ * Off by default and left out of Shipping builds, where the console variables and commands don't exist.
+ *
+ * MPSessions.ProfileListeners 0|1		Turns the timing on, at 0 events are broadcast as usual
+ * MPSessions.ListenerBudgetMs 1.0		Budget of a single listener call
+ * MPSessions.ListenerStats				Logs the totals, slowest listener first
+ * MPSessions.ResetListenerStats
+ */
+class MULTIPLAYERSESSIONS_API FMPListenerProfiler
+{
+public:
+	struct FListenerStats
+	{
+		const TCHAR* EventName { nullptr };
+		/** Totals are per class, so listeners recreated over a session (widgets, components) add up. Null if not a UObject */
+		TWeakObjectPtr<const UClass> ListenerClass;
+		FName FunctionName;
+		int32 NumCalls { 0 };
+		int32 NumOverBudget { 0 };
+		double TotalSeconds { 0.0 };
+		double MaxSeconds { 0.0 };
+
+		/** Class and function of the listener, or where it's not a UObject, what it's bound to */
+		FString GetListenerName() const;
+	};
+
+	/** Times one listener call from construction to destruction, does nothing while profiling is off */
+	class FScope
+	{
+	public:
+		FScope(const TCHAR* InEventName, const UObject* InListener, const FName InFunctionName);
+		~FScope();
+
+		FScope(const FScope&) = delete;
+		FScope& operator=(const FScope&) = delete;
+
+	private:
+		const TCHAR* EventName;
+		TWeakObjectPtr<const UObject> Listener;
+		FName FunctionName;
+		double StartTime { 0.0 };
+	};
+
+	static FMPListenerProfiler& Get();
+#if MP_WITH_LISTENER_PROFILER
+	static bool IsEnabled();
+#else
+	static constexpr bool IsEnabled() { return false; }
+#endif
+	static float GetBudgetMs();
+
+	void RecordListenerCall(const TCHAR* EventName, const UObject* Listener, const FName FunctionName, const double Seconds);
+	/** @return  The totals of every listener, slowest first */
+	TArray<FListenerStats> GetListenerStats() const;
+	void DumpListenerStats() const;
+	void ResetListenerStats();
+
+	/**
+	 * Broadcasts a dynamic multicast delegate (a BlueprintAssignable event) one listener at a time, through a delegate holding
+	 * only that listener, so each call is timed on its own. Listeners are called in the order and from the copy
+	 * ProcessMulticastDelegate would use, one unbound by an earlier listener is skipped.
+	 */
+	template <typename DynamicDelegateType, typename... ArgTypes>
+	static void BroadcastDynamic(const TCHAR* EventName, const DynamicDelegateType& Delegate, const ArgTypes&... Args)
+	{
+		if (!IsEnabled())
+		{
+			Delegate.Broadcast(Args...);
+			return;
+		}
+
+		const TArray<FScriptDelegate> Listeners = FScriptInvocationList::Copy(Delegate);
+		for (const FScriptDelegate& Listener : Listeners)
+		{
+			if (!Listener.IsBound() || !static_cast<const FMulticastScriptDelegate&>(Delegate).Contains(Listener))
+			{
+				continue;
+			}
+			DynamicDelegateType SingleListener;
+			static_cast<FMulticastScriptDelegate&>(SingleListener).Add(Listener);
+			FScope Scope(EventName, Listener.GetUObject(), Listener.GetFunctionName());
+			SingleListener.Broadcast(Args...);
+		}
+	}
+
+private:
+	// The invocation list of dynamic delegates is protected, a member pointer formed here reads it without a cast
+	struct FScriptInvocationList : public FMulticastScriptDelegate
+	{
+		static TArray<FScriptDelegate> Copy(const FMulticastScriptDelegate& Delegate)
+		{
+			return Delegate.*(&FScriptInvocationList::InvocationList);
+		}
+	};
+
+	struct FListenerKey
+	{
+		const TCHAR* EventName;
+		TWeakObjectPtr<const UClass> ListenerClass;
+		FName FunctionName;
+
+		bool operator==(const FListenerKey& Other) const
+		{
+			return EventName == Other.EventName && ListenerClass == Other.ListenerClass && FunctionName == Other.FunctionName;
+		}
+
+		friend uint32 GetTypeHash(const FListenerKey& Key)
+		{
+			return HashCombine(HashCombine(::PointerHash(Key.EventName), GetTypeHash(Key.ListenerClass)), GetTypeHash(Key.FunctionName));
+		}
+	};
+
+	mutable FCriticalSection StatsCriticalSection;
+	// Event names are the literals the events are declared with, so they are keyed by pointer and no string is built per call
+	TMap<FListenerKey, FListenerStats> Stats;
+};
+
+/**
+ * Multicast delegate with the interface of the engine's native ones, whose broadcast times each listener through
+ * FMPListenerProfiler. Listeners are called newest first, like the engine's; one added by a listener is first called by
+ * the next broadcast, one removed by a listener is not called anymore. Listeners bound to a destroyed object are dropped.
+ *
+ *	using FMyEvent = TMPProfiledMulticastDelegate<void(bool bWasSuccessful)>;
+ *	FMyEvent MyEvent { TEXT("MyEvent") };
+ */
+template <typename FunctionType>
+class TMPProfiledMulticastDelegate;
+
+template <typename... ParamTypes>
+class TMPProfiledMulticastDelegate<void(ParamTypes...)>
+{
+public:
+	using FDelegate = TDelegate<void(ParamTypes...)>;
+
+	explicit TMPProfiledMulticastDelegate(const TCHAR* InEventName):
+		EventName(InEventName)
+	{
+	}
+
+	FDelegateHandle Add(FDelegate&& Delegate)
+	{
+		if (!Delegate.IsBound())
+		{
+			return FDelegateHandle();
+		}
+		const FDelegateHandle Handle = Delegate.GetHandle();
+		Bindings.Add(MakeShared<FBinding, ESPMode::NotThreadSafe>(MoveTemp(Delegate)));
+		return Handle;
+	}
+
+	FDelegateHandle Add(const FDelegate& Delegate)
+	{
+		return Add(CopyTemp(Delegate));
+	}
+
+	template <typename... VarTypes>
+	FDelegateHandle AddStatic(VarTypes&&... Vars)
+	{
+		return Add(FDelegate::CreateStatic(Forward<VarTypes>(Vars)...));
+	}
+
+	template <typename... VarTypes>
+	FDelegateHandle AddLambda(VarTypes&&... Vars)
+	{
+		return Add(FDelegate::CreateLambda(Forward<VarTypes>(Vars)...));
+	}
+
+	template <typename... VarTypes>
+	FDelegateHandle AddWeakLambda(VarTypes&&... Vars)
+	{
+		return Add(FDelegate::CreateWeakLambda(Forward<VarTypes>(Vars)...));
+	}
+
+	template <typename... VarTypes>
+	FDelegateHandle AddRaw(VarTypes&&... Vars)
+	{
+		return Add(FDelegate::CreateRaw(Forward<VarTypes>(Vars)...));
+	}
+
+	template <typename... VarTypes>
+	FDelegateHandle AddSP(VarTypes&&... Vars)
+	{
+		return Add(FDelegate::CreateSP(Forward<VarTypes>(Vars)...));
+	}
+
+	template <typename... VarTypes>
+	FDelegateHandle AddUObject(VarTypes&&... Vars)
+	{
+		return Add(FDelegate::CreateUObject(Forward<VarTypes>(Vars)...));
+	}
+
+	template <typename... VarTypes>
+	FDelegateHandle AddUFunction(VarTypes&&... Vars)
+	{
+		return Add(FDelegate::CreateUFunction(Forward<VarTypes>(Vars)...));
+	}
+
+	bool Remove(const FDelegateHandle Handle)
+	{
+		return Handle.IsValid() && RemoveBindings([Handle](const FDelegate& Delegate)
+		{
+			return Delegate.GetHandle() == Handle;
+		}) > 0;
+	}
+
+	/** @return  The number of listeners removed */
+	int32 RemoveAll(const void* UserObject)
+	{
+		return RemoveBindings([UserObject](const FDelegate& Delegate)
+		{
+			return Delegate.IsBoundToObject(UserObject);
+		});
+	}
+
+	void Clear()
+	{
+		RemoveBindings([](const FDelegate& Delegate)
+		{
+			return true;
+		});
+	}
+
+	bool IsBound() const
+	{
+		return Bindings.ContainsByPredicate([](const FBindingRef& Binding)
+		{
+			return !Binding->bIsRemoved && Binding->Delegate.IsBound();
+		});
+	}
+
+	bool IsBoundToObject(const void* UserObject) const
+	{
+		return Bindings.ContainsByPredicate([UserObject](const FBindingRef& Binding)
+		{
+			return !Binding->bIsRemoved && Binding->Delegate.IsBoundToObject(UserObject);
+		});
+	}
+
+	void Broadcast(ParamTypes... Params) const
+	{
+		const bool bIsProfiling = FMPListenerProfiler::IsEnabled();
+		++BroadcastDepth;
+		for (int32 Index = Bindings.Num() - 1; Index >= 0; --Index)
+		{
+			// Held for the call, the listener may remove itself
+			const FBindingRef Binding = Bindings[Index];
+			if (Binding->bIsRemoved)
+			{
+				continue;
+			}
+
+			bool bWasExecuted = false;
+			if (bIsProfiling)
+			{
+				FMPListenerProfiler::FScope Scope(EventName, Binding->Delegate.GetUObject(), GetBoundFunctionName(Binding->Delegate));
+				bWasExecuted = Binding->Delegate.ExecuteIfBound(Params...);
+			}
+			else
+			{
+				bWasExecuted = Binding->Delegate.ExecuteIfBound(Params...);
+			}
+			if (!bWasExecuted)
+			{
+				Binding->bIsRemoved = true;
+				bNeedsCompaction = true;
+			}
+		}
+		if (--BroadcastDepth == 0 && bNeedsCompaction)
+		{
+			bNeedsCompaction = false;
+			Bindings.RemoveAll([](const FBindingRef& Binding)
+			{
+				return Binding->bIsRemoved;
+			});
+		}
+	}
+
+private:
+	struct FBinding
+	{
+		explicit FBinding(FDelegate&& InDelegate):
+			Delegate(MoveTemp(InDelegate))
+		{
+		}
+
+		FDelegate Delegate;
+		bool bIsRemoved { false };
+	};
+	using FBindingRef = TSharedRef<FBinding, ESPMode::NotThreadSafe>;
+
+	/** Removes now, or while broadcasting, once the outermost broadcast is over */
+	template <typename PredicateType>
+	int32 RemoveBindings(PredicateType&& Predicate)
+	{
+		int32 NumRemoved = 0;
+		for (const FBindingRef& Binding : Bindings)
+		{
+			if (!Binding->bIsRemoved && Predicate(Binding->Delegate))
+			{
+				Binding->bIsRemoved = true;
+				++NumRemoved;
+			}
+		}
+		if (NumRemoved > 0)
+		{
+			if (BroadcastDepth > 0)
+			{
+				bNeedsCompaction = true;
+			}
+			else
+			{
+				Bindings.RemoveAll([](const FBindingRef& Binding)
+				{
+					return Binding->bIsRemoved;
+				});
+			}
+		}
+		return NumRemoved;
+	}
+
+	static FName GetBoundFunctionName(const FDelegate& Delegate)
+	{
+#if USE_DELEGATE_TRYGETBOUNDFUNCTIONNAME
+		return Delegate.TryGetBoundFunctionName();
+#else
+		return NAME_None;
+#endif
+	}
+
+	const TCHAR* EventName;
+	mutable TArray<FBindingRef> Bindings;
+	mutable int32 BroadcastDepth { 0 };
+	mutable bool bNeedsCompaction { false };
+};
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "OnlineSessionSettings.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPOnlineTraffic, Log, All);
+
+/** What the subsystem sends to IOnlineSession and IOnlineIdentity, and what it gets back */
+enum class EMPOnlineTrafficEvent : uint8
+{
+	LoginCall,
+	CreateSessionCall,
+	UpdateSessionCall,
+	StartSessionCall,
+	DestroySessionCall,
+	FindSessionsCall,
+	FindSessionByIdCall,
+	JoinSessionCall,
+	// Callbacks, in the order of the calls they answer
+	LoginComplete,
+	CreateSessionComplete,
+	UpdateSessionComplete,
+	StartSessionComplete,
+	DestroySessionComplete,
+	FindSessionsComplete,
+	FindSessionByIdComplete,
+	JoinSessionComplete,
+	Num
+};
+
+constexpr int32 MPNumOnlineTrafficCalls { static_cast<int32>(EMPOnlineTrafficEvent::LoginComplete) };
+
+struct MULTIPLAYERSESSIONS_API FMPOnlineTrafficEvent
+{
+	EMPOnlineTrafficEvent Kind { EMPOnlineTrafficEvent::LoginCall };
+	/** Seconds since the recording started */
+	double Time { 0.0 };
+	FName SessionName;
+	/** Calls: whether the interface accepted the call. Callbacks: their outcome */
+	bool bWasSuccessful { false };
+	/** Local user of a login, max results of a search, join result */
+	int32 Value { 0 };
+	/** Login user id, searched session id */
+	FString Id;
+	/** Login error */
+	FString Error;
+	/** Create and update calls only */
+	FOnlineSessionSettings SessionSettings;
+	/** Found sessions, joined session */
+	TArray<FOnlineSessionSearchResult> SearchResults;
+	/** Callbacks: state of the backend's game session when they arrived, replays follow it instead of the online subsystem */
+	bool bHasNamedSession { false };
+	uint8 NamedSessionState { 0 };
+
+	FMPOnlineTrafficEvent() = default;
+	FMPOnlineTrafficEvent(const EMPOnlineTrafficEvent InKind, const FName InSessionName, const bool bInWasSuccessful = false, const int32 InValue = 0):
+		Kind(InKind),
+		SessionName(InSessionName),
+		bWasSuccessful(bInWasSuccessful),
+		Value(InValue)
+	{
+	}
+
+	bool IsCall() const { return static_cast<int32>(Kind) < MPNumOnlineTrafficCalls; }
+	static const TCHAR* LexToString(const EMPOnlineTrafficEvent InKind);
+
+	/** Search results are loaded with a stand-in session info that only carries their session id */
+	friend MULTIPLAYERSESSIONS_API FArchive& operator<<(FArchive& Ar, FMPOnlineTrafficEvent& Event);
+};
+
+/**
+ * Writes the subsystem's online traffic to a binary log: a small header, then the events in the order they were recorded.
+ * Names are written as strings, so logs can be read by any build.
+ */
+class MULTIPLAYERSESSIONS_API FMPOnlineTrafficRecorder
+{
+public:
+	explicit FMPOnlineTrafficRecorder(const FString& InPath);
+	~FMPOnlineTrafficRecorder();
+
+	bool IsRecording() const { return Writer.IsValid(); }
+	/** Seconds since the recording started, stamp calls with it before issuing them */
+	double GetTime() const;
+	void Record(FMPOnlineTrafficEvent& Event);
+	int32 GetNumEvents() const { return NumEvents; }
+
+private:
+	FString Path;
+	TUniquePtr<FArchive> FileWriter;
+	TUniquePtr<FArchive> Writer;
+	double StartTime { 0.0 };
+	int32 NumEvents { 0 };
+};
+
+/**
+ * Answers the subsystem's calls with the callbacks of a recorded log, in place of the online interfaces.
+ * The n-th call of a kind gets the answer recorded for the n-th call of that kind, after the recorded round trip or,
+ * as fast as possible, on the next tick. Callbacks are delivered from the core ticker in due order, so a replay is
+ * deterministic as long as the subsystem is driven the same way as when recording.
+ */
+class MULTIPLAYERSESSIONS_API FMPOnlineTrafficReplay
+{
+public:
+	using FDeliverCallback = TUniqueFunction<void(const FMPOnlineTrafficEvent& Callback)>;
+
+	FMPOnlineTrafficReplay(const FString& Path, const bool bInAsFastAsPossible);
+	~FMPOnlineTrafficReplay();
+
+	bool IsLoaded() const { return bIsLoaded; }
+	/**
+	 * Replays the next recorded call of this kind, Deliver gets its recorded callback if it had one.
+	 * @return  What the interface returned when it was recorded, false once the log has no such call left
+	 */
+	bool Issue(const EMPOnlineTrafficEvent CallKind, FDeliverCallback&& Deliver);
+	int32 GetNumPendingCallbacks() const { return PendingCallbacks.Num(); }
+
+private:
+	struct FRecordedCall
+	{
+		bool bWasIssued { false };
+		double RoundTripSeconds { 0.0 };
+		int32 CallbackIndex { INDEX_NONE };
+	};
+
+	struct FPendingCallback
+	{
+		double DueTime { 0.0 };
+		uint64 Sequence { 0 };
+		int32 CallbackIndex { INDEX_NONE };
+		FDeliverCallback Deliver;
+	};
+
+	bool Load(const FString& Path);
+	bool Tick(float DeltaTime);
+	static bool IsDueFirst(const FPendingCallback& A, const FPendingCallback& B);
+
+	bool bAsFastAsPossible { false };
+	bool bIsLoaded { false };
+	TArray<FMPOnlineTrafficEvent> Callbacks;
+	TArray<FRecordedCall> Calls[MPNumOnlineTrafficCalls];
+	int32 NextCalls[MPNumOnlineTrafficCalls] {};
+	// Min-heap on due time, then on sequence
+	TArray<FPendingCallback> PendingCallbacks;
+	uint64 NextSequence { 0 };
+	FTSTicker::FDelegateHandle TickerHandle;
+};
@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/SaveGame.h"
+#include "MPReconnectSaveGame.generated.h"
+
+/**
+ * The last joined session, saved so a restarted client can reconnect to it (see UMultiplayerSessionsSubsystem::Reconnect).
+ * Search results cannot be saved, a restarted client looks the session up by id.
+ */
+UCLASS()
+class MULTIPLAYERSESSIONS_API UMPReconnectSaveGame : public USaveGame
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	FString SessionId;
+
+	UPROPERTY()
+	FDateTime SavedAtUtc;
+
+	static const FString SlotName;
+};
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Invoke.h"
+#include <atomic>
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPScopedDelegateBinding, Log, All);
+
+/**
+ * Owns one delegate binding and removes it when reset, reassigned or destroyed, so a binding can't outlive its owner
+ * or be overwritten without being removed. Bindings to a delegate whose owner is already gone are simply dropped.
+ * GetNumLiveBindings (console: MPSessions.LiveBindings) counts the bindings currently held, it should stay flat over a session.
+ */
+class MULTIPLAYERSESSIONS_API FMPScopedDelegateBinding
+{
+public:
+	FMPScopedDelegateBinding() = default;
+	explicit FMPScopedDelegateBinding(TUniqueFunction<void()>&& InUnbind);
+	~FMPScopedDelegateBinding();
+
+	FMPScopedDelegateBinding(FMPScopedDelegateBinding&& Other);
+	FMPScopedDelegateBinding& operator=(FMPScopedDelegateBinding&& Other);
+	FMPScopedDelegateBinding(const FMPScopedDelegateBinding&) = delete;
+	FMPScopedDelegateBinding& operator=(const FMPScopedDelegateBinding&) = delete;
+
+	/** Removes the binding now */
+	void Reset();
+	bool IsBound() const { return bIsBound; }
+
+	static int32 GetNumLiveBindings();
+
+	/** Binding to a multicast delegate owned by DelegateOwner, e.g. one of the subsystem's */
+	template <typename DelegateType>
+	static FMPScopedDelegateBinding ForMulticast(const UObject* DelegateOwner, DelegateType& Delegate, const FDelegateHandle Handle)
+	{
+		return FMPScopedDelegateBinding([WeakOwner = TWeakObjectPtr<const UObject>(DelegateOwner), &Delegate, Handle]()
+		{
+			if (WeakOwner.IsValid())
+			{
+				Delegate.Remove(Handle);
+			}
+		});
+	}
+
+	/** Binding to a global multicast delegate, e.g. FCoreUObjectDelegates */
+	template <typename DelegateType>
+	static FMPScopedDelegateBinding ForMulticast(DelegateType& Delegate, const FDelegateHandle Handle)
+	{
+		return FMPScopedDelegateBinding([&Delegate, Handle]()
+		{
+			Delegate.Remove(Handle);
+		});
+	}
+
+	/** Binds a UObject method to a multicast delegate owned by DelegateOwner */
+	template <typename DelegateType, typename UserClass, typename FunctionType>
+	static FMPScopedDelegateBinding AddUObject(const UObject* DelegateOwner, DelegateType& Delegate, UserClass* UserObject, FunctionType Function)
+	{
+		return ForMulticast(DelegateOwner, Delegate, Delegate.AddUObject(UserObject, Function));
+	}
+
+	/**
+	 * Binding to an online interface delegate, removed through Clear (e.g. &IOnlineSession::ClearOnCreateSessionCompleteDelegate_Handle,
+	 * or a callable taking the interface and the handle). Nothing is removed if the interface is gone.
+	 */
+	template <typename InterfaceType, typename ClearFunctionType>
+	static FMPScopedDelegateBinding ForInterface(
+		const TSharedPtr<InterfaceType, ESPMode::ThreadSafe>& Interface,
+		const FDelegateHandle Handle,
+		ClearFunctionType&& Clear
+	)
+	{
+		return FMPScopedDelegateBinding(
+			[WeakInterface = TWeakPtr<InterfaceType, ESPMode::ThreadSafe>(Interface), Handle, Clear = Forward<ClearFunctionType>(Clear)]() mutable
+			{
+				if (const TSharedPtr<InterfaceType, ESPMode::ThreadSafe> PinnedInterface = WeakInterface.Pin())
+				{
+					Invoke(Clear, *PinnedInterface, Handle);
+				}
+			}
+		);
+	}
+
+private:
+	TUniqueFunction<void()> Unbind;
+	bool bIsBound { false };
+
+	static std::atomic<int32> NumLiveBindings;
+};
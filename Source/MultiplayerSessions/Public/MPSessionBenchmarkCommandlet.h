@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MPLatencyStats.h"
+#include "MPSessionSettings.h"
+#include "OnlineSessionSettings.h"
+#include "MPSessionBenchmarkCommandlet.generated.h"
+
+class FJsonObject;
+class UGameInstance;
+class UMultiplayerSessionsSubsystem;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPSessionBenchmark, Log, All);
+
+/**
+ * Repeatable benchmark of a session flow, to catch latency regressions between builds.
+ * Runs the steps of a scenario file in order, many times, through the real UMultiplayerSessionsSubsystem of a standalone
+ * game instance, against the online subsystem selected with -MPSessionsOSS= (NULL for a local stand-in). The timings of
+ * every step are then compared with a stored baseline.
+ *
+ * UnrealEditor-Cmd <Project> -run=MPSessionBenchmark -Scenario=Benchmarks/HostAndFind.json -MPSessionsOSS=NULL
+ *	-Iterations=20 -Warmup=1					Timed iterations, after untimed warmup ones
+ *	-Baseline=<File>							Defaults to Saved/MPSessionBenchmark/<Scenario name>.json, recorded if missing
+ *	-UpdateBaseline								Records this run as the baseline instead of comparing with it
+ *	-Metric=P50 -Threshold=0.2 -MinRegressionMs=2	A step regresses when its metric (Mean, P50, P95, P99, Max) exceeds the
+ *												baseline by more than Threshold (relative) and MinRegressionMs
+ *	-StepTimeout=30
+ * Returns 1 if a step failed or the scenario can't be run, 2 if a step regressed.
+ *
+ * Scenario file:
+ * {
+ *	"Name": "HostAndFind",
+ *	"Steps": [
+ *		{ "Op": "Login" },
+ *		{ "Op": "Create", "PublicConnections": 4, "Settings": { "bUseLAN": true }, "Extras": { "MATCHTYPE": "Bench" } },
+ *		{ "Op": "Start" },
+ *		{ "Op": "Find", "MaxSearchResults": 50, "Filters": { "MATCHTYPE": "Bench" }, "MinResults": 1 },
+ *		{ "Op": "Destroy" },
+ *		{ "Op": "Join", "Result": 0 },
+ *		{ "Op": "Wait", "Seconds": 0.5 }
+ *	]
+ * }
+ * Settings are FMPSessionSettings fields. Join joins a result of the last Find. Any step can set "Name" and "Timeout".
+ * Login is only timed when it is issued, i.e. while the user is not logged in yet. Wait steps are not timed.
+ *
+ * Session pool scenario, against NULL it exercises the pool without a backend:
+ *	{ "Op": "StartPool", "PoolSize": 2, "Settings": { "bUseLAN": true } },	Until PoolSize sessions are ready
+ *	{ "Op": "ClaimPooled", "Extras": { "MATCHTYPE": "Bench" } },				Until the claim is broadcast
+ *	{ "Op": "ReleasePooled" },												Until the released session is ready again
+ *	{ "Op": "StopPool" }														Until every pooled session is destroyed
+ * ReleasePooled releases the session of the last ClaimPooled. StartPool right after StopPool checks the restarted pool
+ * waits for the destroys of the stopped one. The pool steps are stamped by the tick loop, they have no completion event.
+ */
+UCLASS()
+class MULTIPLAYERSESSIONS_API UMPSessionBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMPSessionBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	enum class EStepOperation : uint8
+	{
+		Login,
+		Create,
+		Find,
+		Join,
+		Start,
+		Destroy,
+		Wait,
+		StartPool,
+		ClaimPooled,
+		ReleasePooled,
+		StopPool,
+		Num
+	};
+
+	struct FStep
+	{
+		FString Name;
+		EStepOperation Operation { EStepOperation::Wait };
+		float TimeoutSeconds { 30.f };
+		// Create
+		int32 NumPublicConnections { 4 };
+		FMPSessionSettings SessionSettings {};
+		TMap<FName, FString> ExtraSessionSettings;
+		// Find
+		int32 MaxSearchResults { 50 };
+		FOnlineSearchSettings QuerySettings;
+		int32 MinResults { 0 };
+		// Join
+		int32 ResultIndex { 0 };
+		// Wait
+		float WaitSeconds { 0.f };
+		// StartPool
+		int32 PoolSize { 2 };
+
+		FMPLatencyStats Latency;
+		int32 NumFailed { 0 };
+	};
+
+	enum class EStepResult : uint8
+	{
+		Succeeded,
+		// Succeeded without a backend round trip worth timing, e.g. already logged in
+		SucceededUntimed,
+		Failed
+	};
+
+	bool LoadScenario(const FString& ScenarioPath, const float DefaultTimeoutSeconds);
+	bool ParseStep(const FJsonObject& StepObject, const int32 StepIndex, FStep& OutStep) const;
+	/** @return  False if a step failed, the rest of the iteration is then skipped */
+	bool RunIteration(const bool bIsTimed);
+	EStepResult RunStep(const FStep& Step, double& OutSeconds);
+	/** Ticks the online subsystem and the session scheduler until IsComplete returns true, false on timeout */
+	bool TickUntil(TFunctionRef<bool()> IsComplete, const float TimeoutSeconds) const;
+	/** Destroys the session and the session pool a failed iteration may have left, so the next one starts from scratch */
+	void DestroyLeftoverSession();
+
+	void Report() const;
+	bool SaveBaseline(const FString& BaselinePath) const;
+	/** @return  The number of regressed steps, INDEX_NONE if the baseline can't be read */
+	int32 CompareWithBaseline(const FString& BaselinePath, const FString& Metric, const float Threshold, const float MinRegressionMs) const;
+	static bool GetMetricMs(const FMPLatencyStats& Latency, const FString& Metric, double& OutMs);
+
+	UPROPERTY()
+	TObjectPtr<UGameInstance> GameInstance;
+	UPROPERTY()
+	TObjectPtr<UMultiplayerSessionsSubsystem> Subsystem;
+
+	FString ScenarioName;
+	TArray<FStep> Steps;
+	TArray<FOnlineSessionSearchResult> LastSearchResults;
+	FName LastClaimedSessionName;
+	int32 NumFailedIterations { 0 };
+};
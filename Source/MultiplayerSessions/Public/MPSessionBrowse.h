@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+#include "MPSessionBrowse.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPSessionBrowse, Log, All);
+
+UENUM(BlueprintType)
+enum class EMPSessionSortKey : uint8
+{
+	/** Search order */
+	None,
+	OpenSlots,
+	Ping,
+	OwnerName,
+	/** Value of SortSettingKey, numbers before text, sessions without the setting last */
+	SettingValue
+};
+
+/** Which search results to show in a session browser, and in which order */
+USTRUCT(BlueprintType)
+struct MULTIPLAYERSESSIONS_API FMPSessionBrowseSpec
+{
+	GENERATED_BODY()
+
+	/** Sessions with fewer open public connections are left out, 1 hides full sessions */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Browse")
+	int32 MinOpenSlots { 0 };
+
+	/** Sessions with a higher ping are left out, 0 for any ping */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Browse")
+	int32 MaxPingMs { 0 };
+
+	/** Case insensitive, empty for any owner */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Browse")
+	FString OwnerNameContains;
+
+	/** Settings a session must advertise, with these values as text */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Browse")
+	TMap<FName, FString> RequiredSettings;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Browse")
+	EMPSessionSortKey SortBy { EMPSessionSortKey::None };
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Browse")
+	FName SortSettingKey;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Browse")
+	bool bDescending { false };
+};
+
+using FMPSessionResultsSnapshot = TSharedRef<const TArray<FOnlineSessionSearchResult>, ESPMode::ThreadSafe>;
+
+struct FMPSessionBrowseResult
+{
+	/** The results browsed, never modified, so they can be shared with worker threads */
+	TSharedPtr<const TArray<FOnlineSessionSearchResult>, ESPMode::ThreadSafe> Snapshot;
+	/** Indices into Snapshot of the sessions that passed the filters, in sort order */
+	TArray<int32> Order;
+	double Seconds { 0.0 };
+};
+
+DECLARE_DELEGATE_OneParam(FMPOnSessionsBrowsed, const FMPSessionBrowseResult& Result);
+
+/**
+ * Filters and sorts search results for a session browser. Filters and sort keys are evaluated with ParallelFor, the
+ * sessions left are sorted in chunks in parallel, then the chunks are merged pairwise, also in parallel. The result is a
+ * permutation of indices, the results themselves are never copied. Equal sessions keep their search order.
+ */
+class MULTIPLAYERSESSIONS_API FMPSessionBrowsePipeline
+{
+public:
+	/** Runs the pipeline from a task, OnBrowsed gets the result on the game thread */
+	static void Launch(const FMPSessionResultsSnapshot& Snapshot, const FMPSessionBrowseSpec& Spec, FMPOnSessionsBrowsed&& OnBrowsed);
+	/** Runs the pipeline on the calling thread, which takes part in the parallel work */
+	static TArray<int32> Run(const TArray<FOnlineSessionSearchResult>& Results, const FMPSessionBrowseSpec& Spec);
+
+private:
+	struct FSortKey
+	{
+		// Numbers, then text, then sessions without a value
+		uint8 Rank { 2 };
+		double Number { 0.0 };
+		FString Text;
+	};
+
+	static bool PassesFilters(const FOnlineSessionSearchResult& Result, const FMPSessionBrowseSpec& Spec);
+	static FSortKey MakeSortKey(const FOnlineSessionSearchResult& Result, const FMPSessionBrowseSpec& Spec);
+	static void SetSortKey(const FVariantData& Data, FSortKey& OutSortKey);
+	static bool IsBefore(const FSortKey& A, const int32 IndexA, const FSortKey& B, const int32 IndexB, const bool bDescending);
+};
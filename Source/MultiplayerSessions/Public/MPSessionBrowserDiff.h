@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MPChangedSessionFields.h"
+#include "OnlineSessionSettings.h"
+
+/** A session whose advertised state changed between two refreshes */
+struct FMPChangedSessionResult
+{
+	FOnlineSessionSearchResult SearchResult;
+	// Session settings that changed, plus OwningUserName, NumOpenPublicConnections and NumOpenPrivateConnections
+	TArray<FName> ChangedFields;
+};
+
+/** Difference between two consecutive refreshes of the session browser */
+struct FMPSessionBrowserDiff
+{
+	TArray<FOnlineSessionSearchResult> Added;
+	TArray<FString> RemovedSessionIds;
+	TArray<FMPChangedSessionResult> Changed;
+
+	bool IsEmpty() const { return Added.IsEmpty() && RemovedSessionIds.IsEmpty() && Changed.IsEmpty(); }
+	/** The changed fields of Changed, for Blueprints */
+	TArray<FMPChangedSessionFields> GetChangedFields() const;
+};
+
+/**
+ * Remembers a fingerprint of each session seen in the last refresh (its id and a hash of its advertised state),
+ * so the next refresh can be reduced to what was added, removed or changed.
+ */
+class MULTIPLAYERSESSIONS_API FMPSessionResultTracker
+{
+public:
+	/** Replaces the tracked results and returns what changed since the previous call */
+	FMPSessionBrowserDiff Update(const TArray<FOnlineSessionSearchResult>& SearchResults);
+
+	void Reset();
+	int32 Num() const { return Fingerprints.Num(); }
+
+	static const FName OwningUserNameField;
+	static const FName NumOpenPublicConnectionsField;
+	static const FName NumOpenPrivateConnectionsField;
+
+private:
+	struct FSessionFingerprint
+	{
+		uint32 Hash { 0 };
+		TMap<FName, uint32> FieldHashes;
+	};
+
+	static FSessionFingerprint MakeFingerprint(const FOnlineSessionSearchResult& SearchResult);
+	static void GetChangedFields(const FSessionFingerprint& Previous, const FSessionFingerprint& Current, TArray<FName>& OutChangedFields);
+
+	TMap<FString, FSessionFingerprint> Fingerprints;
+};
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "OnlineSessionSettings.h"
+#include "MPScopedDelegateBinding.h"
+#include "MPSessionBrowserWidget.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPSessionBrowserWidget, Log, All);
+
+class UListView;
+class UMPSessionListItem;
+class UMultiplayerSessionsSubsystem;
+struct FMPSessionBrowserDiff;
+
+UENUM(BlueprintType)
+enum class EMPSessionSortField : uint8
+{
+	None,
+	OwnerName,
+	OpenConnections,
+	MaxConnections,
+	Ping
+};
+
+USTRUCT(BlueprintType)
+struct MULTIPLAYERSESSIONS_API FMPSessionBrowserFilter
+{
+	GENERATED_BODY()
+
+	/** Case insensitive, empty matches every owner */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Browser")
+	FString OwnerNameContains;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Browser")
+	bool bHideFullSessions = false;
+
+	/** 0 disables the ping filter */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Browser")
+	int32 MaxPingInMs = 0;
+
+	/** Session settings that must be advertised with exactly these values */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Browser")
+	TMap<FName, FString> RequiredSettings;
+};
+
+/**
+ * Native session browser built on a virtualized list view.
+ * The list view only creates the entry widgets (UMPSessionListEntry) needed to fill its visible area and recycles them
+ * while scrolling; sessions are held as UMPSessionListItem data items, themselves pooled across refreshes.
+ * Sorting and filtering run natively on the items' cached fields.
+ * The list follows the subsystem's search results and session browser refreshes (see StartSessionBrowserRefresh).
+ */
+UCLASS()
+class MULTIPLAYERSESSIONS_API UMPSessionBrowserWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	void SetSortMode(EMPSessionSortField InSortField, bool bInSortAscending = true);
+
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	void SetFilter(const FMPSessionBrowserFilter& InFilter);
+
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	void JoinSession(UMPSessionListItem* Item);
+
+	UFUNCTION(BlueprintPure, Category = "Multiplayer Sessions")
+	int32 GetNumSessions() const { return ItemsBySessionId.Num(); }
+
+	UFUNCTION(BlueprintPure, Category = "Multiplayer Sessions")
+	int32 GetNumVisibleSessions() const { return VisibleItems.Num(); }
+
+	/** Replaces every session in the list */
+	void SetSessions(const TArray<FOnlineSessionSearchResult>& SearchResults);
+	void ApplyDiff(const FMPSessionBrowserDiff& Diff);
+
+protected:
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions")
+	void OnSessionSelected(UMPSessionListItem* Item);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions")
+	void OnVisibleSessionsChanged(int32 NumVisibleSessions, int32 NumSessions);
+
+private:
+	void OnFindSessionsComplete(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful);
+	void OnSessionBrowserUpdated(const FMPSessionBrowserDiff& Diff, bool bWasSuccessful);
+	void OnListItemClicked(UObject* Item);
+
+	UMPSessionListItem* AcquireItem(const FOnlineSessionSearchResult& SearchResult);
+	void ReleaseItem(UMPSessionListItem* Item);
+	bool PassesFilter(const UMPSessionListItem& Item) const;
+	bool IsSortedBefore(const UMPSessionListItem& A, const UMPSessionListItem& B) const;
+	void RebuildVisibleItems();
+
+	UPROPERTY(meta = (BindWidget))
+	UListView* SessionListView;
+
+	UPROPERTY()
+	UMultiplayerSessionsSubsystem* MultiplayerSessionsSubsystem;
+
+	UPROPERTY()
+	TMap<FString, UMPSessionListItem*> ItemsBySessionId;
+
+	UPROPERTY()
+	TArray<UMPSessionListItem*> VisibleItems;
+
+	// Released items, reused before new ones are created
+	UPROPERTY()
+	TArray<UMPSessionListItem*> FreeItems;
+
+	FMPSessionBrowserFilter Filter;
+	EMPSessionSortField SortField { EMPSessionSortField::None };
+	bool bSortAscending { true };
+
+	TArray<FMPScopedDelegateBinding> SubsystemBindings;
+};
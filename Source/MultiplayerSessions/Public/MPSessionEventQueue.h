@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPSessionEventQueue, Log, All);
+
+enum class EMPSessionEventKind : uint8
+{
+	Login,
+	CreateSession,
+	StartSession,
+	UpdateSession,
+	DestroySession,
+	FindSessions,
+	FindSessionsPage,
+	SessionBrowserUpdated,
+	JoinSession,
+	Reconnect,
+	HostReady,
+	PooledSessionClaimed,
+	FederatedSearch,
+	JoinBestOf
+};
+
+/**
+ * Completion events waiting to be broadcast to the subsystem's listeners.
+ * Events are dispatched from a core ticker, outside of the online subsystem's callbacks, in the order they were queued.
+ * Each tick dispatches at least one event and stops once the frame budget is spent, the rest waits for the next tick.
+ * A coalesced event replaces the pending one of the same kind and subject, and is dispatched after every event queued before it.
+ */
+class MULTIPLAYERSESSIONS_API FMPSessionEventQueue
+{
+public:
+	explicit FMPSessionEventQueue(const float InFrameBudgetSeconds);
+	~FMPSessionEventQueue();
+
+	/**
+	 * @param bCoalesce  Only for events that carry the full state (e.g. search results), an older pending one is dropped
+	 * @param Subject  Events of the same kind only coalesce with the same subject, e.g. the session name
+	 */
+	void Enqueue(const EMPSessionEventKind Kind, TUniqueFunction<void()>&& Dispatch, const bool bCoalesce = false, const FName Subject = NAME_None);
+
+	/** Dispatches every pending event now, regardless of the frame budget. Does nothing when called from a dispatched event */
+	int32 Flush();
+
+	/** Drops every pending event */
+	void Reset();
+
+	bool IsDispatching() const { return bIsDispatching; }
+	int32 Num() const { return Events.Num() - HeadIndex - NumCoalescedPending; }
+	void SetFrameBudgetSeconds(const float InFrameBudgetSeconds) { FrameBudgetSeconds = FMath::Max(InFrameBudgetSeconds, 0.f); }
+
+private:
+	struct FQueuedEvent
+	{
+		uint64 Sequence { 0 };
+		EMPSessionEventKind Kind { EMPSessionEventKind::Login };
+		FName Subject;
+		bool bIsCoalesced { false };
+		TUniqueFunction<void()> Dispatch;
+	};
+
+	bool Tick(float DeltaTime);
+	int32 DispatchEvents(const double BudgetSeconds);
+	void ScheduleTick();
+
+	// Dispatched events stay in front of HeadIndex until the end of the dispatch, so a sequence maps to an index
+	TArray<FQueuedEvent> Events;
+	int32 HeadIndex { 0 };
+	uint64 NextSequence { 0 };
+	// Sequence of the pending coalescable event of each kind and subject
+	TMap<TPair<uint8, FName>, uint64> PendingCoalescableEvents;
+	int32 NumCoalescedPending { 0 };
+	float FrameBudgetSeconds { 0.f };
+	bool bIsDispatching { false };
+	FTSTicker::FDelegateHandle TickerHandle;
+};
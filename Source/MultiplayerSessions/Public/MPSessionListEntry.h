@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "Blueprint/IUserObjectListEntry.h"
+#include "MPSessionListEntry.generated.h"
+
+class UMPSessionListItem;
+
+/**
+ * Base class of the entry widget used by UMPSessionBrowserWidget's list view.
+ * The list view only keeps enough entries to fill its visible area and hands them a new item as the list scrolls.
+ */
+UCLASS(Abstract)
+class MULTIPLAYERSESSIONS_API UMPSessionListEntry : public UUserWidget, public IUserObjectListEntry
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintPure, Category = "Multiplayer Sessions")
+	UMPSessionListItem* GetSessionItem() const { return SessionItem; }
+
+protected:
+	virtual void NativeOnListItemObjectSet(UObject* ListItemObject) override;
+	virtual void NativeOnEntryReleased() override;
+
+	/** Called when the entry is given a session to display, and again when that session changes */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions")
+	void OnSessionItemSet(UMPSessionListItem* Item);
+
+private:
+	void UnbindSessionItem();
+
+	UPROPERTY()
+	UMPSessionListItem* SessionItem;
+
+	FDelegateHandle ItemChangedDelegateHandle;
+};
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "OnlineSessionSettings.h"
+#include "MPSessionListItem.generated.h"
+
+/**
+ * Data item of UMPSessionBrowserWidget's list view, one per session.
+ * Points at the search result and caches the fields used for display, sorting and filtering.
+ * Items are recycled by the browser, entry widgets should not keep a pointer past their release.
+ */
+UCLASS(BlueprintType)
+class MULTIPLAYERSESSIONS_API UMPSessionListItem : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	void SetSearchResult(const TSharedRef<const FOnlineSessionSearchResult>& InSearchResult);
+	void Reset();
+	const TSharedPtr<const FOnlineSessionSearchResult>& GetSearchResult() const { return SearchResult; }
+
+	UFUNCTION(BlueprintPure, Category = "Multiplayer Sessions")
+	const FString& GetSessionId() const { return SessionId; }
+
+	UFUNCTION(BlueprintPure, Category = "Multiplayer Sessions")
+	const FString& GetOwnerName() const { return OwnerName; }
+
+	UFUNCTION(BlueprintPure, Category = "Multiplayer Sessions")
+	int32 GetNumOpenPublicConnections() const { return NumOpenPublicConnections; }
+
+	UFUNCTION(BlueprintPure, Category = "Multiplayer Sessions")
+	int32 GetMaxPublicConnections() const { return MaxPublicConnections; }
+
+	UFUNCTION(BlueprintPure, Category = "Multiplayer Sessions")
+	int32 GetPingInMs() const { return PingInMs; }
+
+	/** @return  False if the session does not advertise the setting */
+	UFUNCTION(BlueprintPure, Category = "Multiplayer Sessions")
+	bool GetSessionSetting(FName SettingName, FString& OutValue) const;
+
+	/** Broadcast when the session behind the item changed, so a displayed entry can refresh itself */
+	FSimpleMulticastDelegate OnItemChanged;
+
+private:
+	TSharedPtr<const FOnlineSessionSearchResult> SearchResult;
+	FString SessionId;
+	FString OwnerName;
+	int32 NumOpenPublicConnections { 0 };
+	int32 MaxPublicConnections { 0 };
+	int32 PingInMs { 0 };
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MPSessionMetricsLayout.h"
+#include "MPSessionOperationScheduler.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPSessionMetrics, Log, All);
+
+class FSharedMemoryRegion;
+
+/** Values sampled from the subsystem when the metrics are published */
+struct FMPSessionMetricsGauges
+{
+	EMPSessionState SessionState { EMPSessionState::Idle };
+	int32 NumQueuedOperations { 0 };
+	int32 NumAdvertisedSessions { 0 };
+	int32 NumRegisteredPlayers { 0 };
+	int32 NumReadyPooledSessions { 0 };
+	int32 NumPendingSessionEvents { 0 };
+};
+
+/**
+ * Session layer metrics of a server, exported to a named shared memory region (FMPSessionMetricsBlock) for an external scraper
+ * such as Tools/MPSessionMetricsReader. Counters are kept locally and copied to the region on Publish, under a seqlock:
+ * readers never block the game thread and the game thread never waits for a reader.
+ * Operation latency is measured from the issue of an operation to the report of its completion.
+ */
+class MULTIPLAYERSESSIONS_API FMPSessionMetrics
+{
+public:
+	/** Maps the region, on Linux it appears as /dev/shm/<RegionName>. A name already exported by this process is refused */
+	explicit FMPSessionMetrics(const FString& InRegionName);
+	~FMPSessionMetrics();
+
+	bool IsExporting() const { return Block != nullptr; }
+	const FString& GetRegionName() const { return RegionName; }
+
+	/** An operation already in flight is not counted again, e.g. when it is issued again after the login it waited for */
+	void OnOperationStarted(const EMPSessionOperation Kind) { OnOperationStarted(static_cast<int32>(Kind)); }
+	/** Completions of operations that were never started (rejected ones) are ignored */
+	void OnOperationCompleted(const EMPSessionOperation Kind, const bool bWasSuccessful) { OnOperationCompleted(static_cast<int32>(Kind), bWasSuccessful); }
+	void OnOperationRejected(const EMPSessionOperation Kind);
+	void OnLoginStarted() { OnOperationStarted(MPSessionMetricsLoginOperation); }
+	void OnLoginCompleted(const bool bWasSuccessful) { OnOperationCompleted(MPSessionMetricsLoginOperation, bWasSuccessful); }
+
+	void Publish(const FMPSessionMetricsGauges& Gauges);
+
+private:
+	void OnOperationStarted(const int32 Operation);
+	void OnOperationCompleted(const int32 Operation, const bool bWasSuccessful);
+
+	FString RegionName;
+	FSharedMemoryRegion* Region { nullptr };
+	FMPSessionMetricsBlock* Block { nullptr };
+	// Published copy, only touched by the game thread
+	FMPSessionMetricsData Data;
+	// Issue time of the operation in flight of each kind, 0 when none is
+	double OperationStartTimes[MPSessionMetricsNumOperations];
+
+	// Regions exported by this process, two exporters of one region would overwrite each other's counters
+	static TSet<FString> ExportedRegionNames;
+};
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// Layout of the metrics block published by the subsystem (see FMPSessionMetrics).
+// Plain C++ without engine types on purpose: the reader tool (Tools/MPSessionMetricsReader) includes it as is.
+// Any change to the layout must bump MPSessionMetricsVersion.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+constexpr uint32_t MPSessionMetricsMagic = 0x4D50534D; // 'MPSM'
+constexpr uint32_t MPSessionMetricsVersion = 1;
+
+/** Session operations in EMPSessionOperation order, followed by the login */
+constexpr int32_t MPSessionMetricsNumOperations = 7;
+constexpr int32_t MPSessionMetricsLoginOperation = 6;
+constexpr const char* MPSessionMetricsOperationNames[MPSessionMetricsNumOperations] =
+{
+	"create", "update", "start", "destroy", "join", "find", "login"
+};
+
+/** Upper bounds of the latency histogram buckets, the last bucket has no upper bound */
+constexpr int32_t MPSessionMetricsNumLatencyBuckets = 12;
+constexpr double MPSessionMetricsLatencyBucketBoundsSeconds[MPSessionMetricsNumLatencyBuckets - 1] =
+{
+	0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0
+};
+
+struct FMPSessionMetricsOperation
+{
+	uint64_t NumStarted;
+	uint64_t NumSucceeded;
+	uint64_t NumFailed;
+	/** Rejected by the scheduler for the session state, without a backend call */
+	uint64_t NumRejected;
+	uint64_t LatencySumMicroseconds;
+	/** Completions per latency bucket, not cumulative */
+	uint64_t LatencyBuckets[MPSessionMetricsNumLatencyBuckets];
+};
+
+struct FMPSessionMetricsData
+{
+	uint64_t NumPublishes;
+	uint64_t PublishTimeUnixMs;
+	int64_t ProcessId;
+	/** EMPSessionState of the game session */
+	int32_t SessionState;
+	int32_t NumQueuedOperations;
+	int32_t NumAdvertisedSessions;
+	int32_t NumRegisteredPlayers;
+	int32_t NumReadyPooledSessions;
+	int32_t NumPendingSessionEvents;
+	FMPSessionMetricsOperation Operations[MPSessionMetricsNumOperations];
+};
+
+/**
+ * Seqlock protected block: the writer makes Sequence odd, copies Data, then makes it even again.
+ * A reader copies Data between two reads of Sequence and retries if they differ or are odd.
+ */
+struct FMPSessionMetricsBlock
+{
+	uint32_t Magic;
+	uint32_t Version;
+	std::atomic<uint32_t> Sequence;
+	uint32_t DataSize;
+	FMPSessionMetricsData Data;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "The metrics sequence must be lock free to be shared between processes");
+static_assert(offsetof(FMPSessionMetricsBlock, Data) % 8 == 0, "Metrics data must stay 8 byte aligned");
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "MPScopedDelegateBinding.h"
+#include "OnlineSessionSettings.h"
+#include "Interfaces/OnlineSessionInterface.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPSessionMirrors, Log, All);
+
+DECLARE_DELEGATE_OneParam(FMPOnSessionMirrorsComplete, bool bWasSuccessful);
+
+/**
+ * The hosted game session advertised on other online subsystems than the one in use (dual advertising, e.g. EOS and LAN).
+ * Each call is sent to every mirror at once and completes once all of them answered, so it takes as long as the slowest
+ * backend. Calls made while one is in flight are queued. A mirror whose create fails is left out until the next create,
+ * the session stays advertised on the others. A mirror whose destroy fails is retried a few times, then still counts as
+ * created: the next destroy tries it again, and the next create updates it to the new settings.
+ */
+class MULTIPLAYERSESSIONS_API FMPSessionMirrors
+{
+public:
+	FMPSessionMirrors(const TArray<FName>& OnlineSubsystemNames, const int32 InHostingPlayerNum);
+	~FMPSessionMirrors();
+
+	FMPSessionMirrors(const FMPSessionMirrors&) = delete;
+	FMPSessionMirrors& operator=(const FMPSessionMirrors&) = delete;
+
+	/** @param OnComplete  Successful if every mirror created the session */
+	void Create(const FOnlineSessionSettings& Settings, FMPOnSessionMirrorsComplete&& OnComplete);
+	void Update(const FOnlineSessionSettings& Settings, FMPOnSessionMirrorsComplete&& OnComplete);
+	/** @param OnComplete  Successful once every mirror confirmed the session is gone */
+	void Destroy(FMPOnSessionMirrorsComplete&& OnComplete);
+	/** Advertises the open slots left with NumPlayers in the session, players join through the backend in use or any mirror */
+	void SetNumPlayers(const int32 NumPlayers);
+
+	bool IsBusy() const { return NumPendingMirrors > 0; }
+	bool HasCreatedMirrors() const;
+	TArray<FName> GetCreatedOnlineSubsystems() const;
+
+private:
+	enum class ECall : uint8
+	{
+		Create,
+		Update,
+		Destroy
+	};
+
+	struct FMirror
+	{
+		FName OnlineSubsystemName;
+		IOnlineSessionPtr Sessions;
+		bool bIsCreated { false };
+		/** Call in flight on this mirror, a create updates a mirror whose destroy failed */
+		ECall Call { ECall::Create };
+		int32 NumAttempts { 0 };
+		FMPScopedDelegateBinding CompleteBinding;
+		FTSTicker::FDelegateHandle RetryHandle;
+	};
+
+	void IssueCall(const ECall Call, const FOnlineSessionSettings* Settings, FMPOnSessionMirrorsComplete&& OnComplete);
+	bool IssueMirrorCall(const int32 MirrorIndex, const FOnlineSessionSettings* Settings);
+	void OnMirrorComplete(FName SessionName, bool bWasSuccessful, int32 MirrorIndex);
+	bool RetryMirrorDestroy(float DeltaTime, int32 MirrorIndex);
+	void FinishMirror(const int32 MirrorIndex, bool bWasSuccessful);
+	FUniqueNetIdPtr GetHostingPlayerId(const FName OnlineSubsystemName) const;
+	static FOnlineSessionSettings MakeMirrorSettings(const FMirror& Mirror, const FOnlineSessionSettings& Settings);
+	static const TCHAR* LexToString(const ECall Call);
+
+	TArray<FMirror> Mirrors;
+	int32 HostingPlayerNum { 0 };
+	int32 NumPendingMirrors { 0 };
+	bool bHaveAllSucceeded { true };
+	FMPOnSessionMirrorsComplete OnInFlightCallComplete;
+	TArray<TUniqueFunction<void()>> QueuedCalls;
+	// Set while a player count change waits for the call in flight
+	TOptional<int32> PendingNumPlayers;
+};
@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "MPSessionOperationScheduler.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPSessionOperationScheduler, Log, All);
+
+/** Lifecycle of the game session (NAME_GameSession) driven by the subsystem */
+UENUM(BlueprintType)
+enum class EMPSessionState : uint8
+{
+	Idle,
+	LoggingIn,
+	/** Also covers joining a session */
+	Creating,
+	Created,
+	Starting,
+	InProgress,
+	Destroying
+};
+
+enum class EMPSessionOperation : uint8
+{
+	Create,
+	Update,
+	Start,
+	Destroy,
+	Join,
+	Find
+};
+
+enum class EMPSessionOperationPriority : uint8
+{
+	Low,
+	Normal,
+	High
+};
+
+/** Rate limit allowing Capacity operations at once, refilled at TokensPerSecond */
+class MULTIPLAYERSESSIONS_API FMPTokenBucket
+{
+public:
+	/** A rate of 0 or less disables the limit */
+	FMPTokenBucket(const float InTokensPerSecond, const float InCapacity);
+
+	bool TryConsume(const double Now);
+	double GetSecondsUntilNextToken(const double Now) const;
+
+private:
+	double GetTokens(const double Now) const;
+
+	double TokensPerSecond;
+	double Capacity;
+	double Tokens;
+	double LastRefillTime;
+};
+
+/**
+ * Orders the session operations sent to one backend.
+ * - Operations run one at a time per lane: searches in one, everything changing the game session in the other.
+ *   Lifecycle operations also wait for the session to leave transitional states (LoggingIn, Creating, Starting, Destroying).
+ * - A queued update or find merges with a new one of the same kind, priority and merge key: it takes the newer arguments
+ *   and the superseded one is rejected. Start and destroy are only issued once, create and join are never merged.
+ * - Operations that can't apply to the session state when their turn comes (e.g. start without a created session) are rejected
+ *   without a backend call.
+ * - The next operation is the queued one of highest priority, first queued first, and every issue costs a token of the backend's bucket.
+ * The owner reports completion with Complete and keeps the state up to date with SetState.
+ */
+class MULTIPLAYERSESSIONS_API FMPSessionOperationScheduler
+{
+public:
+	FMPSessionOperationScheduler(const FName InBackendName, const float OperationsPerSecond, const float OperationsBurst);
+	~FMPSessionOperationScheduler();
+
+	/**
+	 * @param Execute  Issues the operation, which stays in flight until Complete is called with its kind
+	 * @param Reject  Reports the failure of an operation rejected for the session state
+	 * @param MergeKey  Only operations with the same key merge, e.g. so a federated search does not replace a plain one
+	 */
+	void Schedule(
+		const EMPSessionOperation Kind,
+		TUniqueFunction<void()>&& Execute,
+		TUniqueFunction<void()>&& Reject,
+		const EMPSessionOperationPriority Priority = EMPSessionOperationPriority::Normal,
+		const FName MergeKey = NAME_None
+	);
+	/** Queues in front of every operation of its lane, later calls go in front of earlier ones. Never merged */
+	void ScheduleFirst(const EMPSessionOperation Kind, TUniqueFunction<void()>&& Execute, TUniqueFunction<void()>&& Reject);
+
+	/** Ends the in-flight operation of this kind, ignored if it is not the one in flight */
+	void Complete(const EMPSessionOperation Kind);
+
+	EMPSessionState GetState() const { return State; }
+	/** The rate limit is kept, the backends in turn are never used at once */
+	void SetBackendName(const FName InBackendName) { BackendName = InBackendName; }
+	void SetState(const EMPSessionState NewState);
+	bool IsInFlight(const EMPSessionOperation Kind) const;
+	int32 GetNumQueued() const { return Queue.Num(); }
+
+	/** Drops the queued operations without reporting them */
+	void Reset();
+
+	static const TCHAR* LexToString(const EMPSessionOperation Kind);
+	static const TCHAR* LexToString(const EMPSessionState InState);
+
+private:
+	enum class ELane : uint8
+	{
+		Lifecycle,
+		Search,
+		Num
+	};
+
+	struct FOperation
+	{
+		EMPSessionOperation Kind { EMPSessionOperation::Create };
+		EMPSessionOperationPriority Priority { EMPSessionOperationPriority::Normal };
+		FName MergeKey;
+		int64 Sequence { 0 };
+		TUniqueFunction<void()> Execute;
+		TUniqueFunction<void()> Reject;
+	};
+
+	static ELane GetLane(const EMPSessionOperation Kind);
+	static bool IsSettled(const EMPSessionState InState);
+	bool CanApply(const EMPSessionOperation Kind) const;
+	bool CanIssueInLane(const ELane Lane) const;
+	int32 FindNextOperation() const;
+	void IssueReadyOperations();
+	void ScheduleIssue(const float DelaySeconds);
+
+	FName BackendName;
+	FMPTokenBucket TokenBucket;
+	EMPSessionState State { EMPSessionState::Idle };
+	TArray<FOperation> Queue;
+	TOptional<EMPSessionOperation> InFlight[static_cast<int32>(ELane::Num)];
+	int64 NextSequence { 0 };
+	// Decreasing, operations scheduled first sort before every other one
+	int64 NextFirstSequence { -1 };
+	bool bIsIssuing { false };
+	FTSTicker::FDelegateHandle TickerHandle;
+};
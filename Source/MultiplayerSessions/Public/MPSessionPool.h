@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "MPOnlineTraffic.h"
+#include "MPScopedDelegateBinding.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "OnlineSessionSettings.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPSessionPool, Log, All);
+
+enum class EMPPooledSessionState : uint8
+{
+	Empty,
+	Creating,
+	Ready,
+	Claiming,
+	Claimed,
+	Recycling
+};
+
+struct FMPPooledSession
+{
+	FName SessionName;
+	EMPPooledSessionState State { EMPPooledSessionState::Empty };
+};
+
+DECLARE_DELEGATE_ThreeParams(FMPOnPooledSessionClaimed, FName SessionName, const FString& SessionId, bool bWasSuccessful);
+
+/**
+ * Keeps a number of sessions created but not advertised, so a dedicated server can make one joinable
+ * with a single UpdateSession instead of a full create when a match is allocated.
+ * Released sessions are destroyed and created again in the background.
+ */
+class MULTIPLAYERSESSIONS_API FMPSessionPool
+{
+public:
+	FMPSessionPool(
+		const IOnlineSessionPtr& InSessionInterface,
+		const FOnlineSessionSettings& InBaseSessionSettings,
+		const int32 PoolSize,
+		const int32 InHostingPlayerNum = 0
+	);
+	~FMPSessionPool();
+
+	/** Issues creation for every empty slot */
+	void Fill();
+
+	/**
+	 * Advertises a ready session with the given attributes.
+	 * @return  The name of the claimed session, NAME_None if no session is ready
+	 */
+	FName Claim(const FSessionSettings& Attributes);
+
+	/** Destroys a claimed session and creates a fresh unadvertised one in its place */
+	bool Release(const FName SessionName);
+
+	/**
+	 * Destroys every pooled session, the pool does not refill afterwards. Sessions still being created are destroyed once
+	 * created. OnDestroyed is called once the last destroy completed, never from DestroyAll itself, and may delete the pool.
+	 */
+	void DestroyAll(FSimpleDelegate&& OnDestroyed);
+	/** True once DestroyAll has no create, claim or destroy left in flight */
+	bool IsDestroyed() const;
+
+	bool IsPooledSession(const FName SessionName) const;
+	int32 GetNumSessionsInState(const EMPPooledSessionState State) const;
+	/** Players registered in the claimed sessions */
+	int32 GetNumRegisteredPlayers() const;
+
+	FMPOnPooledSessionClaimed OnSessionClaimed;
+	/** Issues the pool's calls to the session interface, e.g. through a traffic recorder. Unset, they are issued directly */
+	TFunction<bool(FMPOnlineTrafficEvent&& Call, TFunctionRef<bool()> IssueCall)> IssueOnlineCall;
+	/** Gets the completions of the pool's calls, e.g. to record them */
+	TFunction<void(FMPOnlineTrafficEvent&& Callback)> OnOnlineCallback;
+
+private:
+	void OnCreateSessionComplete(FName SessionName, bool bWasSuccessful);
+	void OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful);
+	void OnDestroySessionComplete(FName SessionName, bool bWasSuccessful);
+
+	bool IssuePooledSessionCall(FMPOnlineTrafficEvent&& Call, TFunctionRef<bool()> IssueCall);
+	bool TryCreatePooledSession(FMPPooledSession& PooledSession);
+	bool TryDestroyPooledSession(FMPPooledSession& PooledSession);
+	/** Calls OnAllDestroyed once shutting down left nothing in flight */
+	void CompleteDestroyAll();
+	void ScheduleRefill();
+	FMPPooledSession* FindPooledSession(const FName SessionName);
+	const FMPPooledSession* FindPooledSession(const FName SessionName) const;
+
+	IOnlineSessionPtr SessionInterface;
+	FOnlineSessionSettings BaseSessionSettings;
+	int32 HostingPlayerNum;
+	TArray<FMPPooledSession> PooledSessions;
+	bool bIsShuttingDown { false };
+	FSimpleDelegate OnAllDestroyed;
+
+	FMPScopedDelegateBinding CreateSessionCompleteBinding;
+	FMPScopedDelegateBinding UpdateSessionCompleteBinding;
+	FMPScopedDelegateBinding DestroySessionCompleteBinding;
+	FTSTicker::FDelegateHandle RefillTickerHandle;
+
+	// Delay before retrying creation of sessions that failed to create
+	static constexpr float RefillRetryDelaySeconds { 5.f };
+};
@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+#include <type_traits>
+
+/**
+ * Compile-time typed session attributes.
+ * A game declares each key once, with its native type, stable name and advertisement type,
+ * and groups its keys in a schema:
+ *
+ *	MP_DECLARE_SESSION_KEY(FGameModeKey, "GameMode", EGameMode, ViaOnlineServiceAndPing);
+ *	MP_DECLARE_SESSION_KEY(FMaxRankKey, "MaxRank", int32, ViaOnlineService);
+ *	using FMyGameSessionSchema = TMPSessionSchema<FGameModeKey, FMaxRankKey>;
+ *
+ *	FMyGameSessionSchema::Set<FMaxRankKey>(SessionSettings, 20);
+ *	FMyGameSessionSchema::Query<FMaxRankKey>(SessionSearch->QuerySettings, 20, EOnlineComparisonOp::LessThanEquals);
+ *	int32 MaxRank;
+ *	FMyGameSessionSchema::Get<FMaxRankKey>(SearchResult.Session.SessionSettings, MaxRank);
+ *
+ * Values are stored in their native variant type, so numeric keys can be used in backend range queries.
+ * A misspelled key, a key of another schema or a value of the wrong type does not compile.
+ */
+
+namespace MPSessionSchema
+{
+	/** Maps a key's native type to the type stored in FVariantData */
+	template<typename ValueType, typename = void>
+	struct TValueTraits
+	{
+		static constexpr bool bIsSupported = false;
+	};
+
+	template<typename ValueType, EOnlineKeyValuePairDataType::Type InDataType>
+	struct TDirectValueTraits
+	{
+		static constexpr bool bIsSupported = true;
+		static constexpr EOnlineKeyValuePairDataType::Type DataType = InDataType;
+		using StorageType = ValueType;
+		static const StorageType& ToStorage(const ValueType& Value) { return Value; }
+		static ValueType FromStorage(const StorageType& Value) { return Value; }
+	};
+
+	template<> struct TValueTraits<int32> : TDirectValueTraits<int32, EOnlineKeyValuePairDataType::Int32> {};
+	template<> struct TValueTraits<int64> : TDirectValueTraits<int64, EOnlineKeyValuePairDataType::Int64> {};
+	template<> struct TValueTraits<float> : TDirectValueTraits<float, EOnlineKeyValuePairDataType::Float> {};
+	template<> struct TValueTraits<double> : TDirectValueTraits<double, EOnlineKeyValuePairDataType::Double> {};
+	template<> struct TValueTraits<bool> : TDirectValueTraits<bool, EOnlineKeyValuePairDataType::Bool> {};
+	template<> struct TValueTraits<FString> : TDirectValueTraits<FString, EOnlineKeyValuePairDataType::String> {};
+
+	/** Enums are advertised as their integer value */
+	template<typename EnumType>
+	struct TValueTraits<EnumType, std::enable_if_t<std::is_enum_v<EnumType>>>
+	{
+		static constexpr bool bIsSupported = true;
+		static constexpr EOnlineKeyValuePairDataType::Type DataType = EOnlineKeyValuePairDataType::Int32;
+		using StorageType = int32;
+		static StorageType ToStorage(const EnumType Value) { return static_cast<StorageType>(Value); }
+		static EnumType FromStorage(const StorageType Value) { return static_cast<EnumType>(Value); }
+	};
+}
+
+/**
+ * Declares a session key type. KeyName is the attribute name sent to the backend and must stay stable across builds.
+ */
+#define MP_DECLARE_SESSION_KEY(KeyType, KeyName, ValueType, AdvertisementType) \
+	struct KeyType \
+	{ \
+		using Type = ValueType; \
+		static_assert(MPSessionSchema::TValueTraits<ValueType>::bIsSupported, "Session keys support int32, int64, float, double, bool, FString and enums"); \
+		static constexpr EOnlineDataAdvertisementType::Type Advertisement = EOnlineDataAdvertisementType::AdvertisementType; \
+		static FName GetName() { static const FName Name(TEXT(KeyName)); return Name; } \
+	}
+
+template<typename... KeyTypes>
+struct TMPSessionSchema
+{
+	template<typename KeyType>
+	static constexpr bool Contains = (std::is_same_v<KeyType, KeyTypes> || ...);
+
+	/** Advertises a value, either on the session settings or on an attribute set passed to the subsystem */
+	template<typename KeyType>
+	static void Set(FOnlineSessionSettings& SessionSettings, const typename KeyType::Type& Value)
+	{
+		static_assert(Contains<KeyType>, "Key is not part of this session schema");
+		SessionSettings.Set(KeyType::GetName(), TTraits<KeyType>::ToStorage(Value), KeyType::Advertisement);
+	}
+
+	template<typename KeyType>
+	static void Set(FSessionSettings& SessionAttributes, const typename KeyType::Type& Value)
+	{
+		static_assert(Contains<KeyType>, "Key is not part of this session schema");
+		SessionAttributes.Add(KeyType::GetName(), FOnlineSessionSetting(TTraits<KeyType>::ToStorage(Value), KeyType::Advertisement));
+	}
+
+	/** Adds a search filter on the key, compared in its native type */
+	template<typename KeyType>
+	static void Query(
+		FOnlineSearchSettings& QuerySettings,
+		const typename KeyType::Type& Value,
+		const EOnlineComparisonOp::Type ComparisonOp = EOnlineComparisonOp::Equals
+	)
+	{
+		static_assert(Contains<KeyType>, "Key is not part of this session schema");
+		QuerySettings.Set(KeyType::GetName(), TTraits<KeyType>::ToStorage(Value), ComparisonOp);
+	}
+
+	/** @return  False if the key is missing or was advertised with another type */
+	template<typename KeyType>
+	static bool Get(const FOnlineSessionSettings& SessionSettings, typename KeyType::Type& OutValue)
+	{
+		static_assert(Contains<KeyType>, "Key is not part of this session schema");
+		const FOnlineSessionSetting* Setting = SessionSettings.Settings.Find(KeyType::GetName());
+		if (Setting == nullptr || Setting->Data.GetType() != TTraits<KeyType>::DataType)
+		{
+			return false;
+		}
+		typename TTraits<KeyType>::StorageType StoredValue;
+		Setting->Data.GetValue(StoredValue);
+		OutValue = TTraits<KeyType>::FromStorage(StoredValue);
+		return true;
+	}
+
+	/** @return  True if every key of the schema is present with its declared type */
+	static bool IsComplete(const FOnlineSessionSettings& SessionSettings)
+	{
+		return (HasKey<KeyTypes>(SessionSettings) && ...);
+	}
+
+private:
+	template<typename KeyType>
+	using TTraits = MPSessionSchema::TValueTraits<typename KeyType::Type>;
+
+	template<typename KeyType>
+	static bool HasKey(const FOnlineSessionSettings& SessionSettings)
+	{
+		const FOnlineSessionSetting* Setting = SessionSettings.Settings.Find(KeyType::GetName());
+		return Setting != nullptr && Setting->Data.GetType() == TTraits<KeyType>::DataType;
+	}
+};
+
+/**
+ * Keys used by the plugin itself
+ */
+MP_DECLARE_SESSION_KEY(FMPMapNameKey, "MAPNAME", FString, ViaOnlineServiceAndPing);
+MP_DECLARE_SESSION_KEY(FMPMatchTypeKey, "MatchType", FString, ViaOnlineServiceAndPing);
+MP_DECLARE_SESSION_KEY(FMPSecretKeyKey, "SecretKey", FString, ViaOnlineServiceAndPing);
+// The backend session id, advertised so backends without find-by-id can look a session up with a filtered search
+MP_DECLARE_SESSION_KEY(FMPSessionIdKey, "MPSessionId", FString, ViaOnlineService);
+// Stays the same on every backend the session is advertised on, federated searches merge their results by it
+MP_DECLARE_SESSION_KEY(FMPSessionKeyKey, "MPSessionKey", FString, ViaOnlineService);
+
+using FMPSessionSchema = TMPSessionSchema<FMPMapNameKey, FMPMatchTypeKey, FMPSecretKeyKey, FMPSessionIdKey, FMPSessionKeyKey>;
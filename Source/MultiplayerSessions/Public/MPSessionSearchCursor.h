@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MPSessionSearchCursor.generated.h"
+
+/**
+ * Opaque continuation of a paged session search, handed out with each page and passed back to fetch the next one.
+ * A cursor is invalid when there are no more pages, and goes stale once a new paged search is started.
+ */
+USTRUCT(BlueprintType)
+struct MULTIPLAYERSESSIONS_API FMPSessionSearchCursor
+{
+	GENERATED_BODY()
+
+	FMPSessionSearchCursor() = default;
+
+	bool IsValid() const { return bHasMore && SearchId != INDEX_NONE; }
+
+	/** Whether the search has a page left to fetch with this cursor */
+	UPROPERTY(BlueprintReadOnly, Category = "Session Search")
+	bool bHasMore { false };
+
+	/** Index of the page this cursor fetches, the first page being 0 */
+	UPROPERTY(BlueprintReadOnly, Category = "Session Search")
+	int32 PageIndex { 0 };
+
+private:
+	friend class UMultiplayerSessionsSubsystem;
+
+	FMPSessionSearchCursor(const int32 InSearchId, const int32 InPageIndex):
+		bHasMore(true),
+		PageIndex(InPageIndex),
+		SearchId(InSearchId)
+	{
+	}
+
+	int32 SearchId { INDEX_NONE };
+};
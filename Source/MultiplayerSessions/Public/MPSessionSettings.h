@@ -56,5 +56,5 @@ struct MULTIPLAYERSESSIONS_API FMPSessionSettings
 	bool bUseLobbiesVoiceChatIfAvailable = false;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Settings")
-	bool bStartAfterCreate;
+	bool bStartAfterCreate = false;
 };
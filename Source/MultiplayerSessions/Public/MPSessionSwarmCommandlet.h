@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MPLatencyStats.h"
+#include "MPSessionBrowserDiff.h"
+#include "MPSessionOperationScheduler.h"
+#include "MPSimulatedSessionBackend.h"
+#include "MPSessionSwarmCommandlet.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPSessionSwarm, Log, All);
+
+/**
+ * Headless load generator for the building blocks under the session layer, not for UMultiplayerSessionsSubsystem itself.
+ * Spawns logical hosts and clients at the given arrival rates against an in-process stand-in backend (FMPSimulatedSessionBackend).
+ * Every logical player orders its operations through its own FMPSessionOperationScheduler and tracks its search results with
+ * a FMPSessionResultTracker, then it reports throughput, latency percentiles, failure rates and the process memory.
+ * The subsystem's own paths (login, search serialization, join, map preload, event dispatch) don't run here, their timings
+ * come from the MPSessionBenchmark commandlet, which drives a real subsystem instance.
+ *
+ * UnrealEditor-Cmd <Project> -run=MPSessionSwarm -Hosts=50 -Clients=500 -Duration=60
+ *	-HostArrivalRate=10 -ClientArrivalRate=50	Logical players spawned per second
+ *	-Mix=Browse:40,QuickJoin:40,Leave:20		Client behaviour weights, hosts alternate between hosting and leaving
+ *	-ThinkSeconds=2								Mean pause between two behaviours of a player
+ *	-MaxPlayers=8 -MaxSearchResults=50
+ *	-LatencyMs=80 -LatencyJitterMs=40 -FailureRate=0.01 -Seed=0		Stand-in backend
+ *	-OpsPerSecond=5 -OpsBurst=10				Per player scheduler rate limit, as BackendOperationsPerSecond
+ */
+UCLASS()
+class MULTIPLAYERSESSIONS_API UMPSessionSwarmCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMPSessionSwarmCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	enum class EBehaviour : uint8
+	{
+		Browse,
+		QuickJoin,
+		Host,
+		Leave,
+		Num
+	};
+
+	struct FLogicalPlayer
+	{
+		int32 PlayerId { INDEX_NONE };
+		bool bIsHost { false };
+		// Hosted or joined session
+		FString SessionId;
+		bool bIsBusy { false };
+		double NextBehaviourTime { 0.0 };
+		TUniquePtr<FMPSessionOperationScheduler> Scheduler;
+		FMPSessionResultTracker ResultTracker;
+	};
+
+	struct FOperationStats
+	{
+		int32 NumSucceeded { 0 };
+		int32 NumFailed { 0 };
+		// Rejected by the player's scheduler for its session state, without a backend call
+		int32 NumRejected { 0 };
+		FMPLatencyStats Latency;
+	};
+	static constexpr int32 NumOperationKinds { static_cast<int32>(EMPSessionOperation::Find) + 1 };
+
+	void SpawnPlayer(const bool bIsHost);
+	void RunBehaviour(FLogicalPlayer& Player);
+	void Browse(FLogicalPlayer& Player, const bool bJoinFirstResult);
+	void Join(FLogicalPlayer& Player, const FString& SessionId);
+	void Host(FLogicalPlayer& Player);
+	void Leave(FLogicalPlayer& Player);
+	void FinishBehaviour(FLogicalPlayer& Player);
+	EBehaviour PickClientBehaviour();
+	/** Records the operation outcome and releases its scheduler lane */
+	void CompleteOperation(FLogicalPlayer& Player, const EMPSessionOperation Kind, const double StartTime, const bool bWasSuccessful);
+	void RejectOperation(FLogicalPlayer& Player, const EMPSessionOperation Kind);
+	void Report(const double ElapsedSeconds, const uint64 UsedMemoryBefore, const uint64 UsedMemoryAfter) const;
+
+	TUniquePtr<FMPSimulatedSessionBackend> Backend;
+	// Players are never removed during a run, in-flight completions hold their address
+	TArray<TUniquePtr<FLogicalPlayer>> Players;
+	FOperationStats OperationStats[NumOperationKinds];
+	int32 NumBehaviours[static_cast<int32>(EBehaviour::Num)] {};
+	int32 NumJoinResults[EOnJoinSessionCompleteResult::UnknownError + 1] {};
+	int32 ClientBehaviourWeights[static_cast<int32>(EBehaviour::Num)] {};
+	FRandomStream RandomStream;
+
+	int32 MaxPlayers { 8 };
+	int32 MaxSearchResults { 50 };
+	float ThinkSeconds { 2.f };
+	float OperationsPerSecond { 5.f };
+	float OperationsBurst { 10.f };
+};
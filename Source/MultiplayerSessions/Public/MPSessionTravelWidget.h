@@ -3,6 +3,10 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "MPScopedDelegateBinding.h"
+#include "MPTimeSlicedConversion.h"
+#include "BlueprintSessionResult.h"
+#include "MPChangedSessionFields.h"
 #include "Blueprint/UserWidget.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "MPSessionTravelWidget.generated.h"
@@ -13,6 +17,8 @@ DECLARE_LOG_CATEGORY_EXTERN(LogMPSessionTravelWidget, Log, All);
 class UMultiplayerSessionsSubsystem;
 
 struct FBPSessionResult;
+struct FMPSessionBrowserDiff;
+struct FMPHostTimings;
 
 UCLASS()
 class MULTIPLAYERSESSIONS_API UMPSessionTravelWidget : public UUserWidget
@@ -34,11 +40,33 @@ public:
 		const FMPSessionSettings& SessionSettings,
 		const TMap<FName, FString>& ExtraSessionSettings
 	);
+	/**
+	 * Creates the session, starts it with bStartAfterCreate and server travels to the lobby in one call, the lobby loads
+	 * while the session round trips are in flight. OnSessionCreated is called once the host is ready.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Multiplayer Sessions")
+	void HostSession(
+		const TSoftObjectPtr<UWorld> LobbyServerTravelMap,
+		const FMPSessionSettings& SessionSettings,
+		const TMap<FName, FString>& ExtraSessionSettings
+	);
 
 	UFUNCTION(BlueprintCallable, Category="Μultiplayer Sessions")
 	void FindSessions(const int32 MaxSearchResults = 1000) const;
 	UFUNCTION(BlueprintCallable, Category="Μultiplayer Sessions")
 	void JoinSession(const FBPSessionResult& SearchResult);
+	/** Joins a session known by id (invite, link, party) without searching the whole session list */
+	UFUNCTION(BlueprintCallable, Category="Multiplayer Sessions")
+	void JoinSessionById(const FString& SessionId);
+
+	/**
+	 * Keeps the session list up to date without rebuilding it: after the first search, which reports every session as added,
+	 * only the sessions that were added, removed or changed are passed to OnSessionsChanged.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Multiplayer Sessions")
+	void StartAutoRefresh(const int32 MaxSearchResults = 1000, const float MinIntervalSeconds = 5.f, const float MaxIntervalSeconds = 60.f);
+	UFUNCTION(BlueprintCallable, Category="Multiplayer Sessions")
+	void StopAutoRefresh();
 	
 	UFUNCTION(BlueprintImplementableEvent, Category="Multiplayer Sessions")
 	void OnSessionCreated(const FName SessionName, const FString& SessionId, const bool bWasSuccessful);
@@ -46,13 +74,30 @@ public:
 	UFUNCTION(BlueprintImplementableEvent, Category="Multiplayer Sessions")
 	void OnSessionsFound(const TArray<FBPSessionResult>& SearchResults, const bool bWasSuccessful);
 
+	/** Search results as they are converted, the last batch has bIsFinalBatch set and is followed by OnSessionsFound */
+	UFUNCTION(BlueprintImplementableEvent, Category="Multiplayer Sessions")
+	void OnSessionsFoundBatch(const TArray<FBPSessionResult>& BatchResults, const bool bIsFinalBatch, const bool bWasSuccessful);
+
+	/**
+	 * Above 0, search results are converted a slice per frame, each slice within this many microseconds, and passed to
+	 * OnSessionsFoundBatch as it's done. At 0 they are all converted in the frame they arrive in.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Multiplayer Sessions", meta=(ClampMin=0))
+	int32 ResultConversionBudgetMicroseconds { 0 };
+
+	UFUNCTION(BlueprintImplementableEvent, Category="Multiplayer Sessions")
+	void OnSessionsChanged(const TArray<FBPSessionResult>& AddedSessions, const TArray<FString>& RemovedSessionIds, const TArray<FBPSessionResult>& ChangedSessions, const TArray<FMPChangedSessionFields>& ChangedFields);
+
 protected:
 	virtual void NativeDestruct() override;
 
 	void OnCreateSessionComplete(FName SessionName, FString SessionId, bool bWasSuccessful);
 	void OnFindSessionsComplete(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful);
+	void OnFindSessionsBatchConverted(TArray<FBPSessionResult>&& BatchResults, bool bIsFinalBatch, bool bWasSuccessful);
 	void OnJoinSessionComplete(const FName& SessionName, EOnJoinSessionCompleteResult::Type Result);
 	void OnStartSessionComplete(bool bWasSuccessful);
+	void OnSessionBrowserUpdated(const FMPSessionBrowserDiff& Diff, bool bWasSuccessful);
+	void OnHostReady(FName SessionName, const FString& SessionId, const FMPHostTimings& Timings, bool bWasSuccessful);
 	
 	FString GetServerTravelLobbyMapPath() const;
 	FString GetServerTravelSessionMapPath() const;
@@ -66,10 +111,22 @@ private:
 	UPROPERTY()
 	UMultiplayerSessionsSubsystem* MultiplayerSessionsSubsystem;
 
+	// Removed on destruct, or when the menu is set up again
+	TArray<FMPScopedDelegateBinding> SubsystemBindings;
+
 	UFUNCTION(BlueprintCallable, Category="MultiplayerSessions")
 	void StartMultiplayerSession() const;
 
 	void MenuTeardown();
 
+	// Converts the results of the last search, a new search cancels it
+	TMPTimeSlicedConversion<FOnlineSessionSearchResult, FBPSessionResult> FindSessionsConversion;
+	// Results of the running conversion so far
+	TArray<FBPSessionResult> ConvertedSearchResults;
+
 	int32 NumPublicConnections { 4 };
+	// Set while this widget owns the session browser subscription
+	bool bIsAutoRefreshing { false };
+	// Set while a HostSession issued by this widget runs, the subsystem travels instead of OnCreateSessionComplete
+	bool bIsHosting { false };
 };
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "OnlineSessionSettings.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMPSimulatedSessionBackend, Log, All);
+
+struct FMPSimulatedBackendSettings
+{
+	/** Round trip of every operation, sampled uniformly in [LatencyMs - LatencyJitterMs, LatencyMs + LatencyJitterMs] */
+	float LatencyMs { 80.f };
+	float LatencyJitterMs { 40.f };
+	/** Probability of an operation failing for no reason, on top of the failures the session state causes */
+	float FailureRate { 0.f };
+	int32 Seed { 0 };
+};
+
+/**
+ * In-process stand-in of an online session backend shared by many logical players, for the load tools.
+ * Operations complete after a simulated round trip, in due time order, when Tick is called. Like a real backend,
+ * changes apply on completion: a session becomes findable once its creation completes and a join can find it full.
+ * Sessions carry their id in FMPSessionIdKey, and search results a session info, so they go through the plugin's
+ * result handling (FMPSessionResultTracker, GetSessionIdStr) as they would with a real backend.
+ */
+class MULTIPLAYERSESSIONS_API FMPSimulatedSessionBackend
+{
+public:
+	explicit FMPSimulatedSessionBackend(const FMPSimulatedBackendSettings& InSettings);
+	~FMPSimulatedSessionBackend();
+
+	void CreateSession(const FString& OwnerName, const FOnlineSessionSettings& SessionSettings, TUniqueFunction<void(bool bWasSuccessful, const FString& SessionId)>&& OnComplete);
+	void UpdateSession(const FString& SessionId, const FOnlineSessionSettings& SessionSettings, TUniqueFunction<void(bool bWasSuccessful)>&& OnComplete);
+	void StartSession(const FString& SessionId, TUniqueFunction<void(bool bWasSuccessful)>&& OnComplete);
+	void DestroySession(const FString& SessionId, TUniqueFunction<void(bool bWasSuccessful)>&& OnComplete);
+	/** Returns the advertised sessions with open slots, up to MaxSearchResults, in random order */
+	void FindSessions(const int32 MaxSearchResults, TUniqueFunction<void(bool bWasSuccessful, const TArray<FOnlineSessionSearchResult>& SearchResults)>&& OnComplete);
+	void JoinSession(const FString& SessionId, TUniqueFunction<void(EOnJoinSessionCompleteResult::Type Result)>&& OnComplete);
+	/** Frees the slot of a joined player right away, leaving has no completion */
+	void LeaveSession(const FString& SessionId);
+
+	/** Runs the completions due at Now */
+	void Tick(const double Now);
+
+	int32 GetNumSessions() const { return Sessions.Num(); }
+	int32 GetNumPendingCompletions() const { return PendingCompletions.Num(); }
+
+private:
+	struct FSimulatedSession
+	{
+		FString OwnerName;
+		FOnlineSessionSettings SessionSettings;
+		int32 NumPlayers { 0 };
+		bool bIsStarted { false };
+	};
+
+	struct FPendingCompletion
+	{
+		double DueTime { 0.0 };
+		uint64 Sequence { 0 };
+		TUniqueFunction<void()> Complete;
+	};
+
+	/** Queues Complete after a sampled round trip */
+	void Respond(TUniqueFunction<void()>&& Complete);
+	static bool IsDueFirst(const FPendingCompletion& A, const FPendingCompletion& B);
+	bool ShouldFail();
+	FOnlineSessionSearchResult MakeSearchResult(const FString& SessionId, const FSimulatedSession& Session) const;
+
+	FMPSimulatedBackendSettings Settings;
+	FRandomStream RandomStream;
+	TMap<FString, FSimulatedSession> Sessions;
+	// Min-heap on due time, then on sequence so simultaneous completions keep their order
+	TArray<FPendingCompletion> PendingCompletions;
+	uint64 NextSequence { 0 };
+	int32 NextSessionNumber { 0 };
+};
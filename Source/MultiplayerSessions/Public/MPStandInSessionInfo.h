@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+#include "OnlineSubsystemTypes.h"
+
+/**
+ * Session info of sessions that don't come from an online subsystem (stand-in backends, replayed traffic).
+ * It only carries the session id, so results go through GetSessionIdStr as real ones do, but can't be connected to.
+ */
+class FMPStandInSessionInfo : public FOnlineSessionInfo
+{
+public:
+	FMPStandInSessionInfo(const FString& InSessionId, const FName Type):
+		SessionId(FUniqueNetIdString::Create(InSessionId, Type))
+	{
+	}
+
+	virtual const uint8* GetBytes() const override { return nullptr; }
+	virtual int32 GetSize() const override { return 0; }
+	virtual bool IsValid() const override { return true; }
+	virtual const FUniqueNetId& GetSessionId() const override { return *SessionId; }
+	virtual FString ToString() const override { return SessionId->ToString(); }
+	virtual FString ToDebugString() const override { return FString::Printf(TEXT("StandInSession %s (%s)"), *SessionId->ToString(), *SessionId->GetType().ToString()); }
+
+private:
+	FUniqueNetIdRef SessionId;
+};
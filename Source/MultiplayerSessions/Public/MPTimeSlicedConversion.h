@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+/**
+ * Converts a result set on the game thread a slice per tick, each slice within a budget in microseconds, so converting a
+ * large search for Blueprints doesn't hitch a frame. The first slice is converted right away, in the frame the results
+ * arrived in, and a slice always converts at least one result. A budget of 0 converts everything in that first slice.
+ * Starting a new conversion cancels the running one, as does destroying the converter, and may be done from the slice
+ * callback. The sources are shared, not copied, they must not be modified while the conversion runs.
+ */
+template <typename SourceType, typename ResultType>
+class TMPTimeSlicedConversion
+{
+public:
+	using FSources = TSharedRef<const TArray<SourceType>, ESPMode::ThreadSafe>;
+	using FConvert = TFunction<void(const SourceType& Source, ResultType& OutResult)>;
+	/** Gets each slice once converted, bIsFinalSlice with the last one, which is empty if there was nothing to convert */
+	using FOnSliceConverted = TFunction<void(TArray<ResultType>&& Slice, bool bIsFinalSlice)>;
+
+	TMPTimeSlicedConversion() = default;
+	~TMPTimeSlicedConversion()
+	{
+		Cancel();
+	}
+
+	TMPTimeSlicedConversion(const TMPTimeSlicedConversion&) = delete;
+	TMPTimeSlicedConversion& operator=(const TMPTimeSlicedConversion&) = delete;
+
+	void Start(const FSources& InSources, const int32 InBudgetMicroseconds, FConvert&& InConvert, FOnSliceConverted&& InOnSliceConverted)
+	{
+		Cancel();
+		Sources = InSources;
+		NextIndex = 0;
+		BudgetSeconds = FMath::Max(InBudgetMicroseconds, 0) / 1000000.0;
+		Convert = MoveTemp(InConvert);
+		OnSliceConverted = MoveTemp(InOnSliceConverted);
+		if (ConvertSlice())
+		{
+			TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &TMPTimeSlicedConversion::Tick));
+		}
+	}
+
+	void Cancel()
+	{
+		++RunId;
+		if (TickerHandle.IsValid())
+		{
+			FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+			TickerHandle.Reset();
+		}
+		Sources.Reset();
+		NextIndex = 0;
+	}
+
+	bool IsRunning() const { return TickerHandle.IsValid(); }
+
+private:
+	bool Tick(float DeltaTime)
+	{
+		return ConvertSlice();
+	}
+
+	/** @return  True while results are left for a later tick */
+	bool ConvertSlice()
+	{
+		const double EndTime = FPlatformTime::Seconds() + BudgetSeconds;
+		TArray<ResultType> Slice;
+		while (NextIndex < Sources->Num())
+		{
+			Convert((*Sources)[NextIndex], Slice.AddDefaulted_GetRef());
+			++NextIndex;
+			if (BudgetSeconds > 0.0 && FPlatformTime::Seconds() >= EndTime)
+			{
+				break;
+			}
+		}
+
+		const bool bIsFinalSlice = NextIndex >= Sources->Num();
+		if (bIsFinalSlice)
+		{
+			// Returning false removes the ticker, if any
+			TickerHandle.Reset();
+		}
+		const uint32 SliceRunId = RunId;
+		// Moved out while it runs, restarting from the callback assigns the new run's callback
+		FOnSliceConverted RunningOnSliceConverted = MoveTemp(OnSliceConverted);
+		RunningOnSliceConverted(MoveTemp(Slice), bIsFinalSlice);
+		// The callback may have cancelled or restarted the conversion
+		if (RunId != SliceRunId)
+		{
+			return false;
+		}
+		OnSliceConverted = MoveTemp(RunningOnSliceConverted);
+		if (bIsFinalSlice)
+		{
+			Sources.Reset();
+		}
+		return !bIsFinalSlice;
+	}
+
+	TSharedPtr<const TArray<SourceType>, ESPMode::ThreadSafe> Sources;
+	int32 NextIndex { 0 };
+	double BudgetSeconds { 0.0 };
+	FConvert Convert;
+	FOnSliceConverted OnSliceConverted;
+	uint32 RunId { 0 };
+	FTSTicker::FDelegateHandle TickerHandle;
+};
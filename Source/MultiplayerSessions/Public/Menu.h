@@ -3,12 +3,15 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "MPScopedDelegateBinding.h"
 #include "Blueprint/UserWidget.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "Menu.generated.h"
 
 class UMultiplayerSessionsSubsystem;
 class UButton;
+struct FMPHostTimings;
+struct FMPJoinBestOfResult;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogMultiplayerSessionsMenu, Log, All);
 
@@ -41,9 +44,11 @@ protected:
 	FString GetServerTravelLobbyMapPath() const;
 	void OnFindSessionsComplete(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful);
 	void OnJoinSessionComplete(const FName& SessionName, EOnJoinSessionCompleteResult::Type Result);
+	void OnJoinBestOfComplete(const FMPJoinBestOfResult& Result);
 	void OnStartSessionComplete(bool bWasSuccessful);
 	FString GetServerTravelSessionMapPath() const;
 	void OnDestroySessionComplete(bool bWasSuccessful);
+	void OnHostReady(FName SessionName, const FString& SessionId, const FMPHostTimings& Timings, bool bWasSuccessful);
 	
 	// menu setup functions
 	bool TryBindCallbacksToMultiplayerSessionsSubsystem();
@@ -61,6 +66,9 @@ private:
 	UPROPERTY()
 	UMultiplayerSessionsSubsystem* MultiplayerSessionsSubsystem;
 
+	// Removed on destruct, or when the menu is set up again
+	TArray<FMPScopedDelegateBinding> SubsystemBindings;
+
 	UFUNCTION()
 	void HostButtonClicked();
 	
@@ -76,4 +84,8 @@ private:
 
 	int32 NumPublicConnections { 4 };
 	FString MatchType { "FreeForAll" };
+	// Set while the HostSession issued by the host button runs, the subsystem travels instead of OnCreateSessionComplete
+	bool bIsHosting { false };
+	// Ids of the sessions handed to JoinBestOf, to log the one it joined
+	TArray<FString> JoinCandidateSessionIds;
 };
@@ -6,16 +6,32 @@
 #include "MultiplayerSessionsSearchResult.h"
 #include "Components/ActorComponent.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "MPSessionSearchCursor.h"
+#include "MPSessionSettings.h"
+#include "MPHostTimings.h"
+#include "MPSessionOperationScheduler.h"
+#include "MPScopedDelegateBinding.h"
+#include "MPTimeSlicedConversion.h"
+#include "MPSessionBrowse.h"
+#include "MPChangedSessionFields.h"
 #include "MultiplayerSessionsComponent.generated.h"
 
 enum class EJoinSessionResult : uint8;
 
 class UMultiplayerSessionsSubsystem;
+struct FMPSessionBrowserDiff;
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBlueprintCreateSessionComplete, bool, bWasSuccessful);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnBlueprintFindSessionsComplete, const TArray<FMultiplayerSessionsSearchResult>, SearchResults, bool, bWasSuccessful);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnBlueprintFindSessionsBatch, const TArray<FMultiplayerSessionsSearchResult>, BatchResults, bool, bIsFinalBatch, bool, bWasSuccessful);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnBlueprintJoinSessionComplete, const FName&, SessionName, EJoinSessionResult, Result);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBlueprintStartSessionComplete, bool, bWasSuccessful);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBlueprintDestroySessionComplete, bool, bWasSuccessful);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBlueprintUpdateSessionComplete, bool, bWasSuccessful);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnBlueprintHostReady, const FMPHostTimings&, Timings, bool, bWasSuccessful);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBlueprintReconnectComplete, bool, bWasSuccessful);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnBlueprintSessionBrowserUpdated, const TArray<FMultiplayerSessionsSearchResult>, AddedSessions, const TArray<FString>&, RemovedSessionIds, const TArray<FMultiplayerSessionsSearchResult>, ChangedSessions, const TArray<FMPChangedSessionFields>&, ChangedFields);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBlueprintSessionsBrowsed, const TArray<int32>&, Order);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnBlueprintFindSessionsPageComplete, const TArray<FMultiplayerSessionsSearchResult>, PageResults, bool, bHasMore, bool, bWasSuccessful);
 
 
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
@@ -28,6 +44,59 @@ public:
 	
 	/** Initialize and bind to the subsystem events */
 	virtual void InitializeComponent() override;
+	virtual void UninitializeComponent() override;
+
+	/** Creates, starts (with bStartAfterCreate) and travels to TravelURL in one call, completion arrives through OnHostReady */
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	void HostSession(int32 NumPublicConnections, const FMPSessionSettings& SessionSettings, const FString& TravelURL, const TMap<FName, FString>& ExtraSessionSettings);
+
+	/** Starts a paged session search, results arrive through OnFindSessionsPageComplete */
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	void FindSessionsPage(int32 PageSize = 20);
+
+	/** Requests the page after the last one received, usually already prefetched. Returns false if there are no more pages */
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	bool LoadMoreSessions();
+
+	/**
+	 * Keeps the session list up to date, only the added, removed and changed sessions are reported through OnSessionBrowserUpdated.
+	 * Shared with the other subscribers of the subsystem's refresh (e.g. a session travel widget), stopping only ends this
+	 * component's subscription
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	void StartSessionBrowserRefresh(int32 MaxSearchResults = 1000, float MinIntervalSeconds = 5.f, float MaxIntervalSeconds = 60.f);
+
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	void StopSessionBrowserRefresh();
+
+	/** Joins a session known by id with a single lookup, the result arrives through OnJoinSessionComplete */
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	void JoinSessionById(const FString& SessionId);
+
+	/** Gets back into the last joined session without a search. Returns false if there is no session to reconnect to */
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	bool Reconnect();
+
+	UFUNCTION(BlueprintPure, Category = "Multiplayer Sessions")
+	bool CanReconnect() const;
+
+	/**
+	 * Filters and sorts the results of the last search off the game thread, the order arrives through OnSessionsBrowsed as
+	 * indices into the results of OnFindSessionsComplete. A browse that finishes after a newer search completed is dropped.
+	 * Returns false if there are no results yet
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Multiplayer Sessions")
+	bool BrowseSessions(const FMPSessionBrowseSpec& Spec);
+
+	UFUNCTION(BlueprintPure, Category = "Multiplayer Sessions")
+	EMPSessionState GetSessionState() const;
+
+	/**
+	 * Above 0, search results are converted for Blueprints a slice per frame, each slice within this many microseconds, and
+	 * reported through OnFindSessionsBatch as it's done. At 0 they are all converted in the frame they arrive in.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Multiplayer Sessions", meta = (ClampMin = 0))
+	int32 ResultConversionBudgetMicroseconds { 0 };
 
 	// Blueprint Assignment events for session management
 	UPROPERTY(BlueprintAssignable, Category = "Multiplayer Sessions Events")
@@ -36,6 +105,13 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Multiplayer Sessions Events")
 	FOnBlueprintFindSessionsComplete OnFindSessionsComplete;
 
+	/** Search results as they are converted, the last batch has bIsFinalBatch set and is followed by OnFindSessionsComplete */
+	UPROPERTY(BlueprintAssignable, Category = "Multiplayer Sessions Events")
+	FOnBlueprintFindSessionsBatch OnFindSessionsBatch;
+
+	UPROPERTY(BlueprintAssignable, Category = "Multiplayer Sessions Events")
+	FOnBlueprintSessionsBrowsed OnSessionsBrowsed;
+
 	UPROPERTY(BlueprintAssignable, Category = "Multiplayer Sessions Events")
 	FOnBlueprintJoinSessionComplete OnJoinSessionComplete;
 
@@ -45,12 +121,30 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Multiplayer Sessions Events")
 	FOnBlueprintDestroySessionComplete OnDestroySessionComplete;
 
+	UPROPERTY(BlueprintAssignable, Category = "Multiplayer Sessions Events")
+	FOnBlueprintUpdateSessionComplete OnUpdateSessionComplete;
+
+	UPROPERTY(BlueprintAssignable, Category = "Multiplayer Sessions Events")
+	FOnBlueprintFindSessionsPageComplete OnFindSessionsPageComplete;
+
+	UPROPERTY(BlueprintAssignable, Category = "Multiplayer Sessions Events")
+	FOnBlueprintSessionBrowserUpdated OnSessionBrowserUpdated;
+
+	UPROPERTY(BlueprintAssignable, Category = "Multiplayer Sessions Events")
+	FOnBlueprintReconnectComplete OnReconnectComplete;
+
+	UPROPERTY(BlueprintAssignable, Category = "Multiplayer Sessions Events")
+	FOnBlueprintHostReady OnHostReady;
+
 	// Blueprint Implementable Events to be overridable in the components blueprint
 	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions Events")
 	void OnCreateSession(bool bWasSuccessful);
 	
 	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions Events")
 	void OnFindSessions(const TArray<FMultiplayerSessionsSearchResult>& SearchResults, bool bWasSuccessful);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions Events")
+	void OnFindSessionsBatchReceived(const TArray<FMultiplayerSessionsSearchResult>& BatchResults, bool bIsFinalBatch, bool bWasSuccessful);
 	
 	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions Events")
 	void OnJoinSession(FName SessionName, EJoinSessionResult JoinSessionResult);
@@ -60,6 +154,21 @@ public:
 	
 	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions Events")
 	void OnDestroySession(bool bWasSuccessful);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions Events")
+	void OnUpdateSession(bool bWasSuccessful);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions Events")
+	void OnFindSessionsPage(const TArray<FMultiplayerSessionsSearchResult>& PageResults, bool bHasMore, bool bWasSuccessful);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions Events")
+	void OnReconnect(bool bWasSuccessful);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions Events")
+	void OnHostSessionReady(const FMPHostTimings& Timings, bool bWasSuccessful);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Multiplayer Sessions Events")
+	void OnSessionBrowserUpdate(const TArray<FMultiplayerSessionsSearchResult>& AddedSessions, const TArray<FString>& RemovedSessionIds, const TArray<FMultiplayerSessionsSearchResult>& ChangedSessions, const TArray<FMPChangedSessionFields>& ChangedFields);
 	
 protected:
 	virtual void BeginPlay() override;
@@ -73,5 +182,27 @@ private:
 	void HandleJoinSessionComplete(const FName& SessionName, EOnJoinSessionCompleteResult::Type Result);
 	void HandleStartSessionComplete(bool bWasSuccessful);
 	void HandleDestroySessionComplete(bool bWasSuccessful);
+	void HandleUpdateSessionComplete(FName SessionName, bool bWasSuccessful);
+	void HandleReconnectComplete(bool bWasSuccessful);
+	void HandleHostReady(FName SessionName, const FString& SessionId, const FMPHostTimings& Timings, bool bWasSuccessful);
+	void HandleSessionBrowserUpdated(const FMPSessionBrowserDiff& Diff, bool bWasSuccessful);
+	void HandleFindSessionsPageComplete(const TArray<FOnlineSessionSearchResult>& PageResults, const FMPSessionSearchCursor& NextCursor, bool bWasSuccessful);
+
+	void HandleSessionsBrowsed(const FMPSessionBrowseResult& Result);
+	void HandleFindSessionsBatchConverted(TArray<FMultiplayerSessionsSearchResult>&& BatchResults, bool bIsFinalBatch, bool bWasSuccessful);
+
+	// Converts the results of the last search, a new search cancels it
+	TMPTimeSlicedConversion<FOnlineSessionSearchResult, FMultiplayerSessionsSearchResult> FindSessionsConversion;
+	// Results of the running conversion so far
+	TArray<FMultiplayerSessionsSearchResult> ConvertedSearchResults;
+
+	// Continuation of the last page received
+	FMPSessionSearchCursor NextSessionsPageCursor;
+
+	// Set while this component subscribes to the subsystem's session browser refresh
+	bool bIsRefreshingSessionBrowser { false };
+
+	// Bindings to the subsystem's delegates, removed when the component is uninitialized
+	TArray<FMPScopedDelegateBinding> SubsystemBindings;
 		
 };
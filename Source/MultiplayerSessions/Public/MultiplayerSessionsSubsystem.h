@@ -6,32 +6,68 @@
 #include "Interfaces/OnlineIdentityInterface.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "Engine/StreamableManager.h"
+#include "MPSessionSettings.h"
+#include "MPSessionPool.h"
+#include "MPSessionSearchCursor.h"
+#include "MPSessionBrowserDiff.h"
+#include "MPHostTimings.h"
+#include "MPSessionEventQueue.h"
+#include "MPSessionOperationScheduler.h"
+#include "MPScopedDelegateBinding.h"
+#include "MPSessionMetrics.h"
+#include "MPOnlineTraffic.h"
+#include "MPListenerProfiler.h"
+#include "MPSessionBrowse.h"
+#include "MPFederatedSessionSearch.h"
+#include "MPSessionMirrors.h"
+#include "MPJoinBlacklist.h"
+#include "MPJoinBestOf.h"
+#include "OnlineSessionSettings.h"
 #include "queue"
 
 #include "MultiplayerSessionsSubsystem.generated.h"
 
-struct FMPSessionSettings;
 DECLARE_LOG_CATEGORY_EXTERN(LogMultiplayerSessionsSubsystem, Log, All);
 
+class AGameModeBase;
+class AController;
+class APlayerController;
+
 /**
  * Declaring our own custom delegates for the Menu class to bind callbacks to.
+ * Their broadcasts time each listener, see FMPListenerProfiler.
  */
-DECLARE_MULTICAST_DELEGATE_FourParams(FMultiplayerOnLoginComplete, int LocalUserNum, bool bWasSuccseful, const FUniqueNetId& UserId, const FString& Error);
-DECLARE_MULTICAST_DELEGATE_ThreeParams(FMultiplayerOnCreateSessionComplete, FName SessionName, FString SessionString, bool bWasSuccessful);
-DECLARE_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnFindSessionsComplete, const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful);
-DECLARE_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnJoinSessionComplete, const FName& SessionName, EOnJoinSessionCompleteResult::Type Result);
-DECLARE_MULTICAST_DELEGATE_OneParam(FMultiplayerOnStartSessionComplete, bool bWasSuccessful);
-DECLARE_MULTICAST_DELEGATE_OneParam(FMultiplayerOnDestroySessionComplete, bool bWasSuccessful);
+using FMultiplayerOnLoginComplete = TMPProfiledMulticastDelegate<void(int LocalUserNum, bool bWasSuccseful, const FUniqueNetId& UserId, const FString& Error)>;
+using FMultiplayerOnCreateSessionComplete = TMPProfiledMulticastDelegate<void(FName SessionName, FString SessionString, bool bWasSuccessful)>;
+using FMultiplayerOnFindSessionsComplete = TMPProfiledMulticastDelegate<void(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bWasSuccessful)>;
+using FMultiplayerOnJoinSessionComplete = TMPProfiledMulticastDelegate<void(const FName& SessionName, EOnJoinSessionCompleteResult::Type Result)>;
+using FMultiplayerOnStartSessionComplete = TMPProfiledMulticastDelegate<void(bool bWasSuccessful)>;
+using FMultiplayerOnDestroySessionComplete = TMPProfiledMulticastDelegate<void(bool bWasSuccessful)>;
+using FMultiplayerOnUpdateSessionComplete = TMPProfiledMulticastDelegate<void(FName SessionName, bool bWasSuccessful)>;
+using FMultiplayerOnFindSessionsPageComplete = TMPProfiledMulticastDelegate<void(const TArray<FOnlineSessionSearchResult>& PageResults, const FMPSessionSearchCursor& NextCursor, bool bWasSuccessful)>;
+using FMultiplayerOnSessionBrowserUpdated = TMPProfiledMulticastDelegate<void(const FMPSessionBrowserDiff& Diff, bool bWasSuccessful)>;
+using FMultiplayerOnHostReady = TMPProfiledMulticastDelegate<void(FName SessionName, const FString& SessionId, const FMPHostTimings& Timings, bool bWasSuccessful)>;
+using FMultiplayerOnReconnectComplete = TMPProfiledMulticastDelegate<void(bool bWasSuccessful)>;
+using FMultiplayerOnPooledSessionClaimed = TMPProfiledMulticastDelegate<void(FName SessionName, FString SessionId, bool bWasSuccessful)>;
+using FMultiplayerOnFederatedSearchResults = TMPProfiledMulticastDelegate<void(FName OnlineSubsystemName, const TArray<FMPFederatedSearchResult>& NewResults)>;
+using FMultiplayerOnFederatedSearchComplete = TMPProfiledMulticastDelegate<void(const TArray<FMPFederatedSearchResult>& SearchResults, bool bWasSuccessful)>;
+using FMultiplayerOnJoinBestOfComplete = TMPProfiledMulticastDelegate<void(const FMPJoinBestOfResult& Result)>;
+DECLARE_DELEGATE_OneParam(FMPOnSessionSearchComplete, bool bWasSuccessful);
 DECLARE_DELEGATE(FPendingLoginAction) // Used to delegate function calls to be executed after login. Used for find, create, and joint session if user is not already Logged in
 
-UCLASS()
+UCLASS(Config=Game)
 class MULTIPLAYERSESSIONS_API UMultiplayerSessionsSubsystem : public UGameInstanceSubsystem
 {
 	GENERATED_BODY()
 
 public:
 	UMultiplayerSessionsSubsystem();
-	bool TryAsyncLogin(const FPendingLoginAction& PendingLoginAction);
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	/** @param OnLoginFailed  Run instead of PendingLoginAction if the issued login fails, so the caller can report its failure */
+	bool TryAsyncLogin(const FPendingLoginAction& PendingLoginAction, const FPendingLoginAction& OnLoginFailed = FPendingLoginAction());
+	bool IsUserLoggedIn() const { return IsLoggedIn; }
 
 	/**
 	 * To handle session functionality
@@ -42,20 +78,216 @@ public:
 		const FMPSessionSettings& SessionSettings,
 		const TMap<FName, FString>& ExtraSessionSettings = TMap<FName, FString> ()
 	);
+	/** Typed overload, attributes are advertised with their own type and advertisement (see MPSessionSchema.h) */
+	void CreateSession(
+		const int32 NumPublicConnections,
+		const FMPSessionSettings& SessionSettings,
+		const FSessionSettings& SessionAttributes
+	);
+	/**
+	 * Hosts in one call: creates the session, starts it right from the create completion when
+	 * SessionSettings.bStartAfterCreate is set, then server travels to TravelURL (e.g. "/Game/Maps/Lobby?listen").
+	 * The destination map is loaded in the background while the session round trips are in flight.
+	 * The create and start delegates are still broadcast, listeners that travel on them must leave that to HostSession.
+	 * Completion is reported through MultiplayerOnHostReady, as a failure if the host isn't ready within HostSessionTimeoutSeconds.
+	 */
+	void HostSession(
+		const int32 NumPublicConnections,
+		const FMPSessionSettings& SessionSettings,
+		const FString& TravelURL,
+		const TMap<FName, FString>& ExtraSessionSettings = TMap<FName, FString> ()
+	);
+	bool IsHosting() const { return HostPipeline.bIsActive; }
+	/** Online subsystems the hosted session is currently advertised on, the one in use first (see AdvertisingOnlineSubsystems) */
+	TArray<FName> GetAdvertisedOnlineSubsystems() const;
+	/**
+	 * Updates the hosted session in place, sending only the settings that differ from the advertised ones.
+	 * If an immutable setting (LAN, dedicated, presence, lobbies) changes the session is recreated instead,
+	 * and completion is reported through MultiplayerOnCreateSessionComplete.
+	 */
+	void UpdateSession(
+		const FMPSessionSettings& SessionSettings,
+		const TMap<FName, FString>& ExtraSessionSettings = TMap<FName, FString> ()
+	);
+	void UpdateSession(
+		const FMPSessionSettings& SessionSettings,
+		const FSessionSettings& SessionAttributes
+	);
+	/**
+	 * Session pool mode, for dedicated servers that allocate matches.
+	 * Keeps PoolSize sessions created but not advertised, claiming one only costs a session update.
+	 * Restarting the pool fills the new one once every session of the previous one is destroyed. Refused during a replay.
+	 */
+	void StartSessionPool(const int32 PoolSize, const FMPSessionSettings& SessionSettings);
+	/** @return  The name of the session being claimed, NAME_None if no pooled session is ready */
+	FName ClaimPooledSession(const TMap<FName, FString>& ExtraSessionSettings = TMap<FName, FString> ());
+	FName ClaimPooledSession(const FSessionSettings& SessionAttributes);
+	bool ReleasePooledSession(const FName SessionName);
+	/** Destroys the pooled sessions in the background, see IsSessionPoolStopping */
+	void StopSessionPool();
+	int32 GetNumReadyPooledSessions() const;
+	/** True while the sessions of a stopped pool are being destroyed */
+	bool IsSessionPoolStopping() const;
 	void FindSessions(const int32 MaxSearchResults);
+	/** QuerySettings are added to the default search filters, typed filters can be built with TMPSessionSchema::Query */
+	void FindSessions(const int32 MaxSearchResults, const FOnlineSearchSettings& QuerySettings);
+	/**
+	 * Paged search, the first page is reported through MultiplayerOnFindSessionsPageComplete with the cursor of the next one.
+	 * The next page is prefetched in the background while the current one is displayed.
+	 * Starting a new paged search makes the cursors of the previous one stale. Pages stop at MaxPagedSearchResults.
+	 */
+	void FindSessionsPaged(const int32 PageSize, const FOnlineSearchSettings& QuerySettings = FOnlineSearchSettings());
+	/** @return  False if the cursor is invalid or stale */
+	bool FindSessionsNextPage(const FMPSessionSearchCursor& Cursor);
+	/**
+	 * Session browser subscription. Searches again on an interval and reports only the sessions added, removed or changed
+	 * since the previous search through MultiplayerOnSessionBrowserUpdated, the first search reports every session as added.
+	 * The interval doubles while nothing changes, up to MaxIntervalSeconds, and goes back to MinIntervalSeconds on a change.
+	 * MinIntervalSeconds is at least MinSessionBrowserRefreshIntervalSeconds.
+	 * Subscribers are counted: starting again while refreshing applies the new parameters and keeps the refresh running until
+	 * every Start is matched by a Stop. A late subscriber only gets the changes from then on.
+	 */
+	void StartSessionBrowserRefresh(
+		const int32 MaxSearchResults,
+		const FOnlineSearchSettings& QuerySettings = FOnlineSearchSettings(),
+		const float MinIntervalSeconds = 5.f,
+		const float MaxIntervalSeconds = 60.f
+	);
+	/** Ends this subscriber's subscription, the refresh stops with the last one */
+	void StopSessionBrowserRefresh();
+	bool IsSessionBrowserRefreshing() const;
+	/**
+	 * Filters and sorts the results of the last successful FindSessions on worker threads, OnBrowsed gets the order on the
+	 * game thread. The results are shared, not copied, so browsing again with another spec is cheap.
+	 * @return  False if there are no results to browse yet
+	 */
+	bool BrowseLastSearchResults(const FMPSessionBrowseSpec& Spec, FMPOnSessionsBrowsed&& OnBrowsed) const;
+	TSharedPtr<const TArray<FOnlineSessionSearchResult>, ESPMode::ThreadSafe> GetLastSearchResults() const { return LastSearchResults; }
+	/**
+	 * The shared results behind SearchResults, as broadcast by MultiplayerOnFindSessionsComplete, to hold on to them past the
+	 * broadcast without copying them. Only copies if a newer search replaced them during the broadcast.
+	 */
+	FMPSessionResultsSnapshot ShareSearchResults(const TArray<FOnlineSessionSearchResult>& SearchResults) const;
 	void JoinSession(const FOnlineSessionSearchResult& SearchResult);
+	/**
+	 * Federated search: searches the online subsystem in use and each of OnlineSubsystemNames (FederatedOnlineSubsystems
+	 * when empty) at once, so it takes as long as the slowest backend instead of all of them in turn. A session advertised
+	 * on several backends is reported once, matched by the key hosts advertise (FMPSessionKeyKey).
+	 * The sessions each backend adds are reported through MultiplayerOnFederatedSearchResults as it answers, the merged
+	 * results through MultiplayerOnFederatedSearchComplete once every backend answered.
+	 */
+	void FindSessionsFederated(
+		const int32 MaxSearchResults,
+		const FOnlineSearchSettings& QuerySettings = FOnlineSearchSettings(),
+		const TArray<FName>& OnlineSubsystemNames = TArray<FName>()
+	);
+	/**
+	 * Joins through the backend the session was found on. If that isn't the online subsystem in use, the subsystem switches
+	 * to it first, which requires having no session and no search in flight. The switch only lasts as long as the joined
+	 * session: the subsystem switches back once the join fails or the session is destroyed.
+	 * Completion is reported through MultiplayerOnJoinSessionComplete.
+	 */
+	void JoinFederatedSession(const FMPFederatedSearchResult& SearchResult);
+	FName GetOnlineSubsystemName() const { return OnlineSubsystemName; }
+	/**
+	 * Sessions this client failed to join because they were full, gone or had no address are left out of every search
+	 * (FindSessions, paged, browser, federated) for a while, see bBlacklistFailedJoins. Joining one anyway is still allowed.
+	 */
+	bool IsJoinBlacklisted(const FOnlineSessionSearchResult& SearchResult) const;
+	void ClearJoinBlacklist();
+	/**
+	 * Joins the first of Candidates that accepts the player, trying them one at a time in the order given (best first).
+	 * A full, gone or unreachable session moves on to the next candidate right away, blacklisted ones are skipped, and
+	 * with FMPJoinBestOfPolicy::bReverifySlots each candidate is looked up again just before its join.
+	 * The final result is reported once through MultiplayerOnJoinSessionComplete, the failed attempts are not, and with
+	 * the attempts and the time taken through MultiplayerOnJoinBestOfComplete.
+	 * @return  False if another JoinBestOf is in progress or there are no candidates, nothing is reported in that case
+	 */
+	bool JoinBestOf(const TArray<FOnlineSessionSearchResult>& Candidates, const FMPJoinBestOfPolicy& Policy = FMPJoinBestOfPolicy());
+	bool IsJoiningBestOf() const { return JoinBestOfState.bIsActive; }
+	/**
+	 * Joins a session known by id (invites, links, parties) with a single lookup instead of a search:
+	 * the backend's find-by-id where available, otherwise a search filtered on the advertised session id.
+	 * Completion is reported through MultiplayerOnJoinSessionComplete.
+	 */
+	void JoinSessionById(const FString& SessionId);
+	/**
+	 * Gets back into the last joined session without a search, travelling once it is joined:
+	 * - if the session is still registered locally, travels to its resolved address right away
+	 * - otherwise joins the cached search result again, and if that fails looks the session up by id and joins it
+	 * - otherwise (e.g. after a restart, see bPersistReconnectInfo) looks the session up by id and joins it
+	 * Completion is reported through MultiplayerOnReconnectComplete instead of MultiplayerOnJoinSessionComplete.
+	 * @return  False if there is no session to reconnect to
+	 */
+	bool Reconnect();
+	bool CanReconnect() const;
+	/** Forgets the last joined session, e.g. when the player leaves on purpose */
+	void ClearReconnectInfo();
 	void DestroySession();
+	/** @return  False if the start could not be scheduled, completion is reported through MultiplayerOnStartSessionComplete */
 	bool StartSession();
 
+	/**
+	 * Session operations (create, update, start, destroy, join, find) go through a scheduler: conflicting ones are queued
+	 * behind the one in flight, merged with a queued one of the same kind, or rejected when the session state does not allow them.
+	 */
+	EMPSessionState GetSessionState() const;
+
 	/**
 	 * Our own custom delegates for the Menu class to bind callbacks to.
 	 */
-	FMultiplayerOnLoginComplete MultiplayerOnLoginComplete;
-	FMultiplayerOnCreateSessionComplete MultiplayerOnCreateSessionComplete;
-	FMultiplayerOnFindSessionsComplete MultiplayerOnFindSessionsComplete;
-	FMultiplayerOnJoinSessionComplete MultiplayerOnJoinSessionComplete;
-	FMultiplayerOnStartSessionComplete MultiplayerOnStartSessionComplete;
-	FMultiplayerOnDestroySessionComplete MultiplayerOnDestroySessionComplete;
+	FMultiplayerOnLoginComplete MultiplayerOnLoginComplete { TEXT("MultiplayerOnLoginComplete") };
+	FMultiplayerOnCreateSessionComplete MultiplayerOnCreateSessionComplete { TEXT("MultiplayerOnCreateSessionComplete") };
+	FMultiplayerOnFindSessionsComplete MultiplayerOnFindSessionsComplete { TEXT("MultiplayerOnFindSessionsComplete") };
+	FMultiplayerOnJoinSessionComplete MultiplayerOnJoinSessionComplete { TEXT("MultiplayerOnJoinSessionComplete") };
+	FMultiplayerOnStartSessionComplete MultiplayerOnStartSessionComplete { TEXT("MultiplayerOnStartSessionComplete") };
+	FMultiplayerOnDestroySessionComplete MultiplayerOnDestroySessionComplete { TEXT("MultiplayerOnDestroySessionComplete") };
+	FMultiplayerOnUpdateSessionComplete MultiplayerOnUpdateSessionComplete { TEXT("MultiplayerOnUpdateSessionComplete") };
+	FMultiplayerOnFindSessionsPageComplete MultiplayerOnFindSessionsPageComplete { TEXT("MultiplayerOnFindSessionsPageComplete") };
+	FMultiplayerOnSessionBrowserUpdated MultiplayerOnSessionBrowserUpdated { TEXT("MultiplayerOnSessionBrowserUpdated") };
+	FMultiplayerOnReconnectComplete MultiplayerOnReconnectComplete { TEXT("MultiplayerOnReconnectComplete") };
+	FMultiplayerOnHostReady MultiplayerOnHostReady { TEXT("MultiplayerOnHostReady") };
+	FMultiplayerOnPooledSessionClaimed MultiplayerOnPooledSessionClaimed { TEXT("MultiplayerOnPooledSessionClaimed") };
+	FMultiplayerOnFederatedSearchResults MultiplayerOnFederatedSearchResults { TEXT("MultiplayerOnFederatedSearchResults") };
+	FMultiplayerOnFederatedSearchComplete MultiplayerOnFederatedSearchComplete { TEXT("MultiplayerOnFederatedSearchComplete") };
+	FMultiplayerOnJoinBestOfComplete MultiplayerOnJoinBestOfComplete { TEXT("MultiplayerOnJoinBestOfComplete") };
+
+	/**
+	 * Event bus mode: the delegates above are broadcast once per tick from a ticker, in the order the completions happened,
+	 * instead of from inside the online subsystem's callbacks. Listeners can then call back into the subsystem (travel, join)
+	 * without re-entering it, and the work done in one frame is bounded by EventDispatchBudgetMs.
+	 */
+	void SetDeferSessionEvents(const bool bDefer);
+	bool IsDeferringSessionEvents() const { return SessionEventQueue.IsValid(); }
+	/** Broadcasts every deferred event now, e.g. before a blocking load */
+	void FlushSessionEvents();
+
+	/**
+	 * Publishes the session layer metrics (operation counts, failures, latency histograms, sessions and players) to a named
+	 * shared memory region every MetricsPublishIntervalSeconds, see MPSessionMetricsLayout.h and Tools/MPSessionMetricsReader.
+	 * An empty name uses MPSessionMetrics.<process id>. In PIE the name gets a .PIE<instance> suffix per game instance.
+	 */
+	void StartMetricsExport(const FString& RegionName = FString());
+	void StopMetricsExport();
+	bool IsExportingMetrics() const { return Metrics.IsValid(); }
+
+	/**
+	 * Records the calls the subsystem makes into the session and identity interfaces and the callbacks it receives, with
+	 * timestamps and payloads, to a binary log (see MPOnlineTraffic.h). Also started with -MPRecordOnlineTraffic=<File>.
+	 * The session pool's traffic is recorded too. Mirrors and federated searches go to other backends and are not.
+	 */
+	void StartOnlineTrafficRecording(const FString& Path);
+	void StopOnlineTrafficRecording();
+	/**
+	 * Answers the subsystem's calls with the callbacks of a recorded log instead of the online interfaces, in real time or
+	 * as fast as possible. Also started with -MPReplayOnlineTraffic=<File> [-MPReplayAsFastAsPossible].
+	 * Only calls and callbacks are replayed, queries (named sessions, connect strings) still go to the online subsystem.
+	 * Only the game session is replayed: refused while a session pool runs, and neither mirrors nor other federated
+	 * backends are reached during a replay.
+	 */
+	void StartOnlineTrafficReplay(const FString& Path, const bool bAsFastAsPossible);
+	void StopOnlineTrafficReplay();
+	bool IsReplayingOnlineTraffic() const { return OnlineTrafficReplay.IsValid(); }
 
 	/**
 	 * Utility functions for the Menu class to use.
@@ -63,6 +295,117 @@ public:
 	bool GetResolvedConnectString(const FName& SessionName, FString& ConnectInfo) const;
 	bool TryFirstLocalPlayerControllerClientTravel(const FString& Address);
 	bool TryFirstLocalPlayerControllerClientTravel(const FName& SessionName);
+	static FString GetMapPackageName(const TSoftObjectPtr<UWorld>& Map);
+	/** Converts string settings to session attributes advertised as strings */
+	static FSessionSettings ToSessionAttributes(const TMap<FName, FString>& ExtraSessionSettings);
+
+	/**
+	 * True on headless dedicated servers. Sessions are then owned by ServerHostingPlayerNum instead of a local player,
+	 * login uses the server credentials (if any) and joining is not available.
+	 */
+	bool IsServerHostingMode() const;
+
+	/**
+	 * When joining, asynchronously load the map the host advertises (SETTING_MAPNAME) while the join is in flight,
+	 * so that ClientTravel finds the package already in memory. The load is cancelled if the join fails.
+	 */
+	bool bPreloadDestinationMapOnJoin { true };
+
+	/** HostSession reports a failure if the session isn't created, started and travelled to by then */
+	UPROPERTY(Config)
+	float HostSessionTimeoutSeconds { 60.f };
+
+	/**
+	 * Hosts advertise their session id as an attribute once the session is created (one extra update),
+	 * so clients on backends without find-by-id can still join them by id
+	 */
+	UPROPERTY(Config)
+	bool bAdvertiseSessionId { true };
+
+	/** Result limit of the filtered search used to find a session by id when the backend has no find-by-id */
+	UPROPERTY(Config)
+	int32 FindSessionByIdMaxSearchResults { 20 };
+
+	/**
+	 * Results a paged search reaches at most, over all its pages. Without an offset each page searches every result up to
+	 * it again, so the cost of the pages grows with their index
+	 */
+	UPROPERTY(Config)
+	int32 MaxPagedSearchResults { 200 };
+
+	/** Starts the subsystem in event bus mode (see SetDeferSessionEvents), also enabled with -MPDeferSessionEvents */
+	UPROPERTY(Config)
+	bool bDeferSessionEvents { false };
+
+	/** Time deferred events may take in one frame, at least one event is dispatched per frame. 0 dispatches them all */
+	UPROPERTY(Config)
+	float EventDispatchBudgetMs { 2.f };
+
+	/** Deferred events carrying the full state (search results) replace a pending older one of the same kind */
+	UPROPERTY(Config)
+	bool bCoalesceSessionEvents { true };
+
+	/** Rate limit of the session operations sent to the backend, 0 disables it */
+	UPROPERTY(Config)
+	float BackendOperationsPerSecond { 5.f };
+
+	/** Session operations that can be sent at once before the rate limit applies */
+	UPROPERTY(Config)
+	float BackendOperationsBurst { 10.f };
+
+	/** Starts the metrics export (see StartMetricsExport), also enabled with -MPMetricsRegion=<Name> */
+	UPROPERTY(Config)
+	bool bExportMetrics { false };
+
+	UPROPERTY(Config)
+	FString MetricsRegionName;
+
+	/** 0 publishes every tick */
+	UPROPERTY(Config)
+	float MetricsPublishIntervalSeconds { 1.f };
+
+	/** Saves the last joined session to a save game slot, so Reconnect also works after the client restarts */
+	UPROPERTY(Config)
+	bool bPersistReconnectInfo { false };
+
+	/** Saved reconnect info older than this is ignored */
+	UPROPERTY(Config)
+	float PersistedReconnectInfoMaxAgeSeconds { 600.f };
+
+	/** Leaves sessions this client recently failed to join out of search results, for the time configured per failure */
+	UPROPERTY(Config)
+	bool bBlacklistFailedJoins { true };
+
+	/** A full session may free a slot soon */
+	UPROPERTY(Config)
+	float JoinBlacklistSessionIsFullSeconds { 30.f };
+
+	/** Stale advertisements of a destroyed session can linger in the backend's search results for minutes */
+	UPROPERTY(Config)
+	float JoinBlacklistSessionDoesNotExistSeconds { 300.f };
+
+	UPROPERTY(Config)
+	float JoinBlacklistCouldNotRetrieveAddressSeconds { 60.f };
+
+	/** Online subsystems FindSessionsFederated searches along with the one in use, e.g. Steam and EOS for crossplay */
+	UPROPERTY(Config)
+	TArray<FName> FederatedOnlineSubsystems;
+
+	/** Lower bound of the session browser refresh interval, whatever a subscriber asks for */
+	UPROPERTY(Config)
+	float MinSessionBrowserRefreshIntervalSeconds { 1.f };
+
+	/** Backends that haven't answered a federated search by then are completed as failed, freeing the search lane */
+	UPROPERTY(Config)
+	float FederatedSearchTimeoutSeconds { 15.f };
+
+	/**
+	 * Dual advertising: online subsystems the hosted session is also created on, besides the one in use, e.g. NULL for LAN
+	 * players at on-site events. Creates, updates and destroys are sent to all of them at once and complete once the slowest
+	 * answered, the open slots follow the players in the game. Mirrors are not recorded, nor created while replaying.
+	 */
+	UPROPERTY(Config)
+	TArray<FName> AdvertisingOnlineSubsystems;
 
 protected:
 	// Internal callbacks we'll bind to the Online Session Interface delegates
@@ -73,51 +416,362 @@ protected:
 	void OnFindSessionsComplete(bool bWasSuccessful);
 	void OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
 	void OnDestroySessionComplete(FName SessionName, bool bWasSuccessful);
-	void OnStartSessionComplete(FName SessionName, bool bWasSuccessful) const ;
+	void OnStartSessionComplete(FName SessionName, bool bWasSuccessful);
+	void OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful);
 
 	bool IsSessionInterfaceInvalid() const;
 	bool IsIdentityInterfaceInvalid() const;
+	bool TryAsyncServerLogin(const FPendingLoginAction& PendingLoginAction, const FPendingLoginAction& OnLoginFailed);
+	FUniqueNetIdPtr GetFirstLocalPlayerNetId() const;
 	bool TryAsyncCreateSession(
 		const FMPSessionSettings& SessionSettings,
-		const TMap<FName, FString>& ExtraSessionSettings = TMap<FName, FString>()
+		const FSessionSettings& ExtraSessionSettings = FSessionSettings()
 	);
+	void ApplySessionSettings(
+		const FMPSessionSettings& SessionSettings,
+		const FSessionSettings& ExtraSessionSettings,
+		FOnlineSessionSettings& OutSettings
+	) const;
 	void SetupLastSessionSettings(
 		const FMPSessionSettings& SessionSettings,
-		const TMap<FName, FString>& ExtraSessionSettings
+		const FSessionSettings& ExtraSessionSettings
+	);
+	// Scheduled operations, issued by the operation scheduler when their turn comes
+	void ScheduleOperation(
+		const EMPSessionOperation Kind,
+		TUniqueFunction<void()>&& Execute,
+		TUniqueFunction<void()>&& Reject,
+		const EMPSessionOperationPriority Priority = EMPSessionOperationPriority::Normal,
+		const FName MergeKey = NAME_None
 	);
-	bool DestroyPreviousSessionIfExists(const int32 NumPublicConnections);
-	bool TryAsyncFindSessions(int32 MaxSearchResults);
-	void SetupLastSessionSearchOptions(int32 MaxSearchResults);
+	void CompleteOperation(const EMPSessionOperation Kind, const bool bWasSuccessful);
+	void SetSessionState(const EMPSessionState State);
+	/** Reads the game session state back from the session interface, after a backend completion */
+	void SyncSessionState();
+	void IssueCreateSession(
+		const int32 NumPublicConnections,
+		const FMPSessionSettings& SessionSettings,
+		const FSessionSettings& ExtraSessionSettings
+	);
+	/** Queues a destroy of the existing session followed by its creation with the new settings, in front of the other operations */
+	void RecreateSession(
+		const int32 NumPublicConnections,
+		const FMPSessionSettings& SessionSettings,
+		const FSessionSettings& ExtraSessionSettings,
+		const EMPSessionOperation InFlightOperation
+	);
+	void IssueUpdateSession(
+		const FMPSessionSettings& SessionSettings,
+		const FSessionSettings& ExtraSessionSettings
+	);
+	bool IssueStartSession();
+	void IssueDestroySession();
+	void IssueJoinSession(const FOnlineSessionSearchResult& SearchResult);
+	void IssueFindSessions(const int32 MaxSearchResults, const FOnlineSearchSettings& QuerySettings);
+	void FailFindSessionsLogin();
+	void IssueFindSessionsFederated(const int32 MaxSearchResults, const FOnlineSearchSettings& QuerySettings, const TArray<FName>& OnlineSubsystemNames);
+	void IssueFederatedSearches(const int32 MaxSearchResults, const FOnlineSearchSettings& QuerySettings, const TArray<FName>& OnlineSubsystemNames);
+	void IssueJoinFederatedSession(const FMPFederatedSearchResult& SearchResult);
+	bool IsHostingSession() const;
+	bool RequiresSessionRecreation(const FMPSessionSettings& SessionSettings) const;
+	int32 ApplySessionSettingsDiff(
+		const FMPSessionSettings& SessionSettings,
+		const FSessionSettings& ExtraSessionSettings,
+		FOnlineSessionSettings& OutUpdatedSettings
+	) const;
+	bool TryAsyncUpdateSession(const FOnlineSessionSettings& UpdatedSettings);
+	bool TryAsyncFindSessions(int32 MaxSearchResults, const FOnlineSearchSettings& QuerySettings);
+	void SetupLastSessionSearchOptions(int32 MaxSearchResults, const FOnlineSearchSettings& QuerySettings);
+	TSharedRef<FOnlineSessionSearch> MakeSessionSearch(int32 MaxSearchResults, const FOnlineSearchSettings& QuerySettings) const;
+	bool TryIssueSessionSearch(const TSharedRef<FOnlineSessionSearch>& SessionSearch, const FMPOnSessionSearchComplete& OnComplete);
+	void OnLastSessionSearchComplete(bool bWasSuccessful);
+
+	// Paged search
+	bool TryIssueSessionSearchPage(const int32 PageIndex);
+	void OnSessionSearchPageComplete(bool bWasSuccessful, const int32 SearchId, const int32 PageIndex);
+	void DeliverSessionSearchPage();
+
+	// Session pool
+	void OnSessionPoolDestroyed();
+
+	// Session browser subscription
+	void IssueSessionBrowserRefresh();
+	void OnSessionBrowserRefreshComplete(bool bWasSuccessful, const int32 SubscriptionId);
+	void ScheduleSessionBrowserRefresh();
+
+	// Dual advertising
+	void IssueSessionMirrorsCall(TFunctionRef<void(FMPOnSessionMirrorsComplete&&)> Issue);
+	void OnSessionMirrorsComplete(bool bWasSuccessful);
+	/** Runs Completion once the mirrors answered too, right away if no call to them is in flight */
+	void CompleteWithSessionMirrors(TUniqueFunction<void()>&& Completion);
+	void OnGameModePostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer);
+	void OnGameModeLogout(AGameModeBase* GameMode, AController* Exiting);
+
+	// Federated search
+	void OnFederatedOwnSearchComplete(bool bWasSuccessful, const int32 SearchId);
+	void OnFederatedSearchResults(FName ResultsOnlineSubsystemName, const TArray<FMPFederatedSearchResult>& NewResults, const int32 SearchId);
+	void OnFederatedSearchComplete(bool bWasSuccessful, const int32 SearchId);
+	/** Makes another online subsystem the one in use, only while there is no session and no search in flight */
+	bool TrySwitchOnlineSubsystem(const FName NewOnlineSubsystemName);
+	void RestoreHomeOnlineSubsystem();
+
+	// Join failure blacklist
+	float GetJoinBlacklistSeconds(const EOnJoinSessionCompleteResult::Type Reason) const;
+	void RemoveJoinBlacklisted(TArray<FMPFederatedSearchResult>& SearchResults) const;
+
+	// Join with ordered fallback
+	void AttemptNextJoinBestOf();
+	void OnJoinBestOfCandidateFound(int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult& SearchResult, int32 CandidateIndex);
+	void IssueJoinBestOfAttempt(const int32 CandidateIndex, const FOnlineSessionSearchResult& SearchResult);
+	void OnJoinBestOfAttemptComplete(const FName SessionName, const EOnJoinSessionCompleteResult::Type Result);
+	void FinishJoinBestOf(const FName SessionName, const EOnJoinSessionCompleteResult::Type Result);
+
+	// Completion of create and start, routed to the host pipeline when it is running
+	void BroadcastCreateSessionComplete(const FName SessionName, const FString& SessionId, const bool bWasSuccessful);
+	void BroadcastStartSessionComplete(const bool bWasSuccessful);
+	void TravelHostPipeline();
+	void FinishHostPipeline(const bool bWasSuccessful);
+
+	// Lookup of a single session by id
+	bool TryAsyncFindSessionById(const FString& SessionId, const FOnSingleSessionResultCompleteDelegate& OnComplete);
+	bool TryAsyncFindSessionByIdAttribute(const FString& SessionId, const FOnSingleSessionResultCompleteDelegate& OnComplete);
+	void OnJoinSessionByIdFound(int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult& SearchResult);
+	void BroadcastJoinSessionByIdFailure(const EOnJoinSessionCompleteResult::Type Result);
+	void AdvertiseSessionId(const FString& SessionId);
+	void ScheduleInternalSessionUpdate(const FName MergeKey, TUniqueFunction<bool(FOnlineSessionSettings&)>&& Apply);
+
+	// Reconnect
+	void IssueReconnectDestroySession();
+	void ContinueReconnect();
+	void LookUpReconnectSession();
+	void OnReconnectSessionFound(int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult& SearchResult);
+	void FinishReconnect(const bool bWasSuccessful);
+	void BroadcastJoinSessionResult(const FName SessionName, const EOnJoinSessionCompleteResult::Type Result);
+	void RememberJoinedSession(const FOnlineSessionSearchResult& SearchResult);
+	void LoadPersistedReconnectInfo();
+
+	void PublishMetrics();
+
+	/**
+	 * Issues a call into the online interfaces through IssueCall, recording it, or hands it to the traffic replay which
+	 * answers it through DeliverReplayed, or by default through DeliverReplayedCallback.
+	 */
+	bool IssueOnlineCall(
+		FMPOnlineTrafficEvent&& Call,
+		TFunctionRef<bool()> IssueCall,
+		FMPOnlineTrafficReplay::FDeliverCallback&& DeliverReplayed = nullptr
+	);
+	void RecordOnlineCallback(FMPOnlineTrafficEvent&& Callback);
+	void DeliverReplayedCallback(const FMPOnlineTrafficEvent& Callback);
+
+	/** Broadcasts right away, or queues the broadcast in event bus mode. bCoalescable only for events carrying the full state */
+	void DispatchSessionEvent(
+		const EMPSessionEventKind Kind,
+		TUniqueFunction<void()>&& Broadcast,
+		const bool bCoalescable = false,
+		const FName Subject = NAME_None
+	);
+
+	// Destination map preloading
+	FString GetCurrentMapPackageName() const;
+	void StartDestinationMapPreload(const FString& MapPackageName);
+	void CancelDestinationMapPreload();
+	void OnPostLoadMapWithWorld(UWorld* LoadedWorld);
 
 private:
+	/**
+	 * Server credentials used by dedicated servers to log in, overridden by -MPServerAuthType=, -MPServerAuthId= and -MPServerAuthToken=.
+	 * When no type is given the server does not log in, hosting through the hosting player number does not need a user.
+	 */
+	UPROPERTY(Config)
+	FString ServerAuthType;
+	UPROPERTY(Config)
+	FString ServerAuthId;
+	UPROPERTY(Config)
+	FString ServerAuthToken;
+	UPROPERTY(Config)
+	int32 ServerHostingPlayerNum { 0 };
+
+	/** -MPAutoHost makes a dedicated server create its session once the first map is loaded, -MPMaxPlayers= sets its size */
+	bool bAutoHostPending { false };
+
+	// Online subsystem in use, the default one unless overridden with -MPSessionsOSS=<Name> (e.g. NULL for a local backend)
+	FName OnlineSubsystemName;
 	IOnlineSessionPtr SessionInterface;
 	IOnlineIdentityPtr IdentityInterface;
 	TSharedPtr<FOnlineSessionSettings> LastSessionSettings;
 	TSharedPtr<FOnlineSessionSearch> LastSessionSearch;
+	// Results of the last successful FindSessions, never modified once set so browse tasks can read them
+	TSharedPtr<const TArray<FOnlineSessionSearchResult>, ESPMode::ThreadSafe> LastSearchResults;
 
 	/**
 	 * To add to the Online Session Interface delegate list.
 	 * We'll bind the MultiplayerSessionsSubsystem internal callback functions to these delegates.
+	 * Each binding is removed when its operation completes, when it is bound again, or with the subsystem.
 	 */
 	FOnLoginCompleteDelegate LoginCompleteDelegate;
-	FDelegateHandle LoginCompleteDelegateHandle;
+	FMPScopedDelegateBinding LoginCompleteBinding;
 	FOnCreateSessionCompleteDelegate CreateSessionCompleteDelegate;
-	FDelegateHandle CreateSessionCompleteDelegateHandle;
+	FMPScopedDelegateBinding CreateSessionCompleteBinding;
 	FOnFindSessionsCompleteDelegate FindSessionsCompleteDelegate;
-	FDelegateHandle FindSessionsCompleteDelegateHandle;
+	FMPScopedDelegateBinding FindSessionsCompleteBinding;
 	FOnJoinSessionCompleteDelegate JoinSessionCompleteDelegate;
-	FDelegateHandle JoinSessionCompleteDelegateHandle;
+	FMPScopedDelegateBinding JoinSessionCompleteBinding;
 	FOnDestroySessionCompleteDelegate DestroySessionCompleteDelegate;
-	FDelegateHandle DestroySessionCompleteDelegateHandle;
+	FMPScopedDelegateBinding DestroySessionCompleteBinding;
 	FOnStartSessionCompleteDelegate StartSessionCompleteDelegate;
-	FDelegateHandle StartSessionCompleteDelegateHandle;
+	FMPScopedDelegateBinding StartSessionCompleteBinding;
+	FOnUpdateSessionCompleteDelegate UpdateSessionCompleteDelegate;
+	FMPScopedDelegateBinding UpdateSessionCompleteBinding;
+
+	FStreamableManager MapPreloadStreamableManager;
+	TSharedPtr<FStreamableHandle> MapPreloadHandle;
+	FMPScopedDelegateBinding PostLoadMapBinding;
+
+	// Orders the session operations and tracks the game session state, created in Initialize
+	TUniquePtr<FMPSessionOperationScheduler> OperationScheduler;
+
+	// Names of the extra settings currently advertised, so an update can remove the ones that were dropped
+	TSet<FName> LastExtraSessionSettingNames;
+	// Settings sent with the in-flight UpdateSession, they replace LastSessionSettings once the backend accepts them
+	TSharedPtr<FOnlineSessionSettings> PendingUpdatedSessionSettings;
+	// Set when CreateSession was served by an in-place update, so the completion is reported as a create
+	bool bReportUpdateAsCreate { false };
+	// Set while an update of ScheduleInternalSessionUpdate is in flight, its completion is not broadcast
+	bool bIsInternalUpdateInFlight { false };
+
+	TUniquePtr<FMPSessionPool> SessionPool;
+	// Stopped pool whose sessions are still being destroyed
+	TUniquePtr<FMPSessionPool> StoppingSessionPool;
+	// Start deferred until the stopping pool is destroyed, its sessions have the same names
+	TUniqueFunction<void()> PendingSessionPoolStart;
+	// Only set in event bus mode
+	TUniquePtr<FMPSessionEventQueue> SessionEventQueue;
+	// Only set while exporting metrics
+	TUniquePtr<FMPSessionMetrics> Metrics;
+	FTSTicker::FDelegateHandle MetricsTickerHandle;
+	// Only set while recording or replaying the online traffic, never both
+	TUniquePtr<FMPOnlineTrafficRecorder> OnlineTrafficRecorder;
+	TUniquePtr<FMPOnlineTrafficReplay> OnlineTrafficReplay;
+	// Backend game session state of the last replayed callback, unset when there was none
+	TOptional<EOnlineSessionState::Type> ReplayedNamedSessionState;
+
+	// Searches are serialized, the session interface reports completion without telling which search completed
+	TSharedPtr<FOnlineSessionSearch> InFlightSessionSearch;
+	FMPOnSessionSearchComplete InFlightSessionSearchComplete;
+	TArray<TPair<TSharedRef<FOnlineSessionSearch>, FMPOnSessionSearchComplete>> QueuedSessionSearches;
+
+	/**
+	 * State of the current paged search. The session interface has no offset, so page N is a search for (N + 1) * PageSize
+	 * results of which the sessions already delivered are skipped.
+	 */
+	struct FPagedSessionSearch
+	{
+		int32 SearchId { INDEX_NONE };
+		int32 PageSize { 0 };
+		// Cap of the search of the last page
+		int32 MaxSearchResults { 0 };
+		FOnlineSearchSettings QuerySettings;
+		TSet<FString> DeliveredSessionIds;
+		int32 NumDeliveredPages { 0 };
+		// Search of the page after the last delivered one, issued ahead of the request for it
+		TSharedPtr<FOnlineSessionSearch> NextPageSearch;
+		bool bIsNextPageInFlight { false };
+		bool bIsNextPageReady { false };
+		bool bWasNextPageSuccessful { false };
+		bool bIsNextPageRequested { false };
+	};
+	FPagedSessionSearch PagedSessionSearch;
+	int32 LastPagedSearchId { INDEX_NONE };
+
+	struct FSessionBrowserSubscription
+	{
+		int32 SubscriptionId { INDEX_NONE };
+		int32 NumSubscribers { 0 };
+		int32 MaxSearchResults { 0 };
+		FOnlineSearchSettings QuerySettings;
+		float MinIntervalSeconds { 5.f };
+		float MaxIntervalSeconds { 60.f };
+		float IntervalSeconds { 5.f };
+		FMPSessionResultTracker ResultTracker;
+		TSharedPtr<FOnlineSessionSearch> Search;
+		FTSTicker::FDelegateHandle RefreshTickerHandle;
+	};
+	FSessionBrowserSubscription SessionBrowserSubscription;
+	int32 LastSessionBrowserSubscriptionId { INDEX_NONE };
+
+	// Sessions recently failed to join, kept for the lifetime of the game instance
+	FMPJoinBlacklist JoinBlacklist;
+
+	struct FJoinBestOfState
+	{
+		bool bIsActive { false };
+		TArray<FOnlineSessionSearchResult> Candidates;
+		FMPJoinBestOfPolicy Policy;
+		int32 NextCandidateIndex { 0 };
+		// Candidate the join in flight was issued for
+		int32 AttemptedCandidateIndex { INDEX_NONE };
+		double StartTime { 0.0 };
+		FMPJoinBestOfResult Result;
+	};
+	FJoinBestOfState JoinBestOfState;
+
+	// Only set while hosting with AdvertisingOnlineSubsystems
+	TUniquePtr<FMPSessionMirrors> SessionMirrors;
+	int32 NumAwaitedSessionMirrorsCalls { 0 };
+	// Completion of the operation in flight, held until the mirrors answered
+	TUniqueFunction<void()> PendingMirroredCompletion;
+	FMPScopedDelegateBinding PostLoginBinding;
+	FMPScopedDelegateBinding LogoutBinding;
+
+	// Current federated search, kept once complete so its results can be looked up
+	TUniquePtr<FMPFederatedSessionSearch> FederatedSearch;
+	// The part of it searched on the online subsystem in use, through TryIssueSessionSearch
+	TSharedPtr<FOnlineSessionSearch> FederatedOwnSearch;
+	int32 LastFederatedSearchId { INDEX_NONE };
+	// Online subsystem to switch back to once the session joined through another backend is left, none when not switched
+	FName HomeOnlineSubsystemName;
+
+	// Set by CreateSession from FMPSessionSettings::bStartAfterCreate, consumed by its completion
+	bool bStartAfterCreatePending { false };
+
+	struct FHostPipeline
+	{
+		bool bIsActive { false };
+		FString TravelURL;
+		FString SessionId;
+		double StartTime { 0.0 };
+		FMPHostTimings Timings;
+		FTSTicker::FDelegateHandle TimeoutHandle;
+	};
+	FHostPipeline HostPipeline;
 
-	bool bCreateSessionOnDestroy { false };
-	int32 LastNumPublicConnections { 4 };
+	// Last joined session. The subsystem lives as long as the game instance, so this survives map loads
+	struct FReconnectInfo
+	{
+		FString SessionId;
+		// Not available when the info was loaded from a previous run
+		TSharedPtr<const FOnlineSessionSearchResult> SearchResult;
+	};
+	FReconnectInfo ReconnectInfo;
+	// Result passed to the in-flight JoinSession, remembered once the join succeeds
+	TSharedPtr<const FOnlineSessionSearchResult> PendingJoinSearchResult;
+	bool bIsReconnecting { false };
+	// Set once Reconnect looked the session up, so a failed join of the result found ends the reconnect
+	bool bHasReconnectLookedUp { false };
+	bool bReconnectAfterDestroy { false };
+	double ReconnectStartTime { 0.0 };
 	bool IsLoggedIn;
 	
 private:
-	std::queue<FPendingLoginAction> PendingLoginActionsQueue;
+	struct FPendingLogin
+	{
+		FPendingLoginAction OnLoggedIn;
+		FPendingLoginAction OnLoginFailed;
+	};
+	std::queue<FPendingLogin> PendingLoginActionsQueue;
 	bool ExecutePendingLoginActions();
+	// Tells the callers waiting for the login that it failed
+	void FailPendingLoginActions();
 	void ClearPendingLoginActions();
 };
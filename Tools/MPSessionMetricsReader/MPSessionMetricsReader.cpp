@@ -0,0 +1,216 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Dumps the session metrics published by a server (UMultiplayerSessionsSubsystem::StartMetricsExport) in Prometheus text format.
+// Standalone, it only reads the shared memory region and never talks to the server process.
+//
+// Build:  c++ -std=c++17 -O2 -o MPSessionMetricsReader MPSessionMetricsReader.cpp   (add -lrt on older glibc)
+//         cl /std:c++17 /O2 /EHsc MPSessionMetricsReader.cpp
+// Usage:  MPSessionMetricsReader <RegionName>
+//         Exits with 1 if the region does not exist or has another layout version, 2 if no consistent copy could be read.
+
+#include "../../Source/MultiplayerSessions/Public/MPSessionMetricsLayout.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	const char* SessionStateNames[] = { "idle", "logging_in", "creating", "created", "starting", "in_progress", "destroying" };
+
+	const FMPSessionMetricsBlock* MapBlock(const char* RegionName)
+	{
+#if defined(_WIN32)
+		const HANDLE Mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, RegionName);
+		if (Mapping == nullptr)
+		{
+			return nullptr;
+		}
+		return static_cast<const FMPSessionMetricsBlock*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, sizeof(FMPSessionMetricsBlock)));
+#else
+		// The engine prefixes region names with a slash on POSIX platforms
+		const std::string ShmName = std::string("/") + RegionName;
+		const int Fd = shm_open(ShmName.c_str(), O_RDONLY, 0);
+		if (Fd < 0)
+		{
+			return nullptr;
+		}
+		void* Address = mmap(nullptr, sizeof(FMPSessionMetricsBlock), PROT_READ, MAP_SHARED, Fd, 0);
+		close(Fd);
+		return Address == MAP_FAILED ? nullptr : static_cast<const FMPSessionMetricsBlock*>(Address);
+#endif
+	}
+
+	/** Seqlock read, retries while the server is publishing */
+	bool ReadData(const FMPSessionMetricsBlock& Block, FMPSessionMetricsData& OutData)
+	{
+		for (int Attempt = 0; Attempt < 1000; ++Attempt)
+		{
+			const uint32_t SequenceBefore = Block.Sequence.load(std::memory_order_acquire);
+			if ((SequenceBefore & 1u) == 0)
+			{
+				std::memcpy(&OutData, &Block.Data, sizeof(FMPSessionMetricsData));
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (Block.Sequence.load(std::memory_order_relaxed) == SequenceBefore)
+				{
+					return true;
+				}
+			}
+			std::this_thread::yield();
+		}
+		return false;
+	}
+
+	void PrintHeader(const char* Name, const char* Type, const char* Help)
+	{
+		std::printf("# HELP %s %s\n# TYPE %s %s\n", Name, Help, Name, Type);
+	}
+
+	/** Estimate within the histogram bucket holding the quantile, assuming completions are spread evenly in it */
+	double GetLatencyQuantile(const FMPSessionMetricsOperation& Operation, const double Quantile)
+	{
+		uint64_t NumCompleted = 0;
+		for (const uint64_t BucketCount : Operation.LatencyBuckets)
+		{
+			NumCompleted += BucketCount;
+		}
+		if (NumCompleted == 0)
+		{
+			return 0.0;
+		}
+		const double Rank = Quantile * static_cast<double>(NumCompleted);
+		uint64_t NumBelow = 0;
+		for (int32_t Bucket = 0; Bucket < MPSessionMetricsNumLatencyBuckets; ++Bucket)
+		{
+			const uint64_t BucketCount = Operation.LatencyBuckets[Bucket];
+			if (BucketCount > 0 && static_cast<double>(NumBelow + BucketCount) >= Rank)
+			{
+				const double LowerBound = Bucket == 0 ? 0.0 : MPSessionMetricsLatencyBucketBoundsSeconds[Bucket - 1];
+				if (Bucket == MPSessionMetricsNumLatencyBuckets - 1)
+				{
+					// No upper bound, the lower one is the best estimate
+					return LowerBound;
+				}
+				const double UpperBound = MPSessionMetricsLatencyBucketBoundsSeconds[Bucket];
+				return LowerBound + (UpperBound - LowerBound) * (Rank - static_cast<double>(NumBelow)) / static_cast<double>(BucketCount);
+			}
+			NumBelow += BucketCount;
+		}
+		return MPSessionMetricsLatencyBucketBoundsSeconds[MPSessionMetricsNumLatencyBuckets - 2];
+	}
+
+	void PrintOperationCounter(const char* Name, const char* Help, const FMPSessionMetricsData& Data, uint64_t FMPSessionMetricsOperation::* Counter)
+	{
+		PrintHeader(Name, "counter", Help);
+		for (int32_t Operation = 0; Operation < MPSessionMetricsNumOperations; ++Operation)
+		{
+			std::printf("%s{operation=\"%s\"} %llu\n", Name, MPSessionMetricsOperationNames[Operation],
+				static_cast<unsigned long long>(Data.Operations[Operation].*Counter));
+		}
+	}
+
+	void PrintMetrics(const FMPSessionMetricsData& Data)
+	{
+		PrintHeader("mpsessions_publishes_total", "counter", "Number of times the server published its metrics");
+		std::printf("mpsessions_publishes_total %llu\n", static_cast<unsigned long long>(Data.NumPublishes));
+		PrintHeader("mpsessions_last_publish_timestamp_seconds", "gauge", "Unix time of the last publish");
+		std::printf("mpsessions_last_publish_timestamp_seconds %.3f\n", static_cast<double>(Data.PublishTimeUnixMs) / 1000.0);
+		PrintHeader("mpsessions_process_id", "gauge", "Process id of the server");
+		std::printf("mpsessions_process_id %lld\n", static_cast<long long>(Data.ProcessId));
+
+		PrintHeader("mpsessions_session_state", "gauge", "1 for the current state of the game session");
+		for (int32_t State = 0; State < static_cast<int32_t>(sizeof(SessionStateNames) / sizeof(SessionStateNames[0])); ++State)
+		{
+			std::printf("mpsessions_session_state{state=\"%s\"} %d\n", SessionStateNames[State], Data.SessionState == State ? 1 : 0);
+		}
+		PrintHeader("mpsessions_queued_operations", "gauge", "Session operations waiting in the scheduler");
+		std::printf("mpsessions_queued_operations %d\n", Data.NumQueuedOperations);
+		PrintHeader("mpsessions_advertised_sessions", "gauge", "Sessions hosted and advertised by the server");
+		std::printf("mpsessions_advertised_sessions %d\n", Data.NumAdvertisedSessions);
+		PrintHeader("mpsessions_registered_players", "gauge", "Players registered in the hosted sessions");
+		std::printf("mpsessions_registered_players %d\n", Data.NumRegisteredPlayers);
+		PrintHeader("mpsessions_ready_pooled_sessions", "gauge", "Pooled sessions ready to be claimed");
+		std::printf("mpsessions_ready_pooled_sessions %d\n", Data.NumReadyPooledSessions);
+		PrintHeader("mpsessions_pending_session_events", "gauge", "Session events waiting to be dispatched in event bus mode");
+		std::printf("mpsessions_pending_session_events %d\n", Data.NumPendingSessionEvents);
+
+		PrintOperationCounter("mpsessions_operations_started_total", "Operations issued to the backend", Data, &FMPSessionMetricsOperation::NumStarted);
+		PrintOperationCounter("mpsessions_operations_succeeded_total", "Operations completed successfully", Data, &FMPSessionMetricsOperation::NumSucceeded);
+		PrintOperationCounter("mpsessions_operations_failed_total", "Operations that failed to issue or to complete", Data, &FMPSessionMetricsOperation::NumFailed);
+		PrintOperationCounter("mpsessions_operations_rejected_total", "Operations rejected for the session state without a backend call", Data, &FMPSessionMetricsOperation::NumRejected);
+
+		PrintHeader("mpsessions_operation_latency_seconds", "histogram", "Time from the issue of an operation to its completion");
+		for (int32_t Operation = 0; Operation < MPSessionMetricsNumOperations; ++Operation)
+		{
+			const FMPSessionMetricsOperation& OperationData = Data.Operations[Operation];
+			const char* OperationName = MPSessionMetricsOperationNames[Operation];
+			uint64_t CumulativeCount = 0;
+			for (int32_t Bucket = 0; Bucket < MPSessionMetricsNumLatencyBuckets; ++Bucket)
+			{
+				CumulativeCount += OperationData.LatencyBuckets[Bucket];
+				if (Bucket < MPSessionMetricsNumLatencyBuckets - 1)
+				{
+					std::printf("mpsessions_operation_latency_seconds_bucket{operation=\"%s\",le=\"%g\"} %llu\n",
+						OperationName, MPSessionMetricsLatencyBucketBoundsSeconds[Bucket], static_cast<unsigned long long>(CumulativeCount));
+				}
+				else
+				{
+					std::printf("mpsessions_operation_latency_seconds_bucket{operation=\"%s\",le=\"+Inf\"} %llu\n",
+						OperationName, static_cast<unsigned long long>(CumulativeCount));
+				}
+			}
+			std::printf("mpsessions_operation_latency_seconds_sum{operation=\"%s\"} %.6f\n",
+				OperationName, static_cast<double>(OperationData.LatencySumMicroseconds) / 1e6);
+			std::printf("mpsessions_operation_latency_seconds_count{operation=\"%s\"} %llu\n",
+				OperationName, static_cast<unsigned long long>(CumulativeCount));
+		}
+
+		PrintHeader("mpsessions_operation_latency_quantile_seconds", "gauge", "Latency percentiles estimated from the histogram");
+		for (int32_t Operation = 0; Operation < MPSessionMetricsNumOperations; ++Operation)
+		{
+			for (const double Quantile : { 0.5, 0.95, 0.99 })
+			{
+				std::printf("mpsessions_operation_latency_quantile_seconds{operation=\"%s\",quantile=\"%g\"} %.6f\n",
+					MPSessionMetricsOperationNames[Operation], Quantile, GetLatencyQuantile(Data.Operations[Operation], Quantile));
+			}
+		}
+	}
+}
+
+int main(int ArgC, char** ArgV)
+{
+	if (ArgC != 2)
+	{
+		std::fprintf(stderr, "Usage: %s <RegionName>\n", ArgV[0]);
+		return 1;
+	}
+	const FMPSessionMetricsBlock* Block = MapBlock(ArgV[1]);
+	if (Block == nullptr)
+	{
+		std::fprintf(stderr, "No metrics region named '%s'\n", ArgV[1]);
+		return 1;
+	}
+	if (Block->Magic != MPSessionMetricsMagic || Block->Version != MPSessionMetricsVersion || Block->DataSize != sizeof(FMPSessionMetricsData))
+	{
+		std::fprintf(stderr, "Region '%s' has layout version %u, this reader reads version %u\n", ArgV[1], Block->Version, MPSessionMetricsVersion);
+		return 1;
+	}
+	FMPSessionMetricsData Data;
+	if (!ReadData(*Block, Data))
+	{
+		std::fprintf(stderr, "Could not read a consistent copy of '%s'\n", ArgV[1]);
+		return 2;
+	}
+	PrintMetrics(Data);
+	return 0;
+}